@@ -19,18 +19,45 @@
 
 #include <atomic>
 #include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
 #include <type_traits>
 #include <utility>
+#include <vector>
+
+#include "cyber/base/macros.h"
 
 namespace apollo {
 namespace cyber {
 namespace base {
+
+/**
+ * @brief Reader slot of the calling thread, readers of different threads
+ * mostly count on different cache lines
+ */
+inline uint32_t AtomicHashMapReaderSlot() {
+  static std::atomic<uint32_t> next_slot = {0};
+  static thread_local uint32_t slot =
+      next_slot.fetch_add(1, std::memory_order_relaxed);
+  return slot;
+}
+
 /**
- * @brief A implementation of lock-free fixed size hash map
+ * @brief A implementation of concurrent hash map, lookups are lock-free
+ *
+ * The keys are spread over 16 shards, each shard is an open addressing
+ * table with linear probing over cache line aligned slots. Writers of a
+ * shard are serialized by its mutex and grow the table online by publishing
+ * a rehashed copy. Replaced tables and values are reclaimed once no lookup
+ * is in flight.
+ *
+ * @warning a value got by Get(key, &value_ptr) stays valid until the key is
+ * removed or set again.
  *
  * @tparam K Type of key, must be integral
  * @tparam V Type of value
- * @tparam 128 Size of hash table
+ * @tparam 128 Initial size of hash table
  * @tparam 0 Type traits, use for checking types of key & value
  */
 template <typename K, typename V, std::size_t TableSize = 128,
@@ -39,257 +66,271 @@ template <typename K, typename V, std::size_t TableSize = 128,
                                   int>::type = 0>
 class AtomicHashMap {
  public:
-  AtomicHashMap() : capacity_(TableSize), mode_num_(capacity_ - 1) {}
+  AtomicHashMap() {
+    uint32_t bits = 0;
+    while ((kShardNum << bits) < TableSize || (1UL << bits) < kMinCapacity) {
+      ++bits;
+    }
+    for (auto &shard : shards_) {
+      shard.table.store(new Table(bits), std::memory_order_release);
+    }
+  }
   AtomicHashMap(const AtomicHashMap &other) = delete;
   AtomicHashMap &operator=(const AtomicHashMap &other) = delete;
 
+  ~AtomicHashMap() {
+    for (auto &shard : shards_) {
+      auto table = shard.table.load(std::memory_order_acquire);
+      for (uint64_t i = 0; i < table->capacity; ++i) {
+        auto value = table->slots[i].value.load(std::memory_order_acquire);
+        if (IsValue(value)) {
+          delete value;
+        }
+      }
+      delete table;
+      FreeRetired(&shard);
+    }
+  }
+
   bool Has(K key) {
-    uint64_t index = key & mode_num_;
-    return table_[index].Has(key);
+    ReadGuard guard(this);
+    return Find(key) != nullptr;
   }
 
   bool Get(K key, V **value) {
-    uint64_t index = key & mode_num_;
-    return table_[index].Get(key, value);
+    ReadGuard guard(this);
+    V *val = Find(key);
+    if (val == nullptr) {
+      return false;
+    }
+    *value = val;
+    return true;
   }
 
   bool Get(K key, V *value) {
-    uint64_t index = key & mode_num_;
-    V *val = nullptr;
-    bool res = table_[index].Get(key, &val);
-    if (res) {
-      *value = *val;
+    ReadGuard guard(this);
+    V *val = Find(key);
+    if (val == nullptr) {
+      return false;
     }
-    return res;
+    *value = *val;
+    return true;
   }
 
-  void Set(K key) {
-    uint64_t index = key & mode_num_;
-    table_[index].Insert(key);
-  }
+  void Set(K key) { Insert(key, new V()); }
+
+  void Set(K key, const V &value) { Insert(key, new V(value)); }
+
+  void Set(K key, V &&value) { Insert(key, new V(std::forward<V>(value))); }
 
-  void Set(K key, const V &value) {
-    uint64_t index = key & mode_num_;
-    table_[index].Insert(key, value);
+  bool Remove(K key) {
+    uint64_t hash = Hash(key);
+    auto &shard = shards_[hash >> (64 - kShardBits)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto table = shard.table.load(std::memory_order_relaxed);
+    auto slot = table->Probe(key, hash);
+    auto old_value = slot->value.load(std::memory_order_relaxed);
+    if (!IsValue(old_value)) {
+      return false;
+    }
+    // the key is kept, the slot is not reused by another key until rehash
+    slot->value.store(Tombstone(), std::memory_order_release);
+    --shard.size;
+    shard.retired_values.emplace_back(old_value);
+    Reclaim(&shard);
+    return true;
   }
 
-  void Set(K key, V &&value) {
-    uint64_t index = key & mode_num_;
-    table_[index].Insert(key, std::forward<V>(value));
+  std::size_t Size() {
+    std::size_t size = 0;
+    for (auto &shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      size += shard.size;
+    }
+    return size;
   }
 
  private:
-  struct Entry {
-    Entry() {}
-    explicit Entry(K key) : key(key) {
-      value_ptr.store(new V(), std::memory_order_release);
-    }
-    Entry(K key, const V &value) : key(key) {
-      value_ptr.store(new V(value), std::memory_order_release);
-    }
-    Entry(K key, V &&value) : key(key) {
-      value_ptr.store(new V(std::forward<V>(value)), std::memory_order_release);
-    }
-    ~Entry() { delete value_ptr.load(std::memory_order_acquire); }
+  static constexpr uint32_t kShardBits = 4;
+  static constexpr uint32_t kShardNum = 1 << kShardBits;
+  static constexpr uint32_t kReaderSlotNum = 16;
+  static constexpr uint64_t kMinCapacity = 8;
 
-    K key = 0;
-    std::atomic<V *> value_ptr = {nullptr};
-    std::atomic<Entry *> next = {nullptr};
+  struct Slot {
+    std::atomic<K> key = {0};
+    // nullptr: never used, Tombstone(): removed
+    std::atomic<V *> value = {nullptr};
   };
 
-  class Bucket {
-   public:
-    Bucket() : head_(new Entry()) {}
-    ~Bucket() {
-      Entry *ite = head_;
-      while (ite) {
-        auto tmp = ite->next.load(std::memory_order_acquire);
-        delete ite;
-        ite = tmp;
+  struct Table {
+    explicit Table(uint32_t table_bits)
+        : bits(table_bits), capacity(1UL << table_bits), mask(capacity - 1) {
+      // probes of a key mostly stay in one cache line
+      void *mem = nullptr;
+      if (posix_memalign(&mem, CACHELINE_SIZE, capacity * sizeof(Slot)) != 0) {
+        throw std::bad_alloc();
+      }
+      slots = static_cast<Slot *>(mem);
+      for (uint64_t i = 0; i < capacity; ++i) {
+        new (&slots[i]) Slot();
       }
     }
+    ~Table() { std::free(slots); }
 
-    bool Has(K key) {
-      Entry *m_target = head_->next.load(std::memory_order_acquire);
-      while (Entry *target = m_target) {
-        if (target->key < key) {
-          m_target = target->next.load(std::memory_order_acquire);
-          continue;
-        } else {
-          return target->key == key;
+    // slot holding the key, or the empty slot where it goes
+    Slot *Probe(K key, uint64_t hash) {
+      uint64_t index = (hash << kShardBits) >> (64 - bits);
+      while (true) {
+        auto &slot = slots[index];
+        if (slot.value.load(std::memory_order_acquire) == nullptr ||
+            slot.key.load(std::memory_order_relaxed) == key) {
+          return &slot;
         }
+        index = (index + 1) & mask;
       }
-      return false;
     }
 
-    bool Find(K key, Entry **prev_ptr, Entry **target_ptr) {
-      Entry *prev = head_;
-      Entry *m_target = head_->next.load(std::memory_order_acquire);
-      while (Entry *target = m_target) {
-        if (target->key == key) {
-          *prev_ptr = prev;
-          *target_ptr = target;
-          return true;
-        } else if (target->key > key) {
-          *prev_ptr = prev;
-          *target_ptr = target;
-          return false;
-        } else {
-          prev = target;
-          m_target = target->next.load(std::memory_order_acquire);
-        }
-      }
-      *prev_ptr = prev;
-      *target_ptr = nullptr;
-      return false;
+    uint32_t bits;
+    uint64_t capacity;
+    uint64_t mask;
+    Slot *slots = nullptr;
+  };
+
+  struct Shard {
+    std::atomic<Table *> table = {nullptr};
+    std::mutex mutex;
+    // guarded by mutex
+    uint64_t size = 0;
+    uint64_t used = 0;  // live and removed slots
+    std::vector<V *> retired_values;
+    std::vector<Table *> retired_tables;
+    char padding[CACHELINE_SIZE];
+  };
+
+  struct ReaderCount {
+    std::atomic<uint64_t> count = {0};
+    char padding[CACHELINE_SIZE - sizeof(std::atomic<uint64_t>)];
+  };
+
+  class ReadGuard {
+   public:
+    explicit ReadGuard(AtomicHashMap *map)
+        : count_(map->readers_[AtomicHashMapReaderSlot() % kReaderSlotNum]
+                     .count) {
+      count_.fetch_add(1, std::memory_order_acq_rel);
     }
+    ~ReadGuard() { count_.fetch_sub(1, std::memory_order_release); }
 
-    void Insert(K key, const V &value) {
-      Entry *prev = nullptr;
-      Entry *target = nullptr;
-      Entry *new_entry = nullptr;
-      V *new_value = nullptr;
-      while (true) {
-        if (Find(key, &prev, &target)) {
-          // key exists, update value
-          if (!new_value) {
-            new_value = new V(value);
-          }
-          auto old_val_ptr = target->value_ptr.load(std::memory_order_acquire);
-          if (target->value_ptr.compare_exchange_strong(
-                  old_val_ptr, new_value, std::memory_order_acq_rel,
-                  std::memory_order_relaxed)) {
-            delete old_val_ptr;
-            if (new_entry) {
-              delete new_entry;
-              new_entry = nullptr;
-            }
-            return;
-          }
-          continue;
-        } else {
-          if (!new_entry) {
-            new_entry = new Entry(key, value);
-          }
-          new_entry->next.store(target, std::memory_order_release);
-          if (prev->next.compare_exchange_strong(target, new_entry,
-                                                 std::memory_order_acq_rel,
-                                                 std::memory_order_relaxed)) {
-            // Insert success
-            if (new_value) {
-              delete new_value;
-              new_value = nullptr;
-            }
-            return;
-          }
-          // another entry has been inserted, retry
-        }
+   private:
+    std::atomic<uint64_t> &count_;
+  };
+
+  static uint64_t Hash(K key) {
+    return static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15UL;
+  }
+
+  static V *Tombstone() { return reinterpret_cast<V *>(alignof(V)); }
+
+  static bool IsValue(V *value) {
+    return value != nullptr && value != Tombstone();
+  }
+
+  V *Find(K key) {
+    uint64_t hash = Hash(key);
+    auto &shard = shards_[hash >> (64 - kShardBits)];
+    auto table = shard.table.load(std::memory_order_acquire);
+    uint64_t index = (hash << kShardBits) >> (64 - table->bits);
+    while (true) {
+      auto &slot = table->slots[index];
+      auto value = slot.value.load(std::memory_order_acquire);
+      if (value == nullptr) {
+        return nullptr;
       }
+      if (slot.key.load(std::memory_order_relaxed) == key) {
+        return value == Tombstone() ? nullptr : value;
+      }
+      index = (index + 1) & table->mask;
     }
+  }
 
-    void Insert(K key, V &&value) {
-      Entry *prev = nullptr;
-      Entry *target = nullptr;
-      Entry *new_entry = nullptr;
-      V *new_value = nullptr;
-      while (true) {
-        if (Find(key, &prev, &target)) {
-          // key exists, update value
-          if (!new_value) {
-            new_value = new V(std::forward<V>(value));
-          }
-          auto old_val_ptr = target->value_ptr.load(std::memory_order_acquire);
-          if (target->value_ptr.compare_exchange_strong(
-                  old_val_ptr, new_value, std::memory_order_acq_rel,
-                  std::memory_order_relaxed)) {
-            delete old_val_ptr;
-            if (new_entry) {
-              delete new_entry;
-              new_entry = nullptr;
-            }
-            return;
-          }
-          continue;
-        } else {
-          if (!new_entry) {
-            new_entry = new Entry(key, value);
-          }
-          new_entry->next.store(target, std::memory_order_release);
-          if (prev->next.compare_exchange_strong(target, new_entry,
-                                                 std::memory_order_acq_rel,
-                                                 std::memory_order_relaxed)) {
-            // Insert success
-            if (new_value) {
-              delete new_value;
-              new_value = nullptr;
-            }
-            return;
-          }
-          // another entry has been inserted, retry
-        }
-      }
+  void Insert(K key, V *value) {
+    uint64_t hash = Hash(key);
+    auto &shard = shards_[hash >> (64 - kShardBits)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto table = shard.table.load(std::memory_order_relaxed);
+    // keep at most 3/4 of the slots used so probes stay short
+    if ((shard.used + 1) * 4 > table->capacity * 3) {
+      table = Rehash(&shard);
+    }
+    auto slot = table->Probe(key, hash);
+    auto old_value = slot->value.load(std::memory_order_relaxed);
+    if (old_value == nullptr) {
+      slot->key.store(key, std::memory_order_relaxed);
+      ++shard.used;
+    }
+    if (!IsValue(old_value)) {
+      ++shard.size;
     }
+    slot->value.store(value, std::memory_order_release);
+    if (IsValue(old_value)) {
+      shard.retired_values.emplace_back(old_value);
+    }
+    Reclaim(&shard);
+  }
 
-    void Insert(K key) {
-      Entry *prev = nullptr;
-      Entry *target = nullptr;
-      Entry *new_entry = nullptr;
-      V *new_value = nullptr;
-      while (true) {
-        if (Find(key, &prev, &target)) {
-          // key exists, update value
-          if (!new_value) {
-            new_value = new V();
-          }
-          auto old_val_ptr = target->value_ptr.load(std::memory_order_acquire);
-          if (target->value_ptr.compare_exchange_strong(
-                  old_val_ptr, new_value, std::memory_order_acq_rel,
-                  std::memory_order_relaxed)) {
-            delete old_val_ptr;
-            if (new_entry) {
-              delete new_entry;
-              new_entry = nullptr;
-            }
-            return;
-          }
-          continue;
-        } else {
-          if (!new_entry) {
-            new_entry = new Entry(key);
-          }
-          new_entry->next.store(target, std::memory_order_release);
-          if (prev->next.compare_exchange_strong(target, new_entry,
-                                                 std::memory_order_acq_rel,
-                                                 std::memory_order_relaxed)) {
-            // Insert success
-            if (new_value) {
-              delete new_value;
-              new_value = nullptr;
-            }
-            return;
-          }
-          // another entry has been inserted, retry
-        }
+  Table *Rehash(Shard *shard) {
+    auto table = shard->table.load(std::memory_order_relaxed);
+    uint32_t bits = table->bits;
+    // at most half full afterwards, removed slots are dropped
+    while ((shard->size + 1) * 2 > (1UL << bits)) {
+      ++bits;
+    }
+    auto new_table = new Table(bits);
+    for (uint64_t i = 0; i < table->capacity; ++i) {
+      auto &slot = table->slots[i];
+      auto value = slot.value.load(std::memory_order_relaxed);
+      if (!IsValue(value)) {
+        continue;
       }
+      auto key = slot.key.load(std::memory_order_relaxed);
+      auto new_slot = new_table->Probe(key, Hash(key));
+      new_slot->key.store(key, std::memory_order_relaxed);
+      new_slot->value.store(value, std::memory_order_relaxed);
     }
+    shard->used = shard->size;
+    shard->table.store(new_table, std::memory_order_release);
+    shard->retired_tables.emplace_back(table);
+    return new_table;
+  }
 
-    bool Get(K key, V **value) {
-      Entry *prev = nullptr;
-      Entry *target = nullptr;
-      if (Find(key, &prev, &target)) {
-        *value = target->value_ptr.load(std::memory_order_acquire);
-        return true;
+  // free what has been unlinked once no lookup could still see it
+  void Reclaim(Shard *shard) {
+    if (shard->retired_values.empty() && shard->retired_tables.empty()) {
+      return;
+    }
+    // a lookup counting itself after this read synchronizes with it and
+    // sees the unlinked state
+    for (auto &reader : readers_) {
+      if (reader.count.fetch_add(0, std::memory_order_acq_rel) != 0) {
+        return;
       }
-      return false;
     }
+    FreeRetired(shard);
+  }
 
-    Entry *head_;
-  };
+  void FreeRetired(Shard *shard) {
+    for (auto value : shard->retired_values) {
+      delete value;
+    }
+    shard->retired_values.clear();
+    for (auto table : shard->retired_tables) {
+      delete table;
+    }
+    shard->retired_tables.clear();
+  }
 
- private:
-  Bucket table_[TableSize];
-  uint64_t capacity_;
-  uint64_t mode_num_;
+  Shard shards_[kShardNum];
+  ReaderCount readers_[kReaderSlotNum];
 };
 
 }  // namespace base
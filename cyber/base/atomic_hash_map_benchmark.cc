@@ -0,0 +1,167 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+// Lookup latency of AtomicHashMap with 100, 1k and 10k keys, against an
+// unordered_map guarded by AtomicRWLock. Keys are random 64 bit values like
+// the channel ids hashed from channel names.
+
+#include <getopt.h>
+
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "cyber/base/atomic_hash_map.h"
+#include "cyber/base/atomic_rw_lock.h"
+#include "cyber/base/rw_lock_guard.h"
+#include "cyber/common/log.h"
+
+using apollo::cyber::base::AtomicHashMap;
+using apollo::cyber::base::AtomicRWLock;
+using apollo::cyber::base::ReadLockGuard;
+using apollo::cyber::base::WriteLockGuard;
+
+std::string BINARY_NAME = "atomic_hash_map_benchmark";  // NOLINT
+
+int threads = 2;
+int lookups = 2000000;
+
+void DisplayUsage() {
+  AINFO << "Usage: \n    " << BINARY_NAME << " [OPTION]...\n"
+        << "Description: \n"
+        << "    -h, --help: help information \n"
+        << "    -t, --threads=num: lookup threads, default value is 2\n"
+        << "    -n, --lookups=num: lookups per thread, default value is "
+           "2000000\n"
+        << "Example:\n"
+        << "    " << BINARY_NAME << " -t 4 -n 1000000\n";
+}
+
+void GetOptions(const int argc, char* const argv[]) {
+  opterr = 0;  // extern int opterr
+  int long_index = 0;
+  const std::string short_opts = "ht:n:";
+  static const struct option long_opts[] = {
+      {"help", no_argument, nullptr, 'h'},
+      {"threads", required_argument, nullptr, 't'},
+      {"lookups", required_argument, nullptr, 'n'},
+      {NULL, no_argument, nullptr, 0}};
+
+  do {
+    int opt =
+        getopt_long(argc, argv, short_opts.c_str(), long_opts, &long_index);
+    if (opt == -1) {
+      break;
+    }
+    switch (opt) {
+      case 't':
+        threads = std::stoi(std::string(optarg));
+        break;
+      case 'n':
+        lookups = std::stoi(std::string(optarg));
+        break;
+      case 'h':
+        DisplayUsage();
+        exit(0);
+      default:
+        break;
+    }
+  } while (true);
+  if (threads <= 0 || lookups <= 0) {
+    AERROR << "Invalid option, every value should greater than 0";
+    exit(-1);
+  }
+}
+
+struct LockedMap {
+  void Set(uint64_t key, uint64_t value) {
+    WriteLockGuard<AtomicRWLock> lock(rw_lock);
+    map[key] = value;
+  }
+
+  bool Get(uint64_t key, uint64_t* value) {
+    ReadLockGuard<AtomicRWLock> lock(rw_lock);
+    auto it = map.find(key);
+    if (it == map.end()) {
+      return false;
+    }
+    *value = it->second;
+    return true;
+  }
+
+  AtomicRWLock rw_lock;
+  std::unordered_map<uint64_t, uint64_t> map;
+};
+
+template <typename Map>
+double RunLookups(const std::vector<uint64_t>& keys) {
+  Map map;
+  for (auto key : keys) {
+    map.Set(key, key);
+  }
+
+  std::atomic<uint64_t> misses = {0};
+  auto begin = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; ++t) {
+    workers.emplace_back([&map, &keys, &misses, t]() {
+      std::mt19937_64 gen(t);
+      std::uniform_int_distribution<size_t> dist(0, keys.size() - 1);
+      uint64_t value = 0;
+      uint64_t miss = 0;
+      for (int i = 0; i < lookups; ++i) {
+        auto key = keys[dist(gen)];
+        if (!map.Get(key, &value) || value != key) {
+          ++miss;
+        }
+      }
+      misses += miss;
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  auto end = std::chrono::steady_clock::now();
+  if (misses.load() != 0) {
+    AERROR << misses.load() << " lookups failed.";
+  }
+
+  auto total_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin)
+          .count();
+  return static_cast<double>(total_ns) / lookups;
+}
+
+int main(int argc, char** argv) {
+  GetOptions(argc, argv);
+  std::mt19937_64 gen(0);
+  for (size_t key_num : {100, 1000, 10000}) {
+    std::vector<uint64_t> keys(key_num);
+    for (auto& key : keys) {
+      key = gen();
+    }
+    double atomic_ns = RunLookups<AtomicHashMap<uint64_t, uint64_t>>(keys);
+    double locked_ns = RunLookups<LockedMap>(keys);
+    AINFO << "keys: " << key_num << " threads: " << threads
+          << " lookup(ns) atomic hash map: " << atomic_ns
+          << " rw locked unordered_map: " << locked_ns;
+  }
+  return 0;
+}
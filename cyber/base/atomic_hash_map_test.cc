@@ -16,8 +16,10 @@
 
 #include "cyber/base/atomic_hash_map.h"
 
+#include <atomic>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -98,6 +100,69 @@ TEST(AtomicHashMapTest, concurrency) {
   EXPECT_EQ("0", *str);
 }
 
+TEST(AtomicHashMapTest, remove) {
+  AtomicHashMap<uint64_t, std::string, 16> map;
+  std::string value("");
+  EXPECT_FALSE(map.Remove(1));
+  for (uint64_t i = 0; i < 10000; i++) {
+    map.Set(i, std::to_string(i));
+  }
+  EXPECT_EQ(10000, map.Size());
+  for (uint64_t i = 0; i < 10000; i += 2) {
+    EXPECT_TRUE(map.Remove(i));
+    EXPECT_FALSE(map.Remove(i));
+  }
+  EXPECT_EQ(5000, map.Size());
+  for (uint64_t i = 0; i < 10000; i++) {
+    EXPECT_EQ(i % 2 == 1, map.Has(i));
+    EXPECT_EQ(i % 2 == 1, map.Get(i, &value));
+  }
+
+  // set again after removed
+  map.Set(0, "zero");
+  EXPECT_TRUE(map.Get(0, &value));
+  EXPECT_EQ("zero", value);
+  EXPECT_EQ(5001, map.Size());
+}
+
+TEST(AtomicHashMapTest, resize_with_readers) {
+  AtomicHashMap<uint64_t, uint64_t> map;
+  const uint64_t stable_num = 100;
+  for (uint64_t i = 0; i < stable_num; i++) {
+    map.Set(i, i);
+  }
+
+  std::atomic<bool> stop = {false};
+  std::atomic<int> failures = {0};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 4; t++) {
+    readers.emplace_back([&]() {
+      uint64_t value = 0;
+      while (!stop.load()) {
+        for (uint64_t i = 0; i < stable_num; i++) {
+          if (!map.Get(i, &value) || value != i) {
+            failures++;
+          }
+        }
+      }
+    });
+  }
+
+  // grow to 20000 keys, then remove them all, while stable keys are read
+  for (uint64_t i = stable_num; i < 20000; i++) {
+    map.Set(i, i);
+  }
+  for (uint64_t i = stable_num; i < 20000; i++) {
+    EXPECT_TRUE(map.Remove(i));
+  }
+  stop = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(0, failures.load());
+  EXPECT_EQ(stable_num, map.Size());
+}
+
 }  // namespace base
 }  // namespace cyber
 }  // namespace apollo
@@ -0,0 +1,200 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#ifndef CYBER_BASE_RCU_H_
+#define CYBER_BASE_RCU_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace apollo {
+namespace cyber {
+namespace base {
+
+/**
+ * @class Rcu
+ * @brief Process wide epoch based reclamation for read-mostly data.
+ *
+ * Readers enter a read section, load a pointer published by a writer and use
+ * the object it points to without any lock. A writer publishes a new object,
+ * then retires the old one, which is deleted once every read section that
+ * may still see it has ended. Read sections nest and only touch memory of the
+ * calling thread.
+ */
+class Rcu {
+ public:
+  static Rcu* Instance() {
+    // never destroyed, read sections may run during static destruction
+    static Rcu* instance = new Rcu();
+    return instance;
+  }
+
+  void ReadLock() {
+    auto record = LocalRecord();
+    if (record->nesting++ == 0) {
+      record->epoch.store(epoch_.load(std::memory_order_relaxed),
+                          std::memory_order_relaxed);
+      // the announcement must be visible before the reads of the section,
+      // pairs with Retire() publishing then scanning
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+  }
+
+  void ReadUnlock() {
+    auto record = LocalRecord();
+    if (--record->nesting == 0) {
+      record->epoch.store(0, std::memory_order_release);
+    }
+  }
+
+  /**
+   * @brief Delete an object once no read section can reference it any more,
+   * call after the pointer to it has been replaced
+   */
+  void Retire(std::function<void()> deleter) {
+    std::vector<std::function<void()>> ready;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      retired_.emplace_back(epoch_.fetch_add(1), std::move(deleter));
+      Collect(&ready);
+    }
+    // out of the lock, deleters may destroy callbacks that retire again
+    for (auto& deleter : ready) {
+      deleter();
+    }
+  }
+
+  /**
+   * @brief Delete what Retire() could not yet
+   */
+  void Reclaim() {
+    std::vector<std::function<void()>> ready;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      Collect(&ready);
+    }
+    for (auto& deleter : ready) {
+      deleter();
+    }
+  }
+
+  size_t RetiredSize() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return retired_.size();
+  }
+
+ private:
+  struct Record {
+    // epoch at the start of the outermost read section, 0 if out of any
+    std::atomic<uint64_t> epoch = {0};
+    std::atomic<bool> in_use = {false};
+    uint32_t nesting = 0;
+    Record* next = nullptr;
+  };
+
+  // gives the record back when its thread exits
+  struct RecordHolder {
+    Record* record = nullptr;
+    ~RecordHolder() {
+      if (record != nullptr) {
+        record->in_use.store(false, std::memory_order_release);
+      }
+    }
+  };
+
+  Rcu() = default;
+  Rcu(const Rcu&) = delete;
+  Rcu& operator=(const Rcu&) = delete;
+
+  Record* LocalRecord() {
+    static thread_local RecordHolder holder;
+    if (holder.record == nullptr) {
+      holder.record = AcquireRecord();
+    }
+    return holder.record;
+  }
+
+  // records are never freed, the ones of exited threads are reused
+  Record* AcquireRecord() {
+    for (auto record = records_.load(std::memory_order_acquire);
+         record != nullptr; record = record->next) {
+      bool in_use = false;
+      if (!record->in_use.load(std::memory_order_relaxed) &&
+          record->in_use.compare_exchange_strong(in_use, true,
+                                                 std::memory_order_acquire)) {
+        return record;
+      }
+    }
+    auto record = new Record();
+    record->in_use.store(true, std::memory_order_relaxed);
+    auto head = records_.load(std::memory_order_relaxed);
+    do {
+      record->next = head;
+    } while (!records_.compare_exchange_weak(head, record,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed));
+    return record;
+  }
+
+  // NOTE: mutex_ hold
+  void Collect(std::vector<std::function<void()>>* ready) {
+    if (retired_.empty()) {
+      return;
+    }
+    // an object retired in epoch e may be seen by the sections started at or
+    // before e
+    uint64_t oldest = UINT64_MAX;
+    for (auto record = records_.load(std::memory_order_acquire);
+         record != nullptr; record = record->next) {
+      auto epoch = record->epoch.load(std::memory_order_seq_cst);
+      if (epoch != 0 && epoch < oldest) {
+        oldest = epoch;
+      }
+    }
+    auto it = retired_.begin();
+    for (; it != retired_.end() && it->first < oldest; ++it) {
+      ready->emplace_back(std::move(it->second));
+    }
+    retired_.erase(retired_.begin(), it);
+  }
+
+  // starts at 1, 0 marks a thread out of any read section
+  std::atomic<uint64_t> epoch_ = {1};
+  std::atomic<Record*> records_ = {nullptr};
+  std::mutex mutex_;
+  // in retiring order, so in epoch order
+  std::vector<std::pair<uint64_t, std::function<void()>>> retired_;
+};
+
+class RcuReadGuard {
+ public:
+  RcuReadGuard() { Rcu::Instance()->ReadLock(); }
+  ~RcuReadGuard() { Rcu::Instance()->ReadUnlock(); }
+
+ private:
+  RcuReadGuard(const RcuReadGuard&) = delete;
+  RcuReadGuard& operator=(const RcuReadGuard&) = delete;
+};
+
+}  // namespace base
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_BASE_RCU_H_
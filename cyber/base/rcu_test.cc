@@ -0,0 +1,110 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "cyber/base/rcu.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace apollo {
+namespace cyber {
+namespace base {
+
+TEST(RcuTest, retire) {
+  auto rcu = Rcu::Instance();
+  rcu->Reclaim();
+  int deleted = 0;
+  rcu->Retire([&deleted]() { ++deleted; });
+  EXPECT_EQ(deleted, 1);
+
+  {
+    RcuReadGuard outer;
+    rcu->Retire([&deleted]() { ++deleted; });
+    {
+      RcuReadGuard inner;
+    }
+    // the outer section may still see it
+    rcu->Reclaim();
+    EXPECT_EQ(deleted, 1);
+  }
+  rcu->Reclaim();
+  EXPECT_EQ(deleted, 2);
+
+  // a section started after the retirement does not hold it back
+  std::atomic<bool> entered = {false};
+  std::atomic<bool> done = {false};
+  std::thread reader([&entered, &done]() {
+    RcuReadGuard guard;
+    entered = true;
+    while (!done) {
+      std::this_thread::yield();
+    }
+  });
+  while (!entered) {
+    std::this_thread::yield();
+  }
+  rcu->Retire([&deleted]() { ++deleted; });
+  EXPECT_EQ(deleted, 2);
+  done = true;
+  reader.join();
+  rcu->Reclaim();
+  EXPECT_EQ(deleted, 3);
+  EXPECT_EQ(rcu->RetiredSize(), 0);
+}
+
+TEST(RcuTest, concurrent) {
+  struct Value {
+    std::atomic<int> alive = {1};
+  };
+  std::atomic<Value*> current = {new Value()};
+  std::atomic<bool> stop = {false};
+  std::atomic<int> errors = {0};
+
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&current, &stop, &errors]() {
+      while (!stop) {
+        RcuReadGuard guard;
+        auto value = current.load(std::memory_order_acquire);
+        if (value->alive.load() != 1) {
+          ++errors;
+        }
+      }
+    });
+  }
+  for (int i = 0; i < 10000; ++i) {
+    auto old_value = current.exchange(new Value());
+    Rcu::Instance()->Retire([old_value]() {
+      old_value->alive = 0;
+      delete old_value;
+    });
+  }
+  stop = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  Rcu::Instance()->Reclaim();
+  EXPECT_EQ(errors.load(), 0);
+  EXPECT_EQ(Rcu::Instance()->RetiredSize(), 0);
+  delete current.load();
+}
+
+}  // namespace base
+}  // namespace cyber
+}  // namespace apollo
@@ -17,11 +17,13 @@
 #ifndef CYBER_BASE_SIGNAL_H_
 #define CYBER_BASE_SIGNAL_H_
 
-#include <algorithm>
+#include <atomic>
 #include <functional>
-#include <list>
 #include <memory>
 #include <mutex>
+#include <vector>
+
+#include "cyber/base/rcu.h"
 
 namespace apollo {
 namespace cyber {
@@ -38,79 +40,94 @@ class Signal {
  public:
   using Callback = std::function<void(Args...)>;
   using SlotPtr = std::shared_ptr<Slot<Args...>>;
-  using SlotList = std::list<SlotPtr>;
+  using SlotList = std::vector<SlotPtr>;
   using ConnectionType = Connection<Args...>;
 
   Signal() {}
   virtual ~Signal() { DisconnectAllSlots(); }
 
+  // the slots are an immutable snapshot replaced on every change, emitting
+  // neither locks nor copies it
   void operator()(Args... args) {
-    SlotList local;
-    {
-      std::lock_guard<std::mutex> lock(mutex_);
-      for (auto& slot : slots_) {
-        local.emplace_back(slot);
-      }
+    RcuReadGuard guard;
+    auto slots = slots_.load(std::memory_order_acquire);
+    if (slots == nullptr) {
+      return;
     }
-
-    if (!local.empty()) {
-      for (auto& slot : local) {
-        (*slot)(args...);
-      }
+    for (auto& slot : *slots) {
+      (*slot)(args...);
     }
-
-    ClearDisconnectedSlots();
   }
 
   ConnectionType Connect(const Callback& cb) {
     auto slot = std::make_shared<Slot<Args...>>(cb);
     {
       std::lock_guard<std::mutex> lock(mutex_);
-      slots_.emplace_back(slot);
+      auto slots = slots_.load();
+      auto new_slots = slots ? new SlotList(*slots) : new SlotList();
+      new_slots->emplace_back(slot);
+      Publish(new_slots);
     }
 
     return ConnectionType(slot, this);
   }
 
   bool Disconnect(const ConnectionType& conn) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto slots = slots_.load();
+    if (slots == nullptr) {
+      return false;
+    }
     bool find = false;
-    {
-      std::lock_guard<std::mutex> lock(mutex_);
-      for (auto& slot : slots_) {
-        if (conn.HasSlot(slot)) {
-          find = true;
-          slot->Disconnect();
-        }
+    auto new_slots = new SlotList();
+    new_slots->reserve(slots->size());
+    for (auto& slot : *slots) {
+      if (conn.HasSlot(slot)) {
+        find = true;
+        slot->Disconnect();
+      } else {
+        new_slots->emplace_back(slot);
       }
     }
 
-    if (find) {
-      ClearDisconnectedSlots();
+    if (!find) {
+      delete new_slots;
+      return false;
+    }
+    if (new_slots->empty()) {
+      delete new_slots;
+      new_slots = nullptr;
     }
-    return find;
+    Publish(new_slots);
+    return true;
   }
 
   void DisconnectAllSlots() {
     std::lock_guard<std::mutex> lock(mutex_);
-    for (auto& slot : slots_) {
+    auto slots = slots_.load();
+    if (slots == nullptr) {
+      return;
+    }
+    for (auto& slot : *slots) {
       slot->Disconnect();
     }
-    slots_.clear();
+    Publish(nullptr);
   }
 
  private:
   Signal(const Signal&) = delete;
   Signal& operator=(const Signal&) = delete;
 
-  void ClearDisconnectedSlots() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    slots_.erase(
-        std::remove_if(slots_.begin(), slots_.end(),
-                       [](const SlotPtr& slot) { return !slot->connected(); }),
-        slots_.end());
+  // NOTE: mutex_ hold
+  void Publish(SlotList* slots) {
+    auto old_slots = slots_.exchange(slots);
+    if (old_slots != nullptr) {
+      Rcu::Instance()->Retire([old_slots]() { delete old_slots; });
+    }
   }
 
-  SlotList slots_;
+  std::atomic<SlotList*> slots_ = {nullptr};
+  // serializes the writers
   std::mutex mutex_;
 };
 
@@ -167,13 +184,13 @@ class Slot {
  public:
   using Callback = std::function<void(Args...)>;
   Slot(const Slot& another)
-      : cb_(another.cb_), connected_(another.connected_) {}
+      : cb_(another.cb_), connected_(another.connected_.load()) {}
   explicit Slot(const Callback& cb, bool connected = true)
       : cb_(cb), connected_(connected) {}
   virtual ~Slot() {}
 
   void operator()(Args... args) {
-    if (connected_ && cb_) {
+    if (connected_.load(std::memory_order_relaxed) && cb_) {
       cb_(args...);
     }
   }
@@ -183,7 +200,8 @@ class Slot {
 
  private:
   Callback cb_;
-  bool connected_ = true;
+  // cleared while the signal may be emitting
+  std::atomic<bool> connected_ = {true};
 };
 
 }  // namespace base
@@ -16,7 +16,10 @@
 
 #include "cyber/base/signal.h"
 
+#include <atomic>
 #include <memory>
+#include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -135,6 +138,58 @@ TEST(SignalTest, module) {
   EXPECT_NE(sum_b, lhs + rhs);
 }
 
+TEST(SignalTest, reentrant) {
+  Signal<int> sig;
+  int count_a = 0;
+  int count_b = 0;
+  Connection<int> conn_b;
+  // disconnecting and connecting from a slot apply to the next emit
+  auto conn_a = sig.Connect([&](int) {
+    ++count_a;
+    conn_b.Disconnect();
+    sig.Connect([&count_b](int) { ++count_b; });
+  });
+  conn_b = sig.Connect([&count_b](int) { count_b += 100; });
+
+  sig(0);
+  EXPECT_EQ(count_a, 1);
+  EXPECT_EQ(count_b, 0);
+  EXPECT_FALSE(conn_b.IsConnected());
+
+  EXPECT_TRUE(conn_a.Disconnect());
+  sig(0);
+  EXPECT_EQ(count_a, 1);
+  EXPECT_EQ(count_b, 1);
+}
+
+TEST(SignalTest, concurrent) {
+  Signal<int> sig;
+  std::atomic<int> sum = {0};
+  auto conn = sig.Connect([&sum](int n) { sum += n; });
+  std::atomic<bool> stop = {false};
+
+  std::vector<std::thread> emitters;
+  for (int i = 0; i < 4; ++i) {
+    emitters.emplace_back([&sig, &stop]() {
+      while (!stop) {
+        sig(0);
+      }
+    });
+  }
+  for (int i = 0; i < 1000; ++i) {
+    auto temp = sig.Connect([](int) {});
+    EXPECT_TRUE(sig.Disconnect(temp));
+  }
+  stop = true;
+  for (auto& emitter : emitters) {
+    emitter.join();
+  }
+
+  sig(1);
+  EXPECT_EQ(sum.load(), 1);
+  EXPECT_TRUE(conn.IsConnected());
+}
+
 }  // namespace base
 }  // namespace cyber
 }  // namespace apollo
@@ -0,0 +1,182 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+// Per-message cost of the intra dispatch fan-out: the ListenerHandler that
+// IntraDispatcher::OnMessage runs for every message, with half of the
+// subscribers listening to the whole channel and half to one writer only.
+// Callbacks are empty, so the time reported is the emission overhead.
+
+#include <getopt.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cyber/benchmark/benchmark_msg.pb.h"
+#include "cyber/common/log.h"
+#include "cyber/transport/common/identity.h"
+#include "cyber/transport/message/listener_handler.h"
+#include "cyber/transport/message/message_info.h"
+
+using apollo::cyber::benchmark::BenchmarkMsg;
+using apollo::cyber::transport::Identity;
+using apollo::cyber::transport::ListenerHandler;
+using apollo::cyber::transport::MessageInfo;
+
+std::string BINARY_NAME = "cyber_dispatch_benchmark";  // NOLINT
+
+std::vector<int> subscriber_nums = {1, 4, 32};  // NOLINT
+int message_num = 1000000;
+int thread_num = 1;
+
+void DisplayUsage() {
+  AINFO << "Usage: \n    " << BINARY_NAME << " [OPTION]...\n"
+        << "Description: \n"
+        << "    -h, --help: help information \n"
+        << "    -s, --subscriber_num=num[,num]: subscribers per channel, "
+           "default value is 1,4,32\n"
+        << "    -n, --message_num=num: messages per thread, default value "
+           "is 1000000\n"
+        << "    -p, --thread_num=num: threads dispatching concurrently, "
+           "default value is 1\n"
+        << "Example:\n"
+        << "    " << BINARY_NAME << " -s 1,4,32 -n 1000000 -p 4\n";
+}
+
+std::vector<std::string> Split(const std::string& str) {
+  std::vector<std::string> items;
+  std::stringstream ss(str);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (!item.empty()) {
+      items.emplace_back(item);
+    }
+  }
+  return items;
+}
+
+void GetOptions(const int argc, char* const argv[]) {
+  opterr = 0;  // extern int opterr
+  int long_index = 0;
+  const std::string short_opts = "hs:n:p:";
+  static const struct option long_opts[] = {
+      {"help", no_argument, nullptr, 'h'},
+      {"subscriber_num", required_argument, nullptr, 's'},
+      {"message_num", required_argument, nullptr, 'n'},
+      {"thread_num", required_argument, nullptr, 'p'},
+      {NULL, no_argument, nullptr, 0}};
+
+  do {
+    int opt =
+        getopt_long(argc, argv, short_opts.c_str(), long_opts, &long_index);
+    if (opt == -1) {
+      break;
+    }
+    switch (opt) {
+      case 's':
+        subscriber_nums.clear();
+        for (auto& num : Split(optarg)) {
+          subscriber_nums.push_back(std::stoi(num));
+        }
+        break;
+      case 'n':
+        message_num = std::stoi(std::string(optarg));
+        break;
+      case 'p':
+        thread_num = std::stoi(std::string(optarg));
+        break;
+      case 'h':
+        DisplayUsage();
+        exit(0);
+      default:
+        break;
+    }
+  } while (true);
+
+  if (message_num <= 0 || thread_num <= 0 || subscriber_nums.empty() ||
+      *std::min_element(subscriber_nums.begin(), subscriber_nums.end()) <= 0) {
+    AERROR << "Invalid option, numbers should greater than 0";
+    exit(-1);
+  }
+}
+
+void RunBenchmark(int subscriber_num) {
+  ListenerHandler<BenchmarkMsg> handler;
+  Identity writer;
+  std::atomic<uint64_t> received = {0};
+  for (int i = 0; i < subscriber_num; ++i) {
+    Identity reader;
+    auto listener = [&received](const std::shared_ptr<BenchmarkMsg>&,
+                                const MessageInfo&) {
+      received.fetch_add(1, std::memory_order_relaxed);
+    };
+    if (i % 2 == 0) {
+      handler.Connect(reader.HashValue(), listener);
+    } else {
+      handler.Connect(reader.HashValue(), writer.HashValue(), listener);
+    }
+  }
+
+  auto msg = std::make_shared<BenchmarkMsg>();
+  MessageInfo msg_info(writer, 0);
+  // warm up, the first emit of a thread registers its read record
+  for (int i = 0; i < 1000; ++i) {
+    handler.Run(msg, msg_info);
+  }
+  received = 0;
+
+  std::atomic<bool> start = {false};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_num; ++t) {
+    threads.emplace_back([&handler, &msg, &msg_info, &start]() {
+      while (!start.load()) {
+        std::this_thread::yield();
+      }
+      for (int i = 0; i < message_num; ++i) {
+        handler.Run(msg, msg_info);
+      }
+    });
+  }
+  auto begin = std::chrono::steady_clock::now();
+  start = true;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - begin)
+                        .count();
+
+  uint64_t total = static_cast<uint64_t>(message_num) * thread_num;
+  AINFO << "[" << subscriber_num << " subscribers] threads: " << thread_num
+        << " messages: " << total << " callbacks: " << received.load()
+        << " ns per message: " << static_cast<double>(elapsed_ns) / total
+        << " ns per callback: "
+        << static_cast<double>(elapsed_ns) / std::max<uint64_t>(
+                                                 received.load(), 1);
+}
+
+int main(int argc, char** argv) {
+  GetOptions(argc, argv);
+  for (auto num : subscriber_nums) {
+    RunBenchmark(num);
+  }
+  return 0;
+}
@@ -0,0 +1,256 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+// Cross-process wakeup latency and listener cpu cost of the shm notifiers.
+// The notifier side runs in the parent, the listener in a forked child, and
+// the send time (CLOCK_MONOTONIC, shared by both processes) is carried in the
+// channel_id field of ReadableInfo.
+
+#include <getopt.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cyber/common/log.h"
+#include "cyber/transport/shm/condition_notifier.h"
+#include "cyber/transport/shm/futex_notifier.h"
+#include "cyber/transport/shm/multicast_notifier.h"
+
+using apollo::cyber::transport::ConditionNotifier;
+using apollo::cyber::transport::FutexNotifier;
+using apollo::cyber::transport::MulticastNotifier;
+using apollo::cyber::transport::NotifierPtr;
+using apollo::cyber::transport::ReadableInfo;
+
+std::string BINARY_NAME = "cyber_notifier_benchmark";  // NOLINT
+
+std::string notifier_type = "all";  // NOLINT
+int notify_freq = 1000;
+int running_time = 5;
+int idle_time = 2;
+
+const uint32_t kStopIndex = UINT32_MAX;
+
+void DisplayUsage() {
+  AINFO << "Usage: \n    " << BINARY_NAME << " [OPTION]...\n"
+        << "Description: \n"
+        << "    -h, --help: help information \n"
+        << "    -n, --notifier=type: condition, multicast, futex or all, "
+           "default value is all\n"
+        << "    -t, --notify_freq=frequency: notify frequency, default "
+           "value is 1000\n"
+        << "    -T, --time=time: running time, default value is 5 seconds\n"
+        << "    -i, --idle_time=time: idle time used to measure the cpu "
+           "cost of a listener without traffic, default value is 2 seconds\n"
+        << "Example:\n"
+        << "    " << BINARY_NAME << " -n all -t 1000 -T 5\n";
+}
+
+void GetOptions(const int argc, char* const argv[]) {
+  opterr = 0;  // extern int opterr
+  int long_index = 0;
+  const std::string short_opts = "hn:t:T:i:";
+  static const struct option long_opts[] = {
+      {"help", no_argument, nullptr, 'h'},
+      {"notifier", required_argument, nullptr, 'n'},
+      {"notify_freq", required_argument, nullptr, 't'},
+      {"time", required_argument, nullptr, 'T'},
+      {"idle_time", required_argument, nullptr, 'i'},
+      {NULL, no_argument, nullptr, 0}};
+
+  do {
+    int opt =
+        getopt_long(argc, argv, short_opts.c_str(), long_opts, &long_index);
+    if (opt == -1) {
+      break;
+    }
+    switch (opt) {
+      case 'n':
+        notifier_type = std::string(optarg);
+        break;
+      case 't':
+        notify_freq = std::stoi(std::string(optarg));
+        if (notify_freq <= 0) {
+          AERROR << "Invalid notify frequency. It should greater than 0";
+          exit(-1);
+        }
+        break;
+      case 'T':
+        running_time = std::stoi(std::string(optarg));
+        if (running_time <= 0) {
+          AERROR << "Invalid running time. It should greater than 0";
+          exit(-1);
+        }
+        break;
+      case 'i':
+        idle_time = std::stoi(std::string(optarg));
+        if (idle_time < 0) {
+          AERROR << "Invalid idle time. It should not less than 0";
+          exit(-1);
+        }
+        break;
+      case 'h':
+        DisplayUsage();
+        exit(0);
+      default:
+        break;
+    }
+  } while (true);
+}
+
+uint64_t MonoNowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000UL + ts.tv_nsec;
+}
+
+uint64_t CpuTimeUs() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return static_cast<uint64_t>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) *
+             1000000UL +
+         usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+NotifierPtr CreateNotifier(const std::string& type) {
+  if (type == ConditionNotifier::Type()) {
+    return ConditionNotifier::Instance();
+  } else if (type == MulticastNotifier::Type()) {
+    return MulticastNotifier::Instance();
+  } else if (type == FutexNotifier::Type()) {
+    return FutexNotifier::Instance();
+  }
+  return nullptr;
+}
+
+void RunListener(const std::string& type) {
+  auto notifier = CreateNotifier(type);
+  ReadableInfo info;
+  // drain history left in the shared ring by previous runs
+  while (notifier->Listen(0, &info)) {
+  }
+
+  // idle phase, nobody notifies, only the listener loop costs cpu
+  uint64_t idle_cpu_begin = CpuTimeUs();
+  auto idle_end =
+      std::chrono::steady_clock::now() + std::chrono::seconds(idle_time);
+  while (std::chrono::steady_clock::now() < idle_end) {
+    notifier->Listen(100, &info);
+  }
+  uint64_t idle_cpu_us = CpuTimeUs() - idle_cpu_begin;
+
+  std::vector<uint64_t> latencies;
+  latencies.reserve(static_cast<size_t>(notify_freq) * running_time);
+  uint64_t busy_cpu_begin = CpuTimeUs();
+  while (true) {
+    if (!notifier->Listen(1000, &info)) {
+      continue;
+    }
+    uint64_t now = MonoNowNs();
+    if (info.block_index() == kStopIndex) {
+      break;
+    }
+    latencies.push_back((now - info.channel_id()) / 1000);
+  }
+  uint64_t busy_cpu_us = CpuTimeUs() - busy_cpu_begin;
+
+  if (latencies.empty()) {
+    AERROR << "[" << type << "] no notification received.";
+    return;
+  }
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&latencies](double p) {
+    return latencies[static_cast<size_t>(p * (latencies.size() - 1))];
+  };
+  AINFO << "[" << type << "] received: " << latencies.size()
+        << " latency(us) p50: " << percentile(0.5)
+        << " p90: " << percentile(0.9) << " p99: " << percentile(0.99)
+        << " max: " << latencies.back() << " idle cpu: "
+        << (idle_time > 0 ? idle_cpu_us / 10000.0 / idle_time : 0.0)
+        << "% busy cpu per notify(us): "
+        << static_cast<double>(busy_cpu_us) / latencies.size();
+}
+
+void RunNotifier(const std::string& type) {
+  auto notifier = CreateNotifier(type);
+  auto interval = std::chrono::nanoseconds(1000000000L / notify_freq);
+  // listener is still in its idle phase during the first idle_time seconds
+  std::this_thread::sleep_for(std::chrono::seconds(idle_time) +
+                              std::chrono::milliseconds(500));
+
+  uint64_t total = static_cast<uint64_t>(notify_freq) * running_time;
+  auto next = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < total; ++i) {
+    ReadableInfo info(0, static_cast<uint32_t>(i % 16), MonoNowNs());
+    notifier->Notify(info);
+    next += interval;
+    std::this_thread::sleep_until(next);
+  }
+
+  // the stop notification may be lost by multicast, resend a few times
+  for (int i = 0; i < 10; ++i) {
+    notifier->Notify(ReadableInfo(0, kStopIndex, 0));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+
+void RunBenchmark(const std::string& type) {
+  pid_t pid = fork();
+  if (pid < 0) {
+    AERROR << "fork failed.";
+    return;
+  }
+  if (pid == 0) {
+    RunListener(type);
+    CreateNotifier(type)->Shutdown();
+    _exit(0);
+  }
+  RunNotifier(type);
+  waitpid(pid, nullptr, 0);
+}
+
+int main(int argc, char** argv) {
+  GetOptions(argc, argv);
+
+  std::vector<std::string> types;
+  if (notifier_type == "all") {
+    types = {ConditionNotifier::Type(), MulticastNotifier::Type(),
+             FutexNotifier::Type()};
+  } else if (notifier_type == ConditionNotifier::Type() ||
+             notifier_type == MulticastNotifier::Type() ||
+             notifier_type == FutexNotifier::Type()) {
+    types.push_back(notifier_type);
+  } else {
+    AERROR << "unknown notifier type: " << notifier_type;
+    DisplayUsage();
+    return -1;
+  }
+
+  // every notifier is created after fork, so parent and child attach the
+  // shared segment or socket independently just like two cyber processes.
+  for (const auto& type : types) {
+    RunBenchmark(type);
+  }
+  return 0;
+}
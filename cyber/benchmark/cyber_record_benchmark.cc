@@ -0,0 +1,278 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+// Write throughput of RecordFileWriter for every compression type and number
+// of flush threads. The messages are half random bytes and half repeated
+// text, every written file is read back and checked before it is removed.
+
+#include <getopt.h>
+#include <sys/stat.h>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "cyber/common/log.h"
+#include "cyber/record/file/record_file_reader.h"
+#include "cyber/record/file/record_file_writer.h"
+#include "cyber/record/header_builder.h"
+
+using apollo::cyber::proto::Channel;
+using apollo::cyber::proto::ChunkBody;
+using apollo::cyber::proto::CompressType;
+using apollo::cyber::proto::Header;
+using apollo::cyber::proto::SectionType;
+using apollo::cyber::proto::SingleMessage;
+using apollo::cyber::record::HeaderBuilder;
+using apollo::cyber::record::RecordFileReader;
+using apollo::cyber::record::RecordFileWriter;
+using apollo::cyber::record::Section;
+
+std::string BINARY_NAME = "cyber_record_benchmark";  // NOLINT
+
+std::string file_path = "cyber_record_benchmark.record";  // NOLINT
+int total_mb = 256;
+int message_kb = 64;
+std::vector<uint32_t> thread_nums = {1, 2, 4};  // NOLINT
+std::vector<std::string> compress_names = {"none", "lz4", "zstd"};  // NOLINT
+
+void DisplayUsage() {
+  AINFO << "Usage: \n    " << BINARY_NAME << " [OPTION]...\n"
+        << "Description: \n"
+        << "    -h, --help: help information \n"
+        << "    -o, --output=file: record file written, default value is "
+           "cyber_record_benchmark.record\n"
+        << "    -s, --size=MB: data written per run, default value is 256\n"
+        << "    -m, --message_size=KB: size of a message, default value is "
+           "64\n"
+        << "    -t, --thread_num=num[,num]: flush threads, default value is "
+           "1,2,4\n"
+        << "    -z, --compress=type[,type]: none, lz4 or zstd, default value "
+           "is none,lz4,zstd\n"
+        << "Example:\n"
+        << "    " << BINARY_NAME << " -s 1024 -t 4 -z lz4\n";
+}
+
+std::vector<std::string> Split(const std::string& str) {
+  std::vector<std::string> items;
+  std::stringstream ss(str);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (!item.empty()) {
+      items.emplace_back(item);
+    }
+  }
+  return items;
+}
+
+bool ParseCompress(const std::string& name, CompressType* type) {
+  if (name == "none") {
+    *type = CompressType::COMPRESS_NONE;
+  } else if (name == "lz4") {
+    *type = CompressType::COMPRESS_LZ4;
+  } else if (name == "zstd") {
+    *type = CompressType::COMPRESS_ZSTD;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void GetOptions(const int argc, char* const argv[]) {
+  opterr = 0;  // extern int opterr
+  int long_index = 0;
+  const std::string short_opts = "ho:s:m:t:z:";
+  static const struct option long_opts[] = {
+      {"help", no_argument, nullptr, 'h'},
+      {"output", required_argument, nullptr, 'o'},
+      {"size", required_argument, nullptr, 's'},
+      {"message_size", required_argument, nullptr, 'm'},
+      {"thread_num", required_argument, nullptr, 't'},
+      {"compress", required_argument, nullptr, 'z'},
+      {NULL, no_argument, nullptr, 0}};
+
+  do {
+    int opt =
+        getopt_long(argc, argv, short_opts.c_str(), long_opts, &long_index);
+    if (opt == -1) {
+      break;
+    }
+    switch (opt) {
+      case 'o':
+        file_path = std::string(optarg);
+        break;
+      case 's':
+        total_mb = std::stoi(std::string(optarg));
+        break;
+      case 'm':
+        message_kb = std::stoi(std::string(optarg));
+        break;
+      case 't':
+        thread_nums.clear();
+        for (auto& num : Split(optarg)) {
+          thread_nums.push_back(std::stoi(num));
+        }
+        break;
+      case 'z':
+        compress_names = Split(optarg);
+        break;
+      case 'h':
+        DisplayUsage();
+        exit(0);
+      default:
+        break;
+    }
+  } while (true);
+
+  CompressType type;
+  for (auto& name : compress_names) {
+    if (!ParseCompress(name, &type)) {
+      AERROR << "Invalid compress type: " << name;
+      exit(-1);
+    }
+  }
+  if (total_mb <= 0 || message_kb <= 0 || thread_nums.empty() ||
+      compress_names.empty()) {
+    AERROR << "Invalid option, numbers should greater than 0";
+    exit(-1);
+  }
+  for (auto num : thread_nums) {
+    if (num == 0) {
+      AERROR << "Invalid option, thread_num should greater than 0";
+      exit(-1);
+    }
+  }
+}
+
+std::vector<std::string> MakeContents() {
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> dist(0, 255);
+  const size_t size = message_kb * 1024;
+  std::vector<std::string> contents(16);
+  for (size_t i = 0; i < contents.size(); ++i) {
+    auto& content = contents[i];
+    content.reserve(size);
+    while (content.size() < size / 2) {
+      content.push_back(static_cast<char>(dist(gen)));
+    }
+    while (content.size() < size) {
+      content.append("timestamp_sec: 1234.5 frame_id: velodyne128 ");
+    }
+    content.resize(size);
+  }
+  return contents;
+}
+
+bool Verify(uint64_t message_num, size_t content_size) {
+  RecordFileReader reader;
+  if (!reader.Open(file_path)) {
+    return false;
+  }
+  Section section;
+  uint64_t count = 0;
+  while (reader.ReadSection(&section)) {
+    if (section.type == SectionType::SECTION_INDEX) {
+      break;
+    }
+    if (section.type != SectionType::SECTION_CHUNK_BODY) {
+      if (!reader.SkipSection(section.size)) {
+        return false;
+      }
+      continue;
+    }
+    ChunkBody body;
+    if (!reader.ReadSection<ChunkBody>(section.size, &body)) {
+      return false;
+    }
+    for (const auto& message : body.messages()) {
+      if (message.time() != count + 1 ||
+          message.content().size() != content_size) {
+        return false;
+      }
+      ++count;
+    }
+  }
+  return count == message_num;
+}
+
+void RunBenchmark(const std::string& compress_name, uint32_t thread_num,
+                  const std::vector<std::string>& contents) {
+  CompressType type;
+  ParseCompress(compress_name, &type);
+  const uint64_t message_num =
+      static_cast<uint64_t>(total_mb) * 1024 / message_kb;
+
+  auto start = std::chrono::steady_clock::now();
+  {
+    RecordFileWriter writer(thread_num);
+    if (!writer.Open(file_path)) {
+      AERROR << "open " << file_path << " failed.";
+      return;
+    }
+    Header header = HeaderBuilder::GetHeader();
+    header.set_segment_interval(0);
+    header.set_segment_raw_size(0);
+    header.set_compress(type);
+    Channel channel;
+    channel.set_name("/apollo/benchmark");
+    channel.set_message_type("apollo.cyber.proto.Benchmark");
+    if (!writer.WriteHeader(header) || !writer.WriteChannel(channel)) {
+      AERROR << "write " << file_path << " failed.";
+      return;
+    }
+    SingleMessage message;
+    message.set_channel_name(channel.name());
+    for (uint64_t i = 1; i <= message_num; ++i) {
+      message.set_time(i);
+      message.set_content(contents[i % contents.size()]);
+      if (!writer.WriteMessage(message)) {
+        AERROR << "write message failed.";
+        return;
+      }
+    }
+    writer.Close();
+  }
+  auto seconds = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+
+  struct stat st;
+  double file_mb = 0.0;
+  if (stat(file_path.c_str(), &st) == 0) {
+    file_mb = static_cast<double>(st.st_size) / 1024 / 1024;
+  }
+  bool verified = Verify(message_num, contents[0].size());
+  AINFO << "[" << compress_name << "] flush threads: " << thread_num
+        << " write(MB/s): " << total_mb / seconds
+        << " file(MB): " << file_mb
+        << " ratio: " << file_mb / total_mb
+        << " verified: " << (verified ? "yes" : "NO");
+  std::remove(file_path.c_str());
+}
+
+int main(int argc, char** argv) {
+  GetOptions(argc, argv);
+  auto contents = MakeContents();
+  for (auto& compress_name : compress_names) {
+    for (auto thread_num : thread_nums) {
+      RunBenchmark(compress_name, thread_num, contents);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,244 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+// Wake-to-run latency of the scheduler policies: croutines hang up waiting
+// for data, the main thread notifies random ones and every croutine records
+// how long it took from NotifyTask() until it was resumed. The scheduler is
+// a process wide singleton, so every process group (and so every policy) is
+// measured in a forked child.
+
+#include <getopt.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cyber/common/global_data.h"
+#include "cyber/common/log.h"
+#include "cyber/croutine/croutine.h"
+#include "cyber/init.h"
+#include "cyber/scheduler/scheduler_factory.h"
+
+using apollo::cyber::common::GlobalData;
+using apollo::cyber::croutine::CRoutine;
+using apollo::cyber::croutine::RoutineState;
+
+std::string BINARY_NAME = "cyber_scheduler_benchmark";  // NOLINT
+
+std::vector<std::string> process_groups = {  // NOLINT
+    "example_sched_classic", "example_sched_work_stealing"};
+std::vector<int> routine_nums = {10, 100, 1000};  // NOLINT
+int rounds = 2000;
+int burst = 8;
+int interval_us = 1000;
+
+void DisplayUsage() {
+  AINFO << "Usage: \n    " << BINARY_NAME << " [OPTION]...\n"
+        << "Description: \n"
+        << "    -h, --help: help information \n"
+        << "    -g, --process_group=name[,name]: process groups whose "
+           "conf/<name>.conf selects the policy, default value is "
+           "example_sched_classic,example_sched_work_stealing\n"
+        << "    -n, --routine_num=num[,num]: croutine numbers, default value "
+           "is 10,100,1000\n"
+        << "    -r, --rounds=num: notify rounds, default value is 2000\n"
+        << "    -b, --burst=num: croutines notified per round, default value "
+           "is 8\n"
+        << "    -i, --interval=us: interval between rounds, default value is "
+           "1000\n"
+        << "Example:\n"
+        << "    " << BINARY_NAME
+        << " -g example_sched_work_stealing -n 10,1000 -r 1000\n";
+}
+
+std::vector<std::string> Split(const std::string& str) {
+  std::vector<std::string> items;
+  std::stringstream ss(str);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (!item.empty()) {
+      items.emplace_back(item);
+    }
+  }
+  return items;
+}
+
+void GetOptions(const int argc, char* const argv[]) {
+  opterr = 0;  // extern int opterr
+  int long_index = 0;
+  const std::string short_opts = "hg:n:r:b:i:";
+  static const struct option long_opts[] = {
+      {"help", no_argument, nullptr, 'h'},
+      {"process_group", required_argument, nullptr, 'g'},
+      {"routine_num", required_argument, nullptr, 'n'},
+      {"rounds", required_argument, nullptr, 'r'},
+      {"burst", required_argument, nullptr, 'b'},
+      {"interval", required_argument, nullptr, 'i'},
+      {NULL, no_argument, nullptr, 0}};
+
+  do {
+    int opt =
+        getopt_long(argc, argv, short_opts.c_str(), long_opts, &long_index);
+    if (opt == -1) {
+      break;
+    }
+    switch (opt) {
+      case 'g':
+        process_groups = Split(optarg);
+        break;
+      case 'n':
+        routine_nums.clear();
+        for (auto& num : Split(optarg)) {
+          routine_nums.push_back(std::stoi(num));
+        }
+        break;
+      case 'r':
+        rounds = std::stoi(std::string(optarg));
+        break;
+      case 'b':
+        burst = std::stoi(std::string(optarg));
+        break;
+      case 'i':
+        interval_us = std::stoi(std::string(optarg));
+        break;
+      case 'h':
+        DisplayUsage();
+        exit(0);
+      default:
+        break;
+    }
+  } while (true);
+
+  if (rounds <= 0 || burst <= 0 || interval_us < 0 || routine_nums.empty() ||
+      *std::min_element(routine_nums.begin(), routine_nums.end()) <= 0) {
+    AERROR << "Invalid option, numbers should greater than 0";
+    exit(-1);
+  }
+}
+
+uint64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+struct Routine {
+  uint64_t crid = 0;
+  std::atomic<uint64_t> notify_time = {0};
+  // only written by the croutine itself
+  std::vector<uint64_t> latencies;
+};
+
+void RunRoutines(const std::string& group, int routine_num) {
+  auto sched = apollo::cyber::scheduler::Instance();
+  std::vector<std::unique_ptr<Routine>> routines;
+  for (int i = 0; i < routine_num; ++i) {
+    auto name = "sched_bench_" + std::to_string(routine_num) + "_" +
+                std::to_string(i);
+    routines.emplace_back(new Routine());
+    auto routine = routines.back().get();
+    routine->latencies.reserve(static_cast<size_t>(rounds) * burst /
+                                   routine_num +
+                               16);
+    sched->CreateTask(
+        [routine]() {
+          for (;;) {
+            // same wait pattern as the routines built by RoutineFactory
+            CRoutine::GetCurrentRoutine()->set_state(RoutineState::DATA_WAIT);
+            auto notify_time = routine->notify_time.exchange(0);
+            if (notify_time != 0) {
+              routine->latencies.push_back((NowNs() - notify_time) / 1000);
+            }
+            CRoutine::Yield();
+          }
+        },
+        name);
+    routine->crid = GlobalData::GenerateHashId(name);
+  }
+  // let every croutine run once and hang up
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  std::mt19937 gen(routine_num);
+  std::uniform_int_distribution<int> dist(0, routine_num - 1);
+  for (int r = 0; r < rounds; ++r) {
+    for (int b = 0; b < burst; ++b) {
+      auto routine = routines[dist(gen)].get();
+      uint64_t expected = 0;
+      // one pending notification per croutine, it is measured from the first
+      if (routine->notify_time.compare_exchange_strong(expected, NowNs())) {
+        sched->NotifyTask(routine->crid);
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(interval_us));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  std::vector<uint64_t> latencies;
+  for (int i = 0; i < routine_num; ++i) {
+    sched->RemoveTask("sched_bench_" + std::to_string(routine_num) + "_" +
+                      std::to_string(i));
+    auto& samples = routines[i]->latencies;
+    latencies.insert(latencies.end(), samples.begin(), samples.end());
+  }
+  if (latencies.empty()) {
+    AERROR << "[" << group << "] no croutine has been woken up.";
+    return;
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&latencies](double p) {
+    return latencies[static_cast<size_t>(p * (latencies.size() - 1))];
+  };
+  AINFO << "[" << group << "] croutines: " << routine_num
+        << " wakeups: " << latencies.size()
+        << " wake-to-run(us) p50: " << percentile(0.5)
+        << " p90: " << percentile(0.9) << " p99: " << percentile(0.99)
+        << " max: " << latencies.back();
+}
+
+void RunBenchmark(const std::string& group, char* binary) {
+  pid_t pid = fork();
+  if (pid < 0) {
+    AERROR << "fork failed.";
+    return;
+  }
+  if (pid == 0) {
+    GlobalData::Instance()->SetProcessGroup(group);
+    apollo::cyber::Init(binary, BINARY_NAME);
+    for (auto routine_num : routine_nums) {
+      RunRoutines(group, routine_num);
+    }
+    apollo::cyber::Clear();
+    _exit(0);
+  }
+  waitpid(pid, nullptr, 0);
+}
+
+int main(int argc, char** argv) {
+  GetOptions(argc, argv);
+  for (auto& group : process_groups) {
+    RunBenchmark(group, argv[0]);
+  }
+  return 0;
+}
@@ -0,0 +1,259 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+// Throughput and cpu cost per message of small shm messages, with and without
+// batching (batch_max_count of QosProfile). The writer runs in the parent and
+// the reader, a ShmDispatcher listener, in a forked child.
+
+#include <getopt.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cyber/benchmark/benchmark_msg.pb.h"
+#include "cyber/common/global_data.h"
+#include "cyber/common/log.h"
+#include "cyber/common/util.h"
+#include "cyber/time/time.h"
+#include "cyber/transport/common/identity.h"
+#include "cyber/transport/dispatcher/shm_dispatcher.h"
+#include "cyber/transport/transmitter/shm_transmitter.h"
+
+using apollo::cyber::Time;
+using apollo::cyber::benchmark::BenchmarkMsg;
+using apollo::cyber::common::GlobalData;
+using apollo::cyber::proto::RoleAttributes;
+using apollo::cyber::transport::Identity;
+using apollo::cyber::transport::MessageInfo;
+using apollo::cyber::transport::ShmDispatcher;
+using apollo::cyber::transport::ShmTransmitter;
+using apollo::cyber::transport::Transmitter;
+
+std::string BINARY_NAME = "cyber_shm_batch_benchmark";  // NOLINT
+
+std::vector<uint32_t> batch_counts = {1, 16};  // NOLINT
+uint32_t batch_delay_us = 1000;
+int message_size = 64;
+int message_num = 100000;
+int message_rate = 10000;
+
+void DisplayUsage() {
+  AINFO << "Usage: \n    " << BINARY_NAME << " [OPTION]...\n"
+        << "Description: \n"
+        << "    -h, --help: help information \n"
+        << "    -b, --batch_count=num[,num]: batch_max_count, 1 disables "
+           "batching, default value is 1,16\n"
+        << "    -d, --batch_delay=us: batch_max_delay_us, default value is "
+           "1000\n"
+        << "    -s, --message_size=bytes: payload size, default value is 64\n"
+        << "    -n, --message_num=num: messages to write, default value is "
+           "100000\n"
+        << "    -r, --rate=num: messages per second, 0 writes as fast as "
+           "possible, default value is 10000\n"
+        << "Example:\n"
+        << "    " << BINARY_NAME << " -b 1,8,64 -s 32 -r 0\n";
+}
+
+std::vector<std::string> Split(const std::string& str) {
+  std::vector<std::string> items;
+  std::stringstream ss(str);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (!item.empty()) {
+      items.emplace_back(item);
+    }
+  }
+  return items;
+}
+
+void GetOptions(const int argc, char* const argv[]) {
+  opterr = 0;  // extern int opterr
+  int long_index = 0;
+  const std::string short_opts = "hb:d:s:n:r:";
+  static const struct option long_opts[] = {
+      {"help", no_argument, nullptr, 'h'},
+      {"batch_count", required_argument, nullptr, 'b'},
+      {"batch_delay", required_argument, nullptr, 'd'},
+      {"message_size", required_argument, nullptr, 's'},
+      {"message_num", required_argument, nullptr, 'n'},
+      {"rate", required_argument, nullptr, 'r'},
+      {NULL, no_argument, nullptr, 0}};
+
+  do {
+    int opt =
+        getopt_long(argc, argv, short_opts.c_str(), long_opts, &long_index);
+    if (opt == -1) {
+      break;
+    }
+    switch (opt) {
+      case 'b':
+        batch_counts.clear();
+        for (auto& count : Split(optarg)) {
+          batch_counts.push_back(std::stoi(count));
+        }
+        break;
+      case 'd':
+        batch_delay_us = std::stoi(std::string(optarg));
+        break;
+      case 's':
+        message_size = std::stoi(std::string(optarg));
+        break;
+      case 'n':
+        message_num = std::stoi(std::string(optarg));
+        break;
+      case 'r':
+        message_rate = std::stoi(std::string(optarg));
+        break;
+      case 'h':
+        DisplayUsage();
+        exit(0);
+      default:
+        break;
+    }
+  } while (true);
+
+  if (message_size < 0 || message_num <= 0 || message_rate < 0 ||
+      batch_counts.empty()) {
+    AERROR << "Invalid option.";
+    exit(-1);
+  }
+}
+
+uint64_t CpuTimeUs() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return static_cast<uint64_t>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) *
+             1000000UL +
+         usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+RoleAttributes CreateAttr(uint32_t batch_count) {
+  std::string channel = "/benchmark/shm_batch_" + std::to_string(batch_count);
+  RoleAttributes attr;
+  attr.set_host_ip(GlobalData::Instance()->HostIp());
+  attr.set_channel_name(channel);
+  attr.set_channel_id(apollo::cyber::common::Hash(channel));
+  attr.set_id(Identity().HashValue());
+  attr.mutable_qos_profile()->set_batch_max_count(batch_count);
+  attr.mutable_qos_profile()->set_batch_max_delay_us(batch_delay_us);
+  return attr;
+}
+
+void RunReader(uint32_t batch_count) {
+  std::atomic<uint64_t> received = {0};
+  std::atomic<uint64_t> last_time = {0};
+  uint64_t cpu_begin = CpuTimeUs();
+  uint64_t begin = Time::MonoTime().ToMicrosecond();
+  ShmDispatcher::Instance()->AddListener<BenchmarkMsg>(
+      CreateAttr(batch_count),
+      [&received, &last_time](const std::shared_ptr<BenchmarkMsg>&,
+                              const MessageInfo&) {
+        received.fetch_add(1);
+        last_time = Time::MonoTime().ToMicrosecond();
+      });
+
+  // stop once everything arrived or nothing did for a second
+  uint64_t previous = 0;
+  while (received.load() < static_cast<uint64_t>(message_num)) {
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    uint64_t now = received.load();
+    if (now != 0 && now == previous) {
+      break;
+    }
+    previous = now;
+  }
+  uint64_t cpu_us = CpuTimeUs() - cpu_begin;
+  ShmDispatcher::Instance()->Shutdown();
+
+  uint64_t count = received.load();
+  if (count == 0) {
+    AERROR << "[batch " << batch_count << "] no message received.";
+    return;
+  }
+  AINFO << "[batch " << batch_count << "] reader received: " << count << "/"
+        << message_num << " cpu per message(us): "
+        << static_cast<double>(cpu_us) / count << " active time(ms): "
+        << (last_time.load() - begin) / 1000;
+}
+
+void RunWriter(uint32_t batch_count) {
+  // the reader attaches its listener meanwhile
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+  std::shared_ptr<Transmitter<BenchmarkMsg>> transmitter =
+      std::make_shared<ShmTransmitter<BenchmarkMsg>>(CreateAttr(batch_count));
+  transmitter->Enable();
+  auto msg = std::make_shared<BenchmarkMsg>();
+  msg->set_data_bytes(std::string(message_size, 'a'));
+
+  auto interval = message_rate > 0
+                      ? std::chrono::nanoseconds(1000000000L / message_rate)
+                      : std::chrono::nanoseconds(0);
+  uint64_t cpu_begin = CpuTimeUs();
+  auto begin = std::chrono::steady_clock::now();
+  auto next = begin;
+  for (int i = 0; i < message_num; ++i) {
+    transmitter->Transmit(msg);
+    if (message_rate > 0) {
+      next += interval;
+      std::this_thread::sleep_until(next);
+    }
+  }
+  transmitter->Flush();
+  auto elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - begin)
+                        .count();
+  uint64_t cpu_us = CpuTimeUs() - cpu_begin;
+  transmitter->Disable();
+
+  AINFO << "[batch " << batch_count << "] writer sent: " << message_num
+        << " msgs/s: " << message_num * 1000000.0 / elapsed_us
+        << " cpu per message(us): "
+        << static_cast<double>(cpu_us) / message_num;
+}
+
+void RunBenchmark(uint32_t batch_count) {
+  pid_t pid = fork();
+  if (pid < 0) {
+    AERROR << "fork failed.";
+    return;
+  }
+  if (pid == 0) {
+    RunReader(batch_count);
+    _exit(0);
+  }
+  RunWriter(batch_count);
+  waitpid(pid, nullptr, 0);
+}
+
+int main(int argc, char** argv) {
+  GetOptions(argc, argv);
+  // dispatcher and transmitter are created after fork, so each side attaches
+  // the segment and the notifier on its own like two cyber processes.
+  for (auto count : batch_counts) {
+    RunBenchmark(count);
+  }
+  return 0;
+}
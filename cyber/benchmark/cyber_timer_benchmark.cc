@@ -0,0 +1,188 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+// Firing accuracy of periodic timers: every callback records when it ran and
+// the lateness against its ideal deadline start + k * interval is reported.
+// The wheel resolution comes from timer_conf in conf/cyber.pb.conf.
+
+#include <getopt.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cyber/common/log.h"
+#include "cyber/init.h"
+#include "cyber/time/time.h"
+#include "cyber/timer/timer.h"
+#include "cyber/timer/timing_wheel.h"
+
+using apollo::cyber::Time;
+using apollo::cyber::Timer;
+using apollo::cyber::TimingWheel;
+
+std::string BINARY_NAME = "cyber_timer_benchmark";  // NOLINT
+
+std::vector<uint32_t> intervals = {1, 10, 100};  // NOLINT
+int timer_num = 10;
+int duration_s = 10;
+
+void DisplayUsage() {
+  AINFO << "Usage: \n    " << BINARY_NAME << " [OPTION]...\n"
+        << "Description: \n"
+        << "    -h, --help: help information \n"
+        << "    -i, --interval=ms[,ms]: timer intervals, default value is "
+           "1,10,100\n"
+        << "    -n, --timer_num=num: timers per interval, default value is "
+           "10\n"
+        << "    -d, --duration=s: seconds per interval, default value is 10\n"
+        << "Example:\n"
+        << "    " << BINARY_NAME << " -i 1,5 -n 100 -d 5\n";
+}
+
+std::vector<std::string> Split(const std::string& str) {
+  std::vector<std::string> items;
+  std::stringstream ss(str);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (!item.empty()) {
+      items.emplace_back(item);
+    }
+  }
+  return items;
+}
+
+void GetOptions(const int argc, char* const argv[]) {
+  opterr = 0;  // extern int opterr
+  int long_index = 0;
+  const std::string short_opts = "hi:n:d:";
+  static const struct option long_opts[] = {
+      {"help", no_argument, nullptr, 'h'},
+      {"interval", required_argument, nullptr, 'i'},
+      {"timer_num", required_argument, nullptr, 'n'},
+      {"duration", required_argument, nullptr, 'd'},
+      {NULL, no_argument, nullptr, 0}};
+
+  do {
+    int opt =
+        getopt_long(argc, argv, short_opts.c_str(), long_opts, &long_index);
+    if (opt == -1) {
+      break;
+    }
+    switch (opt) {
+      case 'i':
+        intervals.clear();
+        for (auto& interval : Split(optarg)) {
+          intervals.push_back(std::stoi(interval));
+        }
+        break;
+      case 'n':
+        timer_num = std::stoi(std::string(optarg));
+        break;
+      case 'd':
+        duration_s = std::stoi(std::string(optarg));
+        break;
+      case 'h':
+        DisplayUsage();
+        exit(0);
+      default:
+        break;
+    }
+  } while (true);
+
+  if (timer_num <= 0 || duration_s <= 0 || intervals.empty() ||
+      *std::min_element(intervals.begin(), intervals.end()) == 0) {
+    AERROR << "Invalid option, numbers should greater than 0";
+    exit(-1);
+  }
+}
+
+struct Samples {
+  std::mutex mutex;
+  uint64_t start = 0;
+  std::vector<uint64_t> stamps;
+};
+
+void RunBenchmark(uint32_t interval_ms) {
+  std::vector<std::unique_ptr<Samples>> samples;
+  std::vector<std::unique_ptr<Timer>> timers;
+  for (int i = 0; i < timer_num; ++i) {
+    samples.emplace_back(new Samples());
+    auto sample = samples.back().get();
+    sample->stamps.reserve(duration_s * 1000 / interval_ms + 16);
+    timers.emplace_back(new Timer(
+        interval_ms,
+        [sample]() {
+          auto now = Time::MonoTime().ToNanosecond();
+          std::lock_guard<std::mutex> lock(sample->mutex);
+          sample->stamps.push_back(now);
+        },
+        false));
+    sample->start = Time::MonoTime().ToNanosecond();
+    timers.back()->Start();
+  }
+  std::this_thread::sleep_for(std::chrono::seconds(duration_s));
+  for (auto& timer : timers) {
+    timer->Stop();
+  }
+
+  const uint64_t interval_ns = interval_ms * 1000000ULL;
+  std::vector<uint64_t> lateness;
+  uint64_t expected = 0;
+  for (auto& sample : samples) {
+    std::lock_guard<std::mutex> lock(sample->mutex);
+    expected += duration_s * 1000ULL / interval_ms;
+    for (auto stamp : sample->stamps) {
+      // a late firing does not shift the later deadlines, so measure against
+      // the latest deadline passed
+      auto elapsed = stamp - sample->start;
+      if (elapsed >= interval_ns) {
+        lateness.push_back((elapsed % interval_ns) / 1000);
+      }
+    }
+  }
+  if (lateness.empty()) {
+    AERROR << "[" << interval_ms << "ms] no timer has fired.";
+    return;
+  }
+
+  std::sort(lateness.begin(), lateness.end());
+  auto percentile = [&lateness](double p) {
+    return lateness[static_cast<size_t>(p * (lateness.size() - 1))];
+  };
+  AINFO << "[" << interval_ms << "ms] timers: " << timer_num
+        << " fired: " << lateness.size() << "/" << expected
+        << " lateness(us) p50: " << percentile(0.5)
+        << " p90: " << percentile(0.9) << " p99: " << percentile(0.99)
+        << " max: " << lateness.back();
+}
+
+int main(int argc, char** argv) {
+  GetOptions(argc, argv);
+  apollo::cyber::Init(argv[0], BINARY_NAME);
+  AINFO << "timing wheel resolution(us): "
+        << TimingWheel::Instance()->ResolutionNs() / 1000;
+  for (auto interval : intervals) {
+    RunBenchmark(interval);
+  }
+  apollo::cyber::Clear();
+  return 0;
+}
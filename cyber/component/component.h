@@ -182,6 +182,7 @@ bool Component<M0, NullType, NullType, NullType>::Initialize(
   reader_cfg.channel_name = config.readers(0).channel();
   reader_cfg.qos_profile.CopyFrom(config.readers(0).qos_profile());
   reader_cfg.pending_queue_size = config.readers(0).pending_queue_size();
+  reader_cfg.stack_size = config.readers(0).stack_size();
 
   auto role_attr = std::make_shared<proto::RoleAttributes>();
   role_attr->set_node_name(config.name());
@@ -233,6 +234,7 @@ bool Component<M0, NullType, NullType, NullType>::Initialize(
   auto dv = std::make_shared<data::DataVisitor<M0>>(conf);
   croutine::RoutineFactory factory =
       croutine::CreateRoutineFactory<M0>(func, dv);
+  factory.set_stack_size(config.stack_size());
   auto sched = scheduler::Instance();
   return sched->CreateTask(factory, node_->Name());
 }
@@ -268,12 +270,14 @@ bool Component<M0, M1, NullType, NullType>::Initialize(
   reader_cfg.channel_name = config.readers(1).channel();
   reader_cfg.qos_profile.CopyFrom(config.readers(1).qos_profile());
   reader_cfg.pending_queue_size = config.readers(1).pending_queue_size();
+  reader_cfg.stack_size = config.readers(1).stack_size();
 
   auto reader1 = node_->template CreateReader<M1>(reader_cfg);
 
   reader_cfg.channel_name = config.readers(0).channel();
   reader_cfg.qos_profile.CopyFrom(config.readers(0).qos_profile());
   reader_cfg.pending_queue_size = config.readers(0).pending_queue_size();
+  reader_cfg.stack_size = config.readers(0).stack_size();
 
   auto role_attr = std::make_shared<proto::RoleAttributes>();
   role_attr->set_node_name(config.name());
@@ -358,6 +362,7 @@ bool Component<M0, M1, NullType, NullType>::Initialize(
   auto dv = std::make_shared<data::DataVisitor<M0, M1>>(config_list);
   croutine::RoutineFactory factory =
       croutine::CreateRoutineFactory<M0, M1>(func, dv);
+  factory.set_stack_size(config.stack_size());
   return sched->CreateTask(factory, node_->Name());
 }
 
@@ -393,18 +398,21 @@ bool Component<M0, M1, M2, NullType>::Initialize(
   reader_cfg.channel_name = config.readers(1).channel();
   reader_cfg.qos_profile.CopyFrom(config.readers(1).qos_profile());
   reader_cfg.pending_queue_size = config.readers(1).pending_queue_size();
+  reader_cfg.stack_size = config.readers(1).stack_size();
 
   auto reader1 = node_->template CreateReader<M1>(reader_cfg);
 
   reader_cfg.channel_name = config.readers(2).channel();
   reader_cfg.qos_profile.CopyFrom(config.readers(2).qos_profile());
   reader_cfg.pending_queue_size = config.readers(2).pending_queue_size();
+  reader_cfg.stack_size = config.readers(2).stack_size();
 
   auto reader2 = node_->template CreateReader<M2>(reader_cfg);
 
   reader_cfg.channel_name = config.readers(0).channel();
   reader_cfg.qos_profile.CopyFrom(config.readers(0).qos_profile());
   reader_cfg.pending_queue_size = config.readers(0).pending_queue_size();
+  reader_cfg.stack_size = config.readers(0).stack_size();
 
   auto role_attr = std::make_shared<proto::RoleAttributes>();
   role_attr->set_node_name(config.name());
@@ -498,6 +506,7 @@ bool Component<M0, M1, M2, NullType>::Initialize(
   auto dv = std::make_shared<data::DataVisitor<M0, M1, M2>>(config_list);
   croutine::RoutineFactory factory =
       croutine::CreateRoutineFactory<M0, M1, M2>(func, dv);
+  factory.set_stack_size(config.stack_size());
   return sched->CreateTask(factory, node_->Name());
 }
 
@@ -533,24 +542,28 @@ bool Component<M0, M1, M2, M3>::Initialize(const ComponentConfig& config) {
   reader_cfg.channel_name = config.readers(1).channel();
   reader_cfg.qos_profile.CopyFrom(config.readers(1).qos_profile());
   reader_cfg.pending_queue_size = config.readers(1).pending_queue_size();
+  reader_cfg.stack_size = config.readers(1).stack_size();
 
   auto reader1 = node_->template CreateReader<M1>(reader_cfg);
 
   reader_cfg.channel_name = config.readers(2).channel();
   reader_cfg.qos_profile.CopyFrom(config.readers(2).qos_profile());
   reader_cfg.pending_queue_size = config.readers(2).pending_queue_size();
+  reader_cfg.stack_size = config.readers(2).stack_size();
 
   auto reader2 = node_->template CreateReader<M2>(reader_cfg);
 
   reader_cfg.channel_name = config.readers(3).channel();
   reader_cfg.qos_profile.CopyFrom(config.readers(3).qos_profile());
   reader_cfg.pending_queue_size = config.readers(3).pending_queue_size();
+  reader_cfg.stack_size = config.readers(3).stack_size();
 
   auto reader3 = node_->template CreateReader<M3>(reader_cfg);
 
   reader_cfg.channel_name = config.readers(0).channel();
   reader_cfg.qos_profile.CopyFrom(config.readers(0).qos_profile());
   reader_cfg.pending_queue_size = config.readers(0).pending_queue_size();
+  reader_cfg.stack_size = config.readers(0).stack_size();
 
   auto role_attr = std::make_shared<proto::RoleAttributes>();
   role_attr->set_node_name(config.name());
@@ -651,6 +664,7 @@ bool Component<M0, M1, M2, M3>::Initialize(const ComponentConfig& config) {
   auto dv = std::make_shared<data::DataVisitor<M0, M1, M2, M3>>(config_list);
   croutine::RoutineFactory factory =
       croutine::CreateRoutineFactory<M0, M1, M2, M3>(func, dv);
+  factory.set_stack_size(config.stack_size());
   return sched->CreateTask(factory, node_->Name());
 }
 
@@ -19,7 +19,6 @@
 #include <algorithm>
 #include <utility>
 
-#include "cyber/base/concurrent_object_pool.h"
 #include "cyber/common/global_data.h"
 #include "cyber/common/log.h"
 #include "cyber/croutine/detail/routine_context.h"
@@ -30,9 +29,10 @@ namespace croutine {
 
 thread_local CRoutine *CRoutine::current_routine_ = nullptr;
 thread_local char *CRoutine::main_stack_ = nullptr;
+bool CRoutine::ready_time_enabled_ = false;
 
 namespace {
-std::shared_ptr<base::CCObjectPool<RoutineContext>> context_pool = nullptr;
+std::shared_ptr<RoutineContextPool> context_pool = nullptr;
 std::once_flag pool_init_flag;
 
 void CRoutineEntry(void *arg) {
@@ -42,31 +42,43 @@ void CRoutineEntry(void *arg) {
 }
 }  // namespace
 
-CRoutine::CRoutine(const std::function<void()> &func) : func_(func) {
+CRoutine::CRoutine(const std::function<void()> &func, size_t stack_size)
+    : func_(func) {
   std::call_once(pool_init_flag, [&]() {
     uint32_t routine_num = common::GlobalData::Instance()->ComponentNums();
+    size_t default_stack_size = STACK_SIZE;
     auto &global_conf = common::GlobalData::Instance()->Config();
-    if (global_conf.has_scheduler_conf() &&
-        global_conf.scheduler_conf().has_routine_num()) {
-      routine_num =
-          std::max(routine_num, global_conf.scheduler_conf().routine_num());
+    if (global_conf.has_scheduler_conf()) {
+      auto &sched_conf = global_conf.scheduler_conf();
+      if (sched_conf.has_routine_num()) {
+        routine_num = std::max(routine_num, sched_conf.routine_num());
+      }
+      if (sched_conf.default_stack_size() > 0) {
+        default_stack_size = sched_conf.default_stack_size();
+      }
     }
-    context_pool.reset(new base::CCObjectPool<RoutineContext>(routine_num));
+    // routine_num bounds the idle stacks kept for reuse, not the croutines
+    routine_num = std::max(routine_num, 16u);
+    context_pool.reset(new RoutineContextPool(routine_num, default_stack_size));
   });
 
-  context_ = context_pool->GetObject();
-  if (context_ == nullptr) {
-    AWARN << "Maximum routine context number exceeded! Please check "
-             "[routine_num] in config file.";
-    context_.reset(new RoutineContext());
-  }
+  context_ = context_pool->GetObject(stack_size);
 
   MakeContext(CRoutineEntry, this, context_.get());
   state_ = RoutineState::READY;
   updated_.test_and_set(std::memory_order_release);
 }
 
-CRoutine::~CRoutine() { context_ = nullptr; }
+CRoutine::~CRoutine() {
+  if (!name_.empty()) {
+    auto peak = context_->PeakStackUsage();
+    if (peak > context_->stack_size / 4 * 3) {
+      AWARN << "croutine [" << name_ << "] peak stack usage: " << peak
+            << " of " << context_->stack_size << " bytes.";
+    }
+  }
+  context_ = nullptr;
+}
 
 RoutineState CRoutine::Resume() {
   if (cyber_unlikely(force_stop_)) {
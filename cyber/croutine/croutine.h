@@ -25,6 +25,7 @@
 #include <set>
 #include <string>
 
+#include "cyber/base/macros.h"
 #include "cyber/common/log.h"
 #include "cyber/croutine/detail/routine_context.h"
 
@@ -39,7 +40,11 @@ enum class RoutineState { READY, FINISHED, SLEEP, IO_WAIT, DATA_WAIT };
 
 class CRoutine {
  public:
-  explicit CRoutine(const RoutineFunc &func);
+  /**
+   * @param stack_size bytes of stack, rounded up to a size class, 0 uses
+   * scheduler_conf.default_stack_size
+   */
+  explicit CRoutine(const RoutineFunc &func, size_t stack_size = 0);
   virtual ~CRoutine();
 
   // static interfaces
@@ -63,6 +68,8 @@ class CRoutine {
   RoutineState UpdateState();
   RoutineContext *GetContext();
   char **GetStack();
+  size_t StackSize() const;
+  size_t PeakStackUsage() const;
 
   void Run();
   void Stop();
@@ -94,6 +101,21 @@ class CRoutine {
 
   const std::string &group_name() { return group_name_; }
 
+  // steady nanosecond the croutine became ready to run, 0 if unknown, only
+  // stamped after EnableReadyTime, see scheduler::Processor
+  static void EnableReadyTime() { ready_time_enabled_ = true; }
+  uint64_t ready_time() const { return ready_time_; }
+  void set_ready_time(uint64_t ready_time) { ready_time_ = ready_time; }
+
+  // processor tid of the last resume
+  int last_tid() const { return last_tid_; }
+  void set_last_tid(int tid) { last_tid_ = tid; }
+
+  // callback trace of the croutine, moves along with it across processors,
+  // see statistics::LatencyTracer
+  const void *trace() const { return trace_; }
+  void set_trace(const void *trace) { trace_ = trace; }
+
  private:
   CRoutine(CRoutine &) = delete;
   CRoutine &operator=(CRoutine &) = delete;
@@ -118,6 +140,13 @@ class CRoutine {
 
   std::string group_name_;
 
+  uint64_t ready_time_ = 0;
+  // first SetUpdateFlag since the last UpdateState
+  std::atomic<uint64_t> notify_time_ = {0};
+  int last_tid_ = -1;
+  const void *trace_ = nullptr;
+  static bool ready_time_enabled_;
+
   static thread_local CRoutine *current_routine_;
   static thread_local char *main_stack_;
 };
@@ -140,6 +169,12 @@ inline RoutineContext *CRoutine::GetContext() { return context_.get(); }
 
 inline char **CRoutine::GetStack() { return &(context_->sp); }
 
+inline size_t CRoutine::StackSize() const { return context_->stack_size; }
+
+inline size_t CRoutine::PeakStackUsage() const {
+  return context_->PeakStackUsage();
+}
+
 inline void CRoutine::Run() { func_(); }
 
 inline void CRoutine::set_state(const RoutineState &state) { state_ = state; }
@@ -178,13 +213,23 @@ inline RoutineState CRoutine::UpdateState() {
   if (state_ == RoutineState::SLEEP &&
       std::chrono::steady_clock::now() > wake_time_) {
     state_ = RoutineState::READY;
+    if (cyber_unlikely(ready_time_enabled_)) {
+      ready_time_ = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        wake_time_.time_since_epoch())
+                        .count();
+    }
     return state_;
   }
 
   // Asynchronous Event Mechanism
   if (!updated_.test_and_set(std::memory_order_release)) {
+    uint64_t notify_time = 0;
+    if (cyber_unlikely(ready_time_enabled_)) {
+      notify_time = notify_time_.exchange(0, std::memory_order_relaxed);
+    }
     if (state_ == RoutineState::DATA_WAIT || state_ == RoutineState::IO_WAIT) {
       state_ = RoutineState::READY;
+      ready_time_ = notify_time;
     }
   }
   return state_;
@@ -203,6 +248,15 @@ inline void CRoutine::Release() {
 }
 
 inline void CRoutine::SetUpdateFlag() {
+  if (cyber_unlikely(ready_time_enabled_)) {
+    uint64_t expected = 0;
+    notify_time_.compare_exchange_strong(
+        expected,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count(),
+        std::memory_order_relaxed);
+  }
   updated_.clear(std::memory_order_release);
 }
 
@@ -49,6 +49,78 @@ TEST(Croutine, croutinetest) {
   EXPECT_EQ(cr->Resume(), RoutineState::FINISHED);
 }
 
+TEST(Croutine, stack_size) {
+  EXPECT_EQ(StackSizeClass(0), MIN_STACK_SIZE);
+  EXPECT_EQ(StackSizeClass(MIN_STACK_SIZE + 1), 2 * MIN_STACK_SIZE);
+  EXPECT_EQ(StackSizeClass(STACK_SIZE), STACK_SIZE);
+
+  auto usage = std::make_shared<size_t>(0);
+  std::shared_ptr<CRoutine> cr = std::make_shared<CRoutine>(
+      [usage]() {
+        volatile char buf[32 * 1024];
+        for (size_t i = 0; i < sizeof(buf); ++i) {
+          buf[i] = 1;
+        }
+        *usage = buf[0];
+        CRoutine::Yield(RoutineState::IO_WAIT);
+      },
+      100 * 1024);
+  EXPECT_EQ(cr->StackSize(), 128 * 1024);
+  // only the initial frame written by MakeContext
+  EXPECT_LE(cr->PeakStackUsage(), 2 * sizeof(void*) + REGISTERS_SIZE);
+  cr->Resume();
+  EXPECT_EQ(*usage, 1);
+  EXPECT_GE(cr->PeakStackUsage(), 32 * 1024);
+  EXPECT_LT(cr->PeakStackUsage(), cr->StackSize());
+}
+
+TEST(Croutine, ready_time) {
+  CRoutine::EnableReadyTime();
+  std::shared_ptr<CRoutine> cr = std::make_shared<CRoutine>(function);
+  cr->set_state(RoutineState::DATA_WAIT);
+  EXPECT_EQ(cr->UpdateState(), RoutineState::DATA_WAIT);
+  EXPECT_EQ(cr->ready_time(), 0);
+
+  // stamped by the first notification
+  cr->SetUpdateFlag();
+  EXPECT_EQ(cr->ready_time(), 0);
+  EXPECT_EQ(cr->UpdateState(), RoutineState::READY);
+  EXPECT_NE(cr->ready_time(), 0);
+
+  // a sleeper is ready at its wake time
+  cr->set_ready_time(0);
+  cr->set_state(RoutineState::SLEEP);
+  EXPECT_EQ(cr->UpdateState(), RoutineState::READY);
+  EXPECT_EQ(cr->ready_time(),
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                cr->wake_time().time_since_epoch())
+                .count());
+}
+
+TEST(Croutine, context_pool) {
+  auto pool = std::make_shared<RoutineContextPool>(1, 256 * 1024);
+  auto ctx = pool->GetObject();
+  EXPECT_EQ(ctx->stack_size, 256 * 1024);
+  auto stack = ctx->stack;
+  ctx->stack[ctx->stack_size - 1] = 1;
+  EXPECT_EQ(ctx->PeakStackUsage(), 1);
+  ctx = nullptr;
+  EXPECT_EQ(pool->IdleNum(), 1);
+
+  // the same size class reuses the stack, cleared
+  ctx = pool->GetObject(200 * 1024);
+  EXPECT_EQ(ctx->stack, stack);
+  EXPECT_EQ(ctx->PeakStackUsage(), 0);
+  EXPECT_EQ(pool->IdleNum(), 0);
+
+  auto small = pool->GetObject(MIN_STACK_SIZE);
+  EXPECT_EQ(small->stack_size, MIN_STACK_SIZE);
+  ctx = nullptr;
+  // beyond capacity, unmapped
+  small = nullptr;
+  EXPECT_EQ(pool->IdleNum(), 1);
+}
+
 }  // namespace croutine
 }  // namespace cyber
 }  // namespace apollo
@@ -16,10 +16,136 @@
 
 #include "cyber/croutine/detail/routine_context.h"
 
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <new>
+
 namespace apollo {
 namespace cyber {
 namespace croutine {
 
+namespace {
+size_t PageSize() {
+  static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  return page_size;
+}
+}  // namespace
+
+RoutineContext::RoutineContext(size_t size) {
+  const size_t page_size = PageSize();
+  stack_size = (size + page_size - 1) / page_size * page_size;
+  map_size_ = stack_size + page_size;
+  void* addr = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK,
+                    -1, 0);
+  if (addr == MAP_FAILED) {
+    AERROR << "mmap croutine stack of " << stack_size
+           << " bytes failed: " << std::strerror(errno);
+    throw std::bad_alloc();
+  }
+  map_addr_ = static_cast<char*>(addr);
+  // stacks grow down, the guard page sits at the lowest address
+  if (mprotect(map_addr_, page_size, PROT_NONE) != 0) {
+    AWARN << "protect croutine stack guard page failed: "
+          << std::strerror(errno);
+  }
+  stack = map_addr_ + page_size;
+}
+
+RoutineContext::~RoutineContext() {
+  if (map_addr_ != nullptr) {
+    munmap(map_addr_, map_size_);
+  }
+}
+
+size_t RoutineContext::PeakStackUsage() const {
+  // untouched pages are not resident and read as zero, so look for the
+  // lowest resident page and the first non zero byte in it
+  const size_t page_size = PageSize();
+  const size_t pages = stack_size / page_size;
+  std::vector<unsigned char> resident(pages, 1);
+  if (mincore(stack, stack_size, resident.data()) != 0) {
+    std::fill(resident.begin(), resident.end(), 1);
+  }
+  for (size_t i = 0; i < pages; ++i) {
+    if (!(resident[i] & 1)) {
+      continue;
+    }
+    const char* page = stack + i * page_size;
+    for (size_t j = 0; j < page_size; ++j) {
+      if (page[j] != 0) {
+        return stack_size - i * page_size - j;
+      }
+    }
+  }
+  return 0;
+}
+
+void RoutineContext::Reset() {
+  madvise(stack, stack_size, MADV_DONTNEED);
+  sp = nullptr;
+}
+
+size_t StackSizeClass(size_t size) {
+  size_t size_class = MIN_STACK_SIZE;
+  while (size_class < size) {
+    size_class <<= 1;
+  }
+  return size_class;
+}
+
+RoutineContextPool::RoutineContextPool(uint32_t capacity, size_t default_size)
+    : capacity_(capacity), default_size_(StackSizeClass(default_size)) {}
+
+RoutineContextPool::~RoutineContextPool() {
+  for (auto& item : idle_) {
+    for (auto context : item.second) {
+      delete context;
+    }
+  }
+}
+
+std::shared_ptr<RoutineContext> RoutineContextPool::GetObject(size_t size) {
+  size = size == 0 ? default_size_ : StackSizeClass(size);
+  RoutineContext* context = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = idle_.find(size);
+    if (it != idle_.end() && !it->second.empty()) {
+      context = it->second.back();
+      it->second.pop_back();
+      --idle_num_;
+    }
+  }
+  if (context == nullptr) {
+    context = new RoutineContext(size);
+  }
+  auto self = shared_from_this();
+  return std::shared_ptr<RoutineContext>(
+      context, [self](RoutineContext* context) { self->ReleaseObject(context); });
+}
+
+void RoutineContextPool::ReleaseObject(RoutineContext* context) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (idle_num_ < capacity_) {
+      context->Reset();
+      idle_[context->stack_size].push_back(context);
+      ++idle_num_;
+      return;
+    }
+  }
+  delete context;
+}
+
+uint32_t RoutineContextPool::IdleNum() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return idle_num_;
+}
+
 //  The stack layout looks as follows:
 //
 //              +------------------+
@@ -38,12 +164,13 @@ namespace croutine {
 // ctx->sp  =>  |        RBP       |
 //              +------------------+
 void MakeContext(const func &f1, const void *arg, RoutineContext *ctx) {
-  ctx->sp = ctx->stack + STACK_SIZE - 2 * sizeof(void *) - REGISTERS_SIZE;
+  ctx->sp =
+      ctx->stack + ctx->stack_size - 2 * sizeof(void *) - REGISTERS_SIZE;
   std::memset(ctx->sp, 0, REGISTERS_SIZE);
 #ifdef __aarch64__
-  char *sp = ctx->stack + STACK_SIZE - sizeof(void *);
+  char *sp = ctx->stack + ctx->stack_size - sizeof(void *);
 #else
-  char *sp = ctx->stack + STACK_SIZE - 2 * sizeof(void *);
+  char *sp = ctx->stack + ctx->stack_size - 2 * sizeof(void *);
 #endif
   *reinterpret_cast<void **>(sp) = reinterpret_cast<void *>(f1);
   sp -= sizeof(void *);
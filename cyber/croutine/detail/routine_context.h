@@ -20,6 +20,10 @@
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #include "cyber/common/log.h"
 
@@ -31,7 +35,9 @@ namespace apollo {
 namespace cyber {
 namespace croutine {
 
+// default stack size of a croutine
 constexpr size_t STACK_SIZE = 2 * 1024 * 1024;
+constexpr size_t MIN_STACK_SIZE = 64 * 1024;
 #if defined __aarch64__
 constexpr size_t REGISTERS_SIZE = 160;
 #else
@@ -39,15 +45,78 @@ constexpr size_t REGISTERS_SIZE = 56;
 #endif
 
 typedef void (*func)(void*);
+
+/**
+ * @brief Croutine stack mapped with mmap, with a PROT_NONE guard page right
+ * below it, so an overflow faults instead of corrupting the neighbour.
+ * Pages are only committed when they are touched.
+ */
 struct RoutineContext {
-  char stack[STACK_SIZE];
+  explicit RoutineContext(size_t size = STACK_SIZE);
+  ~RoutineContext();
+
+  /**
+   * @brief Bytes of the stack touched since it was mapped or last Reset()
+   */
+  size_t PeakStackUsage() const;
+
+  /**
+   * @brief Give the touched pages back to the kernel, they read as zero
+   * afterwards which also resets PeakStackUsage()
+   */
+  void Reset();
+
+  char* stack = nullptr;  // lowest usable address
+  size_t stack_size = 0;
   char* sp = nullptr;
+
+ private:
+  RoutineContext(const RoutineContext&) = delete;
+  RoutineContext& operator=(const RoutineContext&) = delete;
+
+  char* map_addr_ = nullptr;
+  size_t map_size_ = 0;
 #if defined __aarch64__
 } __attribute__((aligned(16)));
 #else
 };
 #endif
 
+/**
+ * @brief Round a requested stack size up to its size class, a power of two
+ * no smaller than MIN_STACK_SIZE.
+ */
+size_t StackSizeClass(size_t size);
+
+/**
+ * @class RoutineContextPool
+ * @brief Recycles croutine stacks of the same size class, at most
+ * `capacity` idle stacks are kept in total, the others are unmapped.
+ */
+class RoutineContextPool
+    : public std::enable_shared_from_this<RoutineContextPool> {
+ public:
+  explicit RoutineContextPool(uint32_t capacity,
+                              size_t default_size = STACK_SIZE);
+  ~RoutineContextPool();
+
+  /**
+   * @brief Get a stack of at least `size` bytes, 0 for the default size
+   */
+  std::shared_ptr<RoutineContext> GetObject(size_t size = 0);
+  void ReleaseObject(RoutineContext* context);
+
+  uint32_t IdleNum();
+  size_t default_size() const { return default_size_; }
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<size_t, std::vector<RoutineContext*>> idle_;
+  uint32_t idle_num_ = 0;
+  uint32_t capacity_ = 0;
+  size_t default_size_ = STACK_SIZE;
+};
+
 void MakeContext(const func& f1, const void* arg, RoutineContext* ctx);
 
 inline void SwapContext(char** src_sp, char** dest_sp) {
@@ -42,9 +42,12 @@ class RoutineFactory {
   inline void SetDataVisitor(const std::shared_ptr<data::DataVisitorBase>& dv) {
     data_visitor_ = dv;
   }
+  inline size_t stack_size() const { return stack_size_; }
+  inline void set_stack_size(size_t stack_size) { stack_size_ = stack_size; }
 
  private:
   std::shared_ptr<data::DataVisitorBase> data_visitor_ = nullptr;
+  size_t stack_size_ = 0;
 };
 
 template <typename M0, typename F>
@@ -0,0 +1,197 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+// Fan-out cost of the data dispatch loop with 1 to 16 subscriber buffers on
+// one channel, mutex guarded CacheBuffer against LockFreeCacheBuffer. Every
+// subscriber has a reader thread polling its buffer the way ChannelBuffer
+// does, while the producers run the dispatch loop.
+
+#include <getopt.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cyber/common/log.h"
+#include "cyber/data/cache_buffer.h"
+#include "cyber/data/lock_free_cache_buffer.h"
+
+using apollo::cyber::data::CacheBuffer;
+using apollo::cyber::data::LockFreeCacheBuffer;
+
+using Message = std::shared_ptr<uint64_t>;
+
+std::string BINARY_NAME = "cache_buffer_benchmark";  // NOLINT
+
+int producers = 2;
+int messages = 200000;
+int queue_size = 10;
+
+void DisplayUsage() {
+  AINFO << "Usage: \n    " << BINARY_NAME << " [OPTION]...\n"
+        << "Description: \n"
+        << "    -h, --help: help information \n"
+        << "    -p, --producers=num: dispatching threads, default value is 2\n"
+        << "    -n, --messages=num: messages per producer, default value is "
+           "200000\n"
+        << "    -q, --queue_size=size: subscriber buffer size, default value "
+           "is 10\n"
+        << "Example:\n"
+        << "    " << BINARY_NAME << " -p 2 -n 200000 -q 10\n";
+}
+
+void GetOptions(const int argc, char* const argv[]) {
+  opterr = 0;  // extern int opterr
+  int long_index = 0;
+  const std::string short_opts = "hp:n:q:";
+  static const struct option long_opts[] = {
+      {"help", no_argument, nullptr, 'h'},
+      {"producers", required_argument, nullptr, 'p'},
+      {"messages", required_argument, nullptr, 'n'},
+      {"queue_size", required_argument, nullptr, 'q'},
+      {NULL, no_argument, nullptr, 0}};
+
+  do {
+    int opt =
+        getopt_long(argc, argv, short_opts.c_str(), long_opts, &long_index);
+    if (opt == -1) {
+      break;
+    }
+    switch (opt) {
+      case 'p':
+        producers = std::stoi(std::string(optarg));
+        break;
+      case 'n':
+        messages = std::stoi(std::string(optarg));
+        break;
+      case 'q':
+        queue_size = std::stoi(std::string(optarg));
+        break;
+      case 'h':
+        DisplayUsage();
+        exit(0);
+      default:
+        break;
+    }
+  } while (true);
+  if (producers <= 0 || messages <= 0 || queue_size <= 0) {
+    AERROR << "Invalid option, every value should greater than 0";
+    exit(-1);
+  }
+}
+
+// the dispatch loop and reader side before the lock-free buffer
+struct MutexBuffer {
+  using Buffer = CacheBuffer<Message>;
+
+  explicit MutexBuffer(uint64_t size) : buffer(size) {}
+
+  void Fill(const Message& msg) {
+    std::lock_guard<std::mutex> lock(buffer.Mutex());
+    buffer.Fill(msg);
+  }
+
+  bool Latest(Message* msg) {
+    std::lock_guard<std::mutex> lock(buffer.Mutex());
+    if (buffer.Empty()) {
+      return false;
+    }
+    *msg = buffer.Back();
+    return true;
+  }
+
+  Buffer buffer;
+};
+
+struct LockFreeBuffer {
+  using Buffer = LockFreeCacheBuffer<Message>;
+
+  explicit LockFreeBuffer(uint64_t size) : buffer(size) {}
+
+  void Fill(const Message& msg) { buffer.Fill(msg); }
+
+  bool Latest(Message* msg) {
+    auto tail = buffer.Tail();
+    return tail > 0 && buffer.Get(tail, msg);
+  }
+
+  Buffer buffer;
+};
+
+template <typename SubscriberBuffer>
+double RunFanOut(int subscribers) {
+  std::vector<std::unique_ptr<SubscriberBuffer>> buffers;
+  for (int i = 0; i < subscribers; ++i) {
+    buffers.emplace_back(new SubscriberBuffer(queue_size));
+  }
+
+  std::atomic<bool> stop = {false};
+  std::vector<std::thread> readers;
+  for (auto& buffer : buffers) {
+    auto* buffer_ptr = buffer.get();
+    readers.emplace_back([buffer_ptr, &stop]() {
+      Message msg;
+      while (!stop.load(std::memory_order_relaxed)) {
+        buffer_ptr->Latest(&msg);
+        // give the core back like a woken up reader going idle again
+        std::this_thread::yield();
+      }
+    });
+  }
+
+  auto msg = std::make_shared<uint64_t>(0);
+  auto begin = std::chrono::steady_clock::now();
+  std::vector<std::thread> writers;
+  for (int p = 0; p < producers; ++p) {
+    writers.emplace_back([&buffers, &msg]() {
+      for (int i = 0; i < messages; ++i) {
+        for (auto& buffer : buffers) {
+          buffer->Fill(msg);
+        }
+      }
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  auto end = std::chrono::steady_clock::now();
+  stop = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+
+  auto total_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin)
+          .count();
+  return static_cast<double>(total_ns) / producers / messages;
+}
+
+int main(int argc, char** argv) {
+  GetOptions(argc, argv);
+  for (int subscribers : {1, 2, 4, 8, 16}) {
+    double mutex_ns = RunFanOut<MutexBuffer>(subscribers);
+    double lock_free_ns = RunFanOut<LockFreeBuffer>(subscribers);
+    AINFO << "subscribers: " << subscribers << " producers: " << producers
+          << " dispatch(ns) mutex: " << mutex_ns
+          << " lock free: " << lock_free_ns
+          << " speedup: " << mutex_ns / lock_free_ns;
+  }
+  return 0;
+}
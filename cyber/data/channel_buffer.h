@@ -24,7 +24,9 @@
 
 #include "cyber/common/global_data.h"
 #include "cyber/common/log.h"
+#include "cyber/data/cache_buffer.h"
 #include "cyber/data/data_notifier.h"
+#include "cyber/data/lock_free_cache_buffer.h"
 
 namespace apollo {
 namespace cyber {
@@ -32,12 +34,24 @@ namespace data {
 
 using apollo::cyber::common::GlobalData;
 
+/**
+ * @class ChannelBuffer
+ * @brief The messages of a channel buffered for one reader.
+ *
+ * The buffer is a mutex guarded CacheBuffer, or a LockFreeCacheBuffer for
+ * the channels listed in the DataConf of the cyber config.
+ */
 template <typename T>
 class ChannelBuffer {
  public:
   using BufferType = CacheBuffer<std::shared_ptr<T>>;
+  using LockFreeBufferType = LockFreeCacheBuffer<std::shared_ptr<T>>;
+  using FusionCallback = typename BufferType::FusionCallback;
+
   ChannelBuffer(uint64_t channel_id, BufferType* buffer)
       : channel_id_(channel_id), buffer_(buffer) {}
+  ChannelBuffer(uint64_t channel_id, LockFreeBufferType* buffer)
+      : channel_id_(channel_id), lock_free_buffer_(buffer) {}
 
   bool Fetch(uint64_t* index, std::shared_ptr<T>& m);  // NOLINT
 
@@ -45,17 +59,33 @@ class ChannelBuffer {
 
   bool FetchMulti(uint64_t fetch_size, std::vector<std::shared_ptr<T>>* vec);
 
+  uint64_t Capacity() const;
+  void SetFusionCallback(const FusionCallback& callback);
+
   uint64_t channel_id() const { return channel_id_; }
+  // only one of them is set
   std::shared_ptr<BufferType> Buffer() const { return buffer_; }
+  std::shared_ptr<LockFreeBufferType> LockFreeBuffer() const {
+    return lock_free_buffer_;
+  }
 
  private:
+  bool LockFreeFetch(uint64_t* index, std::shared_ptr<T>& m);  // NOLINT
+  bool LockFreeLatest(std::shared_ptr<T>& m);                 // NOLINT
+  bool LockFreeFetchMulti(uint64_t fetch_size,
+                          std::vector<std::shared_ptr<T>>* vec);
+
   uint64_t channel_id_;
   std::shared_ptr<BufferType> buffer_;
+  std::shared_ptr<LockFreeBufferType> lock_free_buffer_;
 };
 
 template <typename T>
 bool ChannelBuffer<T>::Fetch(uint64_t* index,
                              std::shared_ptr<T>& m) {  // NOLINT
+  if (lock_free_buffer_) {
+    return LockFreeFetch(index, m);
+  }
   std::lock_guard<std::mutex> lock(buffer_->Mutex());
   if (buffer_->Empty()) {
     return false;
@@ -78,6 +108,9 @@ bool ChannelBuffer<T>::Fetch(uint64_t* index,
 
 template <typename T>
 bool ChannelBuffer<T>::Latest(std::shared_ptr<T>& m) {  // NOLINT
+  if (lock_free_buffer_) {
+    return LockFreeLatest(m);
+  }
   std::lock_guard<std::mutex> lock(buffer_->Mutex());
   if (buffer_->Empty()) {
     return false;
@@ -90,6 +123,9 @@ bool ChannelBuffer<T>::Latest(std::shared_ptr<T>& m) {  // NOLINT
 template <typename T>
 bool ChannelBuffer<T>::FetchMulti(uint64_t fetch_size,
                                   std::vector<std::shared_ptr<T>>* vec) {
+  if (lock_free_buffer_) {
+    return LockFreeFetchMulti(fetch_size, vec);
+  }
   std::lock_guard<std::mutex> lock(buffer_->Mutex());
   if (buffer_->Empty()) {
     return false;
@@ -104,6 +140,104 @@ bool ChannelBuffer<T>::FetchMulti(uint64_t fetch_size,
   return true;
 }
 
+template <typename T>
+uint64_t ChannelBuffer<T>::Capacity() const {
+  return lock_free_buffer_ ? lock_free_buffer_->Capacity()
+                           : buffer_->Capacity();
+}
+
+template <typename T>
+void ChannelBuffer<T>::SetFusionCallback(const FusionCallback& callback) {
+  if (lock_free_buffer_) {
+    lock_free_buffer_->SetFusionCallback(callback);
+  } else {
+    buffer_->SetFusionCallback(callback);
+  }
+}
+
+template <typename T>
+bool ChannelBuffer<T>::LockFreeFetch(uint64_t* index,
+                                     std::shared_ptr<T>& m) {  // NOLINT
+  // writers never block readers, a position that is overwritten between
+  // reading the tail and copying the slot out simply falls behind the head
+  // and is retried from the newest one
+  while (true) {
+    auto tail = lock_free_buffer_->Tail();
+    if (tail == 0) {
+      return false;
+    }
+
+    if (*index == 0) {
+      *index = tail;
+    } else if (*index == tail + 1) {
+      return false;
+    } else if (*index < lock_free_buffer_->HeadOf(tail)) {
+      auto interval = tail - *index;
+      AWARN << "channel[" << GlobalData::GetChannelById(channel_id_) << "] "
+            << "read buffer overflow, drop_message[" << interval
+            << "] pre_index[" << *index << "] current_index[" << tail << "] ";
+      *index = tail;
+    }
+    if (lock_free_buffer_->Get(*index, &m)) {
+      return true;
+    }
+  }
+}
+
+template <typename T>
+bool ChannelBuffer<T>::LockFreeLatest(std::shared_ptr<T>& m) {  // NOLINT
+  while (true) {
+    auto tail = lock_free_buffer_->Tail();
+    if (tail == 0) {
+      return false;
+    }
+    if (lock_free_buffer_->Get(tail, &m)) {
+      return true;
+    }
+  }
+}
+
+template <typename T>
+bool ChannelBuffer<T>::LockFreeFetchMulti(
+    uint64_t fetch_size, std::vector<std::shared_ptr<T>>* vec) {
+  auto tail = lock_free_buffer_->Tail();
+  if (tail == 0) {
+    return false;
+  }
+
+  auto num = std::min(lock_free_buffer_->SizeOf(tail), fetch_size);
+  vec->reserve(num);
+  std::shared_ptr<T> m;
+  for (auto index = tail - num + 1; index <= tail; ++index) {
+    // skip what has been overwritten since the tail was read
+    if (lock_free_buffer_->Get(index, &m)) {
+      vec->emplace_back(m);
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief A buffer of `size` messages for a reader of the channel, lock free
+ * if the channel is listed in the DataConf.
+ */
+template <typename T>
+ChannelBuffer<T> CreateChannelBuffer(uint64_t channel_id, uint64_t size) {
+  auto& g_conf = GlobalData::Instance()->Config();
+  if (g_conf.has_data_conf() &&
+      g_conf.data_conf().lock_free_buffer_channels_size() > 0) {
+    const auto& channel_name = GlobalData::GetChannelById(channel_id);
+    for (const auto& name : g_conf.data_conf().lock_free_buffer_channels()) {
+      if (name == channel_name) {
+        return ChannelBuffer<T>(
+            channel_id, new typename ChannelBuffer<T>::LockFreeBufferType(size));
+      }
+    }
+  }
+  return ChannelBuffer<T>(channel_id,
+                          new typename ChannelBuffer<T>::BufferType(size));
+}
+
 }  // namespace data
 }  // namespace cyber
 }  // namespace apollo
@@ -98,6 +98,36 @@ TEST(ChannelBufferTest, FetchMulti) {
   EXPECT_EQ(2, *vector[1]);
 }
 
+TEST(ChannelBufferTest, LockFreeFetch) {
+  auto cache_buffer = new LockFreeCacheBuffer<std::shared_ptr<int>>(2);
+  auto buffer = std::make_shared<ChannelBuffer<int>>(channel0, cache_buffer);
+  EXPECT_EQ(nullptr, buffer->Buffer());
+  EXPECT_EQ(3, buffer->Capacity());
+  std::shared_ptr<int> msg;
+  uint64_t index = 0;
+  EXPECT_FALSE(buffer->Fetch(&index, msg));
+  buffer->LockFreeBuffer()->Fill(std::make_shared<int>(1));
+  EXPECT_TRUE(buffer->Fetch(&index, msg));
+  EXPECT_EQ(1, *msg);
+  EXPECT_EQ(1, index);
+  index++;
+  EXPECT_FALSE(buffer->Fetch(&index, msg));
+  buffer->LockFreeBuffer()->Fill(std::make_shared<int>(2));
+  buffer->LockFreeBuffer()->Fill(std::make_shared<int>(3));
+  buffer->LockFreeBuffer()->Fill(std::make_shared<int>(4));
+  EXPECT_TRUE(buffer->Fetch(&index, msg));
+  EXPECT_EQ(4, *msg);
+  EXPECT_EQ(4, index);
+
+  EXPECT_TRUE(buffer->Latest(msg));
+  EXPECT_EQ(4, *msg);
+  std::vector<std::shared_ptr<int>> vector;
+  EXPECT_TRUE(buffer->FetchMulti(3, &vector));
+  EXPECT_EQ(2, vector.size());
+  EXPECT_EQ(3, *vector[0]);
+  EXPECT_EQ(4, *vector[1]);
+}
+
 }  // namespace data
 }  // namespace cyber
 }  // namespace apollo
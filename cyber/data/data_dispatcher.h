@@ -37,8 +37,13 @@ using apollo::cyber::base::AtomicHashMap;
 template <typename T>
 class DataDispatcher {
  public:
-  using BufferVector =
-      std::vector<std::weak_ptr<CacheBuffer<std::shared_ptr<T>>>>;
+  // the buffer of a reader, one of them is set, see ChannelBuffer
+  struct BufferRef {
+    std::weak_ptr<typename ChannelBuffer<T>::BufferType> buffer;
+    std::weak_ptr<typename ChannelBuffer<T>::LockFreeBufferType>
+        lock_free_buffer;
+  };
+  using BufferVector = std::vector<BufferRef>;
   ~DataDispatcher() {}
 
   void AddBuffer(const ChannelBuffer<T>& channel_buffer);
@@ -59,7 +64,8 @@ inline DataDispatcher<T>::DataDispatcher() {}
 template <typename T>
 void DataDispatcher<T>::AddBuffer(const ChannelBuffer<T>& channel_buffer) {
   std::lock_guard<std::mutex> lock(buffers_map_mutex_);
-  auto buffer = channel_buffer.Buffer();
+  BufferRef buffer = {channel_buffer.Buffer(),
+                      channel_buffer.LockFreeBuffer()};
   BufferVector* buffers = nullptr;
   if (buffers_map_.Get(channel_buffer.channel_id(), &buffers)) {
     buffers->emplace_back(buffer);
@@ -77,10 +83,12 @@ bool DataDispatcher<T>::Dispatch(const uint64_t channel_id,
     return false;
   }
   if (buffers_map_.Get(channel_id, &buffers)) {
-    for (auto& buffer_wptr : *buffers) {
-      if (auto buffer = buffer_wptr.lock()) {
+    for (auto& buffer_ref : *buffers) {
+      if (auto buffer = buffer_ref.buffer.lock()) {
         std::lock_guard<std::mutex> lock(buffer->Mutex());
         buffer->Fill(msg);
+      } else if (auto lock_free_buffer = buffer_ref.lock_free_buffer.lock()) {
+        lock_free_buffer->Fill(msg);
       }
     }
   } else {
@@ -58,6 +58,26 @@ TEST(DataDispatcher, Dispatch) {
   EXPECT_TRUE(dispatcher->Dispatch(channel0, msg));
 }
 
+TEST(DataDispatcher, DispatchLockFree) {
+  auto cache_buffer = new CacheBuffer<std::shared_ptr<int>>(10);
+  auto buffer = ChannelBuffer<int>(channel1, cache_buffer);
+  auto lock_free_cache_buffer =
+      new LockFreeCacheBuffer<std::shared_ptr<int>>(10);
+  auto lock_free_buffer = ChannelBuffer<int>(channel1, lock_free_cache_buffer);
+  auto dispatcher = DataDispatcher<int>::Instance();
+  dispatcher->AddBuffer(buffer);
+  dispatcher->AddBuffer(lock_free_buffer);
+  auto notifier = std::make_shared<Notifier>();
+  DataNotifier::Instance()->AddNotifier(channel1, notifier);
+  EXPECT_TRUE(dispatcher->Dispatch(channel1, std::make_shared<int>(2)));
+
+  std::shared_ptr<int> msg;
+  EXPECT_TRUE(buffer.Latest(msg));
+  EXPECT_EQ(2, *msg);
+  EXPECT_TRUE(lock_free_buffer.Latest(msg));
+  EXPECT_EQ(2, *msg);
+}
+
 }  // namespace data
 }  // namespace cyber
 }  // namespace apollo
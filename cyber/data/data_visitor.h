@@ -48,14 +48,14 @@ template <typename M0, typename M1 = NullType, typename M2 = NullType,
 class DataVisitor : public DataVisitorBase {
  public:
   explicit DataVisitor(const std::vector<VisitorConfig>& configs)
-      : buffer_m0_(configs[0].channel_id,
-                   new BufferType<M0>(configs[0].queue_size)),
-        buffer_m1_(configs[1].channel_id,
-                   new BufferType<M1>(configs[1].queue_size)),
-        buffer_m2_(configs[2].channel_id,
-                   new BufferType<M2>(configs[2].queue_size)),
-        buffer_m3_(configs[3].channel_id,
-                   new BufferType<M3>(configs[3].queue_size)) {
+      : buffer_m0_(CreateChannelBuffer<M0>(configs[0].channel_id,
+                                           configs[0].queue_size)),
+        buffer_m1_(CreateChannelBuffer<M1>(configs[1].channel_id,
+                                           configs[1].queue_size)),
+        buffer_m2_(CreateChannelBuffer<M2>(configs[2].channel_id,
+                                           configs[2].queue_size)),
+        buffer_m3_(CreateChannelBuffer<M3>(configs[3].channel_id,
+                                           configs[3].queue_size)) {
     DataDispatcher<M0>::Instance()->AddBuffer(buffer_m0_);
     DataDispatcher<M1>::Instance()->AddBuffer(buffer_m1_);
     DataDispatcher<M2>::Instance()->AddBuffer(buffer_m2_);
@@ -93,12 +93,12 @@ template <typename M0, typename M1, typename M2>
 class DataVisitor<M0, M1, M2, NullType> : public DataVisitorBase {
  public:
   explicit DataVisitor(const std::vector<VisitorConfig>& configs)
-      : buffer_m0_(configs[0].channel_id,
-                   new BufferType<M0>(configs[0].queue_size)),
-        buffer_m1_(configs[1].channel_id,
-                   new BufferType<M1>(configs[1].queue_size)),
-        buffer_m2_(configs[2].channel_id,
-                   new BufferType<M2>(configs[2].queue_size)) {
+      : buffer_m0_(CreateChannelBuffer<M0>(configs[0].channel_id,
+                                           configs[0].queue_size)),
+        buffer_m1_(CreateChannelBuffer<M1>(configs[1].channel_id,
+                                           configs[1].queue_size)),
+        buffer_m2_(CreateChannelBuffer<M2>(configs[2].channel_id,
+                                           configs[2].queue_size)) {
     DataDispatcher<M0>::Instance()->AddBuffer(buffer_m0_);
     DataDispatcher<M1>::Instance()->AddBuffer(buffer_m1_);
     DataDispatcher<M2>::Instance()->AddBuffer(buffer_m2_);
@@ -134,10 +134,10 @@ template <typename M0, typename M1>
 class DataVisitor<M0, M1, NullType, NullType> : public DataVisitorBase {
  public:
   explicit DataVisitor(const std::vector<VisitorConfig>& configs)
-      : buffer_m0_(configs[0].channel_id,
-                   new BufferType<M0>(configs[0].queue_size)),
-        buffer_m1_(configs[1].channel_id,
-                   new BufferType<M1>(configs[1].queue_size)) {
+      : buffer_m0_(CreateChannelBuffer<M0>(configs[0].channel_id,
+                                           configs[0].queue_size)),
+        buffer_m1_(CreateChannelBuffer<M1>(configs[1].channel_id,
+                                           configs[1].queue_size)) {
     DataDispatcher<M0>::Instance()->AddBuffer(buffer_m0_);
     DataDispatcher<M1>::Instance()->AddBuffer(buffer_m1_);
     data_notifier_->AddNotifier(buffer_m0_.channel_id(), notifier_);
@@ -169,13 +169,14 @@ template <typename M0>
 class DataVisitor<M0, NullType, NullType, NullType> : public DataVisitorBase {
  public:
   explicit DataVisitor(const VisitorConfig& configs)
-      : buffer_(configs.channel_id, new BufferType<M0>(configs.queue_size)) {
+      : buffer_(CreateChannelBuffer<M0>(configs.channel_id,
+                                        configs.queue_size)) {
     DataDispatcher<M0>::Instance()->AddBuffer(buffer_);
     data_notifier_->AddNotifier(buffer_.channel_id(), notifier_);
   }
 
   DataVisitor(uint64_t channel_id, uint32_t queue_size)
-      : buffer_(channel_id, new BufferType<M0>(queue_size)) {
+      : buffer_(CreateChannelBuffer<M0>(channel_id, queue_size)) {
     DataDispatcher<M0>::Instance()->AddBuffer(buffer_);
     data_notifier_->AddNotifier(buffer_.channel_id(), notifier_);
   }
@@ -51,8 +51,8 @@ class AllLatest : public DataFusion<M0, M1, M2, M3> {
         buffer_m3_(buffer_3),
         buffer_fusion_(buffer_m0_.channel_id(),
                        new CacheBuffer<std::shared_ptr<FusionDataType>>(
-                           buffer_0.Buffer()->Capacity() - uint64_t(1))) {
-    buffer_m0_.Buffer()->SetFusionCallback(
+                           buffer_0.Capacity() - uint64_t(1))) {
+    buffer_m0_.SetFusionCallback(
         [this](const std::shared_ptr<M0>& m0) {
           std::shared_ptr<M1> m1;
           std::shared_ptr<M2> m2;
@@ -103,8 +103,8 @@ class AllLatest<M0, M1, M2, NullType> : public DataFusion<M0, M1, M2> {
         buffer_m2_(buffer_2),
         buffer_fusion_(buffer_m0_.channel_id(),
                        new CacheBuffer<std::shared_ptr<FusionDataType>>(
-                           buffer_0.Buffer()->Capacity() - uint64_t(1))) {
-    buffer_m0_.Buffer()->SetFusionCallback(
+                           buffer_0.Capacity() - uint64_t(1))) {
+    buffer_m0_.SetFusionCallback(
         [this](const std::shared_ptr<M0>& m0) {
           std::shared_ptr<M1> m1;
           std::shared_ptr<M2> m2;
@@ -148,8 +148,8 @@ class AllLatest<M0, M1, NullType, NullType> : public DataFusion<M0, M1> {
         buffer_m1_(buffer_1),
         buffer_fusion_(buffer_m0_.channel_id(),
                        new CacheBuffer<std::shared_ptr<FusionDataType>>(
-                           buffer_0.Buffer()->Capacity() - uint64_t(1))) {
-    buffer_m0_.Buffer()->SetFusionCallback(
+                           buffer_0.Capacity() - uint64_t(1))) {
+    buffer_m0_.SetFusionCallback(
         [this](const std::shared_ptr<M0>& m0) {
           std::shared_ptr<M1> m1;
           if (!buffer_m1_.Latest(m1)) {
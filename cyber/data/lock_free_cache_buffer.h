@@ -0,0 +1,216 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#ifndef CYBER_DATA_LOCK_FREE_CACHE_BUFFER_H_
+#define CYBER_DATA_LOCK_FREE_CACHE_BUFFER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+
+#include "cyber/base/macros.h"
+
+namespace apollo {
+namespace cyber {
+namespace data {
+
+/**
+ * @class LockFreeCacheBuffer
+ * @brief Multi-producer multi-consumer variant of CacheBuffer.
+ *
+ * Writers claim a position with a fetch_add and store the value into the
+ * slot tagged with that sequence number. Tail() only moves over contiguous
+ * written positions, so Head/Tail/at keep the CacheBuffer contract without a
+ * buffer wide mutex. Every slot carries a tiny reader/writer spin state that
+ * only conflicts when a writer laps a reader on the very same slot. Values
+ * are copied out, a position that has been overwritten meanwhile is reported
+ * by Get() returning false.
+ *
+ * Readers use it only for the channels listed in the DataConf, see
+ * CreateChannelBuffer, the default is the mutex guarded CacheBuffer.
+ */
+template <typename T>
+class LockFreeCacheBuffer {
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using FusionCallback = std::function<void(const T&)>;
+
+  explicit LockFreeCacheBuffer(uint64_t size)
+      : capacity_(size + 1), slots_(new Slot[size + 1]) {}
+
+  LockFreeCacheBuffer(const LockFreeCacheBuffer& rhs)
+      : capacity_(rhs.capacity_),
+        slots_(new Slot[rhs.capacity_]),
+        fusion_callback_(rhs.fusion_callback_) {
+    for (uint64_t i = 0; i < capacity_; ++i) {
+      rhs.slots_[i].LockShared();
+      slots_[i].seq.store(rhs.slots_[i].seq.load(std::memory_order_relaxed),
+                          std::memory_order_relaxed);
+      slots_[i].value = rhs.slots_[i].value;
+      rhs.slots_[i].UnlockShared();
+    }
+    uint64_t tail = rhs.tail_.load(std::memory_order_acquire);
+    claimed_.store(tail, std::memory_order_relaxed);
+    tail_.store(tail, std::memory_order_release);
+  }
+
+  T operator[](const uint64_t& pos) const { return at(pos); }
+  T at(const uint64_t& pos) const {
+    T value;
+    Get(pos, &value);
+    return value;
+  }
+
+  /**
+   * @brief Copy out the value at `pos`.
+   * @return false if `pos` has not been published or was overwritten already
+   */
+  bool Get(uint64_t pos, T* value) const {
+    if (pos == 0 || pos > tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    const Slot& slot = slots_[GetIndex(pos)];
+    slot.LockShared();
+    bool ok = slot.seq.load(std::memory_order_relaxed) == pos;
+    if (ok) {
+      *value = slot.value;
+    }
+    slot.UnlockShared();
+    return ok;
+  }
+
+  uint64_t Head() const { return HeadOf(Tail()); }
+  uint64_t Tail() const { return tail_.load(std::memory_order_acquire); }
+  uint64_t Size() const { return SizeOf(Tail()); }
+
+  T Front() const { return at(Head()); }
+  T Back() const { return at(Tail()); }
+
+  bool Empty() const { return Tail() == 0; }
+  bool Full() const { return Tail() >= capacity_ - 1; }
+  uint64_t Capacity() const { return capacity_; }
+
+  /**
+   * @brief Oldest readable position if the newest one is `tail`
+   */
+  uint64_t HeadOf(uint64_t tail) const {
+    return tail > capacity_ - 1 ? tail - (capacity_ - 1) + 1 : 1;
+  }
+  uint64_t SizeOf(uint64_t tail) const {
+    return tail > capacity_ - 1 ? capacity_ - 1 : tail;
+  }
+
+  void SetFusionCallback(const FusionCallback& callback) {
+    fusion_callback_ = callback;
+  }
+
+  void Fill(const T& value) {
+    if (fusion_callback_) {
+      fusion_callback_(value);
+      return;
+    }
+
+    uint64_t pos = claimed_.fetch_add(1) + 1;
+    Slot& slot = slots_[GetIndex(pos)];
+    slot.Lock();
+    // a writer that lapped us on this slot already stored a newer value
+    if (slot.seq.load(std::memory_order_relaxed) < pos) {
+      slot.value = value;
+      slot.seq.store(pos);
+    }
+    slot.Unlock();
+    Publish();
+  }
+
+ private:
+  // Move Tail() over every position whose slot has been written. Whoever
+  // fills the gap in front of Tail() carries it on for the writers that
+  // finished after it, so a preempted writer never makes the others wait.
+  void Publish() {
+    uint64_t tail = tail_.load();
+    // a slot not written in this lap still carries a sequence number from the
+    // previous one, which also stops the walk at the last claimed position
+    while (slots_[GetIndex(tail + 1)].seq.load() >= tail + 1) {
+      if (tail_.compare_exchange_weak(tail, tail + 1)) {
+        ++tail;
+      }
+    }
+  }
+
+  struct Slot {
+    // 0: idle, -1: being written, > 0: number of readers
+    mutable std::atomic<int32_t> state = {0};
+    std::atomic<uint64_t> seq = {0};
+    T value;
+
+    void Lock() {
+      int32_t idle = 0;
+      uint32_t spins = 0;
+      while (!state.compare_exchange_weak(idle, -1, std::memory_order_acquire,
+                                          std::memory_order_relaxed)) {
+        idle = 0;
+        Backoff(&spins);
+      }
+    }
+    void Unlock() { state.store(0, std::memory_order_release); }
+
+    void LockShared() const {
+      int32_t readers = state.load(std::memory_order_relaxed);
+      uint32_t spins = 0;
+      while (readers < 0 ||
+             !state.compare_exchange_weak(readers, readers + 1,
+                                          std::memory_order_acquire,
+                                          std::memory_order_relaxed)) {
+        if (readers < 0) {
+          Backoff(&spins);
+          readers = state.load(std::memory_order_relaxed);
+        }
+      }
+    }
+    void UnlockShared() const {
+      state.fetch_sub(1, std::memory_order_release);
+    }
+  };
+
+  // the thread we wait for may have been preempted, stop burning its core
+  static void Backoff(uint32_t* spins) {
+    if (++(*spins) < kSpinLimit) {
+      cpu_relax();
+    } else {
+      std::this_thread::yield();
+    }
+  }
+
+  static constexpr uint32_t kSpinLimit = 64;
+
+  LockFreeCacheBuffer& operator=(const LockFreeCacheBuffer& other) = delete;
+  uint64_t GetIndex(const uint64_t& pos) const { return pos % capacity_; }
+
+  uint64_t capacity_ = 0;
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<uint64_t> claimed_ = {0};
+  std::atomic<uint64_t> tail_ = {0};
+  FusionCallback fusion_callback_;
+};
+
+}  // namespace data
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_DATA_LOCK_FREE_CACHE_BUFFER_H_
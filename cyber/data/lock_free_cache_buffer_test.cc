@@ -0,0 +1,131 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "cyber/data/lock_free_cache_buffer.h"
+
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace apollo {
+namespace cyber {
+namespace data {
+
+TEST(LockFreeCacheBufferTest, cache_buffer_test) {
+  LockFreeCacheBuffer<int> buffer(32);
+  EXPECT_TRUE(buffer.Empty());
+  for (int i = 0; i < 32 - 1; i++) {
+    buffer.Fill(i);
+    EXPECT_FALSE(buffer.Full());
+    EXPECT_EQ(i, buffer[i + 1]);
+    EXPECT_EQ(i, buffer.at(i + 1));
+  }
+  EXPECT_EQ(31, buffer.Size());
+  EXPECT_EQ(1, buffer.Head());
+  EXPECT_EQ(31, buffer.Tail());
+  EXPECT_EQ(0, buffer.Front());
+  EXPECT_EQ(30, buffer.Back());
+  buffer.Fill(31);
+  EXPECT_TRUE(buffer.Full());
+  EXPECT_EQ(32, buffer.Size());
+
+  LockFreeCacheBuffer<int> buffer1(std::move(buffer));
+  EXPECT_EQ(buffer.Size(), buffer1.Size());
+  EXPECT_EQ(buffer.Head(), buffer1.Head());
+  EXPECT_EQ(buffer.Tail(), buffer1.Tail());
+  EXPECT_EQ(buffer.Front(), buffer1.Front());
+  EXPECT_EQ(buffer.Back(), buffer1.Back());
+  EXPECT_TRUE(buffer1.Full());
+}
+
+TEST(LockFreeCacheBufferTest, overwrite) {
+  LockFreeCacheBuffer<int> buffer(2);
+  int value = 0;
+  EXPECT_FALSE(buffer.Get(1, &value));
+  for (int i = 1; i <= 5; i++) {
+    buffer.Fill(i);
+  }
+  EXPECT_EQ(5, buffer.Tail());
+  EXPECT_EQ(4, buffer.Head());
+  EXPECT_EQ(2, buffer.Size());
+  EXPECT_FALSE(buffer.Get(2, &value));
+  EXPECT_FALSE(buffer.Get(6, &value));
+  EXPECT_TRUE(buffer.Get(4, &value));
+  EXPECT_EQ(4, value);
+  EXPECT_TRUE(buffer.Get(5, &value));
+  EXPECT_EQ(5, value);
+}
+
+TEST(LockFreeCacheBufferTest, fusion_callback) {
+  LockFreeCacheBuffer<int> buffer(4);
+  int sum = 0;
+  buffer.SetFusionCallback([&sum](const int& value) { sum += value; });
+  buffer.Fill(1);
+  buffer.Fill(2);
+  EXPECT_EQ(3, sum);
+  EXPECT_TRUE(buffer.Empty());
+}
+
+TEST(LockFreeCacheBufferTest, multi_writer) {
+  const int kWriters = 4;
+  const int kCount = 10000;
+  LockFreeCacheBuffer<uint64_t> buffer(64);
+  std::atomic<bool> stop = {false};
+  std::atomic<uint64_t> bad_reads = {0};
+
+  std::thread reader([&]() {
+    uint64_t value = 0;
+    while (!stop.load()) {
+      auto tail = buffer.Tail();
+      for (auto pos = buffer.HeadOf(tail); tail > 0 && pos <= tail; ++pos) {
+        // every published value carries its writer and a positive counter
+        if (buffer.Get(pos, &value) && value == 0) {
+          bad_reads.fetch_add(1);
+        }
+      }
+    }
+  });
+
+  std::vector<std::thread> writers;
+  for (int w = 0; w < kWriters; ++w) {
+    writers.emplace_back([&buffer, w]() {
+      for (int i = 1; i <= kCount; ++i) {
+        buffer.Fill(static_cast<uint64_t>(w) << 32 | i);
+      }
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  stop = true;
+  reader.join();
+
+  EXPECT_EQ(0, bad_reads.load());
+  EXPECT_EQ(kWriters * kCount, buffer.Tail());
+  EXPECT_TRUE(buffer.Full());
+  uint64_t value = 0;
+  for (auto pos = buffer.Head(); pos <= buffer.Tail(); ++pos) {
+    EXPECT_TRUE(buffer.Get(pos, &value));
+    EXPECT_NE(0, value);
+  }
+}
+
+}  // namespace data
+}  // namespace cyber
+}  // namespace apollo
@@ -27,6 +27,8 @@
 #include <string>
 
 #include "cyber/proto/clock.pb.h"
+#include "cyber/proto/latency_trace.pb.h"
+#include "cyber/proto/scheduler_stats.pb.h"
 
 #include "cyber/binary.h"
 #include "cyber/common/file.h"
@@ -34,11 +36,14 @@
 #include "cyber/data/data_dispatcher.h"
 #include "cyber/logger/async_logger.h"
 #include "cyber/node/node.h"
+#include "cyber/profiler/trace_recorder.h"
 #include "cyber/scheduler/scheduler.h"
 #include "cyber/service_discovery/topology_manager.h"
+#include "cyber/statistics/latency_tracer.h"
 #include "cyber/sysmo/sysmo.h"
 #include "cyber/task/task.h"
 #include "cyber/time/clock.h"
+#include "cyber/timer/timer.h"
 #include "cyber/timer/timing_wheel.h"
 #include "cyber/transport/transport.h"
 #include "cyber/statistics/statistics.h"
@@ -56,9 +61,16 @@ namespace {
 const std::string& kClockChannel = "/clock";
 const std::string& kClockNode = "clock";
 
+const std::string& kLatencyTraceChannel = "/apollo/cyber/latency_trace";
+const std::string& kSchedulerStatsChannel = "/apollo/cyber/scheduler_stats";
+const std::string& kPerfReportNode = "perf_report";
+const uint32_t kPerfReportIntervalMs = 1000;
+
 bool g_atexit_registered = false;
 std::mutex g_mutex;
 std::unique_ptr<Node> clock_node;
+std::unique_ptr<Node> perf_report_node;
+std::unique_ptr<Timer> perf_report_timer;
 
 logger::AsyncLogger* async_logger = nullptr;
 
@@ -85,6 +97,61 @@ void InitLogger(const char* binary_name) {
 
 void StopLogger() { delete async_logger; }
 
+// reports the hop latencies of this process, e.g. to cyber_monitor
+// latency_trace and sched_stats of PerfConf, published like any message so
+// cyber_monitor and cyber_recorder work on them
+void StartPerfReport() {
+  bool latency_trace = statistics::LatencyTracer::Instance()->enabled();
+  bool sched_stats = statistics::Statistics::Instance()->SchedStatsEnabled();
+  if (!latency_trace && !sched_stats) {
+    return;
+  }
+
+  auto node_name = kPerfReportNode + std::to_string(getpid());
+  perf_report_node = std::unique_ptr<Node>(new Node(node_name));
+  std::shared_ptr<Writer<proto::LatencyTrace>> trace_writer = nullptr;
+  if (latency_trace) {
+    trace_writer = perf_report_node->CreateWriter<proto::LatencyTrace>(
+        kLatencyTraceChannel);
+    if (trace_writer == nullptr) {
+      AERROR << "failed to create latency trace writer.";
+    }
+  }
+  std::shared_ptr<Writer<proto::SchedulerStats>> sched_writer = nullptr;
+  if (sched_stats) {
+    sched_writer = perf_report_node->CreateWriter<proto::SchedulerStats>(
+        kSchedulerStatsChannel);
+    if (sched_writer == nullptr) {
+      AERROR << "failed to create scheduler stats writer.";
+    }
+  }
+  perf_report_timer = std::unique_ptr<Timer>(new Timer(
+      kPerfReportIntervalMs,
+      [trace_writer, sched_writer]() {
+        if (trace_writer != nullptr) {
+          auto trace = std::make_shared<proto::LatencyTrace>();
+          statistics::LatencyTracer::Instance()->Report(trace.get());
+          trace_writer->Write(trace);
+        }
+        if (sched_writer != nullptr) {
+          auto stats = std::make_shared<proto::SchedulerStats>();
+          statistics::Statistics::Instance()->ReportSched(stats.get());
+          stats->set_process_name(binary::GetName());
+          sched_writer->Write(stats);
+        }
+      },
+      false));
+  perf_report_timer->Start();
+}
+
+void StopPerfReport() {
+  if (perf_report_timer != nullptr) {
+    perf_report_timer->Stop();
+    perf_report_timer.reset();
+  }
+  perf_report_node.reset();
+}
+
 }  // namespace
 
 void OnShutdown(int sig) {
@@ -131,6 +198,8 @@ bool Init(const char* binary_name, const std::string& dag_info) {
     clock_node->CreateReader<apollo::cyber::proto::Clock>(kClockChannel, cb);
   }
 
+  StartPerfReport();
+
   if (dag_info != "") {
     std::string dump_path;
     if (dag_info.length() > 200) {
@@ -156,10 +225,12 @@ void Clear() {
   if (GetState() == STATE_SHUTDOWN || GetState() == STATE_UNINITIALIZED) {
     return;
   }
+  StopPerfReport();
   SysMo::CleanUp();
   TaskManager::CleanUp();
   TimingWheel::CleanUp();
   scheduler::CleanUp();
+  profiler::TraceRecorder::CleanUp();
   service_discovery::TopologyManager::CleanUp();
   transport::Transport::CleanUp();
   StopLogger();
@@ -0,0 +1,316 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+// Echo throughput of cyber/io: every client croutine owns a socket and an echo
+// server socket of its own, so the fds are spread over the poller loops
+// (io_poller_num of SchedulerConf). udp moves batch messages per
+// SendMmsg/RecvMmsg, tcp writes batch messages per Send.
+
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cyber/cyber.h"
+#include "cyber/init.h"
+#include "cyber/io/session.h"
+#include "cyber/scheduler/scheduler_factory.h"
+
+using apollo::cyber::io::Session;
+
+std::string protocol = "udp";  // NOLINT
+uint16_t base_port = 9600;
+int client_num = 4;
+int batch = 16;
+int message_size = 512;
+int duration_s = 5;
+
+std::atomic<bool> running = {true};
+std::atomic<uint64_t> echoed = {0};
+
+const int kTimeoutMs = 100;
+
+void DisplayUsage(const char* binary) {
+  std::cout << "Usage: \n    " << binary << " [OPTION]...\n"
+            << "    -p, --protocol=udp|tcp, default udp\n"
+            << "    -P, --port=port: first server port, default 9600\n"
+            << "    -c, --clients=num: client sockets, default 4\n"
+            << "    -b, --batch=num: messages in flight per client, "
+               "default 16\n"
+            << "    -s, --message_size=bytes: default 512\n"
+            << "    -d, --duration=s: default 5\n";
+}
+
+void GetOptions(int argc, char* argv[]) {
+  const std::string short_opts = "hp:P:c:b:s:d:";
+  static const struct option long_opts[] = {
+      {"help", no_argument, nullptr, 'h'},
+      {"protocol", required_argument, nullptr, 'p'},
+      {"port", required_argument, nullptr, 'P'},
+      {"clients", required_argument, nullptr, 'c'},
+      {"batch", required_argument, nullptr, 'b'},
+      {"message_size", required_argument, nullptr, 's'},
+      {"duration", required_argument, nullptr, 'd'},
+      {NULL, no_argument, nullptr, 0}};
+
+  int opt = 0;
+  int long_index = 0;
+  while ((opt = getopt_long(argc, argv, short_opts.c_str(), long_opts,
+                            &long_index)) != -1) {
+    switch (opt) {
+      case 'p':
+        protocol = optarg;
+        break;
+      case 'P':
+        base_port = static_cast<uint16_t>(atoi(optarg));
+        break;
+      case 'c':
+        client_num = atoi(optarg);
+        break;
+      case 'b':
+        batch = atoi(optarg);
+        break;
+      case 's':
+        message_size = atoi(optarg);
+        break;
+      case 'd':
+        duration_s = atoi(optarg);
+        break;
+      default:
+        DisplayUsage(argv[0]);
+        exit(0);
+    }
+  }
+
+  if ((protocol != "udp" && protocol != "tcp") || client_num <= 0 ||
+      batch <= 0 || message_size <= 0 || duration_s <= 0) {
+    DisplayUsage(argv[0]);
+    exit(-1);
+  }
+}
+
+struct sockaddr_in Address(uint16_t port) {
+  struct sockaddr_in addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+  addr.sin_port = htons(port);
+  return addr;
+}
+
+// buffers and headers of batch messages
+struct MsgBatch {
+  explicit MsgBatch(int num) : buffers(num), iovs(num), addrs(num), hdrs(num) {
+    for (int i = 0; i < num; ++i) {
+      buffers[i].resize(message_size);
+      iovs[i].iov_base = buffers[i].data();
+      iovs[i].iov_len = buffers[i].size();
+      std::memset(&hdrs[i], 0, sizeof(hdrs[i]));
+      hdrs[i].msg_hdr.msg_iov = &iovs[i];
+      hdrs[i].msg_hdr.msg_iovlen = 1;
+      hdrs[i].msg_hdr.msg_name = &addrs[i];
+      hdrs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+    }
+  }
+
+  // before receiving into it again
+  void Reset() {
+    for (size_t i = 0; i < hdrs.size(); ++i) {
+      iovs[i].iov_len = buffers[i].size();
+      hdrs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+    }
+  }
+
+  std::vector<std::vector<char>> buffers;
+  std::vector<struct iovec> iovs;
+  std::vector<struct sockaddr_in> addrs;
+  std::vector<struct mmsghdr> hdrs;
+};
+
+void UdpServer(uint16_t port) {
+  Session session;
+  session.Socket(AF_INET, SOCK_DGRAM, 0);
+  auto addr = Address(port);
+  if (session.Bind((struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    std::cout << "bind to port[" << port << "] failed." << std::endl;
+    return;
+  }
+
+  MsgBatch msgs(batch);
+  while (running.load()) {
+    msgs.Reset();
+    int num = session.RecvMmsg(msgs.hdrs.data(), batch, 0, kTimeoutMs);
+    if (num <= 0) {
+      continue;
+    }
+    // the received lengths and sources are the replies
+    for (int i = 0; i < num; ++i) {
+      msgs.iovs[i].iov_len = msgs.hdrs[i].msg_len;
+    }
+    session.SendMmsg(msgs.hdrs.data(), num, 0, kTimeoutMs);
+  }
+  session.Close();
+}
+
+void UdpClient(uint16_t port) {
+  Session session;
+  session.Socket(AF_INET, SOCK_DGRAM, 0);
+  auto addr = Address(port);
+  if (session.Connect((struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    std::cout << "connect to port[" << port << "] failed." << std::endl;
+    return;
+  }
+
+  MsgBatch msgs(batch);
+  for (auto& hdr : msgs.hdrs) {
+    hdr.msg_hdr.msg_name = nullptr;
+    hdr.msg_hdr.msg_namelen = 0;
+  }
+  while (running.load()) {
+    int sent = session.SendMmsg(msgs.hdrs.data(), batch, 0, kTimeoutMs);
+    int received = 0;
+    // lost datagrams end the round with the timeout
+    while (sent > 0 && received < sent && running.load()) {
+      int num = session.RecvMmsg(msgs.hdrs.data(), sent - received, 0,
+                                 kTimeoutMs);
+      if (num <= 0) {
+        break;
+      }
+      received += num;
+    }
+    echoed.fetch_add(received);
+  }
+  session.Close();
+}
+
+void TcpServer(uint16_t port) {
+  Session session;
+  session.Socket(AF_INET, SOCK_STREAM, 0);
+  int reuse = 1;
+  setsockopt(session.fd(), SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  auto addr = Address(port);
+  if (session.Bind((struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    std::cout << "bind to port[" << port << "] failed." << std::endl;
+    return;
+  }
+  session.Listen(1);
+  auto conn = session.Accept(nullptr, nullptr);
+  if (conn == nullptr) {
+    return;
+  }
+
+  std::vector<char> buffer(message_size * batch);
+  while (running.load()) {
+    ssize_t nbytes = conn->Recv(buffer.data(), buffer.size(), 0, kTimeoutMs);
+    if (nbytes == 0) {
+      break;
+    }
+    if (nbytes > 0) {
+      conn->Write(buffer.data(), nbytes);
+    }
+  }
+  conn->Close();
+  session.Close();
+}
+
+void TcpClient(uint16_t port) {
+  Session session;
+  session.Socket(AF_INET, SOCK_STREAM, 0);
+  auto addr = Address(port);
+  if (session.Connect((struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    std::cout << "connect to port[" << port << "] failed." << std::endl;
+    return;
+  }
+
+  std::vector<char> buffer(message_size * batch, 'a');
+  while (running.load()) {
+    ssize_t sent = session.Send(buffer.data(), buffer.size(), 0);
+    if (sent <= 0) {
+      break;
+    }
+    ssize_t received = 0;
+    while (received < sent && running.load()) {
+      ssize_t nbytes =
+          session.Recv(buffer.data(), sent - received, 0, kTimeoutMs);
+      if (nbytes == 0) {
+        break;
+      }
+      if (nbytes > 0) {
+        received += nbytes;
+      }
+    }
+    echoed.fetch_add(received / message_size);
+  }
+  session.Close();
+}
+
+int main(int argc, char* argv[]) {
+  GetOptions(argc, argv);
+  apollo::cyber::Init(argv[0]);
+
+  auto sched = apollo::cyber::scheduler::Instance();
+  bool udp = protocol == "udp";
+  for (int i = 0; i < client_num; ++i) {
+    uint16_t port = static_cast<uint16_t>(base_port + i);
+    if (udp) {
+      sched->CreateTask([port]() { UdpServer(port); },
+                        "echo_server" + std::to_string(i));
+    } else {
+      sched->CreateTask([port]() { TcpServer(port); },
+                        "echo_server" + std::to_string(i));
+    }
+  }
+  // the servers bind meanwhile
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  for (int i = 0; i < client_num; ++i) {
+    uint16_t port = static_cast<uint16_t>(base_port + i);
+    if (udp) {
+      sched->CreateTask([port]() { UdpClient(port); },
+                        "echo_client" + std::to_string(i));
+    } else {
+      sched->CreateTask([port]() { TcpClient(port); },
+                        "echo_client" + std::to_string(i));
+    }
+  }
+
+  uint64_t previous = 0;
+  for (int s = 0; s < duration_s && apollo::cyber::OK(); ++s) {
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    uint64_t now = echoed.load();
+    std::cout << protocol << " clients: " << client_num << " batch: " << batch
+              << " size: " << message_size << " msgs/s: " << now - previous
+              << " MB/s: "
+              << static_cast<double>(now - previous) * message_size / 1e6
+              << std::endl;
+    previous = now;
+  }
+  std::cout << "average msgs/s: " << echoed.load() / duration_s << std::endl;
+
+  running.store(false);
+  // let the croutines see the flag and close their sockets
+  std::this_thread::sleep_for(std::chrono::milliseconds(2 * kTimeoutMs));
+  return 0;
+}
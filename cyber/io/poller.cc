@@ -16,13 +16,14 @@
 
 #include "cyber/io/poller.h"
 
-#include <fcntl.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <unistd.h>
 
 #include <csignal>
 #include <cstring>
 
+#include "cyber/common/global_data.h"
 #include "cyber/common/log.h"
 #include "cyber/scheduler/scheduler_factory.h"
 #include "cyber/time/time.h"
@@ -66,19 +67,21 @@ bool Poller::Register(const PollRequest& req) {
   ctrl_param.event.data.fd = req.fd;
   ctrl_param.event.events = req.events;
 
+  auto loop = GetLoop(req.fd);
   {
-    WriteLockGuard<AtomicRWLock> lck(poll_data_lock_);
-    if (requests_.count(req.fd) == 0) {
+    WriteLockGuard<AtomicRWLock> lck(loop->poll_data_lock);
+    auto& request = loop->requests[req.fd];
+    if (request == nullptr) {
       ctrl_param.operation = EPOLL_CTL_ADD;
-      requests_[req.fd] = std::make_shared<PollRequest>();
+      request = std::make_shared<PollRequest>();
     } else {
       ctrl_param.operation = EPOLL_CTL_MOD;
     }
-    *requests_[req.fd] = req;
-    ctrl_params_[ctrl_param.fd] = ctrl_param;
+    *request = req;
+    loop->ctrl_params[ctrl_param.fd] = ctrl_param;
   }
 
-  Notify();
+  Notify(loop);
   return true;
 }
 
@@ -92,9 +95,10 @@ bool Poller::Unregister(const PollRequest& req) {
     return false;
   }
 
+  auto loop = GetLoop(req.fd);
   {
-    WriteLockGuard<AtomicRWLock> lck(poll_data_lock_);
-    auto size = requests_.erase(req.fd);
+    WriteLockGuard<AtomicRWLock> lck(loop->poll_data_lock);
+    auto size = loop->requests.erase(req.fd);
     if (size == 0) {
       AERROR << "unregister failed, can't find fd: " << req.fd;
       return false;
@@ -103,90 +107,104 @@ bool Poller::Unregister(const PollRequest& req) {
     PollCtrlParam ctrl_param;
     ctrl_param.operation = EPOLL_CTL_DEL;
     ctrl_param.fd = req.fd;
-    ctrl_params_[ctrl_param.fd] = ctrl_param;
+    loop->ctrl_params[ctrl_param.fd] = ctrl_param;
   }
 
-  Notify();
+  Notify(loop);
   return true;
 }
 
 bool Poller::Init() {
-  epoll_fd_ = epoll_create(kPollSize);
-  if (epoll_fd_ < 0) {
-    AERROR << "epoll create failed, " << strerror(errno);
-    return false;
+  uint32_t loop_num = 1;
+  auto& global_conf = common::GlobalData::Instance()->Config();
+  if (global_conf.has_scheduler_conf() &&
+      global_conf.scheduler_conf().io_poller_num() > 0) {
+    loop_num = global_conf.scheduler_conf().io_poller_num();
   }
 
-  // create pipe, and set nonblock
-  if (pipe(pipe_fd_) == -1) {
-    AERROR << "create pipe failed, " << strerror(errno);
-    return false;
+  for (uint32_t i = 0; i < loop_num; ++i) {
+    loops_.emplace_back(new Loop());
+    if (!InitLoop(loops_.back().get())) {
+      return false;
+    }
   }
-  if (fcntl(pipe_fd_[0], F_SETFL, O_NONBLOCK) == -1) {
-    AERROR << "set nonblock failed, " << strerror(errno);
+
+  is_shutdown_.store(false);
+  for (auto& loop : loops_) {
+    loop->thread = std::thread(&Poller::ThreadFunc, this, loop.get());
+    scheduler::Instance()->SetInnerThreadAttr("io_poller", &loop->thread);
+  }
+  return true;
+}
+
+bool Poller::InitLoop(Loop* loop) {
+  loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (loop->epoll_fd < 0) {
+    AERROR << "epoll create failed, " << strerror(errno);
     return false;
   }
-  if (fcntl(pipe_fd_[1], F_SETFL, O_NONBLOCK) == -1) {
-    AERROR << "set nonblock failed, " << strerror(errno);
+
+  loop->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (loop->event_fd < 0) {
+    AERROR << "create eventfd failed, " << strerror(errno);
     return false;
   }
 
-  // add pipe[0] to epoll
+  // add the eventfd to epoll
   auto request = std::make_shared<PollRequest>();
-  request->fd = pipe_fd_[0];
+  request->fd = loop->event_fd;
   request->events = EPOLLIN;
   request->timeout_ms = -1;
-  request->callback = [this](const PollResponse&) {
-    char c = 0;
-    while (read(pipe_fd_[0], &c, 1) > 0) {
+  request->callback = [loop](const PollResponse&) {
+    // clear the flag first, a later Notify writes again
+    loop->notified.store(false);
+    uint64_t value = 0;
+    while (read(loop->event_fd, &value, sizeof(value)) > 0) {
     }
   };
-  requests_[request->fd] = request;
+  loop->requests[request->fd] = request;
 
   PollCtrlParam ctrl_param{};
   ctrl_param.operation = EPOLL_CTL_ADD;
-  ctrl_param.fd = pipe_fd_[0];
-  ctrl_param.event.data.fd = pipe_fd_[0];
+  ctrl_param.fd = loop->event_fd;
+  ctrl_param.event.data.fd = loop->event_fd;
   ctrl_param.event.events = EPOLLIN;
-  ctrl_params_[ctrl_param.fd] = ctrl_param;
-
-  is_shutdown_.store(false);
-  thread_ = std::thread(&Poller::ThreadFunc, this);
-  scheduler::Instance()->SetInnerThreadAttr("io_poller", &thread_);
+  loop->ctrl_params[ctrl_param.fd] = ctrl_param;
   return true;
 }
 
 void Poller::Clear() {
-  if (thread_.joinable()) {
-    thread_.join();
+  for (auto& loop : loops_) {
+    Notify(loop.get());
   }
 
-  if (epoll_fd_ >= 0) {
-    close(epoll_fd_);
-    epoll_fd_ = -1;
-  }
+  for (auto& loop : loops_) {
+    if (loop->thread.joinable()) {
+      loop->thread.join();
+    }
 
-  if (pipe_fd_[0] >= 0) {
-    close(pipe_fd_[0]);
-    pipe_fd_[0] = -1;
-  }
+    if (loop->epoll_fd >= 0) {
+      close(loop->epoll_fd);
+      loop->epoll_fd = -1;
+    }
 
-  if (pipe_fd_[1] >= 0) {
-    close(pipe_fd_[1]);
-    pipe_fd_[1] = -1;
-  }
+    if (loop->event_fd >= 0) {
+      close(loop->event_fd);
+      loop->event_fd = -1;
+    }
 
-  {
-    WriteLockGuard<AtomicRWLock> lck(poll_data_lock_);
-    requests_.clear();
-    ctrl_params_.clear();
+    {
+      WriteLockGuard<AtomicRWLock> lck(loop->poll_data_lock);
+      loop->requests.clear();
+      loop->ctrl_params.clear();
+    }
   }
 }
 
-void Poller::Poll(int timeout_ms) {
+void Poller::Poll(Loop* loop, int timeout_ms) {
   epoll_event evt[kPollSize];
   auto before_time_ns = Time::Now().ToNanosecond();
-  int ready_num = epoll_wait(epoll_fd_, evt, kPollSize, timeout_ms);
+  int ready_num = epoll_wait(loop->epoll_fd, evt, kPollSize, timeout_ms);
   auto after_time_ns = Time::Now().ToNanosecond();
   int interval_ms =
       static_cast<int>((after_time_ns - before_time_ns) / 1000000);
@@ -194,12 +212,23 @@ void Poller::Poll(int timeout_ms) {
     interval_ms = 1;
   }
 
-  std::unordered_map<int, PollResponse> responses;
+  auto& responses = loop->responses;
+  responses.clear();
   {
-    ReadLockGuard<AtomicRWLock> lck(poll_data_lock_);
-    for (auto& item : requests_) {
+    ReadLockGuard<AtomicRWLock> lck(loop->poll_data_lock);
+    // a ready fd is answered by its events, not by its timeout
+    for (int i = 0; i < ready_num; ++i) {
+      int fd = evt[i].data.fd;
+      auto search = loop->requests.find(fd);
+      if (search != loop->requests.end()) {
+        search->second->timeout_ms = -1;
+      }
+      responses.emplace_back(fd, PollResponse(evt[i].events));
+    }
+
+    for (auto& item : loop->requests) {
       auto& request = item.second;
-      if (ctrl_params_.count(request->fd) != 0) {
+      if (loop->ctrl_params.count(request->fd) != 0) {
         continue;
       }
 
@@ -211,27 +240,19 @@ void Poller::Poll(int timeout_ms) {
       }
 
       if (request->timeout_ms == 0) {
-        responses[item.first] = PollResponse();
+        responses.emplace_back(item.first, PollResponse());
         request->timeout_ms = -1;
       }
     }
   }
 
-  if (ready_num > 0) {
-    for (int i = 0; i < ready_num; ++i) {
-      int fd = evt[i].data.fd;
-      uint32_t events = evt[i].events;
-      responses[fd] = PollResponse(events);
-    }
-  }
-
   for (auto& item : responses) {
     int fd = item.first;
     auto& response = item.second;
 
-    ReadLockGuard<AtomicRWLock> lck(poll_data_lock_);
-    auto search = requests_.find(fd);
-    if (search != requests_.end()) {
+    ReadLockGuard<AtomicRWLock> lck(loop->poll_data_lock);
+    auto search = loop->requests.find(fd);
+    if (search != loop->requests.end()) {
       search->second->timeout_ms = -1;
       search->second->callback(response);
     }
@@ -244,35 +265,36 @@ void Poller::Poll(int timeout_ms) {
   }
 }
 
-void Poller::ThreadFunc() {
+void Poller::ThreadFunc(Loop* loop) {
   // block all signals in this thread
   sigset_t signal_set;
   sigfillset(&signal_set);
   pthread_sigmask(SIG_BLOCK, &signal_set, nullptr);
 
   while (!is_shutdown_.load()) {
-    HandleChanges();
-    int timeout_ms = GetTimeoutMs();
+    HandleChanges(loop);
+    int timeout_ms = GetTimeoutMs(loop);
     ADEBUG << "this poll timeout ms: " << timeout_ms;
-    Poll(timeout_ms);
+    Poll(loop, timeout_ms);
   }
 }
 
-void Poller::HandleChanges() {
+void Poller::HandleChanges(Loop* loop) {
   CtrlParamMap local_params;
   {
-    ReadLockGuard<AtomicRWLock> lck(poll_data_lock_);
-    if (ctrl_params_.empty()) {
+    WriteLockGuard<AtomicRWLock> lck(loop->poll_data_lock);
+    if (loop->ctrl_params.empty()) {
       return;
     }
-    local_params.swap(ctrl_params_);
+    local_params.swap(loop->ctrl_params);
   }
 
   for (auto& pair : local_params) {
     auto& item = pair.second;
     ADEBUG << "epoll ctl, op[" << item.operation << "] fd[" << item.fd
            << "] events[" << item.event.events << "]";
-    if (epoll_ctl(epoll_fd_, item.operation, item.fd, &item.event) != 0 &&
+    if (epoll_ctl(loop->epoll_fd, item.operation, item.fd, &item.event) !=
+            0 &&
         errno != EBADF) {
       AERROR << "epoll ctl failed, " << strerror(errno);
     }
@@ -280,10 +302,10 @@ void Poller::HandleChanges() {
 }
 
 // min heap can be used to optimize
-int Poller::GetTimeoutMs() {
+int Poller::GetTimeoutMs(Loop* loop) {
   int timeout_ms = kPollTimeoutMs;
-  ReadLockGuard<AtomicRWLock> lck(poll_data_lock_);
-  for (auto& item : requests_) {
+  ReadLockGuard<AtomicRWLock> lck(loop->poll_data_lock);
+  for (auto& item : loop->requests) {
     auto& req = item.second;
     if (req->timeout_ms >= 0 && req->timeout_ms < timeout_ms) {
       timeout_ms = req->timeout_ms;
@@ -292,15 +314,16 @@ int Poller::GetTimeoutMs() {
   return timeout_ms;
 }
 
-void Poller::Notify() {
-  std::unique_lock<std::mutex> lock(pipe_mutex_, std::try_to_lock);
-  if (!lock.owns_lock()) {
+void Poller::Notify(Loop* loop) {
+  // one pending wakeup is enough, the loop handles all changes at once
+  if (loop->event_fd < 0 || loop->notified.exchange(true)) {
     return;
   }
 
-  char msg = 'C';
-  if (write(pipe_fd_[1], &msg, 1) < 0) {
+  uint64_t value = 1;
+  if (write(loop->event_fd, &value, sizeof(value)) < 0) {
     AWARN << "notify failed, " << strerror(errno);
+    loop->notified.store(false);
   }
 }
 
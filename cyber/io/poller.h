@@ -18,11 +18,10 @@
 #define CYBER_IO_POLLER_H_
 
 #include <atomic>
-#include <list>
 #include <memory>
-#include <mutex>
 #include <thread>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "cyber/base/atomic_rw_lock.h"
@@ -33,6 +32,12 @@ namespace apollo {
 namespace cyber {
 namespace io {
 
+/**
+ * @class Poller
+ * @brief Epoll event loops of the io sessions. The fds are spread over
+ * io_poller_num loops of SchedulerConf by their value, each loop has its own
+ * epoll fd, thread, eventfd for wakeups and request map.
+ */
 class Poller {
  public:
   using RequestPtr = std::shared_ptr<PollRequest>;
@@ -46,27 +51,36 @@ class Poller {
   bool Register(const PollRequest& req);
   bool Unregister(const PollRequest& req);
 
+  uint32_t LoopNum() const { return static_cast<uint32_t>(loops_.size()); }
+
  private:
+  struct Loop {
+    int epoll_fd = -1;
+    int event_fd = -1;
+    std::thread thread;
+    RequestMap requests;
+    CtrlParamMap ctrl_params;
+    base::AtomicRWLock poll_data_lock;
+    // an eventfd write is pending
+    std::atomic<bool> notified = {false};
+    // only touched by the loop thread
+    std::vector<std::pair<int, PollResponse>> responses;
+  };
+
   bool Init();
+  bool InitLoop(Loop* loop);
   void Clear();
-  void Poll(int timeout_ms);
-  void ThreadFunc();
-  void HandleChanges();
-  int GetTimeoutMs();
-  void Notify();
-
-  int epoll_fd_ = -1;
-  std::thread thread_;
+  Loop* GetLoop(int fd) { return loops_[fd % loops_.size()].get(); }
+  void Poll(Loop* loop, int timeout_ms);
+  void ThreadFunc(Loop* loop);
+  void HandleChanges(Loop* loop);
+  int GetTimeoutMs(Loop* loop);
+  void Notify(Loop* loop);
+
+  std::vector<std::unique_ptr<Loop>> loops_;
   std::atomic<bool> is_shutdown_ = {true};
 
-  int pipe_fd_[2] = {-1, -1};
-  std::mutex pipe_mutex_;
-
-  RequestMap requests_;
-  CtrlParamMap ctrl_params_;
-  base::AtomicRWLock poll_data_lock_;
-
-  const int kPollSize = 32;
+  const int kPollSize = 128;
   const int kPollTimeoutMs = 100;
 
   DECLARE_SINGLETON(Poller)
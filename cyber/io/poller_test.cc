@@ -16,19 +16,244 @@
 
 #include "cyber/io/poller.h"
 
+#include <arpa/inet.h>
 #include <fcntl.h>
+#include <netinet/in.h>
+#include <stdlib.h>
 #include <unistd.h>
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <string>
 #include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 
+#include "cyber/proto/cyber_conf.pb.h"
+
+#include "cyber/common/environment.h"
+#include "cyber/common/file.h"
 #include "cyber/init.h"
+#include "cyber/io/session.h"
+#include "cyber/scheduler/scheduler_factory.h"
 
 namespace apollo {
 namespace cyber {
 namespace io {
 
+// loops of the poller, set through the cyber config in main
+const uint32_t kLoopNum = 4;
+
+int64_t NowMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+TEST(PollerTest, many_fds) {
+  auto poller = Poller::Instance();
+  ASSERT_EQ(poller->LoopNum(), kLoopNum);
+
+  const int fd_num = 16;
+  std::vector<std::array<int, 2>> pipes(fd_num);
+  std::vector<PollRequest> requests(fd_num);
+  std::atomic<int> readable = {0};
+  for (int i = 0; i < fd_num; ++i) {
+    int pipe_fd[2] = {-1, -1};
+    ASSERT_EQ(pipe(pipe_fd), 0);
+    ASSERT_EQ(fcntl(pipe_fd[0], F_SETFL, O_NONBLOCK), 0);
+    pipes[i] = {pipe_fd[0], pipe_fd[1]};
+    requests[i].fd = pipe_fd[0];
+    requests[i].events = EPOLLIN | EPOLLET | EPOLLONESHOT;
+    requests[i].callback = [&readable](const PollResponse& rsp) {
+      if (rsp.events & EPOLLIN) {
+        readable.fetch_add(1);
+      }
+    };
+    EXPECT_TRUE(poller->Register(requests[i]));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  // every loop wakes up for its own fds
+  char msg = 'C';
+  for (auto& pipe_fd : pipes) {
+    EXPECT_EQ(write(pipe_fd[1], &msg, 1), 1);
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(readable.load(), fd_num);
+
+  for (int i = 0; i < fd_num; ++i) {
+    EXPECT_TRUE(poller->Unregister(requests[i]));
+    close(pipes[i][0]);
+    close(pipes[i][1]);
+  }
+}
+
+TEST(PollerTest, wakeup) {
+  auto poller = Poller::Instance();
+  // fds of every loop, registered at once from several threads, so some
+  // registrations find the eventfd write of another one pending
+  const int fd_num = 4 * static_cast<int>(kLoopNum);
+  std::vector<std::array<int, 2>> pipes(fd_num);
+  std::vector<PollRequest> requests(fd_num);
+  std::vector<std::atomic<int64_t>> response_ms(fd_num);
+  char msg = 'C';
+  for (int i = 0; i < fd_num; ++i) {
+    int pipe_fd[2] = {-1, -1};
+    ASSERT_EQ(pipe(pipe_fd), 0);
+    ASSERT_EQ(fcntl(pipe_fd[0], F_SETFL, O_NONBLOCK), 0);
+    pipes[i] = {pipe_fd[0], pipe_fd[1]};
+    // readable before it is registered
+    ASSERT_EQ(write(pipe_fd[1], &msg, 1), 1);
+    response_ms[i].store(0);
+    requests[i].fd = pipe_fd[0];
+    requests[i].events = EPOLLIN | EPOLLET | EPOLLONESHOT;
+    requests[i].callback = [&response_ms, i](const PollResponse& rsp) {
+      if (rsp.events & EPOLLIN) {
+        response_ms[i].store(NowMs());
+      }
+    };
+  }
+  // every loop sleeps in epoll_wait for its 100 ms poll timeout
+  std::this_thread::sleep_for(std::chrono::milliseconds(150));
+
+  int64_t start_ms = NowMs();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = t; i < fd_num; i += 4) {
+        EXPECT_TRUE(poller->Register(requests[i]));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(80));
+
+  // the eventfd wakes the loops up, they do not wait for the poll timeout
+  for (int i = 0; i < fd_num; ++i) {
+    EXPECT_NE(response_ms[i].load(), 0) << "fd " << requests[i].fd;
+    EXPECT_LT(response_ms[i].load() - start_ms, 50) << "fd " << requests[i].fd;
+  }
+
+  for (int i = 0; i < fd_num; ++i) {
+    poller->Unregister(requests[i]);
+    close(pipes[i][0]);
+    close(pipes[i][1]);
+  }
+}
+
+TEST(SessionTest, udp_batch_round_trip) {
+  const int batch = 8;
+  const int timeout_ms = 100;
+  // outlives the croutine should the test give up waiting
+  auto echoed = std::make_shared<std::promise<int>>();
+  auto result = echoed->get_future();
+
+  scheduler::Instance()->CreateTask(
+      [echoed]() {
+        struct sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+        addr.sin_port = 0;
+        socklen_t addr_len = sizeof(addr);
+
+        Session server;
+        server.Socket(AF_INET, SOCK_DGRAM, 0);
+        if (server.Bind((struct sockaddr*)&addr, addr_len) < 0 ||
+            getsockname(server.fd(), (struct sockaddr*)&addr, &addr_len) < 0) {
+          echoed->set_value(-1);
+          return;
+        }
+        Session client;
+        client.Socket(AF_INET, SOCK_DGRAM, 0);
+        if (client.Connect((struct sockaddr*)&addr, addr_len) < 0) {
+          echoed->set_value(-1);
+          return;
+        }
+
+        std::array<std::array<char, 16>, batch> buffers;
+        std::array<struct iovec, batch> iovs;
+        std::array<struct sockaddr_in, batch> sources;
+        std::array<struct mmsghdr, batch> hdrs;
+        auto reset = [&]() {
+          for (int i = 0; i < batch; ++i) {
+            iovs[i].iov_base = buffers[i].data();
+            iovs[i].iov_len = buffers[i].size();
+            std::memset(&hdrs[i], 0, sizeof(hdrs[i]));
+            hdrs[i].msg_hdr.msg_iov = &iovs[i];
+            hdrs[i].msg_hdr.msg_iovlen = 1;
+            hdrs[i].msg_hdr.msg_name = &sources[i];
+            hdrs[i].msg_hdr.msg_namelen = sizeof(sources[i]);
+          }
+        };
+        // receives until the batch is complete or a receive times out
+        auto receive = [&](Session* session) {
+          int received = 0;
+          while (received < batch) {
+            int num = session->RecvMmsg(hdrs.data() + received,
+                                        batch - received, 0, timeout_ms);
+            if (num <= 0) {
+              break;
+            }
+            received += num;
+          }
+          return received;
+        };
+
+        reset();
+        for (int i = 0; i < batch; ++i) {
+          buffers[i].fill(static_cast<char>('a' + i));
+          hdrs[i].msg_hdr.msg_name = nullptr;
+          hdrs[i].msg_hdr.msg_namelen = 0;
+        }
+        if (client.SendMmsg(hdrs.data(), batch, 0, timeout_ms) != batch) {
+          echoed->set_value(-1);
+          return;
+        }
+
+        // the server sends every datagram back to its source
+        reset();
+        int received = receive(&server);
+        for (int i = 0; i < received; ++i) {
+          iovs[i].iov_len = hdrs[i].msg_len;
+        }
+        if (received != batch ||
+            server.SendMmsg(hdrs.data(), batch, 0, timeout_ms) != batch) {
+          echoed->set_value(-1);
+          return;
+        }
+
+        reset();
+        for (auto& buffer : buffers) {
+          buffer.fill(0);
+        }
+        received = receive(&client);
+        int intact = 0;
+        for (int i = 0; i < received; ++i) {
+          if (hdrs[i].msg_len == buffers[i].size() &&
+              buffers[i][0] == static_cast<char>('a' + i) &&
+              buffers[i].back() == static_cast<char>('a' + i)) {
+            ++intact;
+          }
+        }
+        client.Close();
+        server.Close();
+        echoed->set_value(intact);
+      },
+      "udp_batch_round_trip");
+
+  ASSERT_EQ(result.wait_for(std::chrono::seconds(2)),
+            std::future_status::ready);
+  EXPECT_EQ(result.get(), batch);
+}
+
 TEST(PollerTest, operation) {
   auto poller = Poller::Instance();
   ASSERT_NE(poller, nullptr);
@@ -107,6 +332,23 @@ TEST(PollerTest, operation) {
 
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
+  // a copy of the cyber config with several poller loops
+  namespace common = apollo::cyber::common;
+  char work_root[] = "/tmp/poller_test_XXXXXX";
+  if (mkdtemp(work_root) == nullptr) {
+    return -1;
+  }
+  std::string conf_dir = std::string(work_root) + "/conf";
+  common::CopyDir(common::WorkRoot() + "/conf", conf_dir);
+  apollo::cyber::proto::CyberConfig config;
+  common::GetProtoFromFile(conf_dir + "/cyber.pb.conf", &config);
+  config.mutable_scheduler_conf()->set_io_poller_num(
+      apollo::cyber::io::kLoopNum);
+  common::EnsureDirectory(conf_dir);
+  if (!common::SetProtoToASCIIFile(config, conf_dir + "/cyber.pb.conf")) {
+    return -1;
+  }
+  setenv("CYBER_PATH", work_root, 1);
   apollo::cyber::Init(argv[0]);
   return RUN_ALL_TESTS();
 }
@@ -58,6 +58,13 @@ class Session {
                  const struct sockaddr *dest_addr, socklen_t addrlen,
                  int timeout_ms = -1);
 
+  // batched RecvFrom and SendTo, return the number of messages like
+  // recvmmsg and sendmmsg, blocking only while none could be transferred
+  int RecvMmsg(struct mmsghdr *msgvec, unsigned int vlen, int flags,
+               int timeout_ms = -1);
+  int SendMmsg(struct mmsghdr *msgvec, unsigned int vlen, int flags,
+               int timeout_ms = -1);
+
   ssize_t Read(void *buf, size_t count, int timeout_ms = -1);
   ssize_t Write(const void *buf, size_t count, int timeout_ms = -1);
 
@@ -17,7 +17,9 @@
 #ifndef CYBER_MESSAGE_MESSAGE_TRAITS_H_
 #define CYBER_MESSAGE_MESSAGE_TRAITS_H_
 
+#include <cstring>
 #include <string>
+#include <type_traits>
 
 #include "cyber/base/macros.h"
 #include "cyber/common/log.h"
@@ -53,6 +55,20 @@ class HasSerializer {
 template <typename T>
 constexpr bool HasSerializer<T>::value;
 
+// Trivially copyable types without a serializer are transported as their
+// object representation, which lets shm readers and writers work on the
+// segment block in place (see Writer::Loan).
+template <typename T>
+class IsZeroCopy {
+ public:
+  static constexpr bool value = std::is_trivially_copyable<T>::value &&
+                                std::is_standard_layout<T>::value &&
+                                !HasSerializer<T>::value;
+};
+
+template <typename T>
+constexpr bool IsZeroCopy<T>::value;
+
 template <typename T,
           typename std::enable_if<HasType<T>::value &&
                                       std::is_member_function_pointer<
@@ -126,8 +142,17 @@ typename std::enable_if<HasByteSize<T>::value, int>::type ByteSize(
 }
 
 template <typename T>
-typename std::enable_if<!HasByteSize<T>::value, int>::type ByteSize(
-    const T& message) {
+typename std::enable_if<!HasByteSize<T>::value && IsZeroCopy<T>::value,
+                        int>::type
+ByteSize(const T& message) {
+  (void)message;
+  return static_cast<int>(sizeof(T));
+}
+
+template <typename T>
+typename std::enable_if<!HasByteSize<T>::value && !IsZeroCopy<T>::value,
+                        int>::type
+ByteSize(const T& message) {
   (void)message;
   return -1;
 }
@@ -148,7 +173,19 @@ typename std::enable_if<HasParseFromArray<T>::value, bool>::type ParseFromArray(
 }
 
 template <typename T>
-typename std::enable_if<!HasParseFromArray<T>::value, bool>::type
+typename std::enable_if<!HasParseFromArray<T>::value && IsZeroCopy<T>::value,
+                        bool>::type
+ParseFromArray(const void* data, int size, T* message) {
+  if (data == nullptr || size != static_cast<int>(sizeof(T))) {
+    return false;
+  }
+  std::memcpy(static_cast<void*>(message), data, sizeof(T));
+  return true;
+}
+
+template <typename T>
+typename std::enable_if<!HasParseFromArray<T>::value && !IsZeroCopy<T>::value,
+                        bool>::type
 ParseFromArray(const void* data, int size, T* message) {
   return false;
 }
@@ -191,7 +228,19 @@ SerializeToArray(const T& message, void* data, int size) {
 }
 
 template <typename T>
-typename std::enable_if<!HasSerializeToArray<T>::value, bool>::type
+typename std::enable_if<!HasSerializeToArray<T>::value && IsZeroCopy<T>::value,
+                        bool>::type
+SerializeToArray(const T& message, void* data, int size) {
+  if (data == nullptr || size < static_cast<int>(sizeof(T))) {
+    return false;
+  }
+  std::memcpy(data, static_cast<const void*>(&message), sizeof(T));
+  return true;
+}
+
+template <typename T>
+typename std::enable_if<
+    !HasSerializeToArray<T>::value && !IsZeroCopy<T>::value, bool>::type
 SerializeToArray(const T& message, void* data, int size) {
   return false;
 }
@@ -77,6 +77,11 @@ class PbMessage {
   static std::string TypeName() { return "protobuf"; }
 };
 
+struct PodData {
+  uint64_t timestamp;
+  uint32_t points[16];
+};
+
 TEST(MessageTraitsTest, type_trait) {
   EXPECT_FALSE(HasType<Data>::value);
   EXPECT_FALSE(HasSerializer<Data>::value);
@@ -232,6 +237,31 @@ TEST(MessageTraitsTest, parse_from_string) {
   EXPECT_EQ(str, raw.message);
 }
 
+TEST(MessageTraitsTest, zero_copy) {
+  EXPECT_TRUE(IsZeroCopy<PodData>::value);
+  EXPECT_FALSE(IsZeroCopy<Data>::value);
+  EXPECT_FALSE(IsZeroCopy<Message>::value);
+  EXPECT_FALSE(IsZeroCopy<RawMessage>::value);
+  EXPECT_FALSE(IsZeroCopy<proto::UnitTest>::value);
+
+  PodData pod;
+  pod.timestamp = 12345;
+  for (uint32_t i = 0; i < 16; ++i) {
+    pod.points[i] = i;
+  }
+  EXPECT_EQ(ByteSize(pod), static_cast<int>(sizeof(PodData)));
+
+  char array[sizeof(PodData)] = {0};
+  EXPECT_FALSE(SerializeToArray(pod, array, sizeof(array) - 1));
+  EXPECT_TRUE(SerializeToArray(pod, array, sizeof(array)));
+
+  PodData parsed;
+  EXPECT_FALSE(ParseFromArray(array, sizeof(array) - 1, &parsed));
+  EXPECT_TRUE(ParseFromArray(array, sizeof(array), &parsed));
+  EXPECT_EQ(parsed.timestamp, 12345);
+  EXPECT_EQ(parsed.points[15], 15);
+}
+
 TEST(MessageTraitsTest, serialize_parse_hc) {
   auto msg = std::make_shared<proto::Chatter>();
   msg->set_timestamp(12345);
@@ -48,7 +48,8 @@ struct ReaderConfig {  ///< configurations for a Reader
   ReaderConfig(const ReaderConfig& other)
       : channel_name(other.channel_name),
         qos_profile(other.qos_profile),
-        pending_queue_size(other.pending_queue_size) {}
+        pending_queue_size(other.pending_queue_size),
+        stack_size(other.stack_size) {}
 
   std::string channel_name;       //< channel reads
   proto::QosProfile qos_profile;  //< the qos configuration
@@ -57,6 +58,10 @@ struct ReaderConfig {  ///< configurations for a Reader
    * Older messages will dropped if you have no time to handle
    */
   uint32_t pending_queue_size;
+  /**
+   * @brief stack size in bytes of the reader croutine, 0 for the default
+   */
+  uint32_t stack_size = 0;
 };
 
 /**
@@ -132,7 +137,8 @@ class NodeChannelImpl {
   template <typename MessageT>
   auto CreateReader(const proto::RoleAttributes& role_attr,
                     const CallbackFunc<MessageT>& reader_func,
-                    uint32_t pending_queue_size = DEFAULT_PENDING_QUEUE_SIZE)
+                    uint32_t pending_queue_size = DEFAULT_PENDING_QUEUE_SIZE,
+                    uint32_t stack_size = 0)
       -> std::shared_ptr<Reader<MessageT>>;
 
   template <typename MessageT>
@@ -194,14 +200,15 @@ auto NodeChannelImpl::CreateReader(const ReaderConfig& config,
   proto::RoleAttributes role_attr;
   role_attr.set_channel_name(config.channel_name);
   role_attr.mutable_qos_profile()->CopyFrom(config.qos_profile);
-  return this->template CreateReader<MessageT>(role_attr, reader_func,
-                                               config.pending_queue_size);
+  return this->template CreateReader<MessageT>(
+      role_attr, reader_func, config.pending_queue_size, config.stack_size);
 }
 
 template <typename MessageT>
 auto NodeChannelImpl::CreateReader(const proto::RoleAttributes& role_attr,
                                    const CallbackFunc<MessageT>& reader_func,
-                                   uint32_t pending_queue_size)
+                                   uint32_t pending_queue_size,
+                                   uint32_t stack_size)
     -> std::shared_ptr<Reader<MessageT>> {
   if (!role_attr.has_channel_name() || role_attr.channel_name().empty()) {
     AERROR << "Can't create a reader with empty channel name!";
@@ -216,8 +223,8 @@ auto NodeChannelImpl::CreateReader(const proto::RoleAttributes& role_attr,
     reader_ptr =
         std::make_shared<blocker::IntraReader<MessageT>>(new_attr, reader_func);
   } else {
-    reader_ptr = std::make_shared<Reader<MessageT>>(new_attr, reader_func,
-                                                    pending_queue_size);
+    reader_ptr = std::make_shared<Reader<MessageT>>(
+        new_attr, reader_func, pending_queue_size, stack_size);
   }
 
   RETURN_VAL_IF_NULL(reader_ptr, nullptr);
@@ -81,12 +81,15 @@ class Reader : public ReaderBase {
    * channel name and other info.
    * @param reader_func is the callback function, when the message is received.
    * @param pending_queue_size is the max depth of message cache queue.
+   * @param stack_size is the stack size of the reader croutine, 0 for the
+   * default
    * @warning the received messages is enqueue a queue,the queue's depth is
    * pending_queue_size
    */
   explicit Reader(const proto::RoleAttributes& role_attr,
                   const CallbackFunc<MessageT>& reader_func = nullptr,
-                  uint32_t pending_queue_size = DEFAULT_PENDING_QUEUE_SIZE);
+                  uint32_t pending_queue_size = DEFAULT_PENDING_QUEUE_SIZE,
+                  uint32_t stack_size = 0);
   virtual ~Reader();
 
   /**
@@ -211,6 +214,7 @@ class Reader : public ReaderBase {
   double latest_recv_time_sec_ = -1.0;
   double second_to_lastest_recv_time_sec_ = -1.0;
   uint32_t pending_queue_size_;
+  uint32_t stack_size_;
 
  private:
   void JoinTheTopology();
@@ -230,9 +234,11 @@ class Reader : public ReaderBase {
 template <typename MessageT>
 Reader<MessageT>::Reader(const proto::RoleAttributes& role_attr,
                          const CallbackFunc<MessageT>& reader_func,
-                         uint32_t pending_queue_size)
+                         uint32_t pending_queue_size,
+                         uint32_t stack_size)
     : ReaderBase(role_attr),
       pending_queue_size_(pending_queue_size),
+      stack_size_(stack_size),
       reader_func_(reader_func) {
   blocker_.reset(new blocker::Blocker<MessageT>(blocker::BlockerAttr(
       role_attr.qos_profile().depth(), role_attr.channel_name())));
@@ -271,8 +277,13 @@ bool Reader<MessageT>::Init() {
       uint64_t proc_done_time;
       uint64_t proc_start_time;
 
+      auto tracer = statistics::LatencyTracer::Instance();
+      statistics::LatencyTracer::CallbackTrace trace;
+      tracer->OnCallbackStart(this->role_attr_.channel_id(), msg.get(),
+                              &trace);
       this->Enqueue(msg);
       this->reader_func_(msg);
+      tracer->OnCallbackEnd(&trace);
       // sampling proc latency in microsecond
       proc_done_time = Time::Now().ToMicrosecond();
       proc_start_time = static_cast<uint64_t>(latest_recv_time_sec_*1000000UL);
@@ -298,6 +309,7 @@ bool Reader<MessageT>::Init() {
   // Using factory to wrap templates.
   croutine::RoutineFactory factory =
       croutine::CreateRoutineFactory<MessageT>(std::move(func), dv);
+  factory.set_stack_size(stack_size_);
   if (!sched->CreateTask(factory, croutine_name_)) {
     AERROR << "Create Task Failed!";
     init_.store(false);
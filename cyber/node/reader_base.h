@@ -26,6 +26,7 @@
 #include "cyber/common/macros.h"
 #include "cyber/common/util.h"
 #include "cyber/event/perf_event_cache.h"
+#include "cyber/statistics/latency_tracer.h"
 #include "cyber/transport/transport.h"
 
 namespace apollo {
@@ -214,6 +215,14 @@ auto ReceiverManager<MessageT>::GetReceiver(
               PerfEventCache::Instance()->AddTransportEvent(
                   TransPerf::DISPATCH, reader_attr.channel_id(),
                   msg_info.seq_num());
+              auto tracer = statistics::LatencyTracer::Instance();
+              if (tracer->enabled()) {
+                tracer->OnDispatch(reader_attr.channel_id(),
+                                   reader_attr.channel_name(), msg.get(),
+                                   msg_info.send_time(), msg_info.recv_time(),
+                                   Time::Now().ToNanosecond(),
+                                   msg_info.origin_time());
+              }
               data::DataDispatcher<MessageT>::Instance()->Dispatch(
                   reader_attr.channel_id(), msg);
               PerfEventCache::Instance()->AddTransportEvent(
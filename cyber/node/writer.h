@@ -19,6 +19,7 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "cyber/proto/topology_change.pb.h"
@@ -84,6 +85,35 @@ class Writer : public WriterBase {
    */
   virtual bool Write(const std::shared_ptr<MessageT>& msg_ptr);
 
+  /**
+   * @brief Loan a MessageT constructed in place inside the shared memory
+   * block of the channel, so publishing it copies nothing. Only zero-copy
+   * message types (see message::IsZeroCopy) can be loaned, and only while
+   * every Reader of the channel is reached through shared memory
+   *
+   * @return the loaned message, check IsValid() and fall back to Write if
+   * no block could be loaned
+   */
+  transport::LoanedMessage<MessageT> Loan();
+
+  /**
+   * @brief Publish a loaned message, the loan is consumed either way
+   *
+   * @param loaned the message returned by Loan
+   * @return true if publish successfully
+   * @return false if publish failed
+   */
+  bool Publish(transport::LoanedMessage<MessageT>&& loaned);
+
+  /**
+   * @brief Send the messages held back by shm batching right away, see
+   * batch_max_count of QosProfile
+   *
+   * @return true if flush successfully
+   * @return false if flush failed
+   */
+  bool Flush();
+
   /**
    * @brief Is there any Reader that subscribes our Channel?
    * You can publish message when this return true
@@ -169,6 +199,31 @@ bool Writer<MessageT>::Write(const std::shared_ptr<MessageT>& msg_ptr) {
   return transmitter_->Transmit(msg_ptr);
 }
 
+template <typename MessageT>
+transport::LoanedMessage<MessageT> Writer<MessageT>::Loan() {
+  transport::LoanedMessage<MessageT> loaned;
+  RETURN_VAL_IF(!WriterBase::IsInit(), loaned);
+  // writers without a transmitter, e.g. blocker::IntraWriter, never loan
+  RETURN_VAL_IF(transmitter_ == nullptr, loaned);
+  transmitter_->Loan(&loaned);
+  return loaned;
+}
+
+template <typename MessageT>
+bool Writer<MessageT>::Publish(transport::LoanedMessage<MessageT>&& loaned) {
+  transport::LoanedMessage<MessageT> msg(std::move(loaned));
+  RETURN_VAL_IF(!WriterBase::IsInit(), false);
+  RETURN_VAL_IF(!msg.IsValid() || transmitter_ == nullptr, false);
+  return transmitter_->Publish(&msg);
+}
+
+template <typename MessageT>
+bool Writer<MessageT>::Flush() {
+  RETURN_VAL_IF(!WriterBase::IsInit(), false);
+  RETURN_VAL_IF(transmitter_ == nullptr, true);
+  return transmitter_->Flush();
+}
+
 template <typename MessageT>
 void Writer<MessageT>::JoinTheTopology() {
   // add listener
@@ -19,6 +19,7 @@
 
 #include "cyber/profiler/block.h"
 #include "cyber/profiler/block_manager.h"
+#include "cyber/profiler/trace_recorder.h"
 
 namespace apollo {
 namespace cyber {
@@ -55,6 +56,19 @@ namespace profiler {
 
 #endif  // #if ENABLE_PROFILER
 
+// Always compiled, recorded only while the TraceRecorder runs. The name is
+// interned once per call site, it must not change between calls.
+#define PERF_TRACE_JOIN(x, y) x ## y
+#define PERF_TRACE_NAME(x, y) PERF_TRACE_JOIN(x, y)
+
+#define PERF_TRACE_BLOCK(name)                                              \
+  static const uint32_t PERF_TRACE_NAME(perf_trace_id, __LINE__) =          \
+      apollo::cyber::profiler::TraceRecorder::Instance()->Intern(name);     \
+  apollo::cyber::profiler::TraceScope PERF_TRACE_NAME(perf_trace, __LINE__)( \
+      PERF_TRACE_NAME(perf_trace_id, __LINE__));
+
+#define PERF_TRACE_FUNCTION() PERF_TRACE_BLOCK(__PRETTY_FUNCTION__)
+
 }  // namespace profiler
 }  // namespace cyber
 }  // namespace apollo
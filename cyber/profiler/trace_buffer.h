@@ -0,0 +1,110 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#ifndef CYBER_PROFILER_TRACE_BUFFER_H_
+#define CYBER_PROFILER_TRACE_BUFFER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace apollo {
+namespace cyber {
+namespace profiler {
+
+// cpu ticks, converted to time by the TraceRecorder drainer
+inline uint64_t TscNow() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+struct TraceEvent {
+  uint64_t begin = 0;
+  uint64_t end = 0;
+  uint32_t name_id = 0;
+  uint32_t depth = 0;
+};
+
+/**
+ * @class TraceBuffer
+ * @brief Ring of trace events, written by the thread it belongs to and read
+ * by the drainer, without locks. Events are dropped while it is full.
+ */
+class TraceBuffer {
+ public:
+  explicit TraceBuffer(uint32_t capacity = 8192)
+      : mask_(RoundUp(capacity) - 1), events_(mask_ + 1) {}
+
+  bool Push(const TraceEvent& event) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) > mask_) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    events_[head & mask_] = event;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool Pop(TraceEvent* event) {
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    *event = events_[tail & mask_];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool Empty() const {
+    return tail_.load(std::memory_order_acquire) ==
+           head_.load(std::memory_order_acquire);
+  }
+
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  static uint32_t RoundUp(uint32_t capacity) {
+    uint32_t size = 2;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    return size;
+  }
+
+  const uint64_t mask_;
+  std::vector<TraceEvent> events_;
+  // the producer and the consumer index live on cache lines of their own
+  alignas(64) std::atomic<uint64_t> head_ = {0};
+  alignas(64) std::atomic<uint64_t> tail_ = {0};
+  std::atomic<uint64_t> dropped_ = {0};
+};
+
+}  // namespace profiler
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_PROFILER_TRACE_BUFFER_H_
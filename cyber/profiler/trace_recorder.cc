@@ -0,0 +1,340 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "cyber/profiler/trace_recorder.h"
+
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <iomanip>
+
+#include "cyber/common/global_data.h"
+#include "cyber/common/log.h"
+
+namespace apollo {
+namespace cyber {
+namespace profiler {
+
+namespace {
+
+// keeps the buffer of a thread, which the drainer releases after the thread
+// exited and all its events are written
+struct LocalBuffer {
+  std::shared_ptr<void> holder;
+  std::atomic<bool>* alive = nullptr;
+  ~LocalBuffer() {
+    if (alive != nullptr) {
+      alive->store(false);
+    }
+  }
+};
+
+thread_local LocalBuffer local_buffer;
+thread_local uint32_t local_depth = 0;
+
+uint64_t SteadyNow() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void WriteJsonString(std::ofstream* of, const std::string& str) {
+  *of << '"';
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      *of << '\\' << c;
+    } else if (static_cast<unsigned char>(c) >= 0x20) {
+      *of << c;
+    }
+  }
+  *of << '"';
+}
+
+template <typename T>
+void WriteBinary(std::ofstream* of, const T& value) {
+  of->write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void WriteBinary(std::ofstream* of, const std::string& str) {
+  WriteBinary(of, static_cast<uint32_t>(str.size()));
+  of->write(str.data(), str.size());
+}
+
+}  // namespace
+
+TraceRecorder::TraceRecorder() {
+  auto& global_conf = common::GlobalData::Instance()->Config();
+  if (!global_conf.has_perf_conf() || !global_conf.perf_conf().trace()) {
+    return;
+  }
+  auto& perf_conf = global_conf.perf_conf();
+  std::string file = perf_conf.trace_file();
+  if (file.empty()) {
+    file = "cyber_trace_" + std::to_string(getpid()) +
+           (perf_conf.trace_format() == proto::BINARY ? ".bin" : ".json");
+  }
+  Start(file, perf_conf.trace_format(), perf_conf.trace_drain_interval_ms());
+}
+
+TraceRecorder::~TraceRecorder() { Shutdown(); }
+
+bool TraceRecorder::Start(const std::string& file, proto::TraceFormat format,
+                          uint32_t drain_interval_ms) {
+  std::lock_guard<std::mutex> lock(drain_mutex_);
+  if (enabled_.load()) {
+    return true;
+  }
+  of_.open(file, std::ios::trunc | std::ios::binary);
+  if (!of_.is_open()) {
+    AERROR << "failed to open trace file " << file;
+    return false;
+  }
+  format_ = format;
+  drain_interval_ms_ = drain_interval_ms > 0 ? drain_interval_ms : 100;
+  pid_ = static_cast<int32_t>(getpid());
+  first_event_ = true;
+  drained_names_.clear();
+  {
+    std::lock_guard<std::mutex> buffers_lock(buffers_mutex_);
+    for (auto& thread : buffers_) {
+      thread->described = false;
+    }
+  }
+  if (format_ == proto::BINARY) {
+    of_.write("CYTRACE1", 8);
+  } else {
+    of_ << "{\"traceEvents\":[";
+  }
+
+  base_tsc_ = TscNow();
+  base_ns_ = SteadyNow();
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  Calibrate();
+
+  stop_ = false;
+  drain_thread_ = std::thread(&TraceRecorder::DrainThreadFunc, this);
+  enabled_.store(true);
+  AINFO << "trace recorder writes to " << file;
+  return true;
+}
+
+void TraceRecorder::Shutdown() {
+  {
+    std::lock_guard<std::mutex> lock(drain_mutex_);
+    if (!enabled_.exchange(false)) {
+      return;
+    }
+    stop_ = true;
+  }
+  drain_cv_.notify_one();
+  if (drain_thread_.joinable()) {
+    drain_thread_.join();
+  }
+
+  std::lock_guard<std::mutex> lock(drain_mutex_);
+  Drain();
+  if (format_ == proto::CHROME_JSON) {
+    of_ << "\n]}\n";
+  }
+  of_.close();
+  uint64_t lost = dropped();
+  if (lost > 0) {
+    AWARN << lost << " trace events dropped, trace buffers were full.";
+  }
+}
+
+uint32_t TraceRecorder::Intern(const std::string& name) {
+  std::lock_guard<std::mutex> lock(names_mutex_);
+  auto iter = name_ids_.find(name);
+  if (iter != name_ids_.end()) {
+    return iter->second;
+  }
+  uint32_t id = static_cast<uint32_t>(names_.size());
+  names_.emplace_back(name);
+  name_ids_[name] = id;
+  return id;
+}
+
+void TraceRecorder::Record(uint32_t name_id, uint64_t begin, uint64_t end,
+                           uint32_t depth) {
+  if (!enabled()) {
+    return;
+  }
+  TraceEvent event;
+  event.begin = begin;
+  event.end = end;
+  event.name_id = name_id;
+  event.depth = depth;
+  GetThreadBuffer()->buffer.Push(event);
+}
+
+uint64_t TraceRecorder::dropped() {
+  uint64_t dropped = 0;
+  std::lock_guard<std::mutex> lock(buffers_mutex_);
+  for (auto& thread : buffers_) {
+    dropped += thread->buffer.dropped();
+  }
+  return dropped;
+}
+
+TraceRecorder::ThreadBuffer* TraceRecorder::GetThreadBuffer() {
+  if (local_buffer.holder != nullptr) {
+    return static_cast<ThreadBuffer*>(local_buffer.holder.get());
+  }
+  auto thread = std::make_shared<ThreadBuffer>();
+  thread->tid = static_cast<int32_t>(syscall(SYS_gettid));
+  char name[16] = {0};
+  if (pthread_getname_np(pthread_self(), name, sizeof(name)) == 0) {
+    thread->thread_name = name;
+  }
+  {
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    buffers_.emplace_back(thread);
+  }
+  local_buffer.alive = &thread->alive;
+  local_buffer.holder = thread;
+  return thread.get();
+}
+
+void TraceRecorder::DrainThreadFunc() {
+  std::unique_lock<std::mutex> lock(drain_mutex_);
+  while (!stop_) {
+    drain_cv_.wait_for(lock, std::chrono::milliseconds(drain_interval_ms_));
+    Drain();
+  }
+}
+
+void TraceRecorder::Drain() {
+  Calibrate();
+  WriteNames();
+
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  {
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    buffers = buffers_;
+  }
+  TraceEvent event;
+  for (auto& thread : buffers) {
+    if (!thread->described) {
+      WriteThread(*thread);
+      thread->described = true;
+    }
+    while (thread->buffer.Pop(&event)) {
+      WriteEvent(*thread, event);
+    }
+  }
+  of_.flush();
+
+  std::lock_guard<std::mutex> lock(buffers_mutex_);
+  for (auto iter = buffers_.begin(); iter != buffers_.end();) {
+    if (!(*iter)->alive.load() && (*iter)->buffer.Empty()) {
+      iter = buffers_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+void TraceRecorder::Calibrate() {
+  uint64_t tsc = TscNow();
+  uint64_t ns = SteadyNow();
+  if (tsc > base_tsc_ && ns > base_ns_) {
+    ns_per_tick_ = static_cast<double>(ns - base_ns_) /
+                   static_cast<double>(tsc - base_tsc_);
+  }
+}
+
+uint64_t TraceRecorder::ToNanoseconds(uint64_t tsc) const {
+  if (tsc < base_tsc_) {
+    return base_ns_ - static_cast<uint64_t>((base_tsc_ - tsc) * ns_per_tick_);
+  }
+  return base_ns_ + static_cast<uint64_t>((tsc - base_tsc_) * ns_per_tick_);
+}
+
+void TraceRecorder::WriteNames() {
+  std::lock_guard<std::mutex> lock(names_mutex_);
+  for (std::size_t i = drained_names_.size(); i < names_.size(); ++i) {
+    drained_names_.emplace_back(names_[i]);
+    if (format_ == proto::BINARY) {
+      WriteBinary(&of_, static_cast<uint8_t>(1));
+      WriteBinary(&of_, static_cast<uint32_t>(i));
+      WriteBinary(&of_, names_[i]);
+    }
+  }
+}
+
+void TraceRecorder::WriteThread(const ThreadBuffer& thread) {
+  if (format_ == proto::BINARY) {
+    WriteBinary(&of_, static_cast<uint8_t>(2));
+    WriteBinary(&of_, thread.tid);
+    WriteBinary(&of_, thread.thread_name);
+    return;
+  }
+  of_ << (first_event_ ? "\n" : ",\n");
+  first_event_ = false;
+  of_ << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid_
+      << ",\"tid\":" << thread.tid << ",\"args\":{\"name\":";
+  WriteJsonString(&of_, thread.thread_name);
+  of_ << "}}";
+}
+
+void TraceRecorder::WriteEvent(const ThreadBuffer& thread,
+                               const TraceEvent& event) {
+  uint64_t begin = ToNanoseconds(event.begin);
+  uint64_t end = ToNanoseconds(event.end);
+  uint64_t duration = end > begin ? end - begin : 0;
+  if (format_ == proto::BINARY) {
+    WriteBinary(&of_, static_cast<uint8_t>(3));
+    WriteBinary(&of_, thread.tid);
+    WriteBinary(&of_, event.name_id);
+    WriteBinary(&of_, event.depth);
+    WriteBinary(&of_, begin);
+    WriteBinary(&of_, duration);
+    return;
+  }
+  of_ << (first_event_ ? "\n" : ",\n");
+  first_event_ = false;
+  of_ << "{\"name\":";
+  WriteJsonString(&of_, event.name_id < drained_names_.size()
+                            ? drained_names_[event.name_id]
+                            : std::to_string(event.name_id));
+  // microsecond
+  of_ << ",\"ph\":\"X\",\"pid\":" << pid_ << ",\"tid\":" << thread.tid
+      << std::fixed << std::setprecision(3) << ",\"ts\":" << begin / 1000.0
+      << ",\"dur\":" << duration / 1000.0 << ",\"args\":{\"depth\":"
+      << event.depth << "}}";
+}
+
+TraceScope::TraceScope(uint32_t name_id) : name_id_(name_id) {
+  if (TraceRecorder::Instance()->enabled()) {
+    depth_ = ++local_depth;
+    begin_ = TscNow();
+  }
+}
+
+TraceScope::~TraceScope() {
+  if (begin_ == 0) {
+    return;
+  }
+  --local_depth;
+  TraceRecorder::Instance()->Record(name_id_, begin_, TscNow(), depth_);
+}
+
+}  // namespace profiler
+}  // namespace cyber
+}  // namespace apollo
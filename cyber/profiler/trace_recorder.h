@@ -0,0 +1,140 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#ifndef CYBER_PROFILER_TRACE_RECORDER_H_
+#define CYBER_PROFILER_TRACE_RECORDER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "cyber/proto/perf_conf.pb.h"
+
+#include "cyber/common/macros.h"
+#include "cyber/profiler/trace_buffer.h"
+
+namespace apollo {
+namespace cyber {
+namespace profiler {
+
+/**
+ * @class TraceRecorder
+ * @brief Always-on tracing of scoped blocks (PERF_TRACE_BLOCK) and croutine
+ * runs, cheap enough for production.
+ *
+ * Every thread records its events into a TraceBuffer of its own, names are
+ * interned once per call site and times are cpu ticks. A drainer thread
+ * converts them and appends them to the trace file, either Chrome trace
+ * json or binary records:
+ *   header  "CYTRACE1"
+ *   name    uint8 1, uint32 name id, uint32 size, name
+ *   thread  uint8 2, int32 tid, uint32 size, thread name
+ *   event   uint8 3, int32 tid, uint32 name id, uint32 depth,
+ *           uint64 begin ns, uint64 duration ns
+ * Started by the trace field of PerfConf, or by hand.
+ */
+class TraceRecorder {
+ public:
+  ~TraceRecorder();
+
+  bool Start(const std::string& file, proto::TraceFormat format,
+             uint32_t drain_interval_ms);
+  // drains the events left and closes the file
+  void Shutdown();
+
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  uint32_t Intern(const std::string& name);
+
+  void Record(uint32_t name_id, uint64_t begin, uint64_t end, uint32_t depth);
+
+  // events lost to full buffers
+  uint64_t dropped();
+
+ private:
+  struct ThreadBuffer {
+    TraceBuffer buffer;
+    int32_t tid = 0;
+    std::string thread_name;
+    bool described = false;
+    std::atomic<bool> alive = {true};
+  };
+
+  ThreadBuffer* GetThreadBuffer();
+  void DrainThreadFunc();
+  void Drain();
+  void Calibrate();
+  uint64_t ToNanoseconds(uint64_t tsc) const;
+  void WriteNames();
+  void WriteThread(const ThreadBuffer& thread);
+  void WriteEvent(const ThreadBuffer& thread, const TraceEvent& event);
+
+  std::atomic<bool> enabled_ = {false};
+
+  std::mutex names_mutex_;
+  std::vector<std::string> names_;
+  std::unordered_map<std::string, uint32_t> name_ids_;
+
+  std::mutex buffers_mutex_;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+
+  // everything below belongs to the drainer
+  std::mutex drain_mutex_;
+  std::condition_variable drain_cv_;
+  bool stop_ = false;
+  std::thread drain_thread_;
+  uint32_t drain_interval_ms_ = 100;
+
+  std::ofstream of_;
+  proto::TraceFormat format_ = proto::CHROME_JSON;
+  bool first_event_ = true;
+  std::vector<std::string> drained_names_;
+  int32_t pid_ = 0;
+
+  uint64_t base_tsc_ = 0;
+  uint64_t base_ns_ = 0;
+  double ns_per_tick_ = 1.0;
+
+  DECLARE_SINGLETON(TraceRecorder)
+};
+
+/**
+ * @class TraceScope
+ * @brief Records the lifetime of a scope, see PERF_TRACE_BLOCK.
+ */
+class TraceScope {
+ public:
+  explicit TraceScope(uint32_t name_id);
+  ~TraceScope();
+
+ private:
+  uint32_t name_id_;
+  uint32_t depth_ = 0;
+  uint64_t begin_ = 0;
+};
+
+}  // namespace profiler
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_PROFILER_TRACE_RECORDER_H_
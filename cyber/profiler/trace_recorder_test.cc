@@ -0,0 +1,97 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "cyber/profiler/trace_recorder.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "cyber/profiler/profiler.h"
+
+namespace apollo {
+namespace cyber {
+namespace profiler {
+
+TEST(TraceBufferTest, push_pop) {
+  TraceBuffer buffer(4);
+  TraceEvent event;
+  for (uint32_t i = 0; i < 4; ++i) {
+    event.name_id = i;
+    EXPECT_TRUE(buffer.Push(event));
+  }
+  EXPECT_FALSE(buffer.Push(event));
+  EXPECT_EQ(buffer.dropped(), 1);
+
+  for (uint32_t i = 0; i < 4; ++i) {
+    ASSERT_TRUE(buffer.Pop(&event));
+    EXPECT_EQ(event.name_id, i);
+  }
+  EXPECT_FALSE(buffer.Pop(&event));
+  EXPECT_TRUE(buffer.Empty());
+  EXPECT_TRUE(buffer.Push(event));
+}
+
+void TracedWork() {
+  PERF_TRACE_BLOCK("outer_block")
+  for (int i = 0; i < 10; ++i) {
+    PERF_TRACE_BLOCK("inner_block")
+  }
+}
+
+TEST(TraceRecorderTest, chrome_json) {
+  auto recorder = TraceRecorder::Instance();
+  EXPECT_EQ(recorder->Intern("name"), recorder->Intern("name"));
+
+  // not recorded, nothing runs yet
+  TracedWork();
+
+  const std::string file = "trace_recorder_test.json";
+  ASSERT_TRUE(recorder->Start(file, proto::CHROME_JSON, 10));
+  std::thread worker(TracedWork);
+  TracedWork();
+  worker.join();
+  recorder->Shutdown();
+  EXPECT_FALSE(recorder->enabled());
+  EXPECT_EQ(recorder->dropped(), 0);
+
+  std::ifstream in(file);
+  std::stringstream ss;
+  ss << in.rdbuf();
+  std::string trace = ss.str();
+  EXPECT_EQ(trace.find("{\"traceEvents\":["), 0);
+  EXPECT_NE(trace.find("\n]}"), std::string::npos);
+
+  std::size_t outer = 0;
+  std::size_t inner = 0;
+  for (std::size_t pos = trace.find("outer_block"); pos != std::string::npos;
+       pos = trace.find("outer_block", pos + 1)) {
+    ++outer;
+  }
+  for (std::size_t pos = trace.find("inner_block"); pos != std::string::npos;
+       pos = trace.find("inner_block", pos + 1)) {
+    ++inner;
+  }
+  EXPECT_EQ(outer, 2);
+  EXPECT_EQ(inner, 20);
+}
+
+}  // namespace profiler
+}  // namespace cyber
+}  // namespace apollo
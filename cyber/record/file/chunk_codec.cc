@@ -0,0 +1,159 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "cyber/record/file/chunk_codec.h"
+
+#include <limits>
+
+#include "lz4.h"
+#include "zstd.h"
+
+#include "cyber/common/log.h"
+
+namespace apollo {
+namespace cyber {
+namespace record {
+
+using apollo::cyber::proto::CompressType;
+
+namespace {
+
+constexpr size_t kRawSizeLength = sizeof(uint64_t);
+// a byte of lz4 input expands to at most 255 bytes, a larger raw size in
+// front of the chunk is corrupt
+constexpr uint64_t kLz4MaxRatio = 255;
+// favour throughput, recording must keep up with the sensors
+constexpr int kZstdLevel = 1;
+
+void PutRawSize(uint64_t size, std::string* out) {
+  for (size_t i = 0; i < kRawSizeLength; ++i) {
+    (*out)[i] = static_cast<char>((size >> (8 * i)) & 0xFF);
+  }
+}
+
+uint64_t GetRawSize(const std::string& in) {
+  uint64_t size = 0;
+  for (size_t i = 0; i < kRawSizeLength; ++i) {
+    size |= static_cast<uint64_t>(static_cast<unsigned char>(in[i])) << (8 * i);
+  }
+  return size;
+}
+
+}  // namespace
+
+bool IsCompressSupported(CompressType type) {
+  return type == CompressType::COMPRESS_NONE ||
+         type == CompressType::COMPRESS_LZ4 ||
+         type == CompressType::COMPRESS_ZSTD;
+}
+
+bool CompressChunk(CompressType type, const std::string& raw,
+                   std::string* compressed) {
+  size_t size = 0;
+  switch (type) {
+    case CompressType::COMPRESS_LZ4: {
+      if (raw.size() > static_cast<size_t>(LZ4_MAX_INPUT_SIZE)) {
+        AERROR << "Chunk is too large for lz4, size: " << raw.size();
+        return false;
+      }
+      auto bound = LZ4_compressBound(static_cast<int>(raw.size()));
+      compressed->resize(kRawSizeLength + bound);
+      int ret = LZ4_compress_default(raw.data(), &(*compressed)[kRawSizeLength],
+                                     static_cast<int>(raw.size()), bound);
+      if (ret <= 0) {
+        AERROR << "lz4 compress chunk failed, size: " << raw.size();
+        return false;
+      }
+      size = static_cast<size_t>(ret);
+      break;
+    }
+    case CompressType::COMPRESS_ZSTD: {
+      auto bound = ZSTD_compressBound(raw.size());
+      compressed->resize(kRawSizeLength + bound);
+      auto ret = ZSTD_compress(&(*compressed)[kRawSizeLength], bound,
+                               raw.data(), raw.size(), kZstdLevel);
+      if (ZSTD_isError(ret)) {
+        AERROR << "zstd compress chunk failed: " << ZSTD_getErrorName(ret);
+        return false;
+      }
+      size = ret;
+      break;
+    }
+    default:
+      AERROR << "Unsupported compress type: " << CompressType_Name(type);
+      return false;
+  }
+  compressed->resize(kRawSizeLength + size);
+  PutRawSize(raw.size(), compressed);
+  return true;
+}
+
+bool DecompressChunk(CompressType type, const std::string& compressed,
+                     std::string* raw) {
+  if (compressed.size() < kRawSizeLength) {
+    AERROR << "Compressed chunk is truncated, size: " << compressed.size();
+    return false;
+  }
+  uint64_t raw_size = GetRawSize(compressed);
+  const char* src = compressed.data() + kRawSizeLength;
+  size_t src_size = compressed.size() - kRawSizeLength;
+  switch (type) {
+    case CompressType::COMPRESS_LZ4: {
+      if (raw_size > static_cast<uint64_t>(std::numeric_limits<int>::max()) ||
+          src_size > static_cast<size_t>(std::numeric_limits<int>::max())) {
+        AERROR << "Chunk is too large for lz4, size: " << raw_size;
+        return false;
+      }
+      if (raw_size > src_size * kLz4MaxRatio) {
+        AERROR << "Corrupt lz4 chunk, raw size: " << raw_size
+               << ", compressed size: " << src_size;
+        return false;
+      }
+      raw->resize(raw_size);
+      int ret = LZ4_decompress_safe(src, &(*raw)[0], static_cast<int>(src_size),
+                                    static_cast<int>(raw_size));
+      if (ret < 0 || static_cast<uint64_t>(ret) != raw_size) {
+        AERROR << "lz4 decompress chunk failed, expect size: " << raw_size
+               << ", actual: " << ret;
+        return false;
+      }
+      return true;
+    }
+    case CompressType::COMPRESS_ZSTD: {
+      // CompressChunk keeps the raw size in the zstd frame as well
+      auto content_size = ZSTD_getFrameContentSize(src, src_size);
+      if (content_size != raw_size) {
+        AERROR << "Corrupt zstd chunk, raw size: " << raw_size
+               << ", frame content size: " << content_size;
+        return false;
+      }
+      raw->resize(raw_size);
+      auto ret = ZSTD_decompress(&(*raw)[0], raw_size, src, src_size);
+      if (ZSTD_isError(ret) || ret != raw_size) {
+        AERROR << "zstd decompress chunk failed, expect size: " << raw_size;
+        return false;
+      }
+      return true;
+    }
+    default:
+      AERROR << "Unsupported compress type: " << CompressType_Name(type);
+      return false;
+  }
+}
+
+}  // namespace record
+}  // namespace cyber
+}  // namespace apollo
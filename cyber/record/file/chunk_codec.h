@@ -0,0 +1,50 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#ifndef CYBER_RECORD_FILE_CHUNK_CODEC_H_
+#define CYBER_RECORD_FILE_CHUNK_CODEC_H_
+
+#include <string>
+
+#include "cyber/proto/record.pb.h"
+
+namespace apollo {
+namespace cyber {
+namespace record {
+
+/**
+ * @brief Whether chunk bodies can be written and read with the compress type
+ */
+bool IsCompressSupported(proto::CompressType type);
+
+/**
+ * @brief Compress a serialized chunk body, the raw size is kept in front of
+ * the compressed bytes as 8 byte little endian
+ */
+bool CompressChunk(proto::CompressType type, const std::string& raw,
+                   std::string* compressed);
+
+/**
+ * @brief Restore a chunk body compressed by CompressChunk
+ */
+bool DecompressChunk(proto::CompressType type, const std::string& compressed,
+                     std::string* raw);
+
+}  // namespace record
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_RECORD_FILE_CHUNK_CODEC_H_
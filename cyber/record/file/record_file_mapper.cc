@@ -0,0 +1,489 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "cyber/record/file/record_file_mapper.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/wire_format_lite.h"
+
+#include "cyber/common/file.h"
+#include "cyber/common/log.h"
+#include "cyber/record/file/chunk_codec.h"
+#include "cyber/record/file/section.h"
+
+namespace apollo {
+namespace cyber {
+namespace record {
+
+using apollo::cyber::proto::ChunkBody;
+using apollo::cyber::proto::CompressType;
+using apollo::cyber::proto::SectionType;
+using apollo::cyber::proto::SingleMessage;
+using google::protobuf::internal::WireFormatLite;
+using google::protobuf::io::CodedInputStream;
+
+RecordFileMapper::~RecordFileMapper() { Close(); }
+
+bool RecordFileMapper::Open(const std::string& path) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Close();
+  if (!Map(path)) {
+    // nothing stays open or mapped, the mapper may open another file
+    Close();
+    return false;
+  }
+  return true;
+}
+
+bool RecordFileMapper::Map(const std::string& path) {
+  path_ = path;
+  if (!::apollo::cyber::common::PathExists(path_)) {
+    AERROR << "File not exist, file: " << path_;
+    return false;
+  }
+  fd_ = open(path_.data(), O_RDONLY);
+  if (fd_ < 0) {
+    AERROR << "Open file failed, file: " << path_ << ", fd: " << fd_
+           << ", errno: " << errno;
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd_, &st) != 0) {
+    AERROR << "Stat file failed, file: " << path_ << ", errno: " << errno;
+    return false;
+  }
+  size_ = static_cast<size_t>(st.st_size);
+  if (size_ < sizeof(struct Section) + HEADER_LENGTH) {
+    AERROR << "File is too small to be a record, file: " << path_;
+    return false;
+  }
+  void* addr = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+  if (addr == MAP_FAILED) {
+    AERROR << "Map file failed, file: " << path_ << ", errno: " << errno;
+    return false;
+  }
+  data_ = static_cast<const char*>(addr);
+
+  int64_t size = 0;
+  if (!ReadSectionAt(0, SectionType::SECTION_HEADER, &size) ||
+      !header_.ParseFromArray(data_ + sizeof(struct Section),
+                              static_cast<int>(size))) {
+    AERROR << "Read header section fail, file is broken or it is not a record "
+              "file.";
+    return false;
+  }
+  if (!header_.is_complete()) {
+    AINFO << "Record file is not complete, it has no index to map, file: "
+          << path_;
+    return false;
+  }
+  if (!ReadSectionAt(header_.index_position(), SectionType::SECTION_INDEX,
+                     &size) ||
+      !index_.ParseFromArray(
+          data_ + header_.index_position() + sizeof(struct Section),
+          static_cast<int>(size))) {
+    AERROR << "Read index section fail, maybe file is broken.";
+    return false;
+  }
+  return LoadChunks();
+}
+
+void RecordFileMapper::Close() {
+  if (data_ != nullptr) {
+    munmap(const_cast<char*>(data_), size_);
+    data_ = nullptr;
+  }
+  size_ = 0;
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+  header_.Clear();
+  index_.Clear();
+  chunks_.clear();
+  message_offsets_.clear();
+  message_indexed_.clear();
+  channel_ids_.clear();
+  channel_names_.clear();
+}
+
+bool RecordFileMapper::ReadSectionAt(int64_t position, SectionType type,
+                                     int64_t* size) const {
+  if (position < 0 ||
+      static_cast<uint64_t>(position) + sizeof(struct Section) > size_) {
+    AERROR << "Section position out of file, position: " << position
+           << ", file size: " << size_;
+    return false;
+  }
+  Section section;
+  std::memcpy(&section, data_ + position, sizeof(section));
+  if (section.type != type) {
+    AERROR << "Check section type failed"
+           << ", expect: " << type << ", actual: " << section.type;
+    return false;
+  }
+  if (section.size < 0 || section.size > std::numeric_limits<int>::max() ||
+      static_cast<uint64_t>(position) + sizeof(struct Section) +
+              static_cast<uint64_t>(section.size) >
+          size_) {
+    AERROR << "Section size out of file, position: " << position
+           << ", size: " << section.size << ", file size: " << size_;
+    return false;
+  }
+  *size = section.size;
+  return true;
+}
+
+bool RecordFileMapper::LoadChunks() {
+  for (const auto& single_idx : index_.indexes()) {
+    switch (single_idx.type()) {
+      case SectionType::SECTION_CHANNEL:
+        if (single_idx.has_channel_cache()) {
+          ChannelId(single_idx.channel_cache().name());
+        }
+        break;
+      case SectionType::SECTION_CHUNK_HEADER: {
+        if (!single_idx.has_chunk_header_cache()) {
+          AERROR << "Single chunk header index does not have "
+                    "chunk_header_cache.";
+          return false;
+        }
+        const auto& cache = single_idx.chunk_header_cache();
+        ChunkInfo info;
+        info.begin_time = cache.begin_time();
+        info.end_time = cache.end_time();
+        info.message_number = cache.message_number();
+        info.raw_size = cache.raw_size();
+        info.max_end_time =
+            chunks_.empty()
+                ? info.end_time
+                : std::max(chunks_.back().max_end_time, info.end_time);
+        chunks_.push_back(info);
+        break;
+      }
+      case SectionType::SECTION_CHUNK_BODY: {
+        if (chunks_.empty() || chunks_.back().body_position != 0) {
+          AERROR << "Chunk body index without chunk header index.";
+          return false;
+        }
+        int64_t size = 0;
+        if (!ReadSectionAt(single_idx.position(),
+                           SectionType::SECTION_CHUNK_BODY, &size)) {
+          return false;
+        }
+        chunks_.back().body_position =
+            single_idx.position() + sizeof(struct Section);
+        chunks_.back().body_size = size;
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  if (!chunks_.empty() && chunks_.back().body_position == 0) {
+    AERROR << "Chunk header index without chunk body index.";
+    return false;
+  }
+  message_offsets_.resize(chunks_.size());
+  message_indexed_.resize(chunks_.size(), false);
+  return true;
+}
+
+size_t RecordFileMapper::FindChunk(uint64_t begin_time) const {
+  auto it = std::partition_point(
+      chunks_.begin(), chunks_.end(), [begin_time](const ChunkInfo& info) {
+        return info.max_end_time < begin_time;
+      });
+  return it - chunks_.begin();
+}
+
+bool RecordFileMapper::ReadChunk(size_t chunk, ChunkBody* body) {
+  if (chunk >= chunks_.size()) {
+    AERROR << "Chunk out of range: " << chunk;
+    return false;
+  }
+  const auto& info = chunks_[chunk];
+  const char* data = data_ + info.body_position;
+  ReadAhead(info);
+
+  if (header_.compress() == CompressType::COMPRESS_NONE) {
+    if (!body->ParseFromArray(data, static_cast<int>(info.body_size))) {
+      AERROR << "Parse chunk body failed, chunk: " << chunk;
+      return false;
+    }
+    return true;
+  }
+  std::string raw;
+  if (!DecompressChunk(header_.compress(),
+                       std::string(data, static_cast<size_t>(info.body_size)),
+                       &raw)) {
+    AERROR << "Decompress chunk body failed, chunk: " << chunk;
+    return false;
+  }
+  if (!body->ParseFromString(raw)) {
+    AERROR << "Parse chunk body failed, chunk: " << chunk;
+    return false;
+  }
+  return true;
+}
+
+bool RecordFileMapper::ReadChunk(size_t chunk,
+                                 const std::set<std::string>& channels,
+                                 ChunkBody* body) {
+  if (channels.empty()) {
+    return ReadChunk(chunk, body);
+  }
+  if (chunk >= chunks_.size()) {
+    AERROR << "Chunk out of range: " << chunk;
+    return false;
+  }
+  std::vector<bool> selected;
+  {
+    std::lock_guard<std::mutex> lock(channel_mutex_);
+    selected.resize(channel_ids_.size(), false);
+    for (const auto& channel : channels) {
+      auto it = channel_ids_.find(channel);
+      if (it != channel_ids_.end()) {
+        selected[it->second] = true;
+      }
+    }
+  }
+
+  const auto& info = chunks_[chunk];
+  const char* data = data_ + info.body_position;
+  const std::vector<MessageOffset>* offsets = nullptr;
+  std::string raw;
+  std::vector<MessageOffset> raw_offsets;
+  if (header_.compress() == CompressType::COMPRESS_NONE) {
+    offsets = GetMessageOffsets(chunk);
+    if (offsets == nullptr) {
+      return false;
+    }
+  } else {
+    // the whole chunk has to be decompressed, only parsing is saved
+    if (!DecompressChunk(
+            header_.compress(),
+            std::string(data, static_cast<size_t>(info.body_size)), &raw)) {
+      AERROR << "Decompress chunk body failed, chunk: " << chunk;
+      return false;
+    }
+    if (!IndexMessages(raw.data(), raw.size(), &raw_offsets)) {
+      AERROR << "Index messages failed, chunk: " << chunk;
+      return false;
+    }
+    data = raw.data();
+    offsets = &raw_offsets;
+  }
+
+  for (const auto& offset : *offsets) {
+    if (offset.channel_id >= selected.size() || !selected[offset.channel_id]) {
+      continue;
+    }
+    if (!body->add_messages()->ParseFromArray(data + offset.offset,
+                                              static_cast<int>(offset.size))) {
+      AERROR << "Parse message failed, chunk: " << chunk
+             << ", offset: " << offset.offset;
+      return false;
+    }
+  }
+  return true;
+}
+
+const std::vector<MessageOffset>* RecordFileMapper::GetMessageOffsets(
+    size_t chunk) {
+  if (chunk >= chunks_.size() ||
+      header_.compress() != CompressType::COMPRESS_NONE) {
+    return nullptr;
+  }
+  {
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    if (message_indexed_[chunk]) {
+      return &message_offsets_[chunk];
+    }
+  }
+  // indexed out of the lock, a chunk indexed twice meanwhile is kept once
+  const auto& info = chunks_[chunk];
+  std::vector<MessageOffset> offsets;
+  offsets.reserve(info.message_number);
+  if (!IndexMessages(data_ + info.body_position,
+                     static_cast<size_t>(info.body_size), &offsets)) {
+    AERROR << "Index messages failed, chunk: " << chunk;
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(index_mutex_);
+  if (!message_indexed_[chunk]) {
+    message_offsets_[chunk].swap(offsets);
+    message_indexed_[chunk] = true;
+  }
+  return &message_offsets_[chunk];
+}
+
+int64_t RecordFileMapper::GetChannelId(const std::string& channel_name) {
+  std::lock_guard<std::mutex> lock(channel_mutex_);
+  auto it = channel_ids_.find(channel_name);
+  if (it == channel_ids_.end()) {
+    return -1;
+  }
+  return it->second;
+}
+
+uint32_t RecordFileMapper::ChannelId(const std::string& channel_name) {
+  std::lock_guard<std::mutex> lock(channel_mutex_);
+  auto it = channel_ids_.find(channel_name);
+  if (it != channel_ids_.end()) {
+    return it->second;
+  }
+  uint32_t id = static_cast<uint32_t>(channel_ids_.size());
+  channel_ids_.emplace(channel_name, id);
+  channel_names_.push_back(channel_name);
+  return id;
+}
+
+void RecordFileMapper::ReadAhead(const ChunkInfo& info) const {
+  // read ahead the whole chunk, the faults are then served from page cache
+  const auto page_size = static_cast<int64_t>(sysconf(_SC_PAGESIZE));
+  const int64_t begin = info.body_position / page_size * page_size;
+  madvise(const_cast<char*>(data_) + begin,
+          info.body_position + info.body_size - begin, MADV_WILLNEED);
+}
+
+bool RecordFileMapper::ReadRawChunk(size_t chunk, std::string* body) const {
+  if (chunk >= chunks_.size()) {
+    AERROR << "Chunk out of range: " << chunk;
+    return false;
+  }
+  const auto& info = chunks_[chunk];
+  ReadAhead(info);
+  body->assign(data_ + info.body_position,
+               static_cast<size_t>(info.body_size));
+  return true;
+}
+
+bool RecordFileMapper::CountMessages(
+    size_t chunk, std::unordered_map<std::string, uint64_t>* counts) {
+  if (chunk >= chunks_.size()) {
+    AERROR << "Chunk out of range: " << chunk;
+    return false;
+  }
+  const auto& info = chunks_[chunk];
+  const char* data = data_ + info.body_position;
+  size_t size = static_cast<size_t>(info.body_size);
+  ReadAhead(info);
+  std::string raw;
+  if (header_.compress() != CompressType::COMPRESS_NONE) {
+    if (!DecompressChunk(header_.compress(), std::string(data, size), &raw)) {
+      AERROR << "Decompress chunk body failed, chunk: " << chunk;
+      return false;
+    }
+    data = raw.data();
+    size = raw.size();
+  }
+  // not kept, unlike GetMessageOffsets
+  std::vector<MessageOffset> offsets;
+  offsets.reserve(info.message_number);
+  if (!IndexMessages(data, size, &offsets)) {
+    AERROR << "Index messages failed, chunk: " << chunk;
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(channel_mutex_);
+  for (const auto& offset : offsets) {
+    ++(*counts)[channel_names_[offset.channel_id]];
+  }
+  return true;
+}
+
+bool RecordFileMapper::IndexMessages(const char* data, size_t size,
+                                     std::vector<MessageOffset>* offsets) {
+  if (size > static_cast<size_t>(std::numeric_limits<int>::max())) {
+    AERROR << "Chunk body is too large to index: " << size;
+    return false;
+  }
+  static const uint32_t kMessageTag =
+      WireFormatLite::MakeTag(ChunkBody::kMessagesFieldNumber,
+                              WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+  static const uint32_t kChannelTag =
+      WireFormatLite::MakeTag(SingleMessage::kChannelNameFieldNumber,
+                              WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+  static const uint32_t kTimeTag = WireFormatLite::MakeTag(
+      SingleMessage::kTimeFieldNumber, WireFormatLite::WIRETYPE_VARINT);
+
+  CodedInputStream input(reinterpret_cast<const uint8_t*>(data),
+                         static_cast<int>(size));
+  std::string channel_name;
+  while (true) {
+    uint32_t tag = input.ReadTag();
+    if (tag == 0) {
+      break;
+    }
+    if (tag != kMessageTag) {
+      if (!WireFormatLite::SkipField(&input, tag)) {
+        return false;
+      }
+      continue;
+    }
+    uint32_t length = 0;
+    if (!input.ReadVarint32(&length)) {
+      return false;
+    }
+    MessageOffset offset;
+    offset.offset = static_cast<uint32_t>(input.CurrentPosition());
+    offset.size = length;
+    auto limit = input.PushLimit(static_cast<int>(length));
+    // the channel name and the time are serialized in front of the content,
+    // which is skipped without being read
+    bool has_channel = false;
+    bool has_time = false;
+    while (!has_channel || !has_time) {
+      uint32_t field_tag = input.ReadTag();
+      if (field_tag == 0) {
+        break;
+      }
+      if (field_tag == kChannelTag) {
+        if (!WireFormatLite::ReadString(&input, &channel_name)) {
+          return false;
+        }
+        has_channel = true;
+      } else if (field_tag == kTimeTag) {
+        if (!input.ReadVarint64(&offset.time)) {
+          return false;
+        }
+        has_time = true;
+      } else if (!WireFormatLite::SkipField(&input, field_tag)) {
+        return false;
+      }
+    }
+    if (!input.Skip(input.BytesUntilLimit())) {
+      return false;
+    }
+    input.PopLimit(limit);
+    offset.channel_id = ChannelId(has_channel ? channel_name : "");
+    offsets->push_back(offset);
+  }
+  return static_cast<size_t>(input.CurrentPosition()) == size;
+}
+
+}  // namespace record
+}  // namespace cyber
+}  // namespace apollo
@@ -0,0 +1,149 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#ifndef CYBER_RECORD_FILE_RECORD_FILE_MAPPER_H_
+#define CYBER_RECORD_FILE_RECORD_FILE_MAPPER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cyber/proto/record.pb.h"
+#include "cyber/record/file/record_file_base.h"
+
+namespace apollo {
+namespace cyber {
+namespace record {
+
+/**
+ * @brief A chunk as described by the index section of the record
+ */
+struct ChunkInfo {
+  uint64_t begin_time = 0;
+  uint64_t end_time = 0;
+  uint64_t message_number = 0;
+  uint64_t raw_size = 0;
+  // greatest end_time of this chunk and all the chunks before it, chunks are
+  // only roughly sorted by time so this is what a time lookup searches
+  uint64_t max_end_time = 0;
+  // file offset of the chunk body payload, behind its section header
+  int64_t body_position = 0;
+  int64_t body_size = 0;
+};
+
+/**
+ * @brief Where a message lies in an uncompressed chunk body
+ */
+struct MessageOffset {
+  uint32_t channel_id = 0;
+  uint64_t time = 0;
+  // offset of the serialized SingleMessage in the chunk body
+  uint32_t offset = 0;
+  uint32_t size = 0;
+};
+
+/**
+ * @class RecordFileMapper
+ * @brief Random access to a complete record file. The file is mapped into
+ * memory and chunks are located through the index section, so a time range
+ * or a few channels are read without parsing the rest of the file. Once
+ * opened, chunks may be read from several threads at once.
+ */
+class RecordFileMapper : public RecordFileBase {
+ public:
+  RecordFileMapper() = default;
+  virtual ~RecordFileMapper();
+
+  /**
+   * @brief Map the record, fails if it has no index (i.e. it is incomplete)
+   */
+  bool Open(const std::string& path) override;
+  void Close() override;
+
+  const std::vector<ChunkInfo>& GetChunks() const { return chunks_; }
+
+  /**
+   * @brief Index of the first chunk that may hold messages at or after
+   * begin_time, every chunk before it ends earlier
+   */
+  size_t FindChunk(uint64_t begin_time) const;
+
+  bool ReadChunk(size_t chunk, proto::ChunkBody* body);
+
+  /**
+   * @brief Read only the messages of the channels, all of them if empty.
+   * The other messages of uncompressed chunks are skipped through their
+   * offsets without being parsed.
+   */
+  bool ReadChunk(size_t chunk, const std::set<std::string>& channels,
+                 proto::ChunkBody* body);
+
+  /**
+   * @brief Per message offsets of an uncompressed chunk, built the first time
+   * the chunk is asked for
+   * @return nullptr if the chunk is compressed or broken
+   */
+  const std::vector<MessageOffset>* GetMessageOffsets(size_t chunk);
+
+  /**
+   * @brief The chunk body as stored, compressed as the header says
+   */
+  bool ReadRawChunk(size_t chunk, std::string* body) const;
+
+  /**
+   * @brief Message number of every channel in the chunk. No message is
+   * parsed, compressed chunks are decompressed though.
+   */
+  bool CountMessages(size_t chunk,
+                     std::unordered_map<std::string, uint64_t>* counts);
+
+  /**
+   * @return id used by MessageOffset::channel_id, -1 if never seen
+   */
+  int64_t GetChannelId(const std::string& channel_name);
+
+ private:
+  bool Map(const std::string& path);
+  bool ReadSectionAt(int64_t position, proto::SectionType type,
+                     int64_t* size) const;
+  bool LoadChunks();
+  bool IndexMessages(const char* data, size_t size,
+                     std::vector<MessageOffset>* offsets);
+  uint32_t ChannelId(const std::string& channel_name);
+  void ReadAhead(const ChunkInfo& info) const;
+
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+  std::vector<ChunkInfo> chunks_;
+  // chunks are indexed outside of the locks, by several threads at once
+  std::mutex index_mutex_;
+  std::vector<std::vector<MessageOffset>> message_offsets_;
+  std::vector<bool> message_indexed_;
+  std::mutex channel_mutex_;
+  std::unordered_map<std::string, uint32_t> channel_ids_;
+  // index: channel id
+  std::vector<std::string> channel_names_;
+};
+
+}  // namespace record
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_RECORD_FILE_RECORD_FILE_MAPPER_H_
@@ -17,11 +17,13 @@
 #include "cyber/record/file/record_file_reader.h"
 
 #include "cyber/common/file.h"
+#include "cyber/record/file/chunk_codec.h"
 
 namespace apollo {
 namespace cyber {
 namespace record {
 
+using apollo::cyber::proto::CompressType;
 using apollo::cyber::proto::SectionType;
 
 bool RecordFileReader::Open(const std::string& path) {
@@ -132,6 +134,47 @@ bool RecordFileReader::ReadSection(Section* section) {
   return true;
 }
 
+template <>
+bool RecordFileReader::ReadSection<proto::ChunkBody>(
+    int64_t size, proto::ChunkBody* message) {
+  if (header_.compress() == CompressType::COMPRESS_NONE) {
+    return ParseSection(size, message);
+  }
+  if (size < 0 || size > std::numeric_limits<int>::max()) {
+    AERROR << "Size value greater than the range of int value.";
+    return false;
+  }
+  std::string compressed(static_cast<size_t>(size), '\0');
+  int64_t offset = 0;
+  while (offset < size) {
+    ssize_t count = read(fd_, &compressed[offset], size - offset);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      AERROR << "Read fd failed, fd_: " << fd_ << ", errno: " << errno;
+      return false;
+    }
+    if (count == 0) {
+      end_of_file_ = true;
+      AERROR << "Chunk body is truncated, expect: " << size
+             << ", actual: " << offset;
+      return false;
+    }
+    offset += count;
+  }
+  std::string raw;
+  if (!DecompressChunk(header_.compress(), compressed, &raw)) {
+    AERROR << "Decompress chunk body failed.";
+    return false;
+  }
+  if (!message->ParseFromString(raw)) {
+    AERROR << "Parse section message failed.";
+    return false;
+  }
+  return true;
+}
+
 bool RecordFileReader::SkipSection(int64_t size) {
   int64_t pos = CurrentPosition();
   if (size > INT64_MAX - pos) {
@@ -58,11 +58,26 @@ class RecordFileReader : public RecordFileBase {
 
  private:
   bool ReadHeader();
+  template <typename T>
+  bool ParseSection(int64_t size, T* message);
   bool end_of_file_ = false;
 };
 
 template <typename T>
 bool RecordFileReader::ReadSection(int64_t size, T* message) {
+  return ParseSection(size, message);
+}
+
+/**
+ * @brief Chunk bodies are decompressed according to the compress type in the
+ * record header
+ */
+template <>
+bool RecordFileReader::ReadSection<proto::ChunkBody>(int64_t size,
+                                                     proto::ChunkBody* message);
+
+template <typename T>
+bool RecordFileReader::ParseSection(int64_t size, T* message) {
   if (size < std::numeric_limits<int>::min() ||
       size > std::numeric_limits<int>::max()) {
     AERROR << "Size value greater than the range of int value.";
@@ -14,16 +14,21 @@
  * limitations under the License.
  *****************************************************************************/
 
+#include <fcntl.h>
 #include <unistd.h>
 #include <atomic>
 #include <string>
+#include <unordered_map>
 
 #include "gflags/gflags.h"
 #include "gtest/gtest.h"
 
+#include "cyber/record/file/chunk_codec.h"
 #include "cyber/record/file/record_file_base.h"
+#include "cyber/record/file/record_file_mapper.h"
 #include "cyber/record/file/record_file_reader.h"
 #include "cyber/record/file/record_file_writer.h"
+#include "cyber/record/file/section.h"
 #include "cyber/record/header_builder.h"
 
 namespace apollo {
@@ -308,6 +313,321 @@ TEST(RecordFileTest, TestIndex) {
   }
 }
 
+TEST(RecordFileTest, TestCompressedChunks) {
+  const proto::CompressType types[] = {proto::CompressType::COMPRESS_NONE,
+                                       proto::CompressType::COMPRESS_LZ4,
+                                       proto::CompressType::COMPRESS_ZSTD};
+  const int msg_num = 1000;
+  for (auto type : types) {
+    {
+      // several flush threads and small chunks, the chunks must still be
+      // written in the order they were filled
+      RecordFileWriter rfw(3);
+      ASSERT_TRUE(rfw.Open(kTestFile1));
+      Header header = HeaderBuilder::GetHeaderWithChunkParams(0, 1024);
+      header.set_segment_interval(0);
+      header.set_segment_raw_size(0);
+      header.set_compress(type);
+      ASSERT_TRUE(rfw.WriteHeader(header));
+
+      Channel chan1;
+      chan1.set_name(kChan1);
+      chan1.set_message_type(kMsgType);
+      chan1.set_proto_desc(kStr10B);
+      ASSERT_TRUE(rfw.WriteChannel(chan1));
+
+      for (int i = 1; i <= msg_num; ++i) {
+        SingleMessage msg;
+        msg.set_channel_name(chan1.name());
+        msg.set_content(std::string(100, static_cast<char>('a' + i % 26)));
+        msg.set_time(i);
+        ASSERT_TRUE(rfw.WriteMessage(msg));
+      }
+      rfw.Close();
+      ASSERT_TRUE(rfw.GetHeader().is_complete());
+      ASSERT_EQ(type, rfw.GetHeader().compress());
+      ASSERT_EQ(msg_num, rfw.GetHeader().message_number());
+      ASSERT_LT(1, rfw.GetHeader().chunk_number());
+    }
+
+    RecordFileReader rfr;
+    ASSERT_TRUE(rfr.Open(kTestFile1));
+    ASSERT_EQ(type, rfr.GetHeader().compress());
+    Section sec;
+    uint64_t chunk_num = 0;
+    uint64_t expect_time = 1;
+    while (rfr.ReadSection(&sec)) {
+      if (sec.type == SectionType::SECTION_INDEX) {
+        break;
+      }
+      if (sec.type != SectionType::SECTION_CHUNK_BODY) {
+        ASSERT_TRUE(rfr.SkipSection(sec.size));
+        continue;
+      }
+      ChunkBody body;
+      ASSERT_TRUE(rfr.ReadSection<ChunkBody>(sec.size, &body));
+      for (const auto& msg : body.messages()) {
+        ASSERT_EQ(expect_time, msg.time());
+        ASSERT_EQ(std::string(100, static_cast<char>('a' + expect_time % 26)),
+                  msg.content());
+        ++expect_time;
+      }
+      ++chunk_num;
+    }
+    ASSERT_EQ(msg_num + 1, expect_time);
+    ASSERT_EQ(rfr.GetHeader().chunk_number(), chunk_num);
+    ASSERT_FALSE(remove(kTestFile1));
+  }
+}
+
+TEST(RecordFileTest, TestCorruptCompressedChunk) {
+  const proto::CompressType types[] = {proto::CompressType::COMPRESS_LZ4,
+                                       proto::CompressType::COMPRESS_ZSTD};
+  std::string raw;
+  for (int i = 0; i < 1000; ++i) {
+    raw += std::string(100, static_cast<char>('a' + i % 26));
+  }
+  for (auto type : types) {
+    std::string compressed;
+    ASSERT_TRUE(CompressChunk(type, raw, &compressed));
+    std::string restored;
+    ASSERT_TRUE(DecompressChunk(type, compressed, &restored));
+    ASSERT_EQ(raw, restored);
+
+    // a raw size beyond what the compressed bytes can hold is rejected
+    // before anything is allocated for it
+    std::string corrupt = compressed;
+    corrupt[5] = static_cast<char>(0x7F);
+    EXPECT_FALSE(DecompressChunk(type, corrupt, &restored));
+    corrupt = compressed;
+    corrupt[0] = static_cast<char>(corrupt[0] + 1);
+    EXPECT_FALSE(DecompressChunk(type, corrupt, &restored));
+
+    // truncated
+    EXPECT_FALSE(DecompressChunk(
+        type, compressed.substr(0, compressed.size() / 2), &restored));
+    EXPECT_FALSE(DecompressChunk(type, compressed.substr(0, 4), &restored));
+  }
+}
+
+// cut the index off a complete record and clear is_complete in its header,
+// as a recorder killed while writing leaves it
+bool MakeIncomplete(const std::string& path) {
+  Header header;
+  {
+    RecordFileReader reader;
+    if (!reader.Open(path)) {
+      return false;
+    }
+    header = reader.GetHeader();
+    reader.Close();
+  }
+  int fd = open(path.c_str(), O_WRONLY);
+  if (fd < 0) {
+    return false;
+  }
+  bool ok = ftruncate(fd, header.index_position()) == 0;
+  header.set_is_complete(false);
+  Section section;
+  memset(&section, 0, sizeof(section));
+  section = {SectionType::SECTION_HEADER,
+             static_cast<int64_t>(header.ByteSizeLong())};
+  std::string data;
+  header.SerializeToString(&data);
+  data.resize(HEADER_LENGTH, '0');
+  ok = ok && pwrite(fd, &section, sizeof(section), 0) == sizeof(section) &&
+       pwrite(fd, data.data(), data.size(), sizeof(section)) ==
+           static_cast<ssize_t>(data.size());
+  close(fd);
+  return ok;
+}
+
+TEST(RecordFileTest, TestMapperIncomplete) {
+  for (auto path : {kTestFile1, kTestFile2}) {
+    RecordFileWriter rfw;
+    ASSERT_TRUE(rfw.Open(path));
+    Header header = HeaderBuilder::GetHeaderWithChunkParams(0, 90);
+    ASSERT_TRUE(rfw.WriteHeader(header));
+    for (int i = 1; i <= 20; ++i) {
+      SingleMessage msg;
+      msg.set_channel_name(kChan1);
+      msg.set_content(kStr10B);
+      msg.set_time(i * 10);
+      ASSERT_TRUE(rfw.WriteMessage(msg));
+    }
+    rfw.Close();
+  }
+  ASSERT_TRUE(MakeIncomplete(kTestFile1));
+
+  RecordFileReader reader;
+  ASSERT_TRUE(reader.Open(kTestFile1));
+  ASSERT_FALSE(reader.GetHeader().is_complete());
+  reader.Close();
+
+  // a failed open leaves nothing behind, the mapper opens the next record
+  RecordFileMapper mapper;
+  ASSERT_FALSE(mapper.Open(kTestFile1));
+  ASSERT_TRUE(mapper.GetChunks().empty());
+  ASSERT_TRUE(mapper.Open(kTestFile2));
+  ASSERT_EQ(2, mapper.GetChunks().size());
+  ASSERT_FALSE(mapper.Open(kTestFile1));
+  ASSERT_TRUE(mapper.GetChunks().empty());
+  mapper.Close();
+  ASSERT_FALSE(remove(kTestFile1));
+  ASSERT_FALSE(remove(kTestFile2));
+}
+
+TEST(RecordFileTest, TestMapper) {
+  const proto::CompressType types[] = {proto::CompressType::COMPRESS_NONE,
+                                       proto::CompressType::COMPRESS_LZ4};
+  for (auto type : types) {
+    {
+      RecordFileWriter rfw;
+      ASSERT_TRUE(rfw.Open(kTestFile1));
+      Header header = HeaderBuilder::GetHeaderWithChunkParams(0, 90);
+      header.set_segment_interval(0);
+      header.set_segment_raw_size(0);
+      header.set_compress(type);
+      ASSERT_TRUE(rfw.WriteHeader(header));
+      for (auto name : {kChan1, kChan2}) {
+        Channel chan;
+        chan.set_name(name);
+        chan.set_message_type(kMsgType);
+        ASSERT_TRUE(rfw.WriteChannel(chan));
+      }
+      // 10 messages of 10 bytes in each chunk
+      for (int i = 1; i <= 100; ++i) {
+        SingleMessage msg;
+        msg.set_channel_name(i % 2 ? kChan1 : kChan2);
+        msg.set_content(kStr10B);
+        msg.set_time(i * 10);
+        ASSERT_TRUE(rfw.WriteMessage(msg));
+      }
+      rfw.Close();
+    }
+
+    RecordFileMapper mapper;
+    ASSERT_TRUE(mapper.Open(kTestFile1));
+    const auto& chunks = mapper.GetChunks();
+    ASSERT_EQ(mapper.GetHeader().chunk_number(), chunks.size());
+    ASSERT_EQ(10, chunks.size());
+    ASSERT_EQ(10, chunks[0].begin_time);
+    ASSERT_EQ(110, chunks[1].begin_time);
+    ASSERT_EQ(0, mapper.FindChunk(0));
+    ASSERT_EQ(1, mapper.FindChunk(101));
+    ASSERT_EQ(9, mapper.FindChunk(1000));
+    ASSERT_EQ(10, mapper.FindChunk(1001));
+
+    ChunkBody body;
+    ASSERT_TRUE(mapper.ReadChunk(3, &body));
+    ASSERT_EQ(10, body.messages_size());
+    ASSERT_EQ(310, body.messages(0).time());
+
+    body.Clear();
+    ASSERT_TRUE(mapper.ReadChunk(3, {kChan2}, &body));
+    ASSERT_EQ(5, body.messages_size());
+    for (int i = 0; i < body.messages_size(); ++i) {
+      ASSERT_EQ(kChan2, body.messages(i).channel_name());
+      ASSERT_EQ(320 + i * 20, body.messages(i).time());
+      ASSERT_EQ(kStr10B, body.messages(i).content());
+    }
+
+    auto offsets = mapper.GetMessageOffsets(3);
+    if (type != proto::CompressType::COMPRESS_NONE) {
+      ASSERT_EQ(nullptr, offsets);
+    } else {
+      ASSERT_NE(nullptr, offsets);
+      ASSERT_EQ(10, offsets->size());
+      ASSERT_EQ(mapper.GetChannelId(kChan1), (*offsets)[0].channel_id);
+      ASSERT_EQ(mapper.GetChannelId(kChan2), (*offsets)[1].channel_id);
+      ASSERT_EQ(310, (*offsets)[0].time);
+      ASSERT_EQ(320, (*offsets)[1].time);
+    }
+    mapper.Close();
+    ASSERT_FALSE(remove(kTestFile1));
+  }
+}
+
+TEST(RecordFileTest, TestRawChunk) {
+  const proto::CompressType types[] = {proto::CompressType::COMPRESS_NONE,
+                                       proto::CompressType::COMPRESS_LZ4};
+  for (auto type : types) {
+    Header header = HeaderBuilder::GetHeaderWithChunkParams(0, 90);
+    header.set_segment_interval(0);
+    header.set_segment_raw_size(0);
+    header.set_compress(type);
+    {
+      RecordFileWriter rfw;
+      ASSERT_TRUE(rfw.Open(kTestFile1));
+      ASSERT_TRUE(rfw.WriteHeader(header));
+      for (int i = 1; i <= 40; ++i) {
+        SingleMessage msg;
+        msg.set_channel_name(i % 5 ? kChan1 : kChan2);
+        msg.set_content(kStr10B);
+        msg.set_time(i * 10);
+        ASSERT_TRUE(rfw.WriteMessage(msg));
+      }
+      rfw.Close();
+    }
+
+    RecordFileMapper mapper;
+    ASSERT_TRUE(mapper.Open(kTestFile1));
+    ASSERT_EQ(4, mapper.GetChunks().size());
+    {
+      // chunk 0 and 2 copied, the messages of chunk 1 in between
+      RecordFileWriter rfw;
+      ASSERT_TRUE(rfw.Open(kTestFile2));
+      ASSERT_TRUE(rfw.WriteHeader(header));
+      for (size_t chunk : {0, 1, 2}) {
+        std::unordered_map<std::string, uint64_t> counts;
+        ASSERT_TRUE(mapper.CountMessages(chunk, &counts));
+        ASSERT_EQ(2, counts.size());
+        ASSERT_EQ(8, counts[kChan1]);
+        ASSERT_EQ(2, counts[kChan2]);
+        if (chunk == 1) {
+          ChunkBody body;
+          ASSERT_TRUE(mapper.ReadChunk(chunk, &body));
+          for (const auto& msg : body.messages()) {
+            ASSERT_TRUE(rfw.WriteMessage(msg));
+          }
+          continue;
+        }
+        const auto& info = mapper.GetChunks()[chunk];
+        ChunkHeader chdr;
+        chdr.set_begin_time(info.begin_time);
+        chdr.set_end_time(info.end_time);
+        chdr.set_message_number(info.message_number);
+        chdr.set_raw_size(info.raw_size);
+        std::string raw;
+        ASSERT_TRUE(mapper.ReadRawChunk(chunk, &raw));
+        ASSERT_TRUE(rfw.WriteRawChunk(chdr, &raw, counts));
+      }
+      rfw.Close();
+      ASSERT_EQ(30, rfw.GetHeader().message_number());
+      ASSERT_EQ(24, rfw.GetMessageNumber(kChan1));
+      ASSERT_EQ(6, rfw.GetMessageNumber(kChan2));
+    }
+    mapper.Close();
+
+    ASSERT_TRUE(mapper.Open(kTestFile2));
+    ASSERT_EQ(3, mapper.GetChunks().size());
+    uint64_t expect_time = 10;
+    for (size_t chunk = 0; chunk < mapper.GetChunks().size(); ++chunk) {
+      ChunkBody body;
+      ASSERT_TRUE(mapper.ReadChunk(chunk, &body));
+      for (const auto& msg : body.messages()) {
+        ASSERT_EQ(expect_time, msg.time());
+        ASSERT_EQ(kStr10B, msg.content());
+        expect_time += 10;
+      }
+    }
+    ASSERT_EQ(310, expect_time);
+    mapper.Close();
+    ASSERT_FALSE(remove(kTestFile1));
+    ASSERT_FALSE(remove(kTestFile2));
+  }
+}
+
 }  // namespace record
 }  // namespace cyber
 }  // namespace apollo
@@ -18,7 +18,10 @@
 
 #include <fcntl.h>
 
+#include <algorithm>
+
 #include "cyber/common/file.h"
+#include "cyber/record/file/chunk_codec.h"
 #include "cyber/time/time.h"
 
 namespace apollo {
@@ -31,11 +34,25 @@ using apollo::cyber::proto::ChunkBody;
 using apollo::cyber::proto::ChunkBodyCache;
 using apollo::cyber::proto::ChunkHeader;
 using apollo::cyber::proto::ChunkHeaderCache;
+using apollo::cyber::proto::CompressType;
 using apollo::cyber::proto::Header;
 using apollo::cyber::proto::SectionType;
 using apollo::cyber::proto::SingleIndex;
 
-RecordFileWriter::RecordFileWriter() : is_writing_(false) {}
+namespace {
+// chunks in flight per flush thread, bounds the memory held by the pipeline
+constexpr uint32_t kChunksPerFlushThread = 2;
+constexpr uint32_t kMaxFlushThreadNum = 4;
+}  // namespace
+
+RecordFileWriter::RecordFileWriter(uint32_t flush_thread_num)
+    : is_writing_(false), flush_thread_num_(flush_thread_num) {
+  if (flush_thread_num_ == 0) {
+    flush_thread_num_ =
+        std::min(kMaxFlushThreadNum,
+                 std::max(1U, std::thread::hardware_concurrency() / 2));
+  }
+}
 
 RecordFileWriter::~RecordFileWriter() { Close(); }
 
@@ -53,53 +70,32 @@ bool RecordFileWriter::Open(const std::string& path) {
     return false;
   }
   chunk_active_.reset(new Chunk());
-  chunk_flush_.reset(new Chunk());
   is_writing_ = true;
-  flush_thread_ = std::make_shared<std::thread>([this]() { this->Flush(); });
-  if (flush_thread_ == nullptr) {
-    AERROR << "Init flush thread error.";
-    return false;
+  for (uint32_t i = 0; i < flush_thread_num_; ++i) {
+    flush_threads_.emplace_back([this]() { this->Flush(); });
   }
   return true;
 }
 
 void RecordFileWriter::Close() {
   if (is_writing_) {
-    // wait for the flush operation that may exist now
-    while (1) {
-      {
-        std::unique_lock<std::mutex> flush_lock(flush_mutex_);
-        if (chunk_flush_->empty()) {
-          break;
-        }
-      }
-      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    if (!chunk_active_->empty()) {
+      SubmitChunk();
     }
 
-    // last swap
+    // wait for every chunk in flight to be written
     {
       std::unique_lock<std::mutex> flush_lock(flush_mutex_);
-      chunk_flush_.swap(chunk_active_);
-      flush_cv_.notify_one();
+      done_cv_.wait(flush_lock, [this] { return inflight_chunks_.empty(); });
+      is_writing_ = false;
     }
-
-    // wait for the last flush operation
-    while (1) {
-      {
-        std::unique_lock<std::mutex> flush_lock(flush_mutex_);
-        if (chunk_flush_->empty()) {
-          break;
-        }
-      }
-      std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
-
-    is_writing_ = false;
     flush_cv_.notify_all();
-    if (flush_thread_ && flush_thread_->joinable()) {
-      flush_thread_->join();
-      flush_thread_ = nullptr;
+    for (auto& thread : flush_threads_) {
+      if (thread.joinable()) {
+        thread.join();
+      }
     }
+    flush_threads_.clear();
 
     if (!WriteIndex()) {
       AERROR << "Write index section failed, file: " << path_;
@@ -120,6 +116,13 @@ void RecordFileWriter::Close() {
 bool RecordFileWriter::WriteHeader(const Header& header) {
   std::lock_guard<std::mutex> lock(mutex_);
   header_ = header;
+  if (!IsCompressSupported(header_.compress())) {
+    AWARN << "Unsupported compress type "
+          << proto::CompressType_Name(header_.compress())
+          << ", write chunks uncompressed.";
+    header_.set_compress(CompressType::COMPRESS_NONE);
+  }
+  compress_ = header_.compress();
   if (!WriteSection<Header>(header_)) {
     AERROR << "Write header section fail";
     return false;
@@ -169,7 +172,7 @@ bool RecordFileWriter::WriteChannel(const Channel& channel) {
 }
 
 bool RecordFileWriter::WriteChunk(const ChunkHeader& chunk_header,
-                                  const ChunkBody& chunk_body) {
+                                  const std::string& chunk_body) {
   std::lock_guard<std::mutex> lock(mutex_);
   uint64_t pos = CurrentPosition();
   if (!WriteSection<ChunkHeader>(chunk_header)) {
@@ -187,7 +190,7 @@ bool RecordFileWriter::WriteChunk(const ChunkHeader& chunk_header,
   single_index->set_allocated_chunk_header_cache(chunk_header_cache);
 
   pos = CurrentPosition();
-  if (!WriteSection<ChunkBody>(chunk_body)) {
+  if (!WriteSection(SectionType::SECTION_CHUNK_BODY, chunk_body)) {
     AERROR << "Write chunk body fail";
     return false;
   }
@@ -202,7 +205,7 @@ bool RecordFileWriter::WriteChunk(const ChunkHeader& chunk_header,
   single_index->set_type(SectionType::SECTION_CHUNK_BODY);
   single_index->set_position(pos);
   ChunkBodyCache* chunk_body_cache = new ChunkBodyCache();
-  chunk_body_cache->set_message_number(chunk_body.messages_size());
+  chunk_body_cache->set_message_number(chunk_header.message_number());
   single_index->set_allocated_chunk_body_cache(chunk_body_cache);
   return true;
 }
@@ -222,38 +225,143 @@ bool RecordFileWriter::WriteMessage(const proto::SingleMessage& message) {
           header_.chunk_interval()) {
     need_flush = true;
   }
-  if (!in_writing_ && header_.chunk_raw_size() > 0 &&
+  if (header_.chunk_raw_size() > 0 &&
       chunk_active_->header_.raw_size() > header_.chunk_raw_size()) {
     need_flush = true;
   }
   if (!need_flush) {
     return true;
   }
-  {
-    std::unique_lock<std::mutex> flush_lock(flush_mutex_);
-    chunk_flush_.swap(chunk_active_);
-    flush_cv_.notify_one();
+  SubmitChunk();
+  return true;
+}
+
+bool RecordFileWriter::WriteSection(SectionType type, const std::string& data) {
+  Section section;
+  /// zero out whole struct even if padded
+  memset(&section, 0, sizeof(section));
+  section = {type, static_cast<int64_t>(data.size())};
+  ssize_t count = write(fd_, &section, sizeof(section));
+  if (count != sizeof(section)) {
+    AERROR << "Write fd failed, fd: " << fd_ << ", errno: " << errno;
+    return false;
+  }
+  size_t written = 0;
+  while (written < data.size()) {
+    count = write(fd_, data.data() + written, data.size() - written);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      AERROR << "Write fd failed, fd: " << fd_ << ", errno: " << errno;
+      return false;
+    }
+    written += count;
   }
+  header_.set_size(CurrentPosition());
   return true;
 }
 
-void RecordFileWriter::Flush() {
-  while (is_writing_) {
-    std::unique_lock<std::mutex> flush_lock(flush_mutex_);
-    flush_cv_.wait(flush_lock,
-                   [this] { return !chunk_flush_->empty() || !is_writing_; });
-    if (!is_writing_) {
-      break;
+void RecordFileWriter::SubmitChunk() {
+  auto task = std::make_shared<FlushTask>();
+  task->chunk = std::move(chunk_active_);
+  task->compress = compress_;
+  chunk_active_.reset(new Chunk());
+
+  std::unique_lock<std::mutex> flush_lock(flush_mutex_);
+  WaitInflightRoom(&flush_lock);
+  inflight_chunks_.emplace_back(task);
+  pending_chunks_.emplace_back(task);
+  flush_cv_.notify_one();
+}
+
+bool RecordFileWriter::WriteRawChunk(
+    const ChunkHeader& chunk_header, std::string* chunk_body,
+    const std::unordered_map<std::string, uint64_t>& message_numbers) {
+  if (!is_writing_) {
+    AERROR << "Write raw chunk to a closed file.";
+    return false;
+  }
+  // keep the order of the chunks with the messages written before
+  if (!chunk_active_->empty()) {
+    SubmitChunk();
+  }
+  for (const auto& item : message_numbers) {
+    channel_message_number_map_[item.first] += item.second;
+  }
+
+  // nothing left to serialize or compress, ready as it is
+  auto task = std::make_shared<FlushTask>();
+  task->chunk.reset(new Chunk());
+  task->chunk->header_ = chunk_header;
+  task->chunk->body_.reset();
+  task->compress = compress_;
+  task->body.swap(*chunk_body);
+  task->ready = true;
+  task->ok = true;
+
+  std::unique_lock<std::mutex> flush_lock(flush_mutex_);
+  WaitInflightRoom(&flush_lock);
+  inflight_chunks_.emplace_back(task);
+  WriteReadyChunks(&flush_lock);
+  return true;
+}
+
+void RecordFileWriter::WaitInflightRoom(
+    std::unique_lock<std::mutex>* flush_lock) {
+  // back pressure, the caller waits while the disk falls behind
+  done_cv_.wait(*flush_lock, [this] {
+    return inflight_chunks_.size() < flush_thread_num_ * kChunksPerFlushThread;
+  });
+}
+
+void RecordFileWriter::WriteReadyChunks(
+    std::unique_lock<std::mutex>* flush_lock) {
+  // the chunks are written in order by whichever thread finds the oldest one
+  // ready
+  while (!chunk_writing_ && !inflight_chunks_.empty() &&
+         inflight_chunks_.front()->ready) {
+    auto front = inflight_chunks_.front();
+    chunk_writing_ = true;
+    flush_lock->unlock();
+    if (!front->ok || !WriteChunk(front->chunk->header_, front->body)) {
+      AERROR << "Write chunk fail.";
     }
-    if (chunk_flush_->empty()) {
-      continue;
+    flush_lock->lock();
+    chunk_writing_ = false;
+    inflight_chunks_.pop_front();
+    done_cv_.notify_all();
+  }
+}
+
+void RecordFileWriter::Flush() {
+  while (true) {
+    FlushTaskPtr task = nullptr;
+    {
+      std::unique_lock<std::mutex> flush_lock(flush_mutex_);
+      flush_cv_.wait(flush_lock, [this] {
+        return !pending_chunks_.empty() || !is_writing_;
+      });
+      if (pending_chunks_.empty()) {
+        break;
+      }
+      task = pending_chunks_.front();
+      pending_chunks_.pop_front();
     }
-    in_writing_ = true;
-    if (!WriteChunk(chunk_flush_->header_, *(chunk_flush_->body_.get()))) {
-      AERROR << "Write chunk fail.";
+
+    // serialize and compress in parallel with the other flush threads
+    std::string raw;
+    task->ok = task->chunk->body_->SerializeToString(&raw);
+    if (task->ok && task->compress != CompressType::COMPRESS_NONE) {
+      task->ok = CompressChunk(task->compress, raw, &task->body);
+    } else {
+      task->body.swap(raw);
     }
-    in_writing_ = false;
-    chunk_flush_->clear();
+    task->chunk->body_.reset();
+
+    std::unique_lock<std::mutex> flush_lock(flush_mutex_);
+    task->ready = true;
+    WriteReadyChunks(&flush_lock);
   }
 }
 
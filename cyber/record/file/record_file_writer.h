@@ -18,6 +18,7 @@
 #define CYBER_RECORD_FILE_RECORD_FILE_WRITER_H_
 
 #include <condition_variable>
+#include <deque>
 #include <fstream>
 #include <memory>
 #include <string>
@@ -25,6 +26,7 @@
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "google/protobuf/io/zero_copy_stream_impl.h"
 #include "google/protobuf/message.h"
@@ -74,31 +76,69 @@ struct Chunk {
   std::unique_ptr<proto::ChunkBody> body_ = nullptr;
 };
 
+/**
+ * @class RecordFileWriter
+ * @brief Full chunks are serialized and compressed by a pool of flush
+ * threads, several chunks at a time, and written to the file in the order
+ * they were filled.
+ */
 class RecordFileWriter : public RecordFileBase {
  public:
-  RecordFileWriter();
+  /**
+   * @param flush_thread_num threads serializing and compressing chunks, 0
+   * picks one from the number of cores
+   */
+  explicit RecordFileWriter(uint32_t flush_thread_num = 0);
   virtual ~RecordFileWriter();
   bool Open(const std::string& path) override;
   void Close() override;
   bool WriteHeader(const proto::Header& header);
   bool WriteChannel(const proto::Channel& channel);
   bool WriteMessage(const proto::SingleMessage& message);
+  /**
+   * @brief Write a chunk body taken verbatim from another record, compressed
+   * as the header of this one says, after the messages written before it
+   * @param message_numbers message number of every channel in the chunk
+   */
+  bool WriteRawChunk(
+      const proto::ChunkHeader& chunk_header, std::string* chunk_body,
+      const std::unordered_map<std::string, uint64_t>& message_numbers);
   uint64_t GetMessageNumber(const std::string& channel_name) const;
 
  private:
+  struct FlushTask {
+    std::unique_ptr<Chunk> chunk;
+    proto::CompressType compress = proto::CompressType::COMPRESS_NONE;
+    // serialized chunk body, compressed if compress is set
+    std::string body;
+    bool ready = false;
+    bool ok = false;
+  };
+  using FlushTaskPtr = std::shared_ptr<FlushTask>;
+
   bool WriteChunk(const proto::ChunkHeader& chunk_header,
-                  const proto::ChunkBody& chunk_body);
+                  const std::string& chunk_body);
   template <typename T>
   bool WriteSection(const T& message);
+  bool WriteSection(proto::SectionType type, const std::string& data);
   bool WriteIndex();
+  void SubmitChunk();
+  void WaitInflightRoom(std::unique_lock<std::mutex>* flush_lock);
+  void WriteReadyChunks(std::unique_lock<std::mutex>* flush_lock);
   void Flush();
   std::atomic_bool is_writing_;
-  std::atomic_bool in_writing_{false};
   std::unique_ptr<Chunk> chunk_active_ = nullptr;
-  std::unique_ptr<Chunk> chunk_flush_ = nullptr;
-  std::shared_ptr<std::thread> flush_thread_ = nullptr;
+  uint32_t flush_thread_num_ = 0;
+  std::vector<std::thread> flush_threads_;
   std::mutex flush_mutex_;
   std::condition_variable flush_cv_;
+  std::condition_variable done_cv_;
+  // chunks waiting for a flush thread
+  std::deque<FlushTaskPtr> pending_chunks_;
+  // chunks not written yet, in the order they were filled
+  std::deque<FlushTaskPtr> inflight_chunks_;
+  bool chunk_writing_ = false;
+  proto::CompressType compress_ = proto::CompressType::COMPRESS_NONE;
   std::unordered_map<std::string, uint64_t> channel_message_number_map_;
 };
 
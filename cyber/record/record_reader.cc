@@ -16,6 +16,7 @@
 
 #include "cyber/record/record_reader.h"
 
+#include <algorithm>
 #include <utility>
 
 namespace apollo {
@@ -30,40 +31,56 @@ using apollo::cyber::proto::SectionType;
 RecordReader::~RecordReader() {}
 
 RecordReader::RecordReader(const std::string& file) {
-  file_reader_.reset(new RecordFileReader());
-  if (!file_reader_->Open(file)) {
-    AERROR << "Failed to open record file: " << file;
-    return;
+  file_mapper_.reset(new RecordFileMapper());
+  if (file_mapper_->Open(file)) {
+    chunk_.reset(new ChunkBody());
+    is_valid_ = true;
+    header_ = file_mapper_->GetHeader();
+    index_ = file_mapper_->GetIndex();
+  } else {
+    file_mapper_.reset();
+    file_reader_.reset(new RecordFileReader());
+    if (!file_reader_->Open(file)) {
+      AERROR << "Failed to open record file: " << file;
+      return;
+    }
+    chunk_.reset(new ChunkBody());
+    is_valid_ = true;
+    header_ = file_reader_->GetHeader();
+    if (file_reader_->ReadIndex()) {
+      index_ = file_reader_->GetIndex();
+    }
+    file_reader_->Reset();
   }
-  chunk_.reset(new ChunkBody());
-  is_valid_ = true;
-  header_ = file_reader_->GetHeader();
-  if (file_reader_->ReadIndex()) {
-    index_ = file_reader_->GetIndex();
-    for (int i = 0; i < index_.indexes_size(); ++i) {
-      auto single_idx = index_.mutable_indexes(i);
-      if (single_idx->type() != SectionType::SECTION_CHANNEL) {
-        continue;
-      }
-      if (!single_idx->has_channel_cache()) {
-        AERROR << "Single channel index does not have channel_cache.";
-        continue;
-      }
-      auto channel_cache = single_idx->mutable_channel_cache();
-      channel_info_.insert(
-          std::make_pair(channel_cache->name(), *channel_cache));
+
+  for (int i = 0; i < index_.indexes_size(); ++i) {
+    auto single_idx = index_.mutable_indexes(i);
+    if (single_idx->type() != SectionType::SECTION_CHANNEL) {
+      continue;
     }
+    if (!single_idx->has_channel_cache()) {
+      AERROR << "Single channel index does not have channel_cache.";
+      continue;
+    }
+    auto channel_cache = single_idx->mutable_channel_cache();
+    channel_info_.insert(std::make_pair(channel_cache->name(), *channel_cache));
   }
-  file_reader_->Reset();
 }
 
 void RecordReader::Reset() {
-  file_reader_->Reset();
+  if (file_reader_) {
+    file_reader_->Reset();
+  }
+  next_chunk_ = 0;
   reach_end_ = false;
   message_index_ = 0;
   chunk_.reset(new ChunkBody());
 }
 
+void RecordReader::SetChannelFilter(const std::set<std::string>& channels) {
+  channels_ = channels;
+}
+
 std::set<std::string> RecordReader::GetChannelList() const {
   std::set<std::string> channel_list;
   for (auto& item : channel_info_) {
@@ -92,6 +109,10 @@ bool RecordReader::ReadMessage(RecordMessage* message, uint64_t begin_time,
     if (time < begin_time) {
       continue;
     }
+    if (!channels_.empty() &&
+        channels_.count(next_message.channel_name()) == 0) {
+      continue;
+    }
 
     message->channel_name = next_message.channel_name();
     message->content = next_message.content();
@@ -110,6 +131,9 @@ bool RecordReader::ReadMessage(RecordMessage* message, uint64_t begin_time,
 }
 
 bool RecordReader::ReadNextChunk(uint64_t begin_time, uint64_t end_time) {
+  if (file_mapper_) {
+    return ReadNextMappedChunk(begin_time, end_time);
+  }
   bool skip_next_chunk_body = false;
   while (!reach_end_) {
     Section section;
@@ -171,6 +195,35 @@ bool RecordReader::ReadNextChunk(uint64_t begin_time, uint64_t end_time) {
   return false;
 }
 
+bool RecordReader::ReadNextMappedChunk(uint64_t begin_time,
+                                       uint64_t end_time) {
+  const auto& chunks = file_mapper_->GetChunks();
+  // every chunk before this one ends earlier than begin_time, jump over them
+  // without touching the file
+  next_chunk_ = std::max(next_chunk_, file_mapper_->FindChunk(begin_time));
+  while (next_chunk_ < chunks.size()) {
+    const auto& chunk = chunks[next_chunk_];
+    if (chunk.end_time < begin_time) {
+      ++next_chunk_;
+      continue;
+    }
+    if (chunk.begin_time > end_time) {
+      return false;
+    }
+    chunk_.reset(new ChunkBody());
+    if (!file_mapper_->ReadChunk(next_chunk_++, channels_, chunk_.get())) {
+      AERROR << "Failed to read chunk body, file: "
+             << file_mapper_->GetPath();
+      return false;
+    }
+    // none of the filtered channels in this chunk
+    if (chunk_->messages_size() > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
 uint64_t RecordReader::GetMessageNumber(const std::string& channel_name) const {
   auto search = channel_info_.find(channel_name);
   if (search == channel_info_.end()) {
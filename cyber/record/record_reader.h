@@ -25,6 +25,7 @@
 
 #include "cyber/proto/record.pb.h"
 
+#include "cyber/record/file/record_file_mapper.h"
 #include "cyber/record/file/record_file_reader.h"
 #include "cyber/record/record_base.h"
 #include "cyber/record/record_message.h"
@@ -34,7 +35,8 @@ namespace cyber {
 namespace record {
 
 /**
- * @brief The record reader.
+ * @brief The record reader. Complete records are memory mapped and their
+ * chunks located through the index, others are read section by section.
  */
 class RecordReader : public RecordBase {
  public:
@@ -77,6 +79,14 @@ class RecordReader : public RecordBase {
    */
   void Reset();
 
+  /**
+   * @brief Only read the messages of these channels, all of them if empty.
+   * The messages of other channels in mapped records are not even parsed.
+   *
+   * @param channels
+   */
+  void SetChannelFilter(const std::set<std::string>& channels);
+
   /**
    * @brief Get message number by channel name.
    *
@@ -115,6 +125,7 @@ class RecordReader : public RecordBase {
 
  private:
   bool ReadNextChunk(uint64_t begin_time, uint64_t end_time);
+  bool ReadNextMappedChunk(uint64_t begin_time, uint64_t end_time);
 
   bool is_valid_ = false;
   bool reach_end_ = false;
@@ -123,6 +134,10 @@ class RecordReader : public RecordBase {
   int message_index_ = 0;
   ChannelInfoMap channel_info_;
   FileReaderPtr file_reader_;
+  std::unique_ptr<RecordFileMapper> file_mapper_;
+  // next chunk of the mapped record
+  size_t next_chunk_ = 0;
+  std::set<std::string> channels_;
 };
 
 }  // namespace record
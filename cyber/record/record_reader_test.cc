@@ -16,10 +16,12 @@
 
 #include "cyber/record/record_reader.h"
 
+#include <set>
 #include <string>
 
 #include "gtest/gtest.h"
 
+#include "cyber/record/header_builder.h"
 #include "cyber/record/record_writer.h"
 
 namespace apollo {
@@ -29,6 +31,7 @@ namespace record {
 using apollo::cyber::message::RawMessage;
 
 constexpr char kChannelName1[] = "/test/channel1";
+constexpr char kChannelName2[] = "/test/channel2";
 constexpr char kMessageType1[] = "apollo.cyber.proto.Test";
 constexpr char kProtoDesc[] = "1234567890";
 constexpr char kStr10B[] = "1234567890";
@@ -122,6 +125,60 @@ TEST(RecordTest, TestReaderOrder) {
   ASSERT_FALSE(remove(kTestFile));
 }
 
+TEST(RecordTest, TestChannelFilterAndTimeRange) {
+  // tiny chunks, so the reader has to jump between many of them
+  auto header = HeaderBuilder::GetHeaderWithChunkParams(0, 64);
+  header.set_segment_interval(0);
+  header.set_segment_raw_size(0);
+  {
+    RecordWriter writer(header);
+    writer.Open(kTestFile);
+    writer.WriteChannel(kChannelName1, kMessageType1, kProtoDesc);
+    writer.WriteChannel(kChannelName2, kMessageType1, kProtoDesc);
+    for (uint32_t i = 0; i < kMessageNum * 16; ++i) {
+      auto msg = std::make_shared<RawMessage>(std::to_string(i));
+      writer.WriteMessage(i % 4 == 0 ? kChannelName1 : kChannelName2, msg, i);
+    }
+    writer.Close();
+  }
+
+  RecordReader reader(kTestFile);
+  ASSERT_TRUE(reader.IsValid());
+  ASSERT_LT(1, reader.GetHeader().chunk_number());
+  RecordMessage message;
+
+  // seek into the middle of the record
+  const uint64_t begin_time = kMessageNum * 8;
+  for (uint64_t i = begin_time; i < kMessageNum * 16; ++i) {
+    ASSERT_TRUE(reader.ReadMessage(&message, begin_time));
+    ASSERT_EQ(std::to_string(i), message.content);
+    ASSERT_EQ(i, message.time);
+  }
+  ASSERT_FALSE(reader.ReadMessage(&message, begin_time));
+
+  // one channel of a time range
+  reader.Reset();
+  reader.SetChannelFilter({kChannelName1});
+  const uint64_t end_time = kMessageNum * 12;
+  for (uint64_t i = begin_time; i <= end_time; i += 4) {
+    ASSERT_TRUE(reader.ReadMessage(&message, begin_time, end_time));
+    ASSERT_EQ(kChannelName1, message.channel_name);
+    ASSERT_EQ(std::to_string(i), message.content);
+    ASSERT_EQ(i, message.time);
+  }
+  ASSERT_FALSE(reader.ReadMessage(&message, begin_time, end_time));
+
+  // back to every channel
+  reader.Reset();
+  reader.SetChannelFilter({});
+  for (uint64_t i = 0; i < kMessageNum * 16; ++i) {
+    ASSERT_TRUE(reader.ReadMessage(&message));
+    ASSERT_EQ(i, message.time);
+  }
+  ASSERT_FALSE(reader.ReadMessage(&message));
+  ASSERT_FALSE(remove(kTestFile));
+}
+
 }  // namespace record
 }  // namespace cyber
 }  // namespace apollo
@@ -85,6 +85,8 @@ void RecordViewer::set_curr_itr(const Iterator& curr_itr) { itr_ = curr_itr; }
 void RecordViewer::Init() {
   // Init the channel list
   for (auto& reader : readers_) {
+    // let the readers drop the other channels before parsing them
+    reader->SetChannelFilter(channels_);
     auto all_channel = reader->GetChannelList();
     std::set_intersection(all_channel.begin(), all_channel.end(),
                           channels_.begin(), channels_.end(),
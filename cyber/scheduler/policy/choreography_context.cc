@@ -65,13 +65,14 @@ void ChoreographyContext::Notify() {
   cv_wq_.notify_one();
 }
 
-void ChoreographyContext::Wait() {
+bool ChoreographyContext::Wait() {
   std::unique_lock<std::mutex> lk(mtx_wq_);
-  cv_wq_.wait_for(lk, std::chrono::milliseconds(1000),
-                  [&]() { return notify > 0; });
+  bool notified = cv_wq_.wait_for(lk, std::chrono::milliseconds(1000),
+                                  [&]() { return notify > 0; });
   if (notify > 0) {
     notify--;
   }
+  return notified;
 }
 
 void ChoreographyContext::Shutdown() {
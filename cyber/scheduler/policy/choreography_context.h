@@ -42,7 +42,7 @@ class ChoreographyContext : public ProcessorContext {
 
   bool Enqueue(const std::shared_ptr<CRoutine>&);
   void Notify();
-  void Wait() override;
+  bool Wait() override;
   void Shutdown() override;
 
  private:
@@ -47,6 +47,7 @@ void ClassicContext::InitGroup(const std::string& group_name) {
   cw_ = &cv_wq_[group_name];
   notify_grp_[group_name] = 0;
   current_grp = group_name;
+  group_name_ = group_name;
 }
 
 std::shared_ptr<CRoutine> ClassicContext::NextRoutine() {
@@ -72,13 +73,15 @@ std::shared_ptr<CRoutine> ClassicContext::NextRoutine() {
   return nullptr;
 }
 
-void ClassicContext::Wait() {
+bool ClassicContext::Wait() {
   std::unique_lock<std::mutex> lk(mtx_wrapper_->Mutex());
-  cw_->Cv().wait_for(lk, std::chrono::milliseconds(1000),
-                     [&]() { return notify_grp_[current_grp] > 0; });
+  bool notified =
+      cw_->Cv().wait_for(lk, std::chrono::milliseconds(1000),
+                         [&]() { return notify_grp_[current_grp] > 0; });
   if (notify_grp_[current_grp] > 0) {
     notify_grp_[current_grp]--;
   }
+  return notified;
 }
 
 void ClassicContext::Shutdown() {
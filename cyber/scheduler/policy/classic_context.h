@@ -55,7 +55,7 @@ class ClassicContext : public ProcessorContext {
   explicit ClassicContext(const std::string &group_name);
 
   std::shared_ptr<CRoutine> NextRoutine() override;
-  void Wait() override;
+  bool Wait() override;
   void Shutdown() override;
 
   static void Notify(const std::string &group_name);
@@ -97,6 +97,7 @@ void SchedulerChoreography::CreateProcessor() {
   for (uint32_t i = 0; i < proc_num_; i++) {
     auto proc = std::make_shared<Processor>();
     auto ctx = std::make_shared<ChoreographyContext>();
+    ctx->set_group_name("choreography");
 
     proc->BindContext(ctx);
     SetSchedAffinity(proc->Thread(), choreography_cpuset_,
@@ -0,0 +1,74 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#ifndef CYBER_SCHEDULER_POLICY_SCHEDULER_WORK_STEALING_H_
+#define CYBER_SCHEDULER_POLICY_SCHEDULER_WORK_STEALING_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cyber/croutine/croutine.h"
+#include "cyber/proto/classic_conf.pb.h"
+#include "cyber/scheduler/policy/work_stealing_context.h"
+#include "cyber/scheduler/scheduler.h"
+
+namespace apollo {
+namespace cyber {
+namespace scheduler {
+
+using apollo::cyber::croutine::CRoutine;
+using apollo::cyber::proto::ClassicConf;
+using apollo::cyber::proto::ClassicTask;
+
+/**
+ * @class SchedulerWorkStealing
+ * @brief Same groups and task priorities as SchedulerClassic (it reads
+ * classic_conf), but every processor only looks at the croutines that have
+ * been woken up, in its own run queues, and steals from the processors of
+ * its group when it runs out of work.
+ */
+class SchedulerWorkStealing : public Scheduler {
+ public:
+  bool RemoveCRoutine(uint64_t crid) override;
+  bool RemoveTask(const std::string& name) override;
+  bool DispatchTask(const std::shared_ptr<CRoutine>&) override;
+
+ private:
+  friend Scheduler* Instance();
+  SchedulerWorkStealing();
+
+  void CreateProcessor();
+  bool NotifyProcessor(uint64_t crid) override;
+
+  struct Group {
+    std::vector<WorkStealingContext*> ctxs;
+    uint32_t next = 0;
+  };
+
+  std::unordered_map<std::string, ClassicTask> cr_confs_;
+  std::unordered_map<std::string, Group> groups_;
+  std::unordered_map<uint64_t, StealableTaskPtr> tasks_;
+
+  ClassicConf classic_conf_;
+};
+
+}  // namespace scheduler
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_SCHEDULER_POLICY_SCHEDULER_WORK_STEALING_H_
@@ -0,0 +1,253 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "cyber/scheduler/policy/work_stealing_context.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace apollo {
+namespace cyber {
+namespace scheduler {
+
+using apollo::cyber::croutine::RoutineState;
+
+std::shared_ptr<CRoutine> WorkStealingContext::NextRoutine() {
+  if (cyber_unlikely(stop_.load())) {
+    return nullptr;
+  }
+
+  // the processor calls us right after the previous croutine yielded
+  if (running_ != nullptr) {
+    AfterRun(running_);
+    running_ = nullptr;
+  }
+  WakeSleepers();
+
+  while (true) {
+    auto task = Pop();
+    if (task == nullptr) {
+      task = Steal();
+    }
+    if (task == nullptr) {
+      return nullptr;
+    }
+
+    uint32_t expected = StealableTask::QUEUED;
+    if (!task->state.compare_exchange_strong(expected,
+                                             StealableTask::RUNNING)) {
+      // stopped while it was queued
+      continue;
+    }
+    task->owner.store(this);
+
+    auto& cr = task->cr;
+    if (!cr->Acquire()) {
+      // only RemoveCRoutine competes with us here
+      continue;
+    }
+    if (cr->UpdateState() == RoutineState::READY) {
+      running_ = task;
+      return cr;
+    }
+    cr->Release();
+    AfterRun(task);
+  }
+}
+
+bool WorkStealingContext::Wait() {
+  std::unique_lock<std::mutex> lk(mtx_wq_);
+  idle_.store(true);
+  auto ready = [this]() {
+    if (stop_.load() || notify_ > 0 || HasReady()) {
+      return true;
+    }
+    for (auto sibling : siblings_) {
+      if (sibling->HasReady()) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(1000);
+  // a due sleeper is work as well
+  bool woken = cv_wq_.wait_until(lk, std::min(deadline, next_wake_), ready) ||
+               next_wake_ < deadline;
+  notify_ = 0;
+  idle_.store(false);
+  return woken;
+}
+
+void WorkStealingContext::Shutdown() {
+  stop_.store(true);
+  mtx_wq_.lock();
+  notify_ = std::numeric_limits<unsigned char>::max();
+  mtx_wq_.unlock();
+  cv_wq_.notify_all();
+}
+
+bool WorkStealingContext::Wake(const StealableTaskPtr& task) {
+  uint32_t state = task->state.load();
+  while (true) {
+    if (state == StealableTask::IDLE) {
+      if (task->state.compare_exchange_weak(state, StealableTask::QUEUED)) {
+        task->owner.load()->Enqueue(task);
+        return true;
+      }
+    } else if (state == StealableTask::RUNNING) {
+      if (task->state.compare_exchange_weak(state, StealableTask::NOTIFIED)) {
+        return true;
+      }
+    } else {
+      return false;
+    }
+  }
+}
+
+void WorkStealingContext::Enqueue(const StealableTaskPtr& task) {
+  Push(task);
+  // let an idle sibling take it over if we are busy running something else
+  if (!IsIdle()) {
+    auto sibling = IdleSibling();
+    if (sibling != nullptr) {
+      sibling->Notify();
+    }
+  }
+  Notify();
+}
+
+void WorkStealingContext::Notify() {
+  mtx_wq_.lock();
+  notify_++;
+  mtx_wq_.unlock();
+  cv_wq_.notify_one();
+}
+
+void WorkStealingContext::Push(const StealableTaskPtr& task) {
+  auto prio = task->cr->priority();
+  task->owner.store(this);
+  std::lock_guard<std::mutex> lk(rq_mtx_);
+  rq_[prio].emplace_back(task);
+  ready_bits_.fetch_or(1u << prio);
+}
+
+StealableTaskPtr WorkStealingContext::Pop() {
+  if (!HasReady()) {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lk(rq_mtx_);
+  auto bits = ready_bits_.load(std::memory_order_relaxed);
+  if (bits == 0) {
+    return nullptr;
+  }
+  int prio = 31 - __builtin_clz(bits);
+  auto& queue = rq_[prio];
+  auto task = std::move(queue.front());
+  queue.pop_front();
+  if (queue.empty()) {
+    ready_bits_.fetch_and(~(1u << prio));
+  }
+  return task;
+}
+
+StealableTaskPtr WorkStealingContext::Steal() {
+  auto num = static_cast<uint32_t>(siblings_.size());
+  for (uint32_t i = 0; i < num; ++i) {
+    auto sibling = siblings_[(steal_start_ + i) % num];
+    if (sibling == this || !sibling->HasReady()) {
+      continue;
+    }
+    auto task = sibling->Pop();
+    if (task != nullptr) {
+      // spread the next attempts over the other siblings
+      steal_start_ = (steal_start_ + i + 1) % num;
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+void WorkStealingContext::AfterRun(const StealableTaskPtr& task) {
+  auto cr_state = task->cr->state();
+  uint32_t state = task->state.load();
+  while (state != StealableTask::STOPPED) {
+    uint32_t next = StealableTask::IDLE;
+    if (cr_state == RoutineState::READY) {
+      next = StealableTask::QUEUED;
+    } else if (cr_state == RoutineState::SLEEP) {
+      next = StealableTask::SLEEPING;
+    } else if (state == StealableTask::NOTIFIED &&
+               cr_state != RoutineState::FINISHED) {
+      next = StealableTask::QUEUED;
+    }
+
+    if (task->state.compare_exchange_weak(state, next)) {
+      if (next == StealableTask::QUEUED) {
+        Push(task);
+      } else if (next == StealableTask::SLEEPING) {
+        sleepers_.emplace_back(task);
+        next_wake_ = std::min(next_wake_, task->cr->wake_time());
+      }
+      return;
+    }
+  }
+}
+
+void WorkStealingContext::WakeSleepers() {
+  if (sleepers_.empty()) {
+    return;
+  }
+  auto now = std::chrono::steady_clock::now();
+  if (now <= next_wake_) {
+    return;
+  }
+
+  next_wake_ = std::chrono::steady_clock::time_point::max();
+  for (auto it = sleepers_.begin(); it != sleepers_.end();) {
+    auto& task = *it;
+    if (task->state.load() == StealableTask::STOPPED) {
+      it = sleepers_.erase(it);
+      continue;
+    }
+    if (now > task->cr->wake_time()) {
+      uint32_t expected = StealableTask::SLEEPING;
+      if (task->state.compare_exchange_strong(expected,
+                                              StealableTask::QUEUED)) {
+        Push(task);
+      }
+      it = sleepers_.erase(it);
+      continue;
+    }
+    next_wake_ = std::min(next_wake_, task->cr->wake_time());
+    ++it;
+  }
+}
+
+WorkStealingContext* WorkStealingContext::IdleSibling() const {
+  for (auto sibling : siblings_) {
+    if (sibling != this && sibling->IsIdle()) {
+      return sibling;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace scheduler
+}  // namespace cyber
+}  // namespace apollo
@@ -0,0 +1,123 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#ifndef CYBER_SCHEDULER_POLICY_WORK_STEALING_CONTEXT_H_
+#define CYBER_SCHEDULER_POLICY_WORK_STEALING_CONTEXT_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "cyber/croutine/croutine.h"
+#include "cyber/scheduler/policy/classic_context.h"
+#include "cyber/scheduler/processor_context.h"
+
+namespace apollo {
+namespace cyber {
+namespace scheduler {
+
+using croutine::CRoutine;
+
+class WorkStealingContext;
+
+/**
+ * @brief A croutine as seen by the work-stealing policy. `state` makes sure a
+ * croutine sits in at most one run queue and that a wake up arriving while
+ * it runs is not lost.
+ */
+struct StealableTask {
+  enum State : uint32_t {
+    IDLE = 0,      // waiting for data, not queued anywhere
+    QUEUED,        // in the run queue of `owner`
+    RUNNING,       // resumed by a processor
+    NOTIFIED,      // woken up while running, requeued after it yields
+    SLEEPING,      // in the sleep list of `owner`
+    STOPPED,       // removed from the scheduler
+  };
+
+  explicit StealableTask(const std::shared_ptr<CRoutine>& routine)
+      : cr(routine) {}
+
+  std::shared_ptr<CRoutine> cr;
+  std::atomic<uint32_t> state = {IDLE};
+  std::atomic<WorkStealingContext*> owner = {nullptr};
+};
+
+using StealableTaskPtr = std::shared_ptr<StealableTask>;
+
+/**
+ * @class WorkStealingContext
+ * @brief Processor context keeping its own priority run queues. Only ready
+ * croutines are queued, the highest non-empty priority is found with a
+ * ready bitmap, and an idle processor steals from its siblings in the group.
+ */
+class WorkStealingContext : public ProcessorContext {
+ public:
+  std::shared_ptr<CRoutine> NextRoutine() override;
+  bool Wait() override;
+  void Shutdown() override;
+
+  /**
+   * @brief Queue a croutine that was just woken up
+   * @return false if the croutine is already queued, running or stopped
+   */
+  static bool Wake(const StealableTaskPtr& task);
+
+  void Enqueue(const StealableTaskPtr& task);
+  void Notify();
+
+  void SetSiblings(const std::vector<WorkStealingContext*>& siblings) {
+    siblings_ = siblings;
+  }
+  bool IsIdle() const { return idle_.load(); }
+  bool HasReady() const { return ready_bits_.load() != 0; }
+
+ private:
+  StealableTaskPtr Pop();
+  StealableTaskPtr Steal();
+  void Push(const StealableTaskPtr& task);
+  void AfterRun(const StealableTaskPtr& task);
+  void WakeSleepers();
+  WorkStealingContext* IdleSibling() const;
+
+  std::mutex rq_mtx_;
+  std::array<std::deque<StealableTaskPtr>, MAX_PRIO> rq_;
+  std::atomic<uint32_t> ready_bits_ = {0};
+
+  // only touched by the processor owning this context
+  std::vector<StealableTaskPtr> sleepers_;
+  std::chrono::steady_clock::time_point next_wake_ =
+      std::chrono::steady_clock::time_point::max();
+  StealableTaskPtr running_ = nullptr;
+  std::vector<WorkStealingContext*> siblings_;
+  uint32_t steal_start_ = 0;
+
+  std::mutex mtx_wq_;
+  std::condition_variable cv_wq_;
+  int notify_ = 0;
+  std::atomic<bool> idle_ = {false};
+};
+
+}  // namespace scheduler
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_SCHEDULER_POLICY_WORK_STEALING_CONTEXT_H_
@@ -25,6 +25,8 @@
 #include "cyber/common/global_data.h"
 #include "cyber/common/log.h"
 #include "cyber/croutine/croutine.h"
+#include "cyber/profiler/trace_recorder.h"
+#include "cyber/statistics/statistics.h"
 #include "cyber/time/time.h"
 
 namespace apollo {
@@ -42,17 +44,38 @@ void Processor::Run() {
   AINFO << "processor_tid: " << tid_;
   snap_shot_->processor_id.store(tid_);
 
+  auto trace_recorder = profiler::TraceRecorder::Instance();
+  bool sched_stats = statistics::Statistics::Instance()->SchedStatsEnabled();
   while (cyber_likely(running_.load())) {
     if (cyber_likely(context_ != nullptr)) {
       auto croutine = context_->NextRoutine();
       if (croutine) {
         snap_shot_->execute_start_time.store(cyber::Time::Now().ToNanosecond());
         snap_shot_->routine_name = croutine->name();
-        croutine->Resume();
+        // every resume is a span, the gaps between them are scheduler time
+        if (cyber_unlikely(trace_recorder->enabled())) {
+          uint64_t begin = profiler::TscNow();
+          Resume(croutine, sched_stats);
+          trace_recorder->Record(TraceNameId(croutine), begin,
+                                 profiler::TscNow(), 0);
+        } else {
+          Resume(croutine, sched_stats);
+        }
         croutine->Release();
       } else {
         snap_shot_->execute_start_time.store(0);
-        context_->Wait();
+        bool woken = context_->Wait();
+        if (cyber_unlikely(sched_stats)) {
+          if (group_vars_ == nullptr) {
+            group_vars_ = statistics::Statistics::Instance()->GetSchedGroupVars(
+                context_->group_name());
+          }
+          if (woken) {
+            *group_vars_->wakeups << 1;
+          } else {
+            *group_vars_->timeouts << 1;
+          }
+        }
       }
     } else {
       std::unique_lock<std::mutex> lk(mtx_ctx_);
@@ -82,6 +105,77 @@ void Processor::BindContext(const std::shared_ptr<ProcessorContext>& context) {
                  [this]() { thread_ = std::thread(&Processor::Run, this); });
 }
 
+void Processor::Resume(const std::shared_ptr<CRoutine>& croutine,
+                       bool sched_stats) {
+  if (cyber_likely(!sched_stats)) {
+    croutine->Resume();
+    return;
+  }
+
+  auto& vars = GetRoutineEntry(croutine).vars;
+  if (vars == nullptr) {
+    vars = statistics::Statistics::Instance()->GetRoutineVars(croutine->name());
+  }
+  uint64_t start = SteadyNs();
+  if (croutine->ready_time() != 0 && start > croutine->ready_time()) {
+    *vars->ready_latency << (start - croutine->ready_time()) / 1000;
+  }
+  croutine->set_ready_time(0);
+  if (croutine->last_tid() != -1 && croutine->last_tid() != tid_.load()) {
+    *vars->migrations << 1;
+  }
+  croutine->set_last_tid(tid_.load());
+
+  auto state = croutine->Resume();
+  uint64_t end = SteadyNs();
+  *vars->run_time << (end - start) / 1000;
+  *vars->resumes << 1;
+  // gave up the processor with work left, it is ready again right away
+  if (state == croutine::RoutineState::READY) {
+    *vars->yields << 1;
+    croutine->set_ready_time(end);
+  }
+}
+
+uint64_t Processor::SteadyNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+uint32_t Processor::TraceNameId(const std::shared_ptr<CRoutine>& croutine) {
+  auto& entry = GetRoutineEntry(croutine);
+  if (!entry.has_trace_name_id) {
+    entry.trace_name_id =
+        profiler::TraceRecorder::Instance()->Intern(croutine->name());
+    entry.has_trace_name_id = true;
+  }
+  return entry.trace_name_id;
+}
+
+Processor::RoutineEntry& Processor::GetRoutineEntry(
+    const std::shared_ptr<CRoutine>& croutine) {
+  auto iter = routine_entries_.find(croutine->id());
+  if (iter != routine_entries_.end()) {
+    return iter->second;
+  }
+  // removed croutines leave their entries behind, sweep them whenever the
+  // map doubled so the cost stays amortized
+  if (routine_entries_.size() >= 2 * swept_entry_num_ + 16) {
+    for (auto it = routine_entries_.begin(); it != routine_entries_.end();) {
+      if (it->second.croutine.expired()) {
+        it = routine_entries_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    swept_entry_num_ = routine_entries_.size();
+  }
+  auto& entry = routine_entries_[croutine->id()];
+  entry.croutine = croutine;
+  return entry;
+}
+
 std::atomic<pid_t>& Processor::Tid() {
   while (tid_.load() == -1) {
     cpu_relax();
@@ -23,12 +23,14 @@
 #include <mutex>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "cyber/proto/scheduler_conf.pb.h"
 
 #include "cyber/croutine/croutine.h"
 #include "cyber/scheduler/processor_context.h"
+#include "cyber/statistics/statistics.h"
 
 namespace apollo {
 namespace cyber {
@@ -56,6 +58,22 @@ class Processor {
   std::shared_ptr<Snapshot> ProcSnapshot() { return snap_shot_; }
 
  private:
+  // per croutine lookups of the profiler and the sched stats, dropped once
+  // the croutine is gone
+  struct RoutineEntry {
+    std::weak_ptr<CRoutine> croutine;
+    bool has_trace_name_id = false;
+    uint32_t trace_name_id = 0;
+    statistics::RoutineVarsPtr vars = nullptr;
+  };
+
+  // trace name of the croutine, see TraceRecorder
+  uint32_t TraceNameId(const std::shared_ptr<CRoutine>& croutine);
+  // resume and, with sched_stats of PerfConf, sample it
+  void Resume(const std::shared_ptr<CRoutine>& croutine, bool sched_stats);
+  RoutineEntry& GetRoutineEntry(const std::shared_ptr<CRoutine>& croutine);
+  static uint64_t SteadyNs();
+
   std::shared_ptr<ProcessorContext> context_;
 
   std::condition_variable cv_ctx_;
@@ -67,6 +85,12 @@ class Processor {
   std::atomic<bool> running_{false};
 
   std::shared_ptr<Snapshot> snap_shot_ = std::make_shared<Snapshot>();
+
+  // key: croutine id
+  std::unordered_map<uint64_t, RoutineEntry> routine_entries_;
+  // size after the last sweep of the removed croutines
+  size_t swept_entry_num_ = 0;
+  statistics::SchedGroupVarsPtr group_vars_ = nullptr;
 };
 
 }  // namespace scheduler
@@ -20,6 +20,7 @@
 #include <limits>
 #include <memory>
 #include <mutex>
+#include <string>
 
 #include "cyber/base/macros.h"
 #include "cyber/croutine/croutine.h"
@@ -34,10 +35,17 @@ class ProcessorContext {
  public:
   virtual void Shutdown();
   virtual std::shared_ptr<CRoutine> NextRoutine() = 0;
-  virtual void Wait() = 0;
+  // false if the wait timed out without any work showing up
+  virtual bool Wait() = 0;
+
+  const std::string& group_name() const { return group_name_; }
+  void set_group_name(const std::string& group_name) {
+    group_name_ = group_name;
+  }
 
  protected:
   std::atomic<bool> stop_{false};
+  std::string group_name_;
 };
 
 }  // namespace scheduler
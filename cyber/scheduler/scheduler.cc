@@ -36,12 +36,14 @@ using apollo::cyber::common::GlobalData;
 
 bool Scheduler::CreateTask(const RoutineFactory& factory,
                            const std::string& name) {
-  return CreateTask(factory.create_routine(), name, factory.GetDataVisitor());
+  return CreateTask(factory.create_routine(), name, factory.GetDataVisitor(),
+                    factory.stack_size());
 }
 
 bool Scheduler::CreateTask(std::function<void()>&& func,
                            const std::string& name,
-                           std::shared_ptr<DataVisitorBase> visitor) {
+                           std::shared_ptr<DataVisitorBase> visitor,
+                           size_t stack_size) {
   if (cyber_unlikely(stop_.load())) {
     ADEBUG << "scheduler is stoped, cannot create task!";
     return false;
@@ -49,7 +51,7 @@ bool Scheduler::CreateTask(std::function<void()>&& func,
 
   auto task_id = GlobalData::RegisterTaskName(name);
 
-  auto cr = std::make_shared<CRoutine>(func);
+  auto cr = std::make_shared<CRoutine>(func, stack_size);
   cr->set_id(task_id);
   cr->set_name(name);
   AINFO << "create croutine: " << name;
@@ -62,7 +62,8 @@ class Scheduler {
 
   bool CreateTask(const RoutineFactory& factory, const std::string& name);
   bool CreateTask(std::function<void()>&& func, const std::string& name,
-                  std::shared_ptr<DataVisitorBase> visitor = nullptr);
+                  std::shared_ptr<DataVisitorBase> visitor = nullptr,
+                  size_t stack_size = 0);
   bool NotifyTask(uint64_t crid);
 
   void Shutdown();
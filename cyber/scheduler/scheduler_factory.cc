@@ -29,7 +29,9 @@
 #include "cyber/common/util.h"
 #include "cyber/scheduler/policy/scheduler_choreography.h"
 #include "cyber/scheduler/policy/scheduler_classic.h"
+#include "cyber/scheduler/policy/scheduler_work_stealing.h"
 #include "cyber/scheduler/scheduler.h"
+#include "cyber/statistics/statistics.h"
 
 namespace apollo {
 namespace cyber {
@@ -52,6 +54,9 @@ Scheduler* Instance() {
     std::lock_guard<std::mutex> lock(mutex);
     obj = instance.load(std::memory_order_relaxed);
     if (obj == nullptr) {
+      if (statistics::Statistics::Instance()->SchedStatsEnabled()) {
+        croutine::CRoutine::EnableReadyTime();
+      }
       std::string policy("classic");
       std::string conf("conf/");
       conf.append(GlobalData::Instance()->ProcessGroup()).append(".conf");
@@ -67,6 +72,8 @@ Scheduler* Instance() {
         obj = new SchedulerClassic();
       } else if (!policy.compare("choreography")) {
         obj = new SchedulerChoreography();
+      } else if (!policy.compare("work_stealing")) {
+        obj = new SchedulerWorkStealing();
       } else {
         AWARN << "Invalid scheduler policy: " << policy;
         obj = new SchedulerClassic();
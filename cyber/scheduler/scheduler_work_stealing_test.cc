@@ -0,0 +1,119 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "cyber/scheduler/policy/scheduler_work_stealing.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "cyber/common/global_data.h"
+#include "cyber/cyber.h"
+#include "cyber/scheduler/policy/work_stealing_context.h"
+#include "cyber/scheduler/processor.h"
+#include "cyber/scheduler/scheduler_factory.h"
+
+namespace apollo {
+namespace cyber {
+namespace scheduler {
+
+void func() {}
+
+TEST(SchedulerWorkStealingTest, context) {
+  auto ctx0 = std::make_shared<WorkStealingContext>();
+  auto ctx1 = std::make_shared<WorkStealingContext>();
+  std::vector<WorkStealingContext*> siblings = {ctx0.get(), ctx1.get()};
+  ctx0->SetSiblings(siblings);
+  ctx1->SetSiblings(siblings);
+  EXPECT_EQ(ctx0->NextRoutine(), nullptr);
+
+  auto low = std::make_shared<StealableTask>(std::make_shared<CRoutine>(func));
+  low->cr->set_priority(1);
+  low->owner.store(ctx0.get());
+  auto high = std::make_shared<StealableTask>(std::make_shared<CRoutine>(func));
+  high->cr->set_priority(10);
+  high->owner.store(ctx0.get());
+
+  EXPECT_TRUE(WorkStealingContext::Wake(low));
+  EXPECT_TRUE(WorkStealingContext::Wake(high));
+  // already queued
+  EXPECT_FALSE(WorkStealingContext::Wake(high));
+  EXPECT_TRUE(ctx0->HasReady());
+  EXPECT_FALSE(ctx1->HasReady());
+
+  // ctx1 has nothing of its own, it steals the highest priority from ctx0
+  auto cr = ctx1->NextRoutine();
+  EXPECT_EQ(cr, high->cr);
+  EXPECT_EQ(high->state.load(), StealableTask::RUNNING);
+  EXPECT_EQ(high->owner.load(), ctx1.get());
+  // woken up while running
+  EXPECT_TRUE(WorkStealingContext::Wake(high));
+  EXPECT_EQ(high->state.load(), StealableTask::NOTIFIED);
+  cr->Release();
+
+  cr = ctx0->NextRoutine();
+  EXPECT_EQ(cr, low->cr);
+  cr->Release();
+
+  ctx0->Shutdown();
+  ctx1->Shutdown();
+  EXPECT_EQ(ctx0->NextRoutine(), nullptr);
+}
+
+TEST(SchedulerWorkStealingTest, sched_work_stealing) {
+  GlobalData::Instance()->SetProcessGroup("example_sched_work_stealing");
+  auto sched = dynamic_cast<SchedulerWorkStealing*>(scheduler::Instance());
+  ASSERT_NE(sched, nullptr);
+  cyber::Init("SchedulerWorkStealingTest");
+
+  std::shared_ptr<CRoutine> cr = std::make_shared<CRoutine>(func);
+  cr->set_id(GlobalData::RegisterTaskName("D"));
+  cr->set_name("D");
+  EXPECT_TRUE(sched->DispatchTask(cr));
+  EXPECT_EQ(cr->group_name(), "group2");
+  EXPECT_EQ(cr->priority(), 3);
+  // dispatch the same task
+  EXPECT_FALSE(sched->DispatchTask(cr));
+  EXPECT_TRUE(sched->RemoveTask("D"));
+  EXPECT_FALSE(sched->RemoveTask("D"));
+
+  std::atomic<int> count = {0};
+  EXPECT_TRUE(sched->CreateTask(
+      [&count]() {
+        while (true) {
+          count++;
+          CRoutine::GetCurrentRoutine()->HangUp();
+        }
+      },
+      "work_stealing_notify"));
+  auto crid = GlobalData::GenerateHashId("work_stealing_notify");
+  for (int i = 1; i <= 10; ++i) {
+    for (int retry = 0; retry < 100 && count.load() < i; ++retry) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(count.load(), i);
+    EXPECT_TRUE(sched->NotifyTask(crid));
+  }
+  EXPECT_TRUE(sched->RemoveTask("work_stealing_notify"));
+  sched->Shutdown();
+}
+
+}  // namespace scheduler
+}  // namespace cyber
+}  // namespace apollo
@@ -0,0 +1,206 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "cyber/statistics/latency_tracer.h"
+
+#include "cyber/binary.h"
+#include "cyber/common/global_data.h"
+#include "cyber/croutine/croutine.h"
+#include "cyber/time/time.h"
+
+namespace apollo {
+namespace cyber {
+namespace statistics {
+
+namespace {
+
+// callbacks run outside croutines, a croutine keeps its own since it may
+// resume on another thread after a yield
+thread_local const LatencyTracer::CallbackTrace* thread_trace = nullptr;
+
+const LatencyTracer::CallbackTrace* CurrentTrace() {
+  auto routine = croutine::CRoutine::GetCurrentRoutine();
+  if (routine != nullptr) {
+    return static_cast<const LatencyTracer::CallbackTrace*>(routine->trace());
+  }
+  return thread_trace;
+}
+
+void SetCurrentTrace(const LatencyTracer::CallbackTrace* trace) {
+  auto routine = croutine::CRoutine::GetCurrentRoutine();
+  if (routine != nullptr) {
+    routine->set_trace(trace);
+  } else {
+    thread_trace = trace;
+  }
+}
+
+void Sample(const std::shared_ptr<::bvar::LatencyRecorder>& recorder,
+            uint64_t begin, uint64_t end) {
+  if (begin == 0 || end < begin) {
+    return;
+  }
+  // microsecond like the other latency vars
+  *recorder << static_cast<int64_t>((end - begin) / 1000);
+}
+
+}  // namespace
+
+LatencyTracer::LatencyTracer() {
+  auto& global_conf = common::GlobalData::Instance()->Config();
+  if (global_conf.has_perf_conf()) {
+    enabled_ = global_conf.perf_conf().latency_trace();
+  }
+}
+
+const char* LatencyTracer::HopName(Hop hop) {
+  switch (hop) {
+    case TRANSPORT:
+      return "transport";
+    case DISPATCH:
+      return "dispatch";
+    case WAIT:
+      return "wait";
+    case CALLBACK:
+      return "callback";
+    case END_TO_END:
+      return "end_to_end";
+    default:
+      return "unknown";
+  }
+}
+
+uint64_t LatencyTracer::OriginTime(uint64_t send_time) const {
+  if (!enabled_) {
+    return 0;
+  }
+  auto current = CurrentTrace();
+  if (current != nullptr && current->origin_time != 0) {
+    return current->origin_time;
+  }
+  return send_time;
+}
+
+void LatencyTracer::OnDispatch(uint64_t channel_id,
+                               const std::string& channel_name,
+                               const void* msg, uint64_t send_time,
+                               uint64_t recv_time, uint64_t dispatch_time,
+                               uint64_t origin_time) {
+  if (!enabled_) {
+    return;
+  }
+  auto channel = GetOrCreateChannel(channel_id, channel_name);
+  std::lock_guard<std::mutex> lock(channel->mutex);
+  auto& pending = channel->pending[channel->next];
+  channel->next = (channel->next + 1) % kPendingNum;
+  pending.msg = msg;
+  pending.send_time = send_time;
+  pending.recv_time = recv_time;
+  pending.dispatch_time = dispatch_time;
+  // untraced writers, e.g. over rtps, start a chain of their own
+  pending.origin_time = origin_time != 0 ? origin_time : send_time;
+}
+
+void LatencyTracer::OnCallbackStart(uint64_t channel_id, const void* msg,
+                                    CallbackTrace* trace) {
+  if (!enabled_) {
+    return;
+  }
+  trace->channel_id = channel_id;
+  trace->start_time = Time::Now().ToNanosecond();
+  auto channel = GetChannel(channel_id);
+  if (channel != nullptr) {
+    std::lock_guard<std::mutex> lock(channel->mutex);
+    // newest first, the address of a released message may be reused
+    for (uint32_t i = 1; i <= kPendingNum; ++i) {
+      auto& pending =
+          channel->pending[(channel->next + kPendingNum - i) % kPendingNum];
+      if (pending.msg == msg) {
+        trace->send_time = pending.send_time;
+        trace->recv_time = pending.recv_time;
+        trace->dispatch_time = pending.dispatch_time;
+        trace->origin_time = pending.origin_time;
+        break;
+      }
+    }
+  }
+  trace->previous = CurrentTrace();
+  SetCurrentTrace(trace);
+}
+
+void LatencyTracer::OnCallbackEnd(CallbackTrace* trace) {
+  if (!enabled_) {
+    return;
+  }
+  SetCurrentTrace(trace->previous);
+  auto channel = GetChannel(trace->channel_id);
+  if (channel == nullptr) {
+    return;
+  }
+  uint64_t end_time = Time::Now().ToNanosecond();
+  Sample(channel->hops[TRANSPORT], trace->send_time, trace->recv_time);
+  Sample(channel->hops[DISPATCH], trace->recv_time, trace->dispatch_time);
+  Sample(channel->hops[WAIT], trace->dispatch_time, trace->start_time);
+  Sample(channel->hops[CALLBACK], trace->start_time, end_time);
+  Sample(channel->hops[END_TO_END], trace->origin_time, end_time);
+}
+
+void LatencyTracer::Report(proto::LatencyTrace* trace) {
+  trace->set_timestamp(Time::Now().ToNanosecond());
+  trace->set_process_name(binary::GetName());
+  trace->set_pid(common::GlobalData::Instance()->ProcessId());
+  std::lock_guard<std::mutex> lock(channels_mutex_);
+  for (auto& item : channels_) {
+    auto channel_latency = trace->add_channels();
+    channel_latency->set_channel_name(item.second->channel_name);
+    for (int i = 0; i < HOP_NUM; ++i) {
+      auto& recorder = item.second->hops[i];
+      auto hop = channel_latency->add_hops();
+      hop->set_hop(HopName(static_cast<Hop>(i)));
+      hop->set_count(recorder->count());
+      hop->set_avg(recorder->latency());
+      hop->set_p99(recorder->latency_percentile(0.99));
+      hop->set_max(recorder->max_latency());
+    }
+  }
+}
+
+std::shared_ptr<LatencyTracer::ChannelTrace> LatencyTracer::GetChannel(
+    uint64_t channel_id) {
+  std::lock_guard<std::mutex> lock(channels_mutex_);
+  auto iter = channels_.find(channel_id);
+  return iter == channels_.end() ? nullptr : iter->second;
+}
+
+std::shared_ptr<LatencyTracer::ChannelTrace> LatencyTracer::GetOrCreateChannel(
+    uint64_t channel_id, const std::string& channel_name) {
+  std::lock_guard<std::mutex> lock(channels_mutex_);
+  auto& channel = channels_[channel_id];
+  if (channel == nullptr) {
+    channel = std::make_shared<ChannelTrace>();
+    channel->channel_name = channel_name;
+    for (int i = 0; i < HOP_NUM; ++i) {
+      channel->hops[i] = std::make_shared<::bvar::LatencyRecorder>(
+          channel_name,
+          std::string("trace-") + HopName(static_cast<Hop>(i)));
+    }
+  }
+  return channel;
+}
+
+}  // namespace statistics
+}  // namespace cyber
+}  // namespace apollo
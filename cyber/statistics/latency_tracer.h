@@ -0,0 +1,125 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#ifndef CYBER_STATISTICS_LATENCY_TRACER_H_
+#define CYBER_STATISTICS_LATENCY_TRACER_H_
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "cyber/proto/latency_trace.pb.h"
+
+#include "cyber/common/macros.h"
+#include "third_party/var/bvar/bvar.h"
+
+namespace apollo {
+namespace cyber {
+namespace statistics {
+
+/**
+ * @class LatencyTracer
+ * @brief Per channel latency of every hop of a message, in trace mode
+ * (latency_trace of PerfConf) only.
+ *
+ * The transmitter stamps the send time and the origin time, the receiver the
+ * receive time, the ReceiverManager the dispatch time, and the Reader callback
+ * its start and end. A message sent from a callback inherits the origin of the
+ * message handled, so the end_to_end hop of e.g. the control channel covers
+ * the whole chain from the sensor driver.
+ */
+class LatencyTracer {
+ public:
+  enum Hop {
+    TRANSPORT = 0,
+    DISPATCH,
+    WAIT,
+    CALLBACK,
+    END_TO_END,
+    HOP_NUM,
+  };
+
+  struct CallbackTrace {
+    uint64_t channel_id = 0;
+    uint64_t send_time = 0;
+    uint64_t recv_time = 0;
+    uint64_t dispatch_time = 0;
+    uint64_t origin_time = 0;
+    uint64_t start_time = 0;
+    // the callback running before in this croutine or thread, if nested
+    const CallbackTrace* previous = nullptr;
+  };
+
+  static const char* HopName(Hop hop);
+
+  bool enabled() const { return enabled_; }
+
+  // origin time of a message sent now, 0 out of trace mode
+  uint64_t OriginTime(uint64_t send_time) const;
+
+  // nanosecond stamps of a message handed to the data dispatcher
+  void OnDispatch(uint64_t channel_id, const std::string& channel_name,
+                  const void* msg, uint64_t send_time, uint64_t recv_time,
+                  uint64_t dispatch_time, uint64_t origin_time);
+
+  // Around the callback of a reader. The trace lives on the caller stack and
+  // is kept on the running croutine, so it follows the croutine to whichever
+  // processor resumes it after a yield.
+  void OnCallbackStart(uint64_t channel_id, const void* msg,
+                       CallbackTrace* trace);
+  void OnCallbackEnd(CallbackTrace* trace);
+
+  void Report(proto::LatencyTrace* trace);
+
+ private:
+  static const uint32_t kPendingNum = 64;
+
+  struct Pending {
+    const void* msg = nullptr;
+    uint64_t send_time = 0;
+    uint64_t recv_time = 0;
+    uint64_t dispatch_time = 0;
+    uint64_t origin_time = 0;
+  };
+
+  struct ChannelTrace {
+    std::string channel_name;
+    std::mutex mutex;
+    // messages dispatched lately, looked up by address
+    std::array<Pending, kPendingNum> pending;
+    uint32_t next = 0;
+    std::array<std::shared_ptr<::bvar::LatencyRecorder>, HOP_NUM> hops;
+  };
+
+  std::shared_ptr<ChannelTrace> GetChannel(uint64_t channel_id);
+  std::shared_ptr<ChannelTrace> GetOrCreateChannel(
+      uint64_t channel_id, const std::string& channel_name);
+
+  bool enabled_ = false;
+  std::mutex channels_mutex_;
+  std::unordered_map<uint64_t, std::shared_ptr<ChannelTrace>> channels_;
+
+  DECLARE_SINGLETON(LatencyTracer)
+};
+
+}  // namespace statistics
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_STATISTICS_LATENCY_TRACER_H_
@@ -16,11 +16,80 @@
 
 #include "cyber/statistics/statistics.h"
 
+#include "cyber/common/global_data.h"
+
 namespace apollo {
 namespace cyber {
 namespace statistics {
 
-Statistics::Statistics() {}
+Statistics::Statistics() {
+  auto& global_conf = common::GlobalData::Instance()->Config();
+  if (global_conf.has_perf_conf()) {
+    sched_stats_ = global_conf.perf_conf().sched_stats();
+  }
+}
+
+RoutineVarsPtr Statistics::GetRoutineVars(const std::string& routine_name) {
+  std::lock_guard<std::mutex> lock(sched_mutex_);
+  auto& vars = routine_vars_[routine_name];
+  if (vars == nullptr) {
+    vars = std::make_shared<RoutineVars>();
+    vars->name = routine_name;
+    vars->ready_latency = std::make_shared<::bvar::LatencyRecorder>(
+        routine_name, "sched-ready");
+    vars->run_time =
+        std::make_shared<::bvar::LatencyRecorder>(routine_name, "sched-run");
+    vars->resumes = std::make_shared<::bvar::Adder<uint64_t>>(
+        routine_name, "sched-resumes");
+    vars->yields = std::make_shared<::bvar::Adder<uint64_t>>(
+        routine_name, "sched-yields");
+    vars->migrations = std::make_shared<::bvar::Adder<uint64_t>>(
+        routine_name, "sched-migrations");
+  }
+  return vars;
+}
+
+SchedGroupVarsPtr Statistics::GetSchedGroupVars(
+    const std::string& group_name) {
+  std::lock_guard<std::mutex> lock(sched_mutex_);
+  auto& vars = sched_group_vars_[group_name];
+  if (vars == nullptr) {
+    vars = std::make_shared<SchedGroupVars>();
+    vars->name = group_name;
+    vars->wakeups = std::make_shared<::bvar::Adder<uint64_t>>(
+        group_name, "sched-wait-wakeups");
+    vars->timeouts = std::make_shared<::bvar::Adder<uint64_t>>(
+        group_name, "sched-wait-timeouts");
+  }
+  return vars;
+}
+
+void Statistics::ReportSched(proto::SchedulerStats* stats) {
+  stats->set_timestamp(Time::Now().ToNanosecond());
+  stats->set_pid(common::GlobalData::Instance()->ProcessId());
+  std::lock_guard<std::mutex> lock(sched_mutex_);
+  for (auto& item : routine_vars_) {
+    auto& vars = item.second;
+    auto routine = stats->add_routines();
+    routine->set_name(vars->name);
+    routine->set_resumes(vars->resumes->get_value());
+    routine->set_yields(vars->yields->get_value());
+    routine->set_migrations(vars->migrations->get_value());
+    routine->set_ready_latency_avg(vars->ready_latency->latency());
+    routine->set_ready_latency_p99(
+        vars->ready_latency->latency_percentile(0.99));
+    routine->set_ready_latency_max(vars->ready_latency->max_latency());
+    routine->set_run_time_avg(vars->run_time->latency());
+    routine->set_run_time_p99(vars->run_time->latency_percentile(0.99));
+    routine->set_run_time_max(vars->run_time->max_latency());
+  }
+  for (auto& item : sched_group_vars_) {
+    auto group = stats->add_groups();
+    group->set_name(item.second->name);
+    group->set_wait_wakeups(item.second->wakeups->get_value());
+    group->set_wait_timeouts(item.second->timeouts->get_value());
+  }
+}
 
 bool Statistics::RegisterChanVar(const proto::RoleAttributes& role_attr) {
   if (latency_map_.find(GetProcLatencyKey(role_attr)) != latency_map_.end()) {
@@ -66,6 +135,10 @@ bool Statistics::RegisterChanVar(const proto::RoleAttributes& role_attr) {
           std::make_shared<::bvar::Adder<int32_t>>(
                   role_attr.node_name() +
                   "-" + role_attr.channel_name() + "-recv-msgs-nums");
+    adder_map_[GetTotalDropStatusKey(role_attr)] =
+          std::make_shared<::bvar::Adder<int32_t>>(
+                  role_attr.node_name() +
+                  "-" + role_attr.channel_name() + "-drop-msgs-nums");
   }
   return true;
 }
@@ -124,6 +197,15 @@ AdderVarPtr Statistics::GetAdderVar(
   return v->second;
 }
 
+AdderVarPtr Statistics::GetDropAdderVar(
+                      const proto::RoleAttributes& role_attr) {
+  auto v = adder_map_.find(GetTotalDropStatusKey(role_attr));
+  if (v == adder_map_.end()) {
+    return nullptr;
+  }
+  return v->second;
+}
+
 
 }  // namespace statistics
 }  // namespace cyber
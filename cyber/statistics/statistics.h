@@ -30,6 +30,7 @@
 #include "cyber/base/macros.h"
 #include "cyber/common/log.h"
 #include "cyber/proto/role_attributes.pb.h"
+#include "cyber/proto/scheduler_stats.pb.h"
 #include "cyber/common/macros.h"
 #include "cyber/time/time.h"
 #include "third_party/var/bvar/bvar.h"
@@ -50,6 +51,31 @@ struct SpanHandler {
   uint64_t min_ns = 0;
 };
 
+// Scheduling of one croutine, sampled by scheduler::Processor. Latencies are
+// in microsecond.
+struct RoutineVars {
+  std::string name;
+  // from ready to run until picked up by a processor
+  LatencyVarPtr ready_latency;
+  // of one resume
+  LatencyVarPtr run_time;
+  std::shared_ptr<::bvar::Adder<uint64_t>> resumes;
+  // resumes that gave up the processor while still ready
+  std::shared_ptr<::bvar::Adder<uint64_t>> yields;
+  // resumes on another processor than the previous one
+  std::shared_ptr<::bvar::Adder<uint64_t>> migrations;
+};
+using RoutineVarsPtr = std::shared_ptr<RoutineVars>;
+
+// idle waits of the processors of one scheduler group
+struct SchedGroupVars {
+  std::string name;
+  std::shared_ptr<::bvar::Adder<uint64_t>> wakeups;
+  // waits that ran into their timeout without a notification
+  std::shared_ptr<::bvar::Adder<uint64_t>> timeouts;
+};
+using SchedGroupVarsPtr = std::shared_ptr<SchedGroupVars>;
+
 static const std::string TIMER_COMPONENT_CHAN_NAME = "_timer_component";    // NOLINT
 
 class Statistics {
@@ -65,6 +91,12 @@ class Statistics {
     disable_chan_var_ = true;
   }
 
+  // sched_stats of PerfConf
+  bool SchedStatsEnabled() const { return sched_stats_; }
+  RoutineVarsPtr GetRoutineVars(const std::string& routine_name);
+  SchedGroupVarsPtr GetSchedGroupVars(const std::string& group_name);
+  void ReportSched(proto::SchedulerStats* stats);
+
   template <typename SampleT>
   std::shared_ptr<::bvar::Adder<SampleT>> CreateAdder(
                         const proto::RoleAttributes& role_attr) {
@@ -197,6 +229,23 @@ class Statistics {
     return true;
   }
 
+  // messages a reader missed, e.g. shm blocks overwritten before read
+  bool AddDropCount(const proto::RoleAttributes& role_attr, int drop_msg_val) {
+    if (disable_chan_var_) {
+      return true;
+    }
+    if (role_attr.channel_name() == TIMER_COMPONENT_CHAN_NAME) {
+      return true;
+    }
+
+    auto var_ptr = GetDropAdderVar(role_attr);
+    if (var_ptr == nullptr) {
+      return true;
+    }
+    (*var_ptr) << drop_msg_val;
+    return true;
+  }
+
  private:
   LatencyVarPtr GetChanProcVar(const proto::RoleAttributes& role_attr);
 
@@ -208,6 +257,8 @@ class Statistics {
 
   AdderVarPtr GetAdderVar(const proto::RoleAttributes& role_attr);
 
+  AdderVarPtr GetDropAdderVar(const proto::RoleAttributes& role_attr);
+
   StatusVarPtr GetTotalMsgsStatusVar(const proto::RoleAttributes& role_attr);
 
   inline uint64_t GetMicroTimeNow() const noexcept;
@@ -244,6 +295,11 @@ class Statistics {
     return role_attr.node_name() + "-" + role_attr.channel_name() + "recv-msgs";
   }
 
+  inline const std::string GetTotalDropStatusKey(
+                      const proto::RoleAttributes& role_attr) {
+    return role_attr.node_name() + "-" + role_attr.channel_name() + "drop-msgs";
+  }
+
   std::unordered_map<std::string, LatencyVarPtr> latency_map_;
   std::unordered_map<std::string, StatusVarPtr> status_map_;
   std::unordered_map<std::string, AdderVarPtr> adder_map_;
@@ -253,6 +309,11 @@ class Statistics {
   bool first_recv_ = true;
   bool disable_chan_var_ = false;
 
+  bool sched_stats_ = false;
+  std::mutex sched_mutex_;
+  std::unordered_map<std::string, RoutineVarsPtr> routine_vars_;
+  std::unordered_map<std::string, SchedGroupVarsPtr> sched_group_vars_;
+
   DECLARE_SINGLETON(Statistics)
 };
 
@@ -48,7 +48,6 @@ struct TimerOption {
 
   /**
    * @brief The period of the timer, unit is ms
-   * max: 512 * 64
    * min: 1
    */
   uint32_t period = 0;
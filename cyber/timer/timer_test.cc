@@ -18,6 +18,8 @@
 
 #include "cyber/timer/timer.h"
 
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <utility>
 
@@ -79,6 +81,33 @@ TEST(TimerTest, start_stop) {
   }
 }
 
+TEST(TimerTest, long_period) {
+  // past the 256 ticks (ms) of the lowest wheel level, it is cascaded down
+  // on the way
+  std::atomic<int> count = {0};
+  std::atomic<int64_t> fired_ms = {0};
+  auto start = std::chrono::steady_clock::now();
+  Timer timer(
+      300,
+      [&count, &fired_ms, start] {
+        fired_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+        count++;
+      },
+      true);
+  timer.Start();
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  EXPECT_EQ(0, count.load());
+  std::this_thread::sleep_for(std::chrono::milliseconds(600));
+  EXPECT_EQ(1, count.load());
+  // within scheduling delay, a cascade one level 1 slot off would be 256 ms
+  // late
+  EXPECT_GE(fired_ms.load(), 300);
+  EXPECT_LT(fired_ms.load(), 300 + 256);
+  timer.Stop();
+}
+
 TEST(TimerTest, sim_mode) {
   auto count = 0;
 
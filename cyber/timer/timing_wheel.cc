@@ -16,13 +16,55 @@
 
 #include "cyber/timer/timing_wheel.h"
 
-#include <cmath>
+#include <time.h>
 
+#include <cerrno>
+#include <utility>
+
+#include "cyber/common/global_data.h"
 #include "cyber/task/task.h"
 
 namespace apollo {
 namespace cyber {
 
+namespace {
+
+constexpr uint64_t kSlotMask = TIMER_WHEEL_SIZE - 1;
+// ticks covered by the whole wheel
+constexpr uint64_t kWheelSpan =
+    1ULL << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS);
+
+uint64_t MonoTimeNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+void SleepUntil(uint64_t deadline_ns) {
+  struct timespec ts;
+  ts.tv_sec = static_cast<time_t>(deadline_ns / 1000000000ULL);
+  ts.tv_nsec = static_cast<long>(deadline_ns % 1000000000ULL);  // NOLINT
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) ==
+         EINTR) {
+  }
+}
+
+}  // namespace
+
+TimingWheel::TimingWheel() {
+  uint64_t resolution_us = proto::TimerConf().resolution_us();
+  auto& global_conf = common::GlobalData::Instance()->Config();
+  if (global_conf.has_timer_conf()) {
+    resolution_us = global_conf.timer_conf().resolution_us();
+  }
+  if (resolution_us < TIMER_MIN_RESOLUTION_US) {
+    AWARN << "Timer resolution " << resolution_us << "us is raised to "
+          << TIMER_MIN_RESOLUTION_US << "us";
+    resolution_us = TIMER_MIN_RESOLUTION_US;
+  }
+  resolution_ns_ = resolution_us * 1000;
+}
+
 void TimingWheel::Start() {
   std::lock_guard<std::mutex> lock(running_mutex_);
   if (!running_) {
@@ -37,111 +79,164 @@ void TimingWheel::Shutdown() {
   std::lock_guard<std::mutex> lock(running_mutex_);
   if (running_) {
     running_ = false;
+    {
+      std::lock_guard<std::mutex> idle_lock(idle_mutex_);
+      idle_cv_.notify_one();
+    }
     if (tick_thread_.joinable()) {
       tick_thread_.join();
     }
+    Clear();
   }
 }
 
-void TimingWheel::Tick() {
-  auto& bucket = work_wheel_[current_work_wheel_index_];
-  {
-    std::lock_guard<std::mutex> lock(bucket.mutex());
-    auto ite = bucket.task_list().begin();
-    while (ite != bucket.task_list().end()) {
-      auto task = ite->lock();
-      if (task) {
-        ADEBUG << "index: " << current_work_wheel_index_
-               << " timer id: " << task->timer_id_;
-        auto* callback =
-            reinterpret_cast<std::function<void()>*>(&(task->callback));
-        cyber::Async([this, callback] {
-          if (this->running_) {
-            (*callback)();
-          }
-        });
+void TimingWheel::AddTask(const std::shared_ptr<TimerTask>& task) {
+  if (!running_) {
+    Start();
+  }
+  auto pending = new PendingTask();
+  pending->task = task;
+  pending->deadline_ns = task->deadline_ns;
+  pending->next = pending_.load(std::memory_order_relaxed);
+  while (!pending_.compare_exchange_weak(pending->next, pending)) {
+  }
+  // the lock is only taken to wake up the tick thread when it has nothing to
+  // do, a running wheel picks the task up at its next tick
+  if (idle_.load()) {
+    std::lock_guard<std::mutex> lock(idle_mutex_);
+    idle_cv_.notify_one();
+  }
+}
+
+void TimingWheel::TickFunc() {
+  start_ns_ = MonoTimeNs();
+  current_tick_ = 0;
+  while (running_) {
+    if (task_num_ == 0 && pending_.load() == nullptr) {
+      if (!WaitForTask()) {
+        break;
       }
-      ite = bucket.task_list().erase(ite);
+      // nothing is in the wheel, the ticks that went by need no processing
+      current_tick_ = (MonoTimeNs() - start_ns_) / resolution_ns_;
     }
+    // absolute deadlines, a late tick does not delay the following ones
+    SleepUntil(start_ns_ + (current_tick_ + 1) * resolution_ns_);
+    ++current_tick_;
+    tick_count_.fetch_add(1, std::memory_order_relaxed);
+    Tick();
   }
 }
 
-void TimingWheel::AddTask(const std::shared_ptr<TimerTask>& task) {
-  AddTask(task, current_work_wheel_index_);
+bool TimingWheel::WaitForTask() {
+  std::unique_lock<std::mutex> lock(idle_mutex_);
+  idle_.store(true);
+  idle_cv_.wait(lock,
+                [this] { return pending_.load() != nullptr || !running_; });
+  idle_.store(false);
+  return running_;
 }
 
-void TimingWheel::AddTask(const std::shared_ptr<TimerTask>& task,
-                          const uint64_t current_work_wheel_index) {
-  if (!running_) {
-    Start();
+void TimingWheel::Tick() {
+  Cascade();
+  DrainPending();
+  auto& bucket = wheel_[0][current_tick_ & kSlotMask];
+  if (bucket.empty()) {
+    return;
   }
-  auto work_wheel_index = current_work_wheel_index +
-                          static_cast<uint64_t>(std::ceil(
-                              static_cast<double>(task->next_fire_duration_ms) /
-                              TIMER_RESOLUTION_MS));
-  if (work_wheel_index >= WORK_WHEEL_SIZE) {
-    auto real_work_wheel_index = GetWorkWheelIndex(work_wheel_index);
-    task->remainder_interval_ms = real_work_wheel_index;
-    auto assistant_ticks = work_wheel_index / WORK_WHEEL_SIZE;
-    if (assistant_ticks == 1 &&
-        real_work_wheel_index < current_work_wheel_index_) {
-      work_wheel_[real_work_wheel_index].AddTask(task);
-      ADEBUG << "add task to work wheel. index :" << real_work_wheel_index;
-    } else {
-      auto assistant_wheel_index = 0;
-      {
-        std::lock_guard<std::mutex> lock(current_assistant_wheel_index_mutex_);
-        assistant_wheel_index = GetAssistantWheelIndex(
-            current_assistant_wheel_index_ + assistant_ticks);
-        assistant_wheel_[assistant_wheel_index].AddTask(task);
-      }
-      ADEBUG << "add task to assistant wheel. index : "
-             << assistant_wheel_index;
-    }
-  } else {
-    work_wheel_[work_wheel_index].AddTask(task);
-    ADEBUG << "add task [" << task->timer_id_
-           << "] to work wheel. index :" << work_wheel_index;
+  std::vector<Entry> entries;
+  entries.swap(bucket);
+  task_num_ -= entries.size();
+  for (auto& entry : entries) {
+    Place(std::move(entry));
   }
 }
 
-void TimingWheel::Cascade(const uint64_t assistant_wheel_index) {
-  auto& bucket = assistant_wheel_[assistant_wheel_index];
-  std::lock_guard<std::mutex> lock(bucket.mutex());
-  auto ite = bucket.task_list().begin();
-  while (ite != bucket.task_list().end()) {
-    auto task = ite->lock();
-    if (task) {
-      work_wheel_[task->remainder_interval_ms].AddTask(task);
+void TimingWheel::Cascade() {
+  // from the top, so tasks moved down into a slot due now are still handled
+  for (uint64_t level = TIMER_WHEEL_LEVELS - 1; level > 0; --level) {
+    const uint64_t shift = TIMER_WHEEL_SLOT_BITS * level;
+    if ((current_tick_ & ((1ULL << shift) - 1)) != 0) {
+      continue;
+    }
+    auto& bucket = wheel_[level][(current_tick_ >> shift) & kSlotMask];
+    if (bucket.empty()) {
+      continue;
+    }
+    std::vector<Entry> entries;
+    entries.swap(bucket);
+    task_num_ -= entries.size();
+    for (auto& entry : entries) {
+      Place(std::move(entry));
     }
-    ite = bucket.task_list().erase(ite);
   }
 }
 
-void TimingWheel::TickFunc() {
-  Rate rate(TIMER_RESOLUTION_MS * 1000000);  // ms to ns
-  while (running_) {
-    Tick();
-    // AINFO_EVERY(1000) << "Tick " << TickCount();
-    tick_count_++;
-    rate.Sleep();
-    {
-      std::lock_guard<std::mutex> lock(current_work_wheel_index_mutex_);
-      current_work_wheel_index_ =
-          GetWorkWheelIndex(current_work_wheel_index_ + 1);
-    }
-    if (current_work_wheel_index_ == 0) {
-      {
-        std::lock_guard<std::mutex> lock(current_assistant_wheel_index_mutex_);
-        current_assistant_wheel_index_ =
-            GetAssistantWheelIndex(current_assistant_wheel_index_ + 1);
-      }
-      Cascade(current_assistant_wheel_index_);
+void TimingWheel::DrainPending() {
+  auto pending = pending_.exchange(nullptr, std::memory_order_acquire);
+  while (pending != nullptr) {
+    Entry entry;
+    entry.task = std::move(pending->task);
+    entry.deadline_tick = DeadlineTick(pending->deadline_ns);
+    Place(std::move(entry));
+    auto next = pending->next;
+    delete pending;
+    pending = next;
+  }
+}
+
+void TimingWheel::Place(Entry&& entry) {
+  if (entry.deadline_tick <= current_tick_) {
+    Fire(entry.task);
+    return;
+  }
+  const uint64_t delta = entry.deadline_tick - current_tick_;
+  uint64_t level = 0;
+  while (level + 1 < TIMER_WHEEL_LEVELS &&
+         delta >= (1ULL << (TIMER_WHEEL_SLOT_BITS * (level + 1)))) {
+    ++level;
+  }
+  // beyond the wheel, parked in the last top slot and placed again from there
+  uint64_t tick = delta < kWheelSpan ? entry.deadline_tick
+                                     : current_tick_ + kWheelSpan - 1;
+  auto slot = (tick >> (TIMER_WHEEL_SLOT_BITS * level)) & kSlotMask;
+  ADEBUG << "add task to wheel level " << level << " slot " << slot;
+  wheel_[level][slot].emplace_back(std::move(entry));
+  ++task_num_;
+}
+
+void TimingWheel::Fire(const std::weak_ptr<TimerTask>& task) {
+  if (task.expired()) {
+    return;
+  }
+  cyber::Async([this, task] {
+    auto timer_task = task.lock();
+    if (timer_task && this->running_) {
+      timer_task->callback();
     }
+  });
+}
+
+uint64_t TimingWheel::DeadlineTick(uint64_t deadline_ns) const {
+  if (deadline_ns <= start_ns_) {
+    return 0;
   }
+  return (deadline_ns - start_ns_ + resolution_ns_ - 1) / resolution_ns_;
 }
 
-TimingWheel::TimingWheel() {}
+void TimingWheel::Clear() {
+  auto pending = pending_.exchange(nullptr);
+  while (pending != nullptr) {
+    auto next = pending->next;
+    delete pending;
+    pending = next;
+  }
+  for (auto& level : wheel_) {
+    for (auto& bucket : level) {
+      bucket.clear();
+    }
+  }
+  task_num_ = 0;
+}
 
 }  // namespace cyber
 }  // namespace apollo
@@ -17,28 +17,36 @@
 #ifndef CYBER_TIMER_TIMING_WHEEL_H_
 #define CYBER_TIMER_TIMING_WHEEL_H_
 
-#include <future>
-#include <list>
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #include "cyber/common/log.h"
 #include "cyber/common/macros.h"
 #include "cyber/scheduler/scheduler_factory.h"
 #include "cyber/time/rate.h"
-#include "cyber/timer/timer_bucket.h"
+#include "cyber/timer/timer_task.h"
 
 namespace apollo {
 namespace cyber {
 
-struct TimerTask;
-
-static const uint64_t WORK_WHEEL_SIZE = 512;
-static const uint64_t ASSISTANT_WHEEL_SIZE = 64;
-static const uint64_t TIMER_RESOLUTION_MS = 2;
-static const uint64_t TIMER_MAX_INTERVAL_MS =
-    WORK_WHEEL_SIZE * ASSISTANT_WHEEL_SIZE * TIMER_RESOLUTION_MS;
-
+static const uint64_t TIMER_WHEEL_LEVELS = 4;
+static const uint64_t TIMER_WHEEL_SLOT_BITS = 8;
+static const uint64_t TIMER_WHEEL_SIZE = 1ULL << TIMER_WHEEL_SLOT_BITS;
+static const uint64_t TIMER_MIN_RESOLUTION_US = 100;
+
+/**
+ * @class TimingWheel
+ * @brief Hierarchical timing wheel driven by one tick thread sleeping until
+ * absolute deadlines. The resolution comes from timer_conf, every level
+ * covers TIMER_WHEEL_SIZE times the span of the one below and tasks due
+ * further than the top level are parked and placed again when it turns, so
+ * intervals are not capped. Only the tick thread touches the wheel, tasks are
+ * handed over through a lock free stack.
+ */
 class TimingWheel {
  public:
   ~TimingWheel() {
@@ -51,37 +59,56 @@ class TimingWheel {
 
   void Shutdown();
 
-  void Tick();
-
+  /**
+   * @brief Fire the task once its deadline_ns has been reached, lock free and
+   * callable from any thread
+   */
   void AddTask(const std::shared_ptr<TimerTask>& task);
 
-  void AddTask(const std::shared_ptr<TimerTask>& task,
-               const uint64_t current_work_wheel_index);
-
-  void Cascade(const uint64_t assistant_wheel_index);
-
-  void TickFunc();
+  inline uint64_t TickCount() const { return tick_count_.load(); }
 
-  inline uint64_t TickCount() const { return tick_count_; }
+  inline uint64_t ResolutionNs() const { return resolution_ns_; }
 
  private:
-  inline uint64_t GetWorkWheelIndex(const uint64_t index) {
-    return index & (WORK_WHEEL_SIZE - 1);
-  }
-  inline uint64_t GetAssistantWheelIndex(const uint64_t index) {
-    return index & (ASSISTANT_WHEEL_SIZE - 1);
-  }
+  struct PendingTask {
+    std::weak_ptr<TimerTask> task;
+    uint64_t deadline_ns = 0;
+    PendingTask* next = nullptr;
+  };
 
-  bool running_ = false;
-  uint64_t tick_count_ = 0;
+  struct Entry {
+    std::weak_ptr<TimerTask> task;
+    uint64_t deadline_tick = 0;
+  };
+
+  void TickFunc();
+  void Tick();
+  void Cascade();
+  void DrainPending();
+  void Place(Entry&& entry);
+  void Fire(const std::weak_ptr<TimerTask>& task);
+  bool WaitForTask();
+  void Clear();
+  uint64_t DeadlineTick(uint64_t deadline_ns) const;
+
+  std::atomic<bool> running_ = {false};
   std::mutex running_mutex_;
-  TimerBucket work_wheel_[WORK_WHEEL_SIZE];
-  TimerBucket assistant_wheel_[ASSISTANT_WHEEL_SIZE];
-  uint64_t current_work_wheel_index_ = 0;
-  std::mutex current_work_wheel_index_mutex_;
-  uint64_t current_assistant_wheel_index_ = 0;
-  std::mutex current_assistant_wheel_index_mutex_;
   std::thread tick_thread_;
+  uint64_t resolution_ns_ = 0;
+  std::atomic<uint64_t> tick_count_ = {0};
+
+  // only touched by the tick thread
+  uint64_t start_ns_ = 0;
+  uint64_t current_tick_ = 0;
+  uint64_t task_num_ = 0;
+  std::vector<Entry> wheel_[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SIZE];
+
+  // tasks added since the last tick
+  std::atomic<PendingTask*> pending_ = {nullptr};
+  // the tick thread sleeps here while the wheel is empty
+  std::atomic<bool> idle_ = {false};
+  std::mutex idle_mutex_;
+  std::condition_variable idle_cv_;
 
   DECLARE_SINGLETON(TimingWheel)
 };
@@ -47,9 +47,9 @@ using apollo::cyber::record::Recoverer;
 using apollo::cyber::record::Spliter;
 
 const char INFO_OPTIONS[] = "h";
-const char RECORD_OPTIONS[] = "o:ac:k:i:m:hCH";
-const char PLAY_OPTIONS[] = "f:ac:k:lr:b:e:s:d:p:h";
-const char SPLIT_OPTIONS[] = "f:o:c:k:b:e:h";
+const char RECORD_OPTIONS[] = "o:ac:k:i:m:z:hCH";
+const char PLAY_OPTIONS[] = "f:ac:k:lr:b:e:s:d:p:j:h";
+const char SPLIT_OPTIONS[] = "f:o:c:k:b:e:j:h";
 const char RECOVER_OPTIONS[] = "f:o:h";
 
 void DisplayUsage(const std::string& binary);
@@ -142,6 +142,10 @@ void DisplayUsage(const std::string& binary, const std::string& command,
         std::cout << "\t-p, --preload <seconds>\t\t\t" << command
                   << " after trying to preload n second(s)" << std::endl;
         break;
+      case 'j':
+        std::cout << "\t-j, --threads <4>\t\t\t" << command
+                  << " with n thread(s) reading the record" << std::endl;
+        break;
       case 'i':
         std::cout << "\t-i, --segment-interval <seconds>\t" << command
                   << " segmented every n second(s)" << std::endl;
@@ -150,6 +154,10 @@ void DisplayUsage(const std::string& binary, const std::string& command,
         std::cout << "\t-m, --segment-size <MB>\t\t\t" << command
                   << " segmented every n megabyte(s)" << std::endl;
         break;
+      case 'z':
+        std::cout << "\t-z, --compress <none|lz4|zstd>\t\t" << command
+                  << " with the chunks compressed" << std::endl;
+        break;
       case 'h':
         std::cout << "\t-h, --help\t\t\t\tshow help message" << std::endl;
         break;
@@ -182,7 +190,7 @@ int main(int argc, char** argv) {
   }
 
   int long_index = 0;
-  const std::string short_opts = "f:c:k:o:alr:b:e:s:d:p:i:m:hCH";
+  const std::string short_opts = "f:c:k:o:alr:b:e:s:d:p:j:i:m:z:hCH";
   static const struct option long_opts[] = {
       {"files", required_argument, nullptr, 'f'},
       {"white-channel", required_argument, nullptr, 'c'},
@@ -196,8 +204,10 @@ int main(int argc, char** argv) {
       {"start", required_argument, nullptr, 's'},
       {"delay", required_argument, nullptr, 'd'},
       {"preload", required_argument, nullptr, 'p'},
+      {"threads", required_argument, nullptr, 'j'},
       {"segment-interval", required_argument, nullptr, 'i'},
       {"segment-size", required_argument, nullptr, 'm'},
+      {"compress", required_argument, nullptr, 'z'},
       {"help", no_argument, nullptr, 'h'},
       {"cpu-profile", no_argument, nullptr, 'C'},
       {"heap-profule", no_argument, nullptr, 'H'}};
@@ -216,6 +226,7 @@ int main(int argc, char** argv) {
   double opt_start = 0;
   uint64_t opt_delay = 0;
   uint32_t opt_preload = 3;
+  uint32_t opt_threads = 4;
   auto opt_header = HeaderBuilder::GetHeader();
 
   do {
@@ -330,6 +341,25 @@ int main(int argc, char** argv) {
           return -1;
         }
         break;
+      case 'j':
+        try {
+          int threads = std::stoi(optarg);
+          if (threads <= 0) {
+            std::cout << "Argument is not positive: -j/--threads "
+                      << std::string(optarg) << std::endl;
+            return -1;
+          }
+          opt_threads = static_cast<uint32_t>(threads);
+        } catch (const std::invalid_argument& ia) {
+          std::cout << "Invalid argument: -j/--threads " << std::string(optarg)
+                    << std::endl;
+          return -1;
+        } catch (const std::out_of_range& e) {
+          std::cout << "Argument is out of range: -j/--threads "
+                    << std::string(optarg) << std::endl;
+          return -1;
+        }
+        break;
       case 'i':
         try {
           int interval_s = std::stoi(optarg);
@@ -368,6 +398,21 @@ int main(int argc, char** argv) {
           return -1;
         }
         break;
+      case 'z': {
+        const std::string compress(optarg);
+        if (compress == "none") {
+          opt_header.set_compress(apollo::cyber::proto::COMPRESS_NONE);
+        } else if (compress == "lz4") {
+          opt_header.set_compress(apollo::cyber::proto::COMPRESS_LZ4);
+        } else if (compress == "zstd") {
+          opt_header.set_compress(apollo::cyber::proto::COMPRESS_ZSTD);
+        } else {
+          std::cout << "Invalid argument: -z/--compress " << compress
+                    << std::endl;
+          return -1;
+        }
+        break;
+      }
       case 'h':
         DisplayUsage(binary, command);
         return 0;
@@ -420,6 +465,7 @@ int main(int argc, char** argv) {
     play_param.start_time_s = opt_start;
     play_param.delay_time_s = opt_delay;
     play_param.preload_time_s = opt_preload;
+    play_param.prefetch_thread_num = opt_threads;
     play_param.files_to_play.insert(opt_file_vec.begin(), opt_file_vec.end());
     play_param.black_channels.insert(opt_black_channels.begin(),
                                      opt_black_channels.end());
@@ -500,7 +546,7 @@ int main(int argc, char** argv) {
     }
     ::apollo::cyber::Init(argv[0]);
     Spliter spliter(opt_file_vec[0], opt_output_vec[0], opt_white_channels,
-                    opt_black_channels, opt_begin, opt_end);
+                    opt_black_channels, opt_begin, opt_end, opt_threads);
     bool split_result = spliter.Proc();
     return split_result ? 0 : -1;
   }
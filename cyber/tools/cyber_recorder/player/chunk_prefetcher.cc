@@ -0,0 +1,191 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "cyber/tools/cyber_recorder/player/chunk_prefetcher.h"
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+#include "cyber/common/log.h"
+
+namespace apollo {
+namespace cyber {
+namespace record {
+
+ChunkPrefetcher::ChunkPrefetcher(const std::vector<std::string>& files,
+                                 uint64_t begin_time, uint64_t end_time,
+                                 const std::set<std::string>& channels,
+                                 uint32_t thread_num)
+    : files_(files),
+      begin_time_(begin_time),
+      end_time_(end_time),
+      channels_(channels),
+      thread_num_(std::max(thread_num, 1U)),
+      window_(2 * static_cast<size_t>(thread_num_)) {}
+
+ChunkPrefetcher::~ChunkPrefetcher() { Stop(); }
+
+bool ChunkPrefetcher::Init() {
+  for (size_t i = 0; i < files_.size(); ++i) {
+    std::unique_ptr<RecordFileMapper> mapper(new RecordFileMapper());
+    if (!mapper->Open(files_[i])) {
+      AERROR << "Map record failed, file: " << files_[i];
+      return false;
+    }
+    const auto& chunks = mapper->GetChunks();
+    for (size_t j = mapper->FindChunk(begin_time_); j < chunks.size(); ++j) {
+      if (chunks[j].begin_time > end_time_ ||
+          chunks[j].end_time < begin_time_) {
+        continue;
+      }
+      chunks_.emplace_back();
+      chunks_.back().file = i;
+      chunks_.back().index = j;
+      chunks_.back().begin_time = chunks[j].begin_time;
+    }
+    mappers_.emplace_back(std::move(mapper));
+  }
+  std::stable_sort(chunks_.begin(), chunks_.end(),
+                   [](const Chunk& a, const Chunk& b) {
+                     return a.begin_time < b.begin_time;
+                   });
+  return true;
+}
+
+void ChunkPrefetcher::Start() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!stopped_) {
+      return;
+    }
+    stopped_ = false;
+  }
+  uint32_t thread_num =
+      static_cast<uint32_t>(std::min<size_t>(thread_num_, chunks_.size()));
+  for (uint32_t i = 0; i < thread_num; ++i) {
+    threads_.emplace_back(&ChunkPrefetcher::ThreadFunc, this);
+  }
+}
+
+void ChunkPrefetcher::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  window_cv_.notify_all();
+  loaded_cv_.notify_all();
+  for (auto& thread : threads_) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+  threads_.clear();
+}
+
+void ChunkPrefetcher::ThreadFunc() {
+  while (true) {
+    size_t chunk = 0;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      window_cv_.wait(lock, [this]() {
+        return stopped_ || next_load_ >= chunks_.size() ||
+               next_load_ < next_merge_ + window_;
+      });
+      if (stopped_ || next_load_ >= chunks_.size()) {
+        return;
+      }
+      chunk = next_load_++;
+    }
+    LoadChunk(&chunks_[chunk]);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      chunks_[chunk].loaded = true;
+    }
+    loaded_cv_.notify_all();
+  }
+}
+
+void ChunkPrefetcher::LoadChunk(Chunk* chunk) {
+  // a broken chunk is skipped, as RecordReader does
+  if (!mappers_[chunk->file]->ReadChunk(chunk->index, channels_,
+                                        &chunk->body)) {
+    AERROR << "Read chunk failed, file: " << files_[chunk->file]
+           << ", chunk: " << chunk->index;
+    chunk->body.Clear();
+    return;
+  }
+  chunk->messages.reserve(chunk->body.messages_size());
+  for (auto& message : *chunk->body.mutable_messages()) {
+    if (message.time() >= begin_time_ && message.time() <= end_time_) {
+      chunk->messages.push_back(&message);
+    }
+  }
+  auto earlier = [](const proto::SingleMessage* a,
+                    const proto::SingleMessage* b) {
+    return a->time() < b->time();
+  };
+  if (!std::is_sorted(chunk->messages.begin(), chunk->messages.end(),
+                      earlier)) {
+    std::stable_sort(chunk->messages.begin(), chunk->messages.end(), earlier);
+  }
+}
+
+bool ChunkPrefetcher::MergeChunks() {
+  while (next_merge_ < chunks_.size() &&
+         (cursors_.empty() ||
+          chunks_[next_merge_].begin_time <= cursors_.top().time)) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      loaded_cv_.wait(lock, [this]() {
+        return stopped_ || chunks_[next_merge_].loaded;
+      });
+      if (stopped_) {
+        return false;
+      }
+      ++next_merge_;
+    }
+    window_cv_.notify_one();
+    const auto& chunk = chunks_[next_merge_ - 1];
+    if (!chunk.messages.empty()) {
+      cursors_.push({chunk.messages[0]->time(), next_merge_ - 1, 0});
+    }
+  }
+  return true;
+}
+
+bool ChunkPrefetcher::Next(proto::SingleMessage* message) {
+  if (!MergeChunks() || cursors_.empty()) {
+    return false;
+  }
+  auto cursor = cursors_.top();
+  cursors_.pop();
+  auto& chunk = chunks_[cursor.chunk];
+  message->Swap(chunk.messages[cursor.pos]);
+  if (++cursor.pos < chunk.messages.size()) {
+    cursor.time = chunk.messages[cursor.pos]->time();
+    cursors_.push(cursor);
+  } else {
+    // the chunk is read, free it, Clear would keep the messages allocated
+    std::vector<proto::SingleMessage*>().swap(chunk.messages);
+    proto::ChunkBody().Swap(&chunk.body);
+  }
+  return true;
+}
+
+}  // namespace record
+}  // namespace cyber
+}  // namespace apollo
@@ -0,0 +1,123 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#ifndef CYBER_TOOLS_CYBER_RECORDER_PLAYER_CHUNK_PREFETCHER_H_
+#define CYBER_TOOLS_CYBER_RECORDER_PLAYER_CHUNK_PREFETCHER_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cyber/proto/record.pb.h"
+
+#include "cyber/record/file/record_file_mapper.h"
+
+namespace apollo {
+namespace cyber {
+namespace record {
+
+/**
+ * @class ChunkPrefetcher
+ * @brief Messages of complete records in time order. Worker threads read,
+ * decompress and parse the chunks ahead of the reader, a bounded window of
+ * chunks in parallel, and the decoded chunks are merged by time.
+ */
+class ChunkPrefetcher {
+ public:
+  ChunkPrefetcher(const std::vector<std::string>& files, uint64_t begin_time,
+                  uint64_t end_time, const std::set<std::string>& channels,
+                  uint32_t thread_num);
+  virtual ~ChunkPrefetcher();
+
+  /**
+   * @brief Map the files and list their chunks in the time range, fails if
+   * any file has no index
+   */
+  bool Init();
+  void Start();
+  void Stop();
+
+  /**
+   * @brief Move the next message into message
+   * @return false once all are read, or once a chunk is waited for after
+   * Stop
+   */
+  bool Next(proto::SingleMessage* message);
+
+ private:
+  struct Chunk {
+    size_t file = 0;
+    size_t index = 0;
+    uint64_t begin_time = 0;
+    bool loaded = false;
+    proto::ChunkBody body;
+    // messages of the body in the time range, sorted by time
+    std::vector<proto::SingleMessage*> messages;
+  };
+
+  // next message of a loaded chunk
+  struct Cursor {
+    uint64_t time;
+    size_t chunk;
+    size_t pos;
+    bool operator>(const Cursor& other) const {
+      return time != other.time ? time > other.time : chunk > other.chunk;
+    }
+  };
+
+  void ThreadFunc();
+  void LoadChunk(Chunk* chunk);
+  // merge the chunks that may hold messages before the ones merged so far
+  bool MergeChunks();
+
+  std::vector<std::string> files_;
+  uint64_t begin_time_;
+  uint64_t end_time_;
+  std::set<std::string> channels_;
+  uint32_t thread_num_;
+  // chunks loaded or being loaded at most, beyond the ones merged
+  size_t window_;
+
+  std::vector<std::unique_ptr<RecordFileMapper>> mappers_;
+  // sorted by begin_time
+  std::vector<Chunk> chunks_;
+  std::vector<std::thread> threads_;
+
+  std::mutex mutex_;
+  std::condition_variable loaded_cv_;
+  std::condition_variable window_cv_;
+  bool stopped_ = true;
+  // the next chunk to load
+  size_t next_load_ = 0;
+  // chunks before it are merged
+  size_t next_merge_ = 0;
+
+  // only touched by the reader
+  std::priority_queue<Cursor, std::vector<Cursor>, std::greater<Cursor>>
+      cursors_;
+};
+
+}  // namespace record
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_TOOLS_CYBER_RECORDER_PLAYER_CHUNK_PREFETCHER_H_
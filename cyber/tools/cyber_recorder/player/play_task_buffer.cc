@@ -16,55 +16,60 @@
 
 #include "cyber/tools/cyber_recorder/player/play_task_buffer.h"
 
-#include <utility>
-
 namespace apollo {
 namespace cyber {
 namespace record {
 
-PlayTaskBuffer::PlayTaskBuffer() {}
+// a power of 2
+const size_t PlayTaskBuffer::kCapacity = 1 << 16;
+
+PlayTaskBuffer::PlayTaskBuffer() : tasks_(kCapacity) {}
 
-PlayTaskBuffer::~PlayTaskBuffer() { tasks_.clear(); }
+PlayTaskBuffer::~PlayTaskBuffer() { Clear(); }
 
 size_t PlayTaskBuffer::Size() const {
-  std::lock_guard<std::mutex> lck(mutex_);
-  return tasks_.size();
+  return static_cast<size_t>(tail_.load(std::memory_order_acquire) -
+                             head_.load(std::memory_order_acquire));
 }
 
-bool PlayTaskBuffer::Empty() const {
-  std::lock_guard<std::mutex> lck(mutex_);
-  return tasks_.empty();
-}
+bool PlayTaskBuffer::Empty() const { return Size() == 0; }
 
-void PlayTaskBuffer::Push(const TaskPtr& task) {
+bool PlayTaskBuffer::Push(const TaskPtr& task) {
   if (task == nullptr) {
-    return;
+    return true;
+  }
+  uint64_t tail = tail_.load(std::memory_order_relaxed);
+  if (tail - head_.load(std::memory_order_acquire) >= kCapacity) {
+    return false;
   }
-  std::lock_guard<std::mutex> lck(mutex_);
-  tasks_.insert(std::make_pair(task->msg_play_time_ns(), task));
+  tasks_[tail & (kCapacity - 1)] = task;
+  tail_.store(tail + 1, std::memory_order_release);
+  return true;
 }
 
 PlayTaskBuffer::TaskPtr PlayTaskBuffer::Front() {
-  std::lock_guard<std::mutex> lck(mutex_);
-  if (tasks_.empty()) {
+  uint64_t head = head_.load(std::memory_order_relaxed);
+  if (head == tail_.load(std::memory_order_acquire)) {
     return nullptr;
   }
-  auto res = tasks_.begin()->second;
-  return res;
+  return tasks_[head & (kCapacity - 1)];
 }
 
 void PlayTaskBuffer::PopFront() {
-  std::lock_guard<std::mutex> lck(mutex_);
-  if (!tasks_.empty()) {
-    tasks_.erase(tasks_.begin());
+  uint64_t head = head_.load(std::memory_order_relaxed);
+  if (head == tail_.load(std::memory_order_acquire)) {
+    return;
   }
+  tasks_[head & (kCapacity - 1)].reset();
+  head_.store(head + 1, std::memory_order_release);
 }
 
 void PlayTaskBuffer::Clear() {
-  std::lock_guard<std::mutex> lck(mutex_);
-  while (!tasks_.empty()) {
-    tasks_.erase(tasks_.begin());
+  uint64_t tail = tail_.load(std::memory_order_acquire);
+  for (uint64_t i = head_.load(std::memory_order_acquire); i != tail; ++i) {
+    tasks_[i & (kCapacity - 1)].reset();
   }
+  head_.store(tail, std::memory_order_release);
 }
 
 }  // namespace record
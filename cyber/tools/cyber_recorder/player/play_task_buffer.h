@@ -17,10 +17,12 @@
 #ifndef CYBER_TOOLS_CYBER_RECORDER_PLAYER_PLAY_TASK_BUFFER_H_
 #define CYBER_TOOLS_CYBER_RECORDER_PLAYER_PLAY_TASK_BUFFER_H_
 
+#include <atomic>
 #include <cstdint>
-#include <map>
 #include <memory>
-#include <mutex>
+#include <vector>
+
+#include "cyber/base/macros.h"
 
 #include "cyber/tools/cyber_recorder/player/play_task.h"
 
@@ -28,11 +30,16 @@ namespace apollo {
 namespace cyber {
 namespace record {
 
+/**
+ * @brief Bounded lock-free queue of the tasks, pushed by the producer thread
+ * and played by the consumer thread. The producers read the record in time
+ * order, so the tasks are kept in the order they are pushed.
+ */
 class PlayTaskBuffer {
  public:
   using TaskPtr = std::shared_ptr<PlayTask>;
-  // if all tasks are in order, we can use other container to replace this
-  using TaskMap = std::multimap<uint64_t, TaskPtr>;
+
+  static const size_t kCapacity;
 
   PlayTaskBuffer();
   virtual ~PlayTaskBuffer();
@@ -40,14 +47,17 @@ class PlayTaskBuffer {
   size_t Size() const;
   bool Empty() const;
 
-  void Push(const TaskPtr& task);
+  // false if the buffer is full
+  bool Push(const TaskPtr& task);
   TaskPtr Front();
   void PopFront();
+  // neither the producer nor the consumer may run meanwhile
   void Clear();
 
  private:
-  TaskMap tasks_;
-  mutable std::mutex mutex_;
+  std::vector<TaskPtr> tasks_;
+  alignas(CACHELINE_SIZE) std::atomic<uint64_t> head_ = {0};
+  alignas(CACHELINE_SIZE) std::atomic<uint64_t> tail_ = {0};
 };
 
 }  // namespace record
@@ -16,6 +16,9 @@
 
 #include "cyber/tools/cyber_recorder/player/play_task_consumer.h"
 
+#include <algorithm>
+
+#include "cyber/base/macros.h"
 #include "cyber/common/log.h"
 #include "cyber/time/time.h"
 
@@ -25,6 +28,7 @@ namespace record {
 
 const uint64_t PlayTaskConsumer::kPauseSleepNanoSec = 100000000UL;
 const uint64_t PlayTaskConsumer::kWaitProduceSleepNanoSec = 5000000UL;
+const uint64_t PlayTaskConsumer::kSpinNanoSec = 500000UL;
 const uint64_t PlayTaskConsumer::MIN_SLEEP_DURATION_NS = 200000000UL;
 
 PlayTaskConsumer::PlayTaskConsumer(const TaskBufferPtr& task_buffer,
@@ -52,6 +56,11 @@ void PlayTaskConsumer::Start(uint64_t begin_time_ns) {
     return;
   }
   begin_time_ns_ = begin_time_ns;
+  played_num_.store(0);
+  sum_timing_error_ns_.store(0);
+  max_timing_error_ns_.store(0);
+  played_span_ns_.store(0);
+  wall_span_ns_.store(0);
   consume_th_.reset(new std::thread(&PlayTaskConsumer::ThreadFunc, this));
 }
 
@@ -69,6 +78,53 @@ void PlayTaskConsumer::Stop() {
   last_played_msg_real_time_ns_ = 0;
 }
 
+double PlayTaskConsumer::achieved_rate() const {
+  uint64_t wall_span_ns = wall_span_ns_.load();
+  if (wall_span_ns == 0) {
+    return 0.0;
+  }
+  return static_cast<double>(played_span_ns_.load()) /
+         static_cast<double>(wall_span_ns);
+}
+
+uint64_t PlayTaskConsumer::avg_timing_error_ns() const {
+  uint64_t played_num = played_num_.load();
+  if (played_num == 0) {
+    return 0;
+  }
+  return sum_timing_error_ns_.load() / played_num;
+}
+
+bool PlayTaskConsumer::WaitUntil(uint64_t target_ns) {
+  uint64_t now_ns = Time::MonoTime().ToNanosecond();
+  // sleeping overshoots, the last stretch is spun
+  while (now_ns + kSpinNanoSec < target_ns) {
+    if (is_stopped_.load()) {
+      return false;
+    }
+    uint64_t sleep_ns =
+        std::min(target_ns - now_ns - kSpinNanoSec, MIN_SLEEP_DURATION_NS);
+    std::this_thread::sleep_for(std::chrono::nanoseconds(sleep_ns));
+    now_ns = Time::MonoTime().ToNanosecond();
+  }
+  while (now_ns < target_ns) {
+    cpu_relax();
+    now_ns = Time::MonoTime().ToNanosecond();
+  }
+  return !is_stopped_.load();
+}
+
+void PlayTaskConsumer::CountTiming(uint64_t target_ns, uint64_t now_ns) {
+  uint64_t error_ns =
+      now_ns > target_ns ? now_ns - target_ns : target_ns - now_ns;
+  // only this thread writes them
+  played_num_.store(played_num_.load() + 1);
+  sum_timing_error_ns_.store(sum_timing_error_ns_.load() + error_ns);
+  if (error_ns > max_timing_error_ns_.load()) {
+    max_timing_error_ns_.store(error_ns);
+  }
+}
+
 void PlayTaskConsumer::ThreadFunc() {
   uint64_t base_real_time_ns = 0;
   uint64_t accumulated_pause_time_ns = 0;
@@ -81,28 +137,18 @@ void PlayTaskConsumer::ThreadFunc() {
       continue;
     }
 
-    uint64_t sleep_ns = 0;
-
     if (base_msg_play_time_ns_ == 0) {
       base_msg_play_time_ns_ = task->msg_play_time_ns();
       base_msg_real_time_ns_ = task->msg_real_time_ns();
+      base_real_time_ns = Time::MonoTime().ToNanosecond();
       if (base_msg_play_time_ns_ > begin_time_ns_) {
-        sleep_ns = static_cast<uint64_t>(
+        base_real_time_ns += static_cast<uint64_t>(
             static_cast<double>(base_msg_play_time_ns_ - begin_time_ns_) /
             play_rate_);
-        while (sleep_ns > MIN_SLEEP_DURATION_NS && !is_stopped_.load()) {
-          std::this_thread::sleep_for(
-              std::chrono::nanoseconds(MIN_SLEEP_DURATION_NS));
-          sleep_ns -= MIN_SLEEP_DURATION_NS;
-        }
-
-        if (is_stopped_.load()) {
+        if (!WaitUntil(base_real_time_ns)) {
           break;
         }
-
-        std::this_thread::sleep_for(std::chrono::nanoseconds(sleep_ns));
       }
-      base_real_time_ns = Time::Now().ToNanosecond();
       ADEBUG << "base_msg_play_time_ns: " << base_msg_play_time_ns_
              << "base_real_time_ns: " << base_real_time_ns;
     }
@@ -110,24 +156,31 @@ void PlayTaskConsumer::ThreadFunc() {
     uint64_t task_interval_ns = static_cast<uint64_t>(
         static_cast<double>(task->msg_play_time_ns() - base_msg_play_time_ns_) /
         play_rate_);
-    uint64_t real_time_interval_ns = Time::Now().ToNanosecond() -
-                                     base_real_time_ns -
-                                     accumulated_pause_time_ns;
-    if (task_interval_ns > real_time_interval_ns) {
-      sleep_ns = task_interval_ns - real_time_interval_ns;
-      std::this_thread::sleep_for(std::chrono::nanoseconds(sleep_ns));
+    uint64_t target_ns =
+        base_real_time_ns + accumulated_pause_time_ns + task_interval_ns;
+    if (!WaitUntil(target_ns)) {
+      break;
     }
+    uint64_t now_ns = Time::MonoTime().ToNanosecond();
+    CountTiming(target_ns, now_ns);
+    played_span_ns_.store(task->msg_play_time_ns() - base_msg_play_time_ns_);
+    wall_span_ns_.store(now_ns - base_real_time_ns - accumulated_pause_time_ns);
 
     task->Play();
     is_playonce_.store(false);
 
     last_played_msg_real_time_ns_ = task->msg_real_time_ns();
-    while (is_paused_.load() && !is_stopped_.load()) {
-      if (is_playonce_.load()) {
-        break;
+    if (is_paused_.load()) {
+      uint64_t pause_begin_ns = Time::MonoTime().ToNanosecond();
+      while (is_paused_.load() && !is_stopped_.load()) {
+        if (is_playonce_.load()) {
+          break;
+        }
+        std::this_thread::sleep_for(
+            std::chrono::nanoseconds(kPauseSleepNanoSec));
       }
-      std::this_thread::sleep_for(std::chrono::nanoseconds(kPauseSleepNanoSec));
-      accumulated_pause_time_ns += kPauseSleepNanoSec;
+      accumulated_pause_time_ns +=
+          Time::MonoTime().ToNanosecond() - pause_begin_ns;
     }
     task_buffer_->PopFront();
   }
@@ -49,8 +49,17 @@ class PlayTaskConsumer {
     return last_played_msg_real_time_ns_;
   }
 
+  // record time played per wall time, pauses excluded
+  double achieved_rate() const;
+  // how late or early the messages were played
+  uint64_t avg_timing_error_ns() const;
+  uint64_t max_timing_error_ns() const { return max_timing_error_ns_.load(); }
+
  private:
   void ThreadFunc();
+  // sleep until shortly before target_ns, then spin, false if stopped
+  bool WaitUntil(uint64_t target_ns);
+  void CountTiming(uint64_t target_ns, uint64_t now_ns);
 
   double play_rate_;
   ThreadPtr consume_th_;
@@ -62,8 +71,15 @@ class PlayTaskConsumer {
   uint64_t base_msg_play_time_ns_;
   uint64_t base_msg_real_time_ns_;
   uint64_t last_played_msg_real_time_ns_;
+  std::atomic<uint64_t> played_num_ = {0};
+  std::atomic<uint64_t> sum_timing_error_ns_ = {0};
+  std::atomic<uint64_t> max_timing_error_ns_ = {0};
+  // play time of the last message since the first, and the wall time it took
+  std::atomic<uint64_t> played_span_ns_ = {0};
+  std::atomic<uint64_t> wall_span_ns_ = {0};
   static const uint64_t kPauseSleepNanoSec;
   static const uint64_t kWaitProduceSleepNanoSec;
+  static const uint64_t kSpinNanoSec;
   static const uint64_t MIN_SLEEP_DURATION_NS;
 };
 
@@ -23,6 +23,7 @@
 #include "cyber/common/time_conversion.h"
 #include "cyber/cyber.h"
 #include "cyber/message/protobuf_factory.h"
+#include "cyber/tools/cyber_recorder/player/chunk_prefetcher.h"
 
 namespace apollo {
 namespace cyber {
@@ -122,6 +123,7 @@ bool PlayTaskProducer::ReadRecordInfo() {
     }
 
     record_readers_.emplace_back(record_reader);
+    record_files_.emplace_back(file);
 
     auto channel_list = record_reader->GetChannelList();
     // loop each channel info
@@ -377,38 +379,46 @@ void PlayTaskProducer::ThreadFunc() {
   if (preload_size < kMinTaskBufferSize) {
     preload_size = kMinTaskBufferSize;
   }
-
-  record_viewer_ptr_ = std::make_shared<RecordViewer>(
-      record_readers_, play_param_.begin_time_ns, play_param_.end_time_ns,
-      play_param_.channels_to_play);
-  record_viewer_ptr_->set_curr_itr(record_viewer_ptr_->begin());
+  // the buffer never fills up
+  if (preload_size > PlayTaskBuffer::kCapacity / 2) {
+    preload_size = static_cast<uint32_t>(PlayTaskBuffer::kCapacity / 2);
+  }
 
   uint32_t loop_num = 0;
   while (!is_stopped_.load()) {
     uint64_t plus_time_ns = loop_num * loop_time_ns;
-    auto itr = record_viewer_ptr_->begin();
-    auto itr_end = record_viewer_ptr_->end();
-
-    while (itr != itr_end && !is_stopped_.load()) {
-      while (!is_stopped_.load() && task_buffer_->Size() > preload_size) {
-        std::this_thread::sleep_for(
-            std::chrono::nanoseconds(avg_interval_time_ns));
-      }
-      for (; itr != itr_end && !is_stopped_.load(); ++itr) {
-        if (task_buffer_->Size() > preload_size) {
-          break;
+    // the chunks are decoded ahead by the prefetch threads, the messages come
+    // in time order and their content is moved, not copied
+    ChunkPrefetcher prefetcher(record_files_, play_param_.begin_time_ns,
+                               play_param_.end_time_ns,
+                               play_param_.channels_to_play,
+                               play_param_.prefetch_thread_num);
+    if (!prefetcher.Init()) {
+      // a record without index can not be mapped, read it through instead
+      AWARN << "prefetch chunks failed, read the records sequentially.";
+      ProduceSequentially(plus_time_ns, preload_size, avg_interval_time_ns);
+    } else {
+      prefetcher.Start();
+
+      proto::SingleMessage msg;
+      while (!is_stopped_.load() && prefetcher.Next(&msg)) {
+        while (!is_stopped_.load() && task_buffer_->Size() > preload_size) {
+          std::this_thread::sleep_for(
+              std::chrono::nanoseconds(avg_interval_time_ns));
         }
 
-        auto search = writers_.find(itr->channel_name);
+        auto search = writers_.find(msg.channel_name());
         if (search == writers_.end()) {
           continue;
         }
 
-        auto raw_msg = std::make_shared<message::RawMessage>(itr->content);
+        auto raw_msg = std::make_shared<message::RawMessage>();
+        raw_msg->message.swap(*msg.mutable_content());
         auto task = std::make_shared<PlayTask>(
-            raw_msg, search->second, itr->time, itr->time + plus_time_ns);
+            raw_msg, search->second, msg.time(), msg.time() + plus_time_ns);
         task_buffer_->Push(task);
       }
+      prefetcher.Stop();
     }
 
     if (!play_param_.is_loop_playback) {
@@ -419,6 +429,38 @@ void PlayTaskProducer::ThreadFunc() {
   }
 }
 
+void PlayTaskProducer::ProduceSequentially(uint64_t plus_time_ns,
+                                           uint32_t preload_size,
+                                           uint64_t avg_interval_time_ns) {
+  record_viewer_ptr_ = std::make_shared<RecordViewer>(
+      record_readers_, play_param_.begin_time_ns, play_param_.end_time_ns,
+      play_param_.channels_to_play);
+  auto itr = record_viewer_ptr_->begin();
+  auto itr_end = record_viewer_ptr_->end();
+
+  while (itr != itr_end && !is_stopped_.load()) {
+    while (!is_stopped_.load() && task_buffer_->Size() > preload_size) {
+      std::this_thread::sleep_for(
+          std::chrono::nanoseconds(avg_interval_time_ns));
+    }
+    for (; itr != itr_end && !is_stopped_.load(); ++itr) {
+      if (task_buffer_->Size() > preload_size) {
+        break;
+      }
+
+      auto search = writers_.find(itr->channel_name);
+      if (search == writers_.end()) {
+        continue;
+      }
+
+      auto raw_msg = std::make_shared<message::RawMessage>(itr->content);
+      auto task = std::make_shared<PlayTask>(
+          raw_msg, search->second, itr->time, itr->time + plus_time_ns);
+      task_buffer_->Push(task);
+    }
+  }
+}
+
 }  // namespace record
 }  // namespace cyber
 }  // namespace apollo
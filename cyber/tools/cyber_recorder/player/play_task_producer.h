@@ -88,6 +88,9 @@ class PlayTaskProducer {
                             const std::string& msg_type);
   void ThreadFunc();
   void ThreadFuncUnderPreloadMode();
+  // one round of ThreadFunc through record_viewer_ptr_, without prefetching
+  void ProduceSequentially(uint64_t plus_time_ns, uint32_t preload_size,
+                           uint64_t avg_interval_time_ns);
 
   PlayParam play_param_;
   TaskBufferPtr task_buffer_;
@@ -100,6 +103,8 @@ class PlayTaskProducer {
   WriterMap writers_;
   MessageTypeMap msg_types_;
   std::vector<RecordReaderPtr> record_readers_;
+  // paths of record_readers_
+  std::vector<std::string> record_files_;
   RecordViewerPtr record_viewer_ptr_;
 
   uint64_t earliest_begin_time_;
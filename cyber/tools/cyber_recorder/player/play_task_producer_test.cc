@@ -0,0 +1,134 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "cyber/tools/cyber_recorder/player/play_task_producer.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "cyber/init.h"
+#include "cyber/record/file/record_file_reader.h"
+#include "cyber/record/record_writer.h"
+
+namespace apollo {
+namespace cyber {
+namespace record {
+
+using apollo::cyber::message::RawMessage;
+using apollo::cyber::proto::Header;
+using apollo::cyber::proto::SectionType;
+
+constexpr char kChannelName[] = "/test/play_task_producer";
+constexpr char kMessageType[] = "apollo.cyber.proto.Test";
+constexpr char kProtoDesc[] = "1234567890";
+constexpr char kTestFile[] = "play_task_producer_test.record";
+constexpr uint64_t kMessageNum = 16;
+
+void WriteRecord(const std::string& path) {
+  RecordWriter writer;
+  writer.SetSizeOfFileSegmentation(0);
+  writer.SetIntervalOfFileSegmentation(0);
+  ASSERT_TRUE(writer.Open(path));
+  ASSERT_TRUE(writer.WriteChannel(kChannelName, kMessageType, kProtoDesc));
+  for (uint64_t i = 1; i <= kMessageNum; ++i) {
+    auto msg = std::make_shared<RawMessage>(std::to_string(i));
+    ASSERT_TRUE(writer.WriteMessage(kChannelName, msg, i * 1000000));
+  }
+  writer.Close();
+}
+
+// cut the index off and mark the record incomplete, like a recorder that
+// did not close it
+bool MakeIncomplete(const std::string& path) {
+  Header header;
+  {
+    RecordFileReader reader;
+    if (!reader.Open(path)) {
+      return false;
+    }
+    header = reader.GetHeader();
+    reader.Close();
+  }
+  int fd = open(path.c_str(), O_WRONLY);
+  if (fd < 0) {
+    return false;
+  }
+  bool ok = ftruncate(fd, header.index_position()) == 0;
+  header.set_is_complete(false);
+  Section section;
+  memset(&section, 0, sizeof(section));
+  section = {SectionType::SECTION_HEADER,
+             static_cast<int64_t>(header.ByteSizeLong())};
+  std::string data;
+  header.SerializeToString(&data);
+  data.resize(HEADER_LENGTH, '0');
+  ok = ok && pwrite(fd, &section, sizeof(section), 0) == sizeof(section) &&
+       pwrite(fd, data.data(), data.size(), sizeof(section)) ==
+           static_cast<ssize_t>(data.size());
+  close(fd);
+  return ok;
+}
+
+TEST(PlayTaskProducerTest, play_incomplete_record) {
+  WriteRecord(kTestFile);
+  PlayParam play_param;
+  play_param.is_play_all_channels = true;
+  play_param.files_to_play.insert(kTestFile);
+  auto task_buffer = std::make_shared<PlayTaskBuffer>();
+  PlayTaskProducer producer(task_buffer, play_param);
+  ASSERT_TRUE(producer.Init());
+
+  // the record is cut off after it was opened, its chunks can not be mapped
+  // for prefetching, the producer falls back to reading them in order
+  ASSERT_TRUE(MakeIncomplete(kTestFile));
+  producer.Start();
+  for (int i = 0; i < 200 && !producer.is_stopped(); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_TRUE(producer.is_stopped());
+  producer.Stop();
+
+  std::vector<uint64_t> times;
+  while (auto task = task_buffer->Front()) {
+    times.push_back(task->msg_real_time_ns());
+    task_buffer->PopFront();
+  }
+  ASSERT_EQ(kMessageNum, times.size());
+  for (uint64_t i = 0; i < kMessageNum; ++i) {
+    EXPECT_EQ((i + 1) * 1000000, times[i]);
+  }
+  ASSERT_FALSE(remove(kTestFile));
+}
+
+}  // namespace record
+}  // namespace cyber
+}  // namespace apollo
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  apollo::cyber::Init(argv[0]);
+  return RUN_ALL_TESTS();
+}
@@ -253,6 +253,13 @@ bool Player::Start() {
   }
 
   std::cout << "\nplay finished." << std::endl;
+  std::cout << "achieved rate: " << std::setprecision(3)
+            << consumer_->achieved_rate() << " / " << play_param.play_rate
+            << ", timing error avg: "
+            << static_cast<double>(consumer_->avg_timing_error_ns()) / 1e3
+            << " us, max: "
+            << static_cast<double>(consumer_->max_timing_error_ns()) / 1e3
+            << " us" << std::endl;
   std::cout.flags(before);
   return true;
 }
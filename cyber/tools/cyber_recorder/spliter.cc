@@ -16,6 +16,10 @@
 
 #include "cyber/tools/cyber_recorder/spliter.h"
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 namespace apollo {
 namespace cyber {
 namespace record {
@@ -26,16 +30,27 @@ using apollo::cyber::proto::SectionType;
 Spliter::Spliter(const std::string& input_file, const std::string& output_file,
                  const std::vector<std::string>& white_channels,
                  const std::vector<std::string>& black_channels,
-                 uint64_t begin_time, uint64_t end_time)
+                 uint64_t begin_time, uint64_t end_time, uint32_t thread_num)
     : input_file_(input_file),
       output_file_(output_file),
       white_channels_(white_channels),
       black_channels_(black_channels),
       begin_time_(begin_time),
-      end_time_(end_time) {}
+      end_time_(end_time),
+      thread_num_(std::max(thread_num, 1U)) {}
 
 Spliter::~Spliter() {}
 
+bool Spliter::IsSelected(const std::string& channel_name) const {
+  if (!white_channels_.empty() &&
+      std::find(white_channels_.begin(), white_channels_.end(),
+                channel_name) == white_channels_.end()) {
+    return false;
+  }
+  return std::find(black_channels_.begin(), black_channels_.end(),
+                   channel_name) == black_channels_.end();
+}
+
 bool Spliter::Proc() {
   // check params
   if (begin_time_ >= end_time_) {
@@ -65,9 +80,15 @@ bool Spliter::Proc() {
            << " is not include in this record file.";
     return false;
   }
+  // complete records are read through their index
+  RecordFileMapper mapper;
+  bool mapped = header.is_complete() && mapper.Open(input_file_);
 
   // open output file
   Header new_hdr = HeaderBuilder::GetHeader();
+  if (mapped) {
+    new_hdr.set_compress(header.compress());
+  }
   if (!writer_.Open(output_file_)) {
     AERROR << "open output file failed. file: " << output_file_;
     return false;
@@ -76,7 +97,160 @@ bool Spliter::Proc() {
     AERROR << "write header to output file failed. file: " << output_file_;
     return false;
   }
+  // the compress type is unsupported by this build otherwise
+  copy_chunks_ = mapped && writer_.GetHeader().compress() == header.compress();
+
+  if (!(mapped ? ProcChunks(&mapper) : ProcSections())) {
+    return false;
+  }
+  AINFO << "split record file done.";
+  return true;
+}  // end for Proc()
+
+bool Spliter::ProcChunks(RecordFileMapper* mapper) {
+  for (const auto& single_idx : mapper->GetIndex().indexes()) {
+    if (single_idx.type() != SectionType::SECTION_CHANNEL ||
+        !single_idx.has_channel_cache() ||
+        !IsSelected(single_idx.channel_cache().name())) {
+      continue;
+    }
+    const auto& cache = single_idx.channel_cache();
+    Channel chan;
+    chan.set_name(cache.name());
+    chan.set_message_type(cache.message_type());
+    chan.set_proto_desc(cache.proto_desc());
+    if (!writer_.WriteChannel(chan)) {
+      AERROR << "write channel failed, channel: " << cache.name();
+      return false;
+    }
+    selected_channels_.insert(cache.name());
+  }
+  if (selected_channels_.empty()) {
+    AWARN << "no channel to split.";
+    return true;
+  }
+
+  std::vector<ChunkTask> tasks;
+  const auto& chunks = mapper->GetChunks();
+  for (size_t i = mapper->FindChunk(begin_time_); i < chunks.size(); ++i) {
+    if (begin_time_ > chunks[i].end_time || end_time_ < chunks[i].begin_time) {
+      continue;
+    }
+    tasks.emplace_back();
+    tasks.back().index = i;
+  }
+
+  // the chunks are split in parallel, a bounded window ahead of the one
+  // written, and written in order
+  const size_t window = 2 * static_cast<size_t>(thread_num_);
+  std::mutex mutex;
+  std::condition_variable done_cv;
+  std::condition_variable window_cv;
+  size_t next_split = 0;
+  size_t next_write = 0;
+  bool failed = false;
+  auto split = [&]() {
+    while (true) {
+      size_t i = 0;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        window_cv.wait(lock, [&]() {
+          return failed || next_split >= tasks.size() ||
+                 next_split < next_write + window;
+        });
+        if (failed || next_split >= tasks.size()) {
+          return;
+        }
+        i = next_split++;
+      }
+      SplitChunk(mapper, &tasks[i]);
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks[i].done = true;
+      }
+      done_cv.notify_all();
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < std::min<size_t>(thread_num_, tasks.size()); ++i) {
+    threads.emplace_back(split);
+  }
 
+  bool ok = true;
+  for (size_t i = 0; i < tasks.size() && ok; ++i) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      done_cv.wait(lock, [&]() { return tasks[i].done; });
+    }
+    ok = WriteChunk(mapper, &tasks[i]);
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      failed = !ok;
+      next_write = i + 1;
+    }
+    window_cv.notify_all();
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return ok;
+}
+
+void Spliter::SplitChunk(RecordFileMapper* mapper, ChunkTask* task) {
+  const auto& info = mapper->GetChunks()[task->index];
+  if (copy_chunks_ && info.begin_time >= begin_time_ &&
+      info.end_time <= end_time_) {
+    // the channels are counted without parsing the messages
+    if (!mapper->CountMessages(task->index, &task->message_numbers)) {
+      return;
+    }
+    task->intact = std::all_of(
+        task->message_numbers.begin(), task->message_numbers.end(),
+        [this](const std::pair<const std::string, uint64_t>& item) {
+          return selected_channels_.count(item.first) > 0;
+        });
+    if (task->intact) {
+      task->ok = mapper->ReadRawChunk(task->index, &task->raw_body);
+      return;
+    }
+    task->message_numbers.clear();
+  }
+  task->ok = mapper->ReadChunk(task->index, selected_channels_, &task->body);
+}
+
+bool Spliter::WriteChunk(RecordFileMapper* mapper, ChunkTask* task) {
+  if (!task->ok) {
+    AERROR << "read chunk failed, chunk: " << task->index;
+    return false;
+  }
+  if (task->intact) {
+    const auto& info = mapper->GetChunks()[task->index];
+    ChunkHeader chdr;
+    chdr.set_begin_time(info.begin_time);
+    chdr.set_end_time(info.end_time);
+    chdr.set_message_number(info.message_number);
+    chdr.set_raw_size(info.raw_size);
+    if (!writer_.WriteRawChunk(chdr, &task->raw_body, task->message_numbers)) {
+      AERROR << "write chunk failed, chunk: " << task->index;
+      return false;
+    }
+    return true;
+  }
+  for (const auto& message : task->body.messages()) {
+    if (message.time() < begin_time_ || message.time() > end_time_) {
+      continue;
+    }
+    if (!writer_.WriteMessage(message)) {
+      AERROR << "add new message failed.";
+      return false;
+    }
+  }
+  // written, free it
+  ChunkBody().Swap(&task->body);
+  return true;
+}
+
+bool Spliter::ProcSections() {
   // read through record file
   bool skip_next_chunk_body(false);
   reader_.Reset();
@@ -96,13 +270,8 @@ bool Spliter::Proc() {
           AERROR << "read channel section fail.";
           return false;
         }
-        if (white_channels_.empty() ||
-            std::find(white_channels_.begin(), white_channels_.end(),
-                      chan.name()) != white_channels_.end()) {
-          if (std::find(black_channels_.begin(), black_channels_.end(),
-                        chan.name()) == black_channels_.end()) {
-            writer_.WriteChannel(chan);
-          }
+        if (IsSelected(chan.name())) {
+          writer_.WriteChannel(chan);
         }
         break;
       }
@@ -129,15 +298,7 @@ bool Spliter::Proc() {
           return false;
         }
         for (int idx = 0; idx < cbd.messages_size(); ++idx) {
-          if (!white_channels_.empty() &&
-              std::find(white_channels_.begin(), white_channels_.end(),
-                        cbd.messages(idx).channel_name()) ==
-                  white_channels_.end()) {
-            continue;
-          }
-          if (std::find(black_channels_.begin(), black_channels_.end(),
-                        cbd.messages(idx).channel_name()) !=
-              black_channels_.end()) {
+          if (!IsSelected(cbd.messages(idx).channel_name())) {
             continue;
           }
           if (cbd.messages(idx).time() < begin_time_ ||
@@ -158,9 +319,8 @@ bool Spliter::Proc() {
       }
     }  // end for switch
   }    // end for while
-  AINFO << "split record file done.";
   return true;
-}  // end for Proc()
+}
 
 }  // namespace record
 }  // namespace cyber
@@ -20,11 +20,14 @@
 #include <algorithm>
 #include <limits>
 #include <memory>
+#include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "cyber/common/log.h"
 #include "cyber/proto/record.pb.h"
+#include "cyber/record/file/record_file_mapper.h"
 #include "cyber/record/file/record_file_reader.h"
 #include "cyber/record/file/record_file_writer.h"
 #include "cyber/record/header_builder.h"
@@ -44,11 +47,34 @@ class Spliter {
           const std::vector<std::string>& white_channels,
           const std::vector<std::string>& black_channels,
           uint64_t begin_time = 0,
-          uint64_t end_time = std::numeric_limits<uint64_t>::max());
+          uint64_t end_time = std::numeric_limits<uint64_t>::max(),
+          uint32_t thread_num = 4);
   virtual ~Spliter();
   bool Proc();
 
  private:
+  // a chunk of the input as it goes to the output
+  struct ChunkTask {
+    size_t index = 0;
+    bool done = false;
+    bool ok = false;
+    // all its messages are selected, the body is copied as it is stored
+    bool intact = false;
+    std::string raw_body;
+    std::unordered_map<std::string, uint64_t> message_numbers;
+    // otherwise the messages of the selected channels
+    ChunkBody body;
+  };
+
+  bool IsSelected(const std::string& channel_name) const;
+  // streams the sections of records without index
+  bool ProcSections();
+  // copies the intact chunks of complete records, the others are filtered by
+  // thread_num threads
+  bool ProcChunks(RecordFileMapper* mapper);
+  void SplitChunk(RecordFileMapper* mapper, ChunkTask* task);
+  bool WriteChunk(RecordFileMapper* mapper, ChunkTask* task);
+
   RecordFileReader reader_;
   RecordFileWriter writer_;
   std::string input_file_;
@@ -58,6 +84,10 @@ class Spliter {
   bool all_channels_;
   uint64_t begin_time_;
   uint64_t end_time_;
+  uint32_t thread_num_;
+  std::set<std::string> selected_channels_;
+  // the output chunks are compressed the same way
+  bool copy_chunks_ = false;
 };
 
 }  // namespace record
@@ -15,9 +15,13 @@
  *****************************************************************************/
 
 #include "cyber/transport/dispatcher/shm_dispatcher.h"
+
+#include <string>
+
 #include "cyber/common/global_data.h"
 #include "cyber/common/util.h"
 #include "cyber/scheduler/scheduler_factory.h"
+#include "cyber/transport/shm/message_batch.h"
 #include "cyber/transport/shm/readable_info.h"
 
 namespace apollo {
@@ -39,6 +43,15 @@ void ShmDispatcher::Shutdown() {
     thread_.join();
   }
 
+  for (auto& queue : dispatch_queues_) {
+    queue->BreakAllWait();
+  }
+  for (auto& thread : dispatch_threads_) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+
   {
     ReadLockGuard<AtomicRWLock> lock(segments_lock_);
     segments_.clear();
@@ -52,34 +65,136 @@ void ShmDispatcher::AddSegment(const RoleAttributes& self_attr) {
     return;
   }
   auto segment = SegmentFactory::CreateSegment(channel_id);
+  segment->EnableReaderCursor();
   segments_[channel_id] = segment;
   previous_indexes_[channel_id] = UINT32_MAX;
+
+  auto stat = std::make_shared<ChannelStat>();
+  const std::string& channel_name = self_attr.channel_name();
+  stat->queue_latency = std::make_shared<::bvar::LatencyRecorder>(
+      channel_name, "shm-dispatch-queue");
+  stat->handle_latency = std::make_shared<::bvar::LatencyRecorder>(
+      channel_name, "shm-dispatch-handle");
+  stat->queue_depth = std::make_shared<::bvar::Status<uint64_t>>(
+      channel_name + "-shm-dispatch-pending", 0);
+  stat->replaced = std::make_shared<::bvar::Adder<uint64_t>>(
+      channel_name + "-shm-dispatch-replaced");
+  channel_stats_[channel_id] = stat;
+}
+
+uint64_t ShmDispatcher::PendingNum(uint64_t channel_id) {
+  ReadLockGuard<AtomicRWLock> lock(segments_lock_);
+  auto iter = channel_stats_.find(channel_id);
+  return iter == channel_stats_.end() ? 0
+                                      : iter->second->queue_depth->get_value();
+}
+
+uint64_t ShmDispatcher::ReplacedNum(uint64_t channel_id) {
+  ReadLockGuard<AtomicRWLock> lock(segments_lock_);
+  auto iter = channel_stats_.find(channel_id);
+  return iter == channel_stats_.end() ? 0
+                                      : iter->second->replaced->get_value();
+}
+
+bool ShmDispatcher::CheckSeq(const RoleAttributes& self_attr,
+                             SeqTracker* seq_tracker,
+                             const MessageInfo& msg_info) {
+  uint64_t dropped = 0;
+  if (!seq_tracker->Check(msg_info, &dropped)) {
+    ADEBUG << "skip message read already, channel: "
+           << self_attr.channel_name() << " seq: " << msg_info.seq_num();
+    return false;
+  }
+  if (dropped > 0) {
+    ADEBUG << dropped << " messages dropped before seq " << msg_info.seq_num()
+           << " of channel: " << self_attr.channel_name();
+    statistics::Statistics::Instance()->AddDropCount(
+        self_attr, static_cast<int>(dropped));
+  }
+  return true;
 }
 
-void ShmDispatcher::ReadMessage(uint64_t channel_id, uint32_t block_index) {
+void ShmDispatcher::ReadMessage(uint64_t channel_id, const SegmentPtr& segment,
+                                const ChannelStatPtr& stat,
+                                uint32_t block_index) {
   ADEBUG << "Reading sharedmem message: "
          << GlobalData::GetChannelById(channel_id)
          << " from block: " << block_index;
   auto rb = std::make_shared<ReadableBlock>();
   rb->index = block_index;
-  if (!segments_[channel_id]->AcquireBlockToRead(rb.get())) {
+  if (!segment->AcquireBlockToRead(rb.get())) {
     AWARN << "fail to acquire block, channel: "
           << GlobalData::GetChannelById(channel_id)
           << " index: " << block_index;
     return;
   }
 
-  MessageInfo msg_info;
-  const char* msg_info_addr =
-      reinterpret_cast<char*>(rb->buf) + rb->block->msg_size();
+  // The block was written again while its index waited in the queue, and
+  // that newer message was read through an earlier index of this block
+  // already: the message of this index is lost.
+  uint64_t block_seq = rb->block->seq();
+  if (stat != nullptr && block_seq != 0) {
+    uint64_t& read_seq = stat->read_seqs[block_index];
+    if (read_seq == block_seq) {
+      ADEBUG << "block " << block_index << " of channel "
+             << GlobalData::GetChannelById(channel_id)
+             << " was replaced before it was read.";
+      *(stat->replaced) << 1;
+      segment->ReleaseReadBlock(*rb);
+      return;
+    }
+    read_seq = block_seq;
+  }
 
-  if (msg_info.DeserializeFrom(msg_info_addr, rb->block->msg_info_size())) {
-    OnMessage(channel_id, rb, msg_info);
+  uint64_t start_time = Time::Now().ToMicrosecond();
+  if (MessageBatch::IsBatch(rb->block)) {
+    ReadBatch(channel_id, rb);
   } else {
-    AERROR << "error msg info of channel:"
+    MessageInfo msg_info;
+    const char* msg_info_addr =
+        reinterpret_cast<char*>(rb->buf) + rb->block->msg_size();
+
+    if (msg_info.DeserializeFrom(msg_info_addr, rb->block->msg_info_size())) {
+      OnMessage(channel_id, rb, msg_info);
+    } else {
+      AERROR << "error msg info of channel:"
+             << GlobalData::GetChannelById(channel_id);
+    }
+  }
+  segment->ReleaseReadBlock(*rb);
+
+  if (stat != nullptr) {
+    *(stat->handle_latency) << Time::Now().ToMicrosecond() - start_time;
+  }
+}
+
+void ShmDispatcher::ReadBatch(uint64_t channel_id,
+                              const std::shared_ptr<ReadableBlock>& rb) {
+  // every record is handed to the listeners as a block of its own, the batch
+  // block stays read locked meanwhile
+  Block record_block;
+  auto record = std::make_shared<ReadableBlock>();
+  record->index = rb->index;
+  record->block = &record_block;
+  MessageInfo msg_info;
+  bool valid = MessageBatch::ForEach(
+      rb->buf, rb->block->msg_size(),
+      [&](const uint8_t* msg, uint32_t msg_size, const char* msg_info_addr,
+          uint32_t msg_info_size) {
+        if (!msg_info.DeserializeFrom(msg_info_addr, msg_info_size)) {
+          AERROR << "error msg info of channel:"
+                 << GlobalData::GetChannelById(channel_id);
+          return;
+        }
+        record_block.set_msg_size(msg_size);
+        record_block.set_msg_info_size(msg_info_size);
+        record->buf = const_cast<uint8_t*>(msg);
+        OnMessage(channel_id, record, msg_info);
+      });
+  if (!valid) {
+    AERROR << "malformed batch block of channel:"
            << GlobalData::GetChannelById(channel_id);
   }
-  segments_[channel_id]->ReleaseReadBlock(*rb);
 }
 
 void ShmDispatcher::OnMessage(uint64_t channel_id,
@@ -115,11 +230,19 @@ void ShmDispatcher::ThreadFunc() {
     uint64_t channel_id = readable_info.channel_id();
     uint32_t block_index = readable_info.block_index();
 
+    SegmentPtr segment = nullptr;
+    ChannelStatPtr stat = nullptr;
     {
       ReadLockGuard<AtomicRWLock> lock(segments_lock_);
-      if (segments_.count(channel_id) == 0) {
+      auto seg_iter = segments_.find(channel_id);
+      if (seg_iter == segments_.end()) {
         continue;
       }
+      segment = seg_iter->second;
+      auto stat_iter = channel_stats_.find(channel_id);
+      if (stat_iter != channel_stats_.end()) {
+        stat = stat_iter->second;
+      }
       // check block index
       if (previous_indexes_.count(channel_id) == 0) {
         previous_indexes_[channel_id] = UINT32_MAX;
@@ -138,15 +261,73 @@ void ShmDispatcher::ThreadFunc() {
         }
       }
       previous_index = block_index;
+    }
+
+    if (dispatch_queues_.empty()) {
+      ReadMessage(channel_id, segment, stat, block_index);
+      continue;
+    }
 
-      ReadMessage(channel_id, block_index);
+    DispatchTask task;
+    task.channel_id = channel_id;
+    task.block_index = block_index;
+    task.enqueue_time = Time::Now().ToMicrosecond();
+    if (stat != nullptr) {
+      stat->queue_depth->set_value(stat->pending.fetch_add(1) + 1);
     }
+    // shard by channel so messages of one channel keep their order
+    dispatch_queues_[channel_id % dispatch_queues_.size()]->Enqueue(task);
+  }
+}
+
+void ShmDispatcher::DispatchThreadFunc(DispatchQueue* queue) {
+  DispatchTask task;
+  while (!is_shutdown_.load()) {
+    if (!queue->WaitDequeue(&task)) {
+      continue;
+    }
+
+    SegmentPtr segment = nullptr;
+    ChannelStatPtr stat = nullptr;
+    {
+      ReadLockGuard<AtomicRWLock> lock(segments_lock_);
+      auto stat_iter = channel_stats_.find(task.channel_id);
+      if (stat_iter != channel_stats_.end()) {
+        stat = stat_iter->second;
+        stat->queue_depth->set_value(stat->pending.fetch_sub(1) - 1);
+        *(stat->queue_latency)
+            << Time::Now().ToMicrosecond() - task.enqueue_time;
+      }
+      auto seg_iter = segments_.find(task.channel_id);
+      if (seg_iter == segments_.end()) {
+        continue;
+      }
+      segment = seg_iter->second;
+    }
+    ReadMessage(task.channel_id, segment, stat, task.block_index);
   }
 }
 
 bool ShmDispatcher::Init() {
   host_id_ = common::Hash(GlobalData::Instance()->HostIp());
   notifier_ = NotifierFactory::CreateNotifier();
+
+  uint32_t dispatch_threads = 0;
+  auto& g_conf = GlobalData::Instance()->Config();
+  if (g_conf.has_transport_conf() && g_conf.transport_conf().has_shm_conf()) {
+    dispatch_threads = g_conf.transport_conf().shm_conf().dispatch_threads();
+  }
+  for (uint32_t i = 0; i < dispatch_threads; ++i) {
+    dispatch_queues_.emplace_back(new DispatchQueue());
+  }
+  for (auto& queue : dispatch_queues_) {
+    dispatch_threads_.emplace_back(&ShmDispatcher::DispatchThreadFunc, this,
+                                   queue.get());
+    scheduler::Instance()->SetInnerThreadAttr("shm_disp",
+                                              &dispatch_threads_.back());
+  }
+  ADEBUG << "shm dispatch threads: " << dispatch_threads;
+
   thread_ = std::thread(&ShmDispatcher::ThreadFunc, this);
   scheduler::Instance()->SetInnerThreadAttr("shm_disp", &thread_);
   // statistics::Statistics::Instance()->CreateSpan("protobuf_parse_time");
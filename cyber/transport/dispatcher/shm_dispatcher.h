@@ -17,13 +17,17 @@
 #ifndef CYBER_TRANSPORT_DISPATCHER_SHM_DISPATCHER_H_
 #define CYBER_TRANSPORT_DISPATCHER_SHM_DISPATCHER_H_
 
+#include <cstdint>
 #include <cstring>
 #include <memory>
 #include <string>
 #include <thread>
+#include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 #include "cyber/base/atomic_rw_lock.h"
+#include "cyber/base/thread_safe_queue.h"
 #include "cyber/common/global_data.h"
 #include "cyber/common/log.h"
 #include "cyber/common/macros.h"
@@ -31,6 +35,7 @@
 #include "cyber/time/time.h"
 #include "cyber/message/message_traits.h"
 #include "cyber/transport/dispatcher/dispatcher.h"
+#include "cyber/transport/message/seq_tracker.h"
 #include "cyber/transport/shm/notifier_factory.h"
 #include "cyber/transport/shm/segment_factory.h"
 
@@ -49,6 +54,30 @@ class ShmDispatcher : public Dispatcher {
   // key: channel_id
   using SegmentContainer = std::unordered_map<uint64_t, SegmentPtr>;
 
+  struct DispatchTask {
+    uint64_t channel_id = 0;
+    uint32_t block_index = 0;
+    uint64_t enqueue_time = 0;
+  };
+  using DispatchQueue = base::ThreadSafeQueue<DispatchTask>;
+
+  // Per channel dispatch metrics, they make head-of-line blocking between
+  // channels sharing a dispatch thread visible.
+  struct ChannelStat {
+    std::atomic<uint64_t> pending = {0};
+    // time spent in the dispatch queue, microsecond
+    statistics::LatencyVarPtr queue_latency;
+    // time spent reading and running the handlers, microsecond
+    statistics::LatencyVarPtr handle_latency;
+    statistics::StatusVarPtr queue_depth;
+    // messages whose block was written again before their turn came
+    std::shared_ptr<::bvar::Adder<uint64_t>> replaced;
+    // seq of the block last read at an index, only touched by the thread
+    // dispatching the channel
+    std::unordered_map<uint32_t, uint64_t> read_seqs;
+  };
+  using ChannelStatPtr = std::shared_ptr<ChannelStat>;
+
   virtual ~ShmDispatcher();
 
   void Shutdown() override;
@@ -62,21 +91,52 @@ class ShmDispatcher : public Dispatcher {
                    const RoleAttributes& opposite_attr,
                    const MessageListener<MessageT>& listener);
 
+  // notifications of the channel waiting for a dispatch thread, and the
+  // ones skipped as their block was written again, see ChannelStat
+  uint64_t PendingNum(uint64_t channel_id);
+  uint64_t ReplacedNum(uint64_t channel_id);
+
  private:
+  // Messages are parsed into a fresh object, except zero-copy ones which are
+  // handed to the listeners as a view of the block, read locked until the
+  // last reference is dropped. A reader holds a bounded number of views, see
+  // Segment::AcquireLoanedBlockToRead.
+  template <typename MessageT>
+  typename std::enable_if<!message::IsZeroCopy<MessageT>::value,
+                          std::shared_ptr<MessageT>>::type
+  ParseMessage(uint64_t channel_id, const std::shared_ptr<ReadableBlock>& rb);
+
+  template <typename MessageT>
+  typename std::enable_if<message::IsZeroCopy<MessageT>::value,
+                          std::shared_ptr<MessageT>>::type
+  ParseMessage(uint64_t channel_id, const std::shared_ptr<ReadableBlock>& rb);
+
+  // drops the messages read already, accounts the ones never read
+  bool CheckSeq(const RoleAttributes& self_attr, SeqTracker* seq_tracker,
+                const MessageInfo& msg_info);
   void AddSegment(const RoleAttributes& self_attr);
-  void ReadMessage(uint64_t channel_id, uint32_t block_index);
+  // called without segments_lock_, the handlers may take their time
+  void ReadMessage(uint64_t channel_id, const SegmentPtr& segment,
+                   const ChannelStatPtr& stat, uint32_t block_index);
+  // unpacks a block written by a batching ShmTransmitter, see MessageBatch
+  void ReadBatch(uint64_t channel_id, const std::shared_ptr<ReadableBlock>& rb);
   void OnMessage(uint64_t channel_id, const std::shared_ptr<ReadableBlock>& rb,
                  const MessageInfo& msg_info);
   void ThreadFunc();
+  void DispatchThreadFunc(DispatchQueue* queue);
   bool Init();
 
   uint64_t host_id_;
   SegmentContainer segments_;
   std::unordered_map<uint64_t, uint32_t> previous_indexes_;
+  std::unordered_map<uint64_t, ChannelStatPtr> channel_stats_;
   AtomicRWLock segments_lock_;
   std::thread thread_;
   NotifierPtr notifier_;
 
+  std::vector<std::unique_ptr<DispatchQueue>> dispatch_queues_;
+  std::vector<std::thread> dispatch_threads_;
+
   DECLARE_SINGLETON(ShmDispatcher)
 };
 
@@ -84,12 +144,13 @@ template <typename MessageT>
 void ShmDispatcher::AddListener(const RoleAttributes& self_attr,
                                 const MessageListener<MessageT>& listener) {
   // FIXME: make it more clean
-  auto listener_adapter = [listener, self_attr](
+  auto seq_tracker = std::make_shared<SeqTracker>();
+  auto listener_adapter = [this, listener, self_attr, seq_tracker](
                                      const std::shared_ptr<ReadableBlock>& rb,
                                      const MessageInfo& msg_info) {
-    auto msg = std::make_shared<MessageT>();
-    RETURN_IF(!message::ParseFromArray(
-        rb->buf, static_cast<int>(rb->block->msg_size()), msg.get()));
+    RETURN_IF(!this->CheckSeq(self_attr, seq_tracker.get(), msg_info));
+    auto msg = this->ParseMessage<MessageT>(self_attr.channel_id(), rb);
+    RETURN_IF(msg == nullptr);
 
     auto send_time = msg_info.send_time();
     auto msg_seq_num = msg_info.msg_seq_num();
@@ -122,12 +183,13 @@ void ShmDispatcher::AddListener(const RoleAttributes& self_attr,
                                 const RoleAttributes& opposite_attr,
                                 const MessageListener<MessageT>& listener) {
   // FIXME: make it more clean
-  auto listener_adapter = [listener, self_attr](
+  auto seq_tracker = std::make_shared<SeqTracker>();
+  auto listener_adapter = [this, listener, self_attr, seq_tracker](
                                      const std::shared_ptr<ReadableBlock>& rb,
                                      const MessageInfo& msg_info) {
-    auto msg = std::make_shared<MessageT>();
-    RETURN_IF(!message::ParseFromArray(
-        rb->buf, static_cast<int>(rb->block->msg_size()), msg.get()));
+    RETURN_IF(!this->CheckSeq(self_attr, seq_tracker.get(), msg_info));
+    auto msg = this->ParseMessage<MessageT>(self_attr.channel_id(), rb);
+    RETURN_IF(msg == nullptr);
 
     auto send_time = msg_info.send_time();
     auto msg_seq_num = msg_info.msg_seq_num();
@@ -156,6 +218,60 @@ void ShmDispatcher::AddListener(const RoleAttributes& self_attr,
   AddSegment(self_attr);
 }
 
+template <typename MessageT>
+typename std::enable_if<!message::IsZeroCopy<MessageT>::value,
+                        std::shared_ptr<MessageT>>::type
+ShmDispatcher::ParseMessage(uint64_t channel_id,
+                            const std::shared_ptr<ReadableBlock>& rb) {
+  (void)channel_id;
+  auto msg = std::make_shared<MessageT>();
+  if (!message::ParseFromArray(
+          rb->buf, static_cast<int>(rb->block->msg_size()), msg.get())) {
+    return nullptr;
+  }
+  return msg;
+}
+
+template <typename MessageT>
+typename std::enable_if<message::IsZeroCopy<MessageT>::value,
+                        std::shared_ptr<MessageT>>::type
+ShmDispatcher::ParseMessage(uint64_t channel_id,
+                            const std::shared_ptr<ReadableBlock>& rb) {
+  if (rb->block->msg_size() != sizeof(MessageT)) {
+    return nullptr;
+  }
+
+  // The view locks the whole block, the message is where rb points, also for
+  // a record of a batch block. Beyond the loans a segment grants, it is
+  // copied.
+  SegmentPtr segment = nullptr;
+  {
+    ReadLockGuard<AtomicRWLock> lock(segments_lock_);
+    auto iter = segments_.find(channel_id);
+    if (iter != segments_.end()) {
+      segment = iter->second;
+    }
+  }
+  if (segment != nullptr &&
+      reinterpret_cast<std::uintptr_t>(rb->buf) % alignof(MessageT) == 0) {
+    ReadableBlock view;
+    view.index = rb->index;
+    if (segment->AcquireLoanedBlockToRead(&view)) {
+      return std::shared_ptr<MessageT>(
+          reinterpret_cast<MessageT*>(rb->buf),
+          [segment, view](MessageT*) { segment->ReleaseLoanedReadBlock(view); });
+    }
+  }
+
+  // fall back to a copy
+  auto msg = std::make_shared<MessageT>();
+  if (!message::ParseFromArray(
+          rb->buf, static_cast<int>(rb->block->msg_size()), msg.get())) {
+    return nullptr;
+  }
+  return msg;
+}
+
 }  // namespace transport
 }  // namespace cyber
 }  // namespace apollo
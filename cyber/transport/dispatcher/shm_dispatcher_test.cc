@@ -16,9 +16,21 @@
 
 #include "cyber/transport/dispatcher/shm_dispatcher.h"
 
+#include <stdlib.h>
+
+#include <chrono>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 #include "gtest/gtest.h"
 
+#include "cyber/proto/cyber_conf.pb.h"
+
+#include "cyber/common/environment.h"
+#include "cyber/common/file.h"
 #include "cyber/common/global_data.h"
 #include "cyber/common/log.h"
 #include "cyber/common/util.h"
@@ -26,12 +38,40 @@
 #include "cyber/message/raw_message.h"
 #include "cyber/proto/unit_test.pb.h"
 #include "cyber/transport/common/identity.h"
+#include "cyber/transport/shm/shm_conf.h"
 #include "cyber/transport/transport.h"
 
 namespace apollo {
 namespace cyber {
 namespace transport {
 
+// the test runs with this many dispatch threads, see main
+constexpr uint32_t kDispatchThreads = 2;
+
+namespace {
+
+RoleAttributes ChannelAttr(const std::string& channel_name) {
+  RoleAttributes attr;
+  attr.set_host_name(common::GlobalData::Instance()->HostName());
+  attr.set_host_ip(common::GlobalData::Instance()->HostIp());
+  attr.set_channel_name(channel_name);
+  attr.set_channel_id(common::Hash(channel_name));
+  Identity id;
+  attr.set_id(id.HashValue());
+  return attr;
+}
+
+// waits up to 10s
+template <typename Predicate>
+bool WaitFor(Predicate predicate) {
+  for (int i = 0; i < 1000 && !predicate(); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return predicate();
+}
+
+}  // namespace
+
 TEST(ShmDispatcherTest, add_listener) {
   auto dispatcher = ShmDispatcher::Instance();
   RoleAttributes self_attr;
@@ -95,6 +135,139 @@ TEST(ShmDispatcherTest, on_message) {
   EXPECT_EQ(recv_msg->message, send_msg->message);
 }
 
+TEST(ShmDispatcherTest, keep_order_of_channel) {
+  auto dispatcher = ShmDispatcher::Instance();
+  constexpr int kChannelNum = 4;
+  constexpr int kMsgNum = 200;
+
+  std::mutex mutex;
+  std::vector<std::vector<int>> received(kChannelNum);
+  std::vector<std::shared_ptr<Transmitter<message::RawMessage>>> transmitters;
+  std::vector<uint64_t> channel_ids;
+  for (int i = 0; i < kChannelNum; ++i) {
+    auto attr = ChannelAttr("keep_order_" + std::to_string(i));
+    channel_ids.push_back(attr.channel_id());
+    dispatcher->AddListener<message::RawMessage>(
+        attr, [&mutex, &received, i](
+                  const std::shared_ptr<message::RawMessage>& msg,
+                  const MessageInfo&) {
+          std::lock_guard<std::mutex> lock(mutex);
+          received[i].push_back(std::stoi(msg->message));
+        });
+    auto transmitter =
+        Transport::Instance()->CreateTransmitter<message::RawMessage>(
+            ChannelAttr(attr.channel_name()), proto::OptionalMode::SHM);
+    ASSERT_NE(transmitter, nullptr);
+    transmitters.push_back(transmitter);
+  }
+  // the channels are spread over the dispatch threads
+  bool sharded = false;
+  for (auto channel_id : channel_ids) {
+    sharded |= channel_id % kDispatchThreads !=
+               channel_ids.front() % kDispatchThreads;
+  }
+  EXPECT_TRUE(sharded);
+
+  for (int j = 0; j < kMsgNum; ++j) {
+    for (auto& transmitter : transmitters) {
+      transmitter->Transmit(
+          std::make_shared<message::RawMessage>(std::to_string(j)));
+    }
+  }
+  EXPECT_TRUE(WaitFor([&]() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& msgs : received) {
+      if (msgs.size() < kMsgNum) {
+        return false;
+      }
+    }
+    return true;
+  }));
+
+  std::vector<int> expected;
+  for (int j = 0; j < kMsgNum; ++j) {
+    expected.push_back(j);
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  for (int i = 0; i < kChannelNum; ++i) {
+    EXPECT_EQ(received[i], expected);
+    EXPECT_EQ(dispatcher->PendingNum(channel_ids[i]), 0U);
+    EXPECT_EQ(dispatcher->ReplacedNum(channel_ids[i]), 0U);
+  }
+}
+
+TEST(ShmDispatcherTest, skip_replaced_block) {
+  auto dispatcher = ShmDispatcher::Instance();
+
+  // a handler of another channel holds the dispatch thread of the channel
+  auto blocker_attr = ChannelAttr("replaced_blocker");
+  std::string channel_name;
+  for (int i = 0; channel_name.empty(); ++i) {
+    std::string name = "replaced_" + std::to_string(i);
+    if (common::Hash(name) % kDispatchThreads ==
+        blocker_attr.channel_id() % kDispatchThreads) {
+      channel_name = name;
+    }
+  }
+  auto attr = ChannelAttr(channel_name);
+
+  std::promise<void> blocked;
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  dispatcher->AddListener<message::RawMessage>(
+      blocker_attr,
+      [&blocked, released](const std::shared_ptr<message::RawMessage>&,
+                           const MessageInfo&) {
+        blocked.set_value();
+        released.wait();
+      });
+  std::mutex mutex;
+  std::vector<int> received;
+  dispatcher->AddListener<message::RawMessage>(
+      attr, [&mutex, &received](const std::shared_ptr<message::RawMessage>& msg,
+                                const MessageInfo&) {
+        std::lock_guard<std::mutex> lock(mutex);
+        received.push_back(std::stoi(msg->message));
+      });
+
+  auto blocker = Transport::Instance()->CreateTransmitter<message::RawMessage>(
+      ChannelAttr(blocker_attr.channel_name()), proto::OptionalMode::SHM);
+  auto transmitter =
+      Transport::Instance()->CreateTransmitter<message::RawMessage>(
+          ChannelAttr(channel_name), proto::OptionalMode::SHM);
+  ASSERT_NE(blocker, nullptr);
+  ASSERT_NE(transmitter, nullptr);
+  blocker->Transmit(std::make_shared<message::RawMessage>("block"));
+  ASSERT_EQ(std::future_status::ready,
+            blocked.get_future().wait_for(std::chrono::seconds(10)));
+
+  // every block of the channel is written twice before its first index is
+  // read: the first visit of a block reads its second message, the second
+  // visit is skipped
+  const int block_num = static_cast<int>(ShmConf(1).block_num());
+  for (int j = 0; j < 2 * block_num; ++j) {
+    transmitter->Transmit(
+        std::make_shared<message::RawMessage>(std::to_string(j)));
+  }
+  EXPECT_TRUE(WaitFor([&]() {
+    return dispatcher->PendingNum(attr.channel_id()) ==
+           static_cast<uint64_t>(2 * block_num);
+  }));
+  release.set_value();
+
+  EXPECT_TRUE(WaitFor([&]() {
+    return dispatcher->PendingNum(attr.channel_id()) == 0;
+  }));
+  std::vector<int> expected;
+  for (int j = block_num; j < 2 * block_num; ++j) {
+    expected.push_back(j);
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  EXPECT_EQ(received, expected);
+  EXPECT_EQ(dispatcher->ReplacedNum(attr.channel_id()),
+            static_cast<uint64_t>(block_num));
+}
+
 TEST(ShmDispatcherTest, shutdown) {
   auto dispatcher = ShmDispatcher::Instance();
   dispatcher->Shutdown();
@@ -109,6 +282,23 @@ TEST(ShmDispatcherTest, shutdown) {
 
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
+  // a copy of the cyber config with several shm dispatch threads
+  namespace common = apollo::cyber::common;
+  char work_root[] = "/tmp/shm_dispatcher_test_XXXXXX";
+  if (mkdtemp(work_root) == nullptr) {
+    return -1;
+  }
+  std::string conf_dir = std::string(work_root) + "/conf";
+  common::CopyDir(common::WorkRoot() + "/conf", conf_dir);
+  apollo::cyber::proto::CyberConfig config;
+  common::GetProtoFromFile(conf_dir + "/cyber.pb.conf", &config);
+  config.mutable_transport_conf()->mutable_shm_conf()->set_dispatch_threads(
+      apollo::cyber::transport::kDispatchThreads);
+  common::EnsureDirectory(conf_dir);
+  if (!common::SetProtoToASCIIFile(config, conf_dir + "/cyber.pb.conf")) {
+    return -1;
+  }
+  setenv("CYBER_PATH", work_root, 1);
   apollo::cyber::Init(argv[0]);
   apollo::cyber::transport::Transport::Instance();
   auto res = RUN_ALL_TESTS();
@@ -149,6 +149,65 @@ TEST_F(ShmTransceiverTest, enable_and_disable) {
   EXPECT_EQ(msgs.size(), 0);
 }
 
+struct PodMessage {
+  uint64_t timestamp;
+  uint32_t points[1024];
+};
+
+TEST_F(ShmTransceiverTest, loan_and_publish) {
+  RoleAttributes attr;
+  attr.set_host_name(common::GlobalData::Instance()->HostName());
+  attr.set_host_ip(common::GlobalData::Instance()->HostIp());
+  attr.set_channel_name("shm_loan_channel");
+  attr.set_channel_id(common::Hash("shm_loan_channel"));
+
+  std::shared_ptr<Transmitter<PodMessage>> transmitter =
+      std::make_shared<ShmTransmitter<PodMessage>>(attr);
+  LoanedMessage<PodMessage> loaned;
+  // not enabled yet
+  EXPECT_FALSE(transmitter->Loan(&loaned));
+  EXPECT_FALSE(loaned.IsValid());
+  transmitter->Enable();
+
+  std::vector<std::shared_ptr<PodMessage>> msgs;
+  auto receiver = std::make_shared<ShmReceiver<PodMessage>>(
+      attr, [&msgs](const std::shared_ptr<PodMessage>& msg,
+                    const MessageInfo& msg_info, const RoleAttributes& attr) {
+        (void)msg_info;
+        (void)attr;
+        msgs.emplace_back(msg);
+      });
+  receiver->Enable();
+
+  EXPECT_TRUE(transmitter->Loan(&loaned));
+  ASSERT_TRUE(loaned.IsValid());
+  loaned->timestamp = 12345;
+  loaned->points[1023] = 1023;
+  EXPECT_TRUE(transmitter->Publish(&loaned));
+  EXPECT_FALSE(loaned.IsValid());
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  ASSERT_EQ(msgs.size(), 1);
+  EXPECT_EQ(msgs[0]->timestamp, 12345);
+  EXPECT_EQ(msgs[0]->points[1023], 1023);
+
+  // an unpublished loan gives its block back
+  EXPECT_TRUE(transmitter->Loan(&loaned));
+  loaned.Reset();
+  EXPECT_FALSE(loaned.IsValid());
+
+  // copying transmit still works for zero-copy types
+  auto msg = std::make_shared<PodMessage>();
+  msg->timestamp = 54321;
+  EXPECT_TRUE(transmitter->Transmit(msg));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  ASSERT_EQ(msgs.size(), 2);
+  EXPECT_EQ(msgs[1]->timestamp, 54321);
+
+  msgs.clear();
+  receiver->Disable();
+  transmitter->Disable();
+}
+
 }  // namespace transport
 }  // namespace cyber
 }  // namespace apollo
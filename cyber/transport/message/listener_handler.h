@@ -17,12 +17,15 @@
 #ifndef CYBER_TRANSPORT_MESSAGE_LISTENER_HANDLER_H_
 #define CYBER_TRANSPORT_MESSAGE_LISTENER_HANDLER_H_
 
+#include <atomic>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 
 #include "cyber/base/atomic_rw_lock.h"
+#include "cyber/base/rcu.h"
 #include "cyber/base/signal.h"
 #include "cyber/common/log.h"
 #include "cyber/message/message_traits.h"
@@ -67,7 +70,7 @@ class ListenerHandler : public ListenerHandlerBase {
   using ConnectionMap = std::unordered_map<uint64_t, MessageConnection>;
 
   ListenerHandler() {}
-  virtual ~ListenerHandler() {}
+  virtual ~ListenerHandler() { delete signals_.load(); }
 
   void Connect(uint64_t self_id, const Listener& listener);
   void Connect(uint64_t self_id, uint64_t oppo_id, const Listener& listener);
@@ -86,12 +89,14 @@ class ListenerHandler : public ListenerHandlerBase {
   MessageSignal signal_;
   ConnectionMap signal_conns_;  // key: self_id
 
-  // used for self_id and oppo_id
-  MessageSignalMap signals_;  // key: oppo_id
+  // used for self_id and oppo_id, key: oppo_id. Only ever grows and is
+  // replaced as a whole, Run() reads it without lock.
+  std::atomic<MessageSignalMap*> signals_ = {nullptr};
   // key: oppo_id
   std::unordered_map<uint64_t, ConnectionMap> signals_conns_;
 
-  base::AtomicRWLock rw_lock_;
+  // serializes Connect() and Disconnect()
+  std::mutex mutex_;
 };
 
 template <>
@@ -107,19 +112,30 @@ void ListenerHandler<MessageT>::Connect(uint64_t self_id,
     return;
   }
 
-  WriteLockGuard<AtomicRWLock> lock(rw_lock_);
+  std::lock_guard<std::mutex> lock(mutex_);
   signal_conns_[self_id] = connection;
 }
 
 template <typename MessageT>
 void ListenerHandler<MessageT>::Connect(uint64_t self_id, uint64_t oppo_id,
                                         const Listener& listener) {
-  WriteLockGuard<AtomicRWLock> lock(rw_lock_);
-  if (signals_.find(oppo_id) == signals_.end()) {
-    signals_[oppo_id] = std::make_shared<MessageSignal>();
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto signals = signals_.load();
+  SignalPtr signal;
+  if (signals != nullptr && signals->find(oppo_id) != signals->end()) {
+    signal = signals->at(oppo_id);
+  } else {
+    signal = std::make_shared<MessageSignal>();
+    auto new_signals = signals ? new MessageSignalMap(*signals)
+                               : new MessageSignalMap();
+    (*new_signals)[oppo_id] = signal;
+    signals_.store(new_signals);
+    if (signals != nullptr) {
+      base::Rcu::Instance()->Retire([signals]() { delete signals; });
+    }
   }
 
-  auto connection = signals_[oppo_id]->Connect(listener);
+  auto connection = signal->Connect(listener);
   if (!connection.IsConnected()) {
     AWARN << oppo_id << " " << self_id << " connect failed!";
     return;
@@ -134,7 +150,7 @@ void ListenerHandler<MessageT>::Connect(uint64_t self_id, uint64_t oppo_id,
 
 template <typename MessageT>
 void ListenerHandler<MessageT>::Disconnect(uint64_t self_id) {
-  WriteLockGuard<AtomicRWLock> lock(rw_lock_);
+  std::lock_guard<std::mutex> lock(mutex_);
   if (signal_conns_.find(self_id) == signal_conns_.end()) {
     return;
   }
@@ -145,7 +161,7 @@ void ListenerHandler<MessageT>::Disconnect(uint64_t self_id) {
 
 template <typename MessageT>
 void ListenerHandler<MessageT>::Disconnect(uint64_t self_id, uint64_t oppo_id) {
-  WriteLockGuard<AtomicRWLock> lock(rw_lock_);
+  std::lock_guard<std::mutex> lock(mutex_);
   if (signals_conns_.find(oppo_id) == signals_conns_.end()) {
     return;
   }
@@ -162,13 +178,17 @@ template <typename MessageT>
 void ListenerHandler<MessageT>::Run(const Message& msg,
                                     const MessageInfo& msg_info) {
   signal_(msg, msg_info);
-  uint64_t oppo_id = msg_info.sender_id().HashValue();
-  ReadLockGuard<AtomicRWLock> lock(rw_lock_);
-  if (signals_.find(oppo_id) == signals_.end()) {
+  base::RcuReadGuard guard;
+  auto signals = signals_.load(std::memory_order_acquire);
+  if (signals == nullptr) {
+    return;
+  }
+  auto it = signals->find(msg_info.sender_id().HashValue());
+  if (it == signals->end()) {
     return;
   }
 
-  (*signals_[oppo_id])(msg, msg_info);
+  (*it->second)(msg, msg_info);
 }
 
 template <typename MessageT>
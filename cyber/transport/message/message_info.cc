@@ -27,6 +27,7 @@ namespace transport {
 const std::size_t MessageInfo::kSize = 2 * ID_SIZE + sizeof(uint64_t) + \
                                         sizeof(uint64_t) + sizeof(int32_t) + \
                                         sizeof(uint64_t);
+const std::size_t MessageInfo::kTraceSize = sizeof(uint64_t);
 
 MessageInfo::MessageInfo() : sender_id_(false), spare_id_(false) {}
 
@@ -41,7 +42,11 @@ MessageInfo::MessageInfo(const MessageInfo& another)
     : sender_id_(another.sender_id_),
       channel_id_(another.channel_id_),
       seq_num_(another.seq_num_),
-      spare_id_(another.spare_id_) {}
+      spare_id_(another.spare_id_),
+      msg_seq_num_(another.msg_seq_num_),
+      send_time_(another.send_time_),
+      origin_time_(another.origin_time_),
+      recv_time_(another.recv_time_) {}
 
 MessageInfo::~MessageInfo() {}
 
@@ -51,6 +56,10 @@ MessageInfo& MessageInfo::operator=(const MessageInfo& another) {
     channel_id_ = another.channel_id_;
     seq_num_ = another.seq_num_;
     spare_id_ = another.spare_id_;
+    msg_seq_num_ = another.msg_seq_num_;
+    send_time_ = another.send_time_;
+    origin_time_ = another.origin_time_;
+    recv_time_ = another.recv_time_;
   }
   return *this;
 }
@@ -78,11 +87,15 @@ bool MessageInfo::SerializeTo(std::string* dst) const {
     &msg_seq_num_), sizeof(msg_seq_num_));
   dst->append(reinterpret_cast<const char*>(
     &send_time_), sizeof(send_time_));
+  if (origin_time_ != 0) {
+    dst->append(reinterpret_cast<const char*>(
+      &origin_time_), sizeof(origin_time_));
+  }
   return true;
 }
 
 bool MessageInfo::SerializeTo(char* dst, std::size_t len) const {
-  if (dst == nullptr || len < kSize) {
+  if (dst == nullptr || len < ByteSize()) {
     return false;
   }
 
@@ -102,6 +115,11 @@ bool MessageInfo::SerializeTo(char* dst, std::size_t len) const {
   ptr += sizeof(msg_seq_num_);
   std::memcpy(ptr,
     reinterpret_cast<const char*>(&send_time_), sizeof(send_time_));
+  ptr += sizeof(send_time_);
+  if (origin_time_ != 0) {
+    std::memcpy(ptr,
+      reinterpret_cast<const char*>(&origin_time_), sizeof(origin_time_));
+  }
   return true;
 }
 
@@ -111,7 +129,7 @@ bool MessageInfo::DeserializeFrom(const std::string& src) {
 
 bool MessageInfo::DeserializeFrom(const char* src, std::size_t len) {
   RETURN_VAL_IF_NULL(src, false);
-  if (len != kSize) {
+  if (len != kSize && len != kSize + kTraceSize) {
     AWARN << "src size mismatch, given[" << len << "] target[" << kSize << "]";
     return false;
   }
@@ -132,6 +150,12 @@ bool MessageInfo::DeserializeFrom(const char* src, std::size_t len) {
   ptr += sizeof(msg_seq_num_);
   std::memcpy(
     reinterpret_cast<char*>(&send_time_), ptr, sizeof(send_time_));
+  ptr += sizeof(send_time_);
+  origin_time_ = 0;
+  if (len == kSize + kTraceSize) {
+    std::memcpy(
+      reinterpret_cast<char*>(&origin_time_), ptr, sizeof(origin_time_));
+  }
   return true;
 }
 
@@ -66,13 +66,32 @@ class MessageInfo {
   uint64_t send_time() const { return send_time_; }
   void set_send_time(uint64_t send_time) { send_time_ = send_time; }
 
+  // Trace stamps in nanosecond, only set in trace mode, see
+  // statistics::LatencyTracer. The origin time, the send time of the first
+  // message of a processing chain, is serialized behind the kSize bytes;
+  // the receive time is stamped by the reading process.
+  static const std::size_t kTraceSize;
+
+  uint64_t origin_time() const { return origin_time_; }
+  void set_origin_time(uint64_t origin_time) { origin_time_ = origin_time; }
+
+  uint64_t recv_time() const { return recv_time_; }
+  void set_recv_time(uint64_t recv_time) { recv_time_ = recv_time; }
+
+  // serialized size, kSize plus kTraceSize if traced
+  std::size_t ByteSize() const {
+    return origin_time_ == 0 ? kSize : kSize + kTraceSize;
+  }
+
  private:
   Identity sender_id_;
   uint64_t channel_id_ = 0;
   uint64_t seq_num_ = 0;
   Identity spare_id_;
-  int32_t msg_seq_num_;
-  uint64_t send_time_;
+  int32_t msg_seq_num_ = 0;
+  uint64_t send_time_ = 0;
+  uint64_t origin_time_ = 0;
+  uint64_t recv_time_ = 0;
 };
 
 }  // namespace transport
@@ -70,6 +70,39 @@ TEST(MessageInfoTest, test) {
   EXPECT_EQ(msgInfo3, msgInfo4);
 }
 
+TEST(MessageInfoTest, trace) {
+  Identity id;
+  MessageInfo msgInfo(id, 1);
+  msgInfo.set_send_time(200);
+  EXPECT_EQ(msgInfo.ByteSize(), MessageInfo::kSize);
+
+  msgInfo.set_origin_time(100);
+  msgInfo.set_recv_time(300);
+  EXPECT_EQ(msgInfo.ByteSize(), MessageInfo::kSize + MessageInfo::kTraceSize);
+
+  MessageInfo copied(msgInfo);
+  EXPECT_EQ(copied.send_time(), 200);
+  EXPECT_EQ(copied.origin_time(), 100);
+  EXPECT_EQ(copied.recv_time(), 300);
+
+  std::string msgStr;
+  EXPECT_TRUE(msgInfo.SerializeTo(&msgStr));
+  EXPECT_EQ(msgStr.size(), msgInfo.ByteSize());
+  EXPECT_FALSE(msgInfo.SerializeTo(const_cast<char*>(msgStr.data()),
+                                   MessageInfo::kSize));
+
+  // only the origin time crosses processes
+  MessageInfo parsed;
+  EXPECT_TRUE(parsed.DeserializeFrom(msgStr));
+  EXPECT_EQ(parsed.send_time(), 200);
+  EXPECT_EQ(parsed.origin_time(), 100);
+  EXPECT_EQ(parsed.recv_time(), 0);
+
+  // an untraced one resets it
+  EXPECT_TRUE(parsed.DeserializeFrom(msgStr.data(), MessageInfo::kSize));
+  EXPECT_EQ(parsed.origin_time(), 0);
+}
+
 }  // namespace transport
 }  // namespace cyber
 }  // namespace apollo
@@ -0,0 +1,58 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "cyber/transport/message/seq_tracker.h"
+
+namespace apollo {
+namespace cyber {
+namespace transport {
+
+bool SeqTracker::Check(const MessageInfo& msg_info, uint64_t* dropped) {
+  *dropped = 0;
+  uint64_t seq_num = msg_info.seq_num();
+  // not numbered by its transmitter
+  if (seq_num == 0) {
+    return true;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& last_seq = last_seqs_[msg_info.sender_id().HashValue()];
+  if (last_seq != 0 && seq_num <= last_seq) {
+    ++skipped_;
+    return false;
+  }
+  // the first message of a sender may be late joined, it is no gap
+  if (last_seq != 0 && seq_num > last_seq + 1) {
+    *dropped = seq_num - last_seq - 1;
+    dropped_ += *dropped;
+  }
+  last_seq = seq_num;
+  return true;
+}
+
+uint64_t SeqTracker::dropped() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return dropped_;
+}
+
+uint64_t SeqTracker::skipped() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return skipped_;
+}
+
+}  // namespace transport
+}  // namespace cyber
+}  // namespace apollo
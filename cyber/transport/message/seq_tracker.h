@@ -0,0 +1,58 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#ifndef CYBER_TRANSPORT_MESSAGE_SEQ_TRACKER_H_
+#define CYBER_TRANSPORT_MESSAGE_SEQ_TRACKER_H_
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+#include "cyber/transport/message/message_info.h"
+
+namespace apollo {
+namespace cyber {
+namespace transport {
+
+// Follows the seq_num of every sender seen by one reader. A gap means the
+// messages in between were dropped, e.g. their shm block was overwritten
+// before it was read; a seq_num not above the last one is a message read
+// twice, or read after a newer one.
+class SeqTracker {
+ public:
+  SeqTracker() = default;
+  virtual ~SeqTracker() = default;
+
+  // @param dropped set to the messages missed right before this one
+  // @return false if the message was seen already and must be skipped
+  bool Check(const MessageInfo& msg_info, uint64_t* dropped);
+
+  uint64_t dropped() const;
+  uint64_t skipped() const;
+
+ private:
+  // key: hash value of the sender id
+  std::unordered_map<uint64_t, uint64_t> last_seqs_;
+  uint64_t dropped_ = 0;
+  uint64_t skipped_ = 0;
+  mutable std::mutex mutex_;
+};
+
+}  // namespace transport
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_TRANSPORT_MESSAGE_SEQ_TRACKER_H_
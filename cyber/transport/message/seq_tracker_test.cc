@@ -0,0 +1,65 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "cyber/transport/message/seq_tracker.h"
+
+#include "gtest/gtest.h"
+
+namespace apollo {
+namespace cyber {
+namespace transport {
+
+TEST(SeqTrackerTest, gap_and_duplicate) {
+  SeqTracker tracker;
+  Identity sender;
+  uint64_t dropped = 0;
+
+  EXPECT_TRUE(tracker.Check(MessageInfo(sender, 5), &dropped));
+  EXPECT_EQ(dropped, 0);
+  EXPECT_TRUE(tracker.Check(MessageInfo(sender, 6), &dropped));
+  EXPECT_EQ(dropped, 0);
+  EXPECT_TRUE(tracker.Check(MessageInfo(sender, 10), &dropped));
+  EXPECT_EQ(dropped, 3);
+
+  EXPECT_FALSE(tracker.Check(MessageInfo(sender, 10), &dropped));
+  EXPECT_FALSE(tracker.Check(MessageInfo(sender, 8), &dropped));
+  EXPECT_EQ(dropped, 0);
+
+  EXPECT_EQ(tracker.dropped(), 3);
+  EXPECT_EQ(tracker.skipped(), 2);
+}
+
+TEST(SeqTrackerTest, senders_are_independent) {
+  SeqTracker tracker;
+  Identity sender1;
+  Identity sender2;
+  uint64_t dropped = 0;
+
+  EXPECT_TRUE(tracker.Check(MessageInfo(sender1, 1), &dropped));
+  EXPECT_TRUE(tracker.Check(MessageInfo(sender2, 1), &dropped));
+  EXPECT_TRUE(tracker.Check(MessageInfo(sender1, 2), &dropped));
+  EXPECT_TRUE(tracker.Check(MessageInfo(sender2, 2), &dropped));
+  EXPECT_EQ(tracker.dropped(), 0);
+
+  // unnumbered messages are not tracked
+  EXPECT_TRUE(tracker.Check(MessageInfo(sender1, 0), &dropped));
+  EXPECT_TRUE(tracker.Check(MessageInfo(sender1, 0), &dropped));
+  EXPECT_EQ(tracker.skipped(), 0);
+}
+
+}  // namespace transport
+}  // namespace cyber
+}  // namespace apollo
@@ -20,6 +20,8 @@
 #include <functional>
 #include <memory>
 
+#include "cyber/statistics/latency_tracer.h"
+#include "cyber/time/time.h"
 #include "cyber/transport/common/endpoint.h"
 #include "cyber/transport/message/history.h"
 #include "cyber/transport/message/message_info.h"
@@ -60,9 +62,16 @@ Receiver<M>::~Receiver() {}
 template <typename M>
 void Receiver<M>::OnNewMessage(const MessagePtr& msg,
                                const MessageInfo& msg_info) {
-  if (msg_listener_ != nullptr) {
-    msg_listener_(msg, msg_info, attr_);
+  if (msg_listener_ == nullptr) {
+    return;
   }
+  if (statistics::LatencyTracer::Instance()->enabled()) {
+    MessageInfo traced_info(msg_info);
+    traced_info.set_recv_time(Time::Now().ToNanosecond());
+    msg_listener_(msg, traced_info, attr_);
+    return;
+  }
+  msg_listener_(msg, msg_info, attr_);
 }
 
 }  // namespace transport
@@ -39,6 +39,10 @@ class Block {
     msg_info_size_ = msg_info_size;
   }
 
+  // 1 + the State seq it was written at, 0 if it has never been written
+  uint64_t seq() const { return seq_.load(std::memory_order_acquire); }
+  void set_seq(uint64_t seq) { seq_.store(seq, std::memory_order_release); }
+
   static const int32_t kRWLockFree;
   static const int32_t kWriteExclusive;
   static const int32_t kMaxTryLockTimes;
@@ -53,6 +57,7 @@ class Block {
 
   uint64_t msg_size_;
   uint64_t msg_info_size_;
+  std::atomic<uint64_t> seq_ = {0};
 };
 
 }  // namespace transport
@@ -0,0 +1,82 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#ifndef CYBER_TRANSPORT_SHM_FUTEX_NOTIFIER_H_
+#define CYBER_TRANSPORT_SHM_FUTEX_NOTIFIER_H_
+
+#include <sys/types.h>
+#include <atomic>
+#include <cstdint>
+
+#include "cyber/common/macros.h"
+#include "cyber/transport/shm/notifier_base.h"
+
+namespace apollo {
+namespace cyber {
+namespace transport {
+
+/**
+ * @brief Same ring layout as ConditionNotifier, but listeners block on a
+ * futex word that lives in the shared segment instead of polling it, so a
+ * Notify wakes every listening process directly and idle listeners cost no
+ * cpu.
+ */
+class FutexNotifier : public NotifierBase {
+  static const uint32_t kBufLength = 4096;
+
+  struct Indicator {
+    std::atomic<uint64_t> next_seq = {0};
+    // bumped after a slot is published, used as the futex word
+    std::atomic<uint32_t> futex = {0};
+    // number of listeners sleeping in FUTEX_WAIT, lets Notify skip the syscall
+    std::atomic<uint32_t> waiters = {0};
+    ReadableInfo infos[kBufLength];
+    uint64_t seqs[kBufLength] = {0};
+  };
+
+ public:
+  virtual ~FutexNotifier();
+
+  void Shutdown() override;
+  bool Notify(const ReadableInfo& info) override;
+  bool Listen(int timeout_ms, ReadableInfo* info) override;
+
+  static const char* Type() { return "futex"; }
+
+ private:
+  bool Init();
+  bool OpenOrCreate();
+  bool OpenOnly();
+  bool Remove();
+  void Reset();
+  bool TryRead(ReadableInfo* info);
+  void Wake();
+
+  key_t key_ = 0;
+  void* managed_shm_ = nullptr;
+  size_t shm_size_ = 0;
+  Indicator* indicator_ = nullptr;
+  uint64_t next_seq_ = 0;
+  std::atomic<bool> is_shutdown_ = {false};
+
+  DECLARE_SINGLETON(FutexNotifier)
+};
+
+}  // namespace transport
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_TRANSPORT_SHM_FUTEX_NOTIFIER_H_
@@ -0,0 +1,111 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#ifndef CYBER_TRANSPORT_SHM_LOANED_MESSAGE_H_
+#define CYBER_TRANSPORT_SHM_LOANED_MESSAGE_H_
+
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "cyber/message/message_traits.h"
+#include "cyber/transport/shm/segment.h"
+
+namespace apollo {
+namespace cyber {
+namespace transport {
+
+template <typename M>
+class ShmTransmitter;
+
+/**
+ * @class LoanedMessage
+ * @brief A message constructed in place inside a write-locked shm block.
+ * It is move-only, the block is handed to the readers by publishing it and
+ * is given back to the segment, unpublished, when the loan is destroyed.
+ *
+ * @tparam M a zero-copy message type, see message::IsZeroCopy
+ */
+template <typename M>
+class LoanedMessage {
+ public:
+  LoanedMessage() = default;
+  ~LoanedMessage() { Reset(); }
+
+  LoanedMessage(const LoanedMessage&) = delete;
+  LoanedMessage& operator=(const LoanedMessage&) = delete;
+
+  LoanedMessage(LoanedMessage&& other) noexcept { *this = std::move(other); }
+  LoanedMessage& operator=(LoanedMessage&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      segment_ = std::move(other.segment_);
+      block_ = other.block_;
+      msg_ = other.msg_;
+      other.segment_ = nullptr;
+      other.msg_ = nullptr;
+    }
+    return *this;
+  }
+
+  bool IsValid() const { return msg_ != nullptr; }
+
+  M* get() const { return msg_; }
+  M* operator->() const { return msg_; }
+  M& operator*() const { return *msg_; }
+
+  /**
+   * @brief Give the block back without publishing it
+   */
+  void Reset() {
+    if (segment_ != nullptr) {
+      segment_->ReleaseLoanedWrittenBlock(block_);
+    }
+    segment_ = nullptr;
+    msg_ = nullptr;
+  }
+
+ private:
+  friend class ShmTransmitter<M>;
+
+  LoanedMessage(const SegmentPtr& segment, const WritableBlock& block)
+      : segment_(segment), block_(block) {
+    msg_ = Construct(block_.buf);
+  }
+
+  template <typename T = M>
+  static typename std::enable_if<message::IsZeroCopy<T>::value, T*>::type
+  Construct(void* buf) {
+    return new (buf) T();
+  }
+
+  template <typename T = M>
+  static typename std::enable_if<!message::IsZeroCopy<T>::value, T*>::type
+  Construct(void* buf) {
+    (void)buf;
+    return nullptr;
+  }
+
+  SegmentPtr segment_ = nullptr;
+  WritableBlock block_;
+  M* msg_ = nullptr;
+};
+
+}  // namespace transport
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_TRANSPORT_SHM_LOANED_MESSAGE_H_
@@ -0,0 +1,53 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "cyber/transport/shm/message_batch.h"
+
+namespace apollo {
+namespace cyber {
+namespace transport {
+
+const uint64_t MessageBatch::kFlag = UINT64_MAX;
+// the smallest size class of ShmConf, a batch fits any segment itself
+const std::size_t MessageBatch::kMaxBytes = 16 * 1024;
+
+bool MessageBatch::ForEach(const uint8_t* buf, uint64_t size,
+                           const RecordHandler& handler) {
+  uint64_t offset = 0;
+  while (offset < size) {
+    if (size - offset < sizeof(RecordHeader)) {
+      return false;
+    }
+    RecordHeader header;
+    std::memcpy(&header, buf + offset, sizeof(header));
+    offset += sizeof(header);
+    uint64_t record_size =
+        static_cast<uint64_t>(header.msg_size) + header.msg_info_size;
+    if (size - offset < record_size) {
+      return false;
+    }
+    const uint8_t* msg = buf + offset;
+    handler(msg, header.msg_size,
+            reinterpret_cast<const char*>(msg) + header.msg_size,
+            header.msg_info_size);
+    offset += record_size;
+  }
+  return true;
+}
+
+}  // namespace transport
+}  // namespace cyber
+}  // namespace apollo
@@ -0,0 +1,124 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#ifndef CYBER_TRANSPORT_SHM_MESSAGE_BATCH_H_
+#define CYBER_TRANSPORT_SHM_MESSAGE_BATCH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include "cyber/message/message_traits.h"
+#include "cyber/transport/message/message_info.h"
+#include "cyber/transport/shm/block.h"
+
+namespace apollo {
+namespace cyber {
+namespace transport {
+
+/**
+ * @class MessageBatch
+ * @brief Several small messages packed by a batching ShmTransmitter into one
+ * block, published with a single notification.
+ *
+ * A batch block has kFlag as msg_info_size and the size of the packed records
+ * as msg_size, each record is a RecordHeader followed by the serialized
+ * message and its MessageInfo.
+ */
+class MessageBatch {
+ public:
+  struct RecordHeader {
+    uint32_t msg_size;
+    uint32_t msg_info_size;
+  };
+
+  // called for every record, in the order they were appended
+  using RecordHandler =
+      std::function<void(const uint8_t* msg, uint32_t msg_size,
+                         const char* msg_info, uint32_t msg_info_size)>;
+
+  static const uint64_t kFlag;
+  // larger messages are not worth batching and are sent on their own
+  static const std::size_t kMaxBytes;
+
+  MessageBatch() = default;
+
+  static bool IsBatch(const Block* block) {
+    return block->msg_info_size() == kFlag;
+  }
+
+  static std::size_t RecordSize(std::size_t msg_size,
+                                std::size_t msg_info_size) {
+    return sizeof(RecordHeader) + msg_size + msg_info_size;
+  }
+
+  /**
+   * @brief Walk the records of a batch block
+   *
+   * @return false if the records are malformed, the ones before are handled
+   */
+  static bool ForEach(const uint8_t* buf, uint64_t size,
+                      const RecordHandler& handler);
+
+  template <typename M>
+  bool Append(const M& msg, std::size_t msg_size,
+              const MessageInfo& msg_info);
+
+  void Clear() {
+    buf_.clear();
+    count_ = 0;
+  }
+
+  bool Empty() const { return count_ == 0; }
+  uint32_t Count() const { return count_; }
+  std::size_t ByteSize() const { return buf_.size(); }
+  const uint8_t* Data() const { return buf_.data(); }
+
+ private:
+  std::vector<uint8_t> buf_;
+  uint32_t count_ = 0;
+};
+
+template <typename M>
+bool MessageBatch::Append(const M& msg, std::size_t msg_size,
+                          const MessageInfo& msg_info) {
+  std::size_t offset = buf_.size();
+  std::size_t msg_info_size = msg_info.ByteSize();
+  buf_.resize(offset + RecordSize(msg_size, msg_info_size));
+
+  RecordHeader header;
+  header.msg_size = static_cast<uint32_t>(msg_size);
+  header.msg_info_size = static_cast<uint32_t>(msg_info_size);
+  std::memcpy(buf_.data() + offset, &header, sizeof(header));
+
+  uint8_t* msg_addr = buf_.data() + offset + sizeof(header);
+  if (!message::SerializeToArray(msg, msg_addr, static_cast<int>(msg_size)) ||
+      !msg_info.SerializeTo(reinterpret_cast<char*>(msg_addr) + msg_size,
+                            msg_info_size)) {
+    buf_.resize(offset);
+    return false;
+  }
+  ++count_;
+  return true;
+}
+
+}  // namespace transport
+}  // namespace cyber
+}  // namespace apollo
+
+#endif  // CYBER_TRANSPORT_SHM_MESSAGE_BATCH_H_
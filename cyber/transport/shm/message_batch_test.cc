@@ -0,0 +1,89 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "cyber/transport/shm/message_batch.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "cyber/proto/unit_test.pb.h"
+#include "cyber/transport/common/identity.h"
+
+namespace apollo {
+namespace cyber {
+namespace transport {
+
+TEST(MessageBatchTest, append_and_for_each) {
+  MessageBatch batch;
+  EXPECT_TRUE(batch.Empty());
+
+  Identity sender;
+  std::vector<MessageInfo> infos;
+  for (uint64_t i = 0; i < 3; ++i) {
+    proto::Chatter chatter;
+    chatter.set_seq(i);
+    chatter.set_content(std::string(i * 10, 'a'));
+    MessageInfo info(sender, i + 1);
+    info.set_send_time(i * 100);
+    infos.push_back(info);
+    EXPECT_TRUE(batch.Append(chatter, chatter.ByteSizeLong(), info));
+  }
+  EXPECT_EQ(batch.Count(), 3);
+
+  std::vector<proto::Chatter> chatters;
+  std::vector<MessageInfo> parsed_infos;
+  auto handler = [&](const uint8_t* msg, uint32_t msg_size,
+                     const char* msg_info, uint32_t msg_info_size) {
+    proto::Chatter chatter;
+    EXPECT_TRUE(chatter.ParseFromArray(msg, msg_size));
+    chatters.push_back(chatter);
+    MessageInfo info;
+    EXPECT_TRUE(info.DeserializeFrom(msg_info, msg_info_size));
+    parsed_infos.push_back(info);
+  };
+  EXPECT_TRUE(MessageBatch::ForEach(batch.Data(), batch.ByteSize(), handler));
+  ASSERT_EQ(chatters.size(), 3);
+  for (uint64_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(chatters[i].seq(), i);
+    EXPECT_EQ(chatters[i].content().size(), i * 10);
+    EXPECT_EQ(parsed_infos[i], infos[i]);
+    EXPECT_EQ(parsed_infos[i].send_time(), i * 100);
+  }
+
+  // a truncated batch stops at the last complete record
+  chatters.clear();
+  EXPECT_FALSE(
+      MessageBatch::ForEach(batch.Data(), batch.ByteSize() - 1, handler));
+  EXPECT_EQ(chatters.size(), 2);
+
+  batch.Clear();
+  EXPECT_TRUE(batch.Empty());
+  EXPECT_EQ(batch.ByteSize(), 0);
+}
+
+TEST(MessageBatchTest, is_batch) {
+  Block block;
+  block.set_msg_info_size(MessageInfo::kSize);
+  EXPECT_FALSE(MessageBatch::IsBatch(&block));
+  block.set_msg_info_size(MessageBatch::kFlag);
+  EXPECT_TRUE(MessageBatch::IsBatch(&block));
+}
+
+}  // namespace transport
+}  // namespace cyber
+}  // namespace apollo
@@ -31,7 +31,7 @@ namespace cyber {
 namespace transport {
 
 PosixSegment::PosixSegment(uint64_t channel_id) : Segment(channel_id) {
-  shm_name_ = std::to_string(channel_id);
+  shm_name_ = std::to_string(SegmentKey(channel_id));
 }
 
 PosixSegment::~PosixSegment() { Destroy(); }
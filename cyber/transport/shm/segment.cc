@@ -16,14 +16,48 @@
 
 #include "cyber/transport/shm/segment.h"
 
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "cyber/common/global_data.h"
 #include "cyber/common/log.h"
 #include "cyber/common/util.h"
+#include "cyber/transport/shm/segment_factory.h"
 #include "cyber/transport/shm/shm_conf.h"
 
 namespace apollo {
 namespace cyber {
 namespace transport {
 
+using common::GlobalData;
+
+namespace {
+
+// writers of one channel in a process share the exposed counters, a second
+// bvar of the same name would fail to expose
+std::shared_ptr<::bvar::Adder<uint64_t>> ChannelAdder(
+    const std::string& channel_name, const std::string& name) {
+  static std::mutex mutex;
+  static std::unordered_map<std::string,
+                            std::weak_ptr<::bvar::Adder<uint64_t>>>
+      adders;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& weak = adders[channel_name + "_" + name];
+  auto adder = weak.lock();
+  if (adder == nullptr) {
+    adder = std::make_shared<::bvar::Adder<uint64_t>>(channel_name, name);
+    weak = adder;
+  }
+  return adder;
+}
+
+}  // namespace
+
 Segment::Segment(uint64_t channel_id)
     : init_(false),
       conf_(),
@@ -34,40 +68,44 @@ Segment::Segment(uint64_t channel_id)
       block_buf_lock_(),
       block_buf_addrs_() {}
 
+const uint32_t Segment::kArenaShift = 28;
+const uint32_t Segment::kLoanedReadDivisor = 4;
+
 bool Segment::AcquireBlockToWrite(std::size_t msg_size,
                                   WritableBlock* writable_block) {
   RETURN_VAL_IF_NULL(writable_block, false);
-  if (!init_ && !OpenOrCreate()) {
-    AERROR << "create shm failed, can't write now.";
-    return false;
-  }
-
-  bool result = true;
-  if (state_->need_remap()) {
-    result = Remap();
+  if (!init_) {
+    // sized for the first message unless it exists already
+    conf_.Update(msg_size);
+    if (!OpenOrCreate()) {
+      AERROR << "create shm failed, can't write now.";
+      return false;
+    }
   }
 
   if (msg_size > conf_.ceiling_msg_size()) {
-    AINFO << "msg_size: " << msg_size
-          << " larger than current shm_buffer_size: "
-          << conf_.ceiling_msg_size() << " , need recreate.";
-    result = Recreate(msg_size);
-  }
-
-  if (!result) {
-    AERROR << "segment update failed.";
-    return false;
+    return AcquireArenaBlockToWrite(msg_size, writable_block);
   }
 
   uint32_t index = GetNextWritableBlockIndex();
   writable_block->index = index;
   writable_block->block = &blocks_[index];
   writable_block->buf = block_buf_addrs_[index];
+  CountHit(0);
   return true;
 }
 
 void Segment::ReleaseWrittenBlock(const WritableBlock& writable_block) {
   auto index = writable_block.index;
+  if (ArenaOf(index) != 0) {
+    auto arena = GetArena(ArenaOf(index));
+    if (arena != nullptr) {
+      WritableBlock local = writable_block;
+      local.index = LocalIndex(index);
+      arena->ReleaseWrittenBlock(local);
+    }
+    return;
+  }
   if (index >= conf_.block_num()) {
     return;
   }
@@ -76,25 +114,36 @@ void Segment::ReleaseWrittenBlock(const WritableBlock& writable_block) {
 
 bool Segment::AcquireBlockToRead(ReadableBlock* readable_block) {
   RETURN_VAL_IF_NULL(readable_block, false);
+  auto index = readable_block->index;
+  if (ArenaOf(index) != 0) {
+    auto arena = GetArena(ArenaOf(index));
+    if (arena == nullptr) {
+      AERROR << "invalid block_index[" << index << "].";
+      return false;
+    }
+    ReadableBlock local;
+    local.index = LocalIndex(index);
+    if (!arena->AcquireBlockToRead(&local)) {
+      return false;
+    }
+    readable_block->block = local.block;
+    readable_block->buf = local.buf;
+    return true;
+  }
+
   if (!init_ && !OpenOnly()) {
     AERROR << "failed to open shared memory, can't read now.";
     return false;
   }
 
-  auto index = readable_block->index;
   if (index >= conf_.block_num()) {
     AERROR << "invalid block_index[" << index << "].";
     return false;
   }
 
-  bool result = true;
-  if (state_->need_remap()) {
-    result = Remap();
-  }
-
-  if (!result) {
-    AERROR << "segment update failed.";
-    return false;
+  // registered on the first read
+  if (reader_cursor_.load() && reader_slot_ < 0 && !reader_slot_failed_) {
+    RegisterReaderCursor();
   }
 
   if (!blocks_[index].TryLockForRead()) {
@@ -107,16 +156,138 @@ bool Segment::AcquireBlockToRead(ReadableBlock* readable_block) {
 
 void Segment::ReleaseReadBlock(const ReadableBlock& readable_block) {
   auto index = readable_block.index;
+  if (ArenaOf(index) != 0) {
+    auto arena = GetArena(ArenaOf(index));
+    if (arena != nullptr) {
+      ReadableBlock local = readable_block;
+      local.index = LocalIndex(index);
+      arena->ReleaseReadBlock(local);
+    }
+    return;
+  }
   if (index >= conf_.block_num()) {
     return;
   }
+  if (reader_slot_ >= 0) {
+    state_->UpdateReader(reader_slot_, blocks_[index].seq());
+  }
   blocks_[index].ReleaseReadLock();
 }
 
+bool Segment::AcquireLoanedBlockToWrite(std::size_t msg_size,
+                                        WritableBlock* writable_block) {
+  return AcquireBlockToWrite(msg_size, writable_block);
+}
+
+void Segment::ReleaseLoanedWrittenBlock(const WritableBlock& writable_block) {
+  ReleaseWrittenBlock(writable_block);
+}
+
+bool Segment::AcquireLoanedBlockToRead(ReadableBlock* readable_block) {
+  RETURN_VAL_IF_NULL(readable_block, false);
+  auto index = readable_block->index;
+  if (ArenaOf(index) != 0) {
+    auto arena = GetArena(ArenaOf(index));
+    if (arena == nullptr) {
+      AERROR << "invalid block_index[" << index << "].";
+      return false;
+    }
+    ReadableBlock local;
+    local.index = LocalIndex(index);
+    if (!arena->AcquireLoanedBlockToRead(&local)) {
+      return false;
+    }
+    readable_block->block = local.block;
+    readable_block->buf = local.buf;
+    return true;
+  }
+
+  // only called while the block is already read locked by the dispatcher
+  if (!init_) {
+    return false;
+  }
+
+  if (index >= conf_.block_num()) {
+    AERROR << "invalid block_index[" << index << "].";
+    return false;
+  }
+
+  uint32_t max_loaned = std::max(1U, conf_.block_num() / kLoanedReadDivisor);
+  if (loaned_read_blocks_.fetch_add(1) >= max_loaned) {
+    loaned_read_blocks_.fetch_sub(1);
+    return false;
+  }
+  if (!blocks_[index].TryLockForRead()) {
+    loaned_read_blocks_.fetch_sub(1);
+    return false;
+  }
+  readable_block->block = blocks_ + index;
+  readable_block->buf = block_buf_addrs_[index];
+  return true;
+}
+
+void Segment::ReleaseLoanedReadBlock(const ReadableBlock& readable_block) {
+  auto index = readable_block.index;
+  if (ArenaOf(index) != 0) {
+    auto arena = GetArena(ArenaOf(index));
+    if (arena != nullptr) {
+      ReadableBlock local = readable_block;
+      local.index = LocalIndex(index);
+      arena->ReleaseLoanedReadBlock(local);
+    }
+    return;
+  }
+  // released by whichever thread drops the view last, the cursor is left to
+  // the dispatch thread, which released its own read lock of the block
+  if (index < conf_.block_num()) {
+    blocks_[index].ReleaseReadLock();
+  }
+  loaned_read_blocks_.fetch_sub(1);
+}
+
+void Segment::EnableReaderCursor() { reader_cursor_.store(true); }
+
+void Segment::set_block_wait_us(uint32_t block_wait_us) {
+  block_wait_us_.store(block_wait_us);
+}
+
+uint64_t Segment::BlockWaits() {
+  InitVars();
+  uint64_t waits = block_waits_->get_value();
+  std::lock_guard<std::mutex> lock(arena_lock_);
+  for (auto& arena : arenas_) {
+    if (arena != nullptr) {
+      waits += arena->BlockWaits();
+    }
+  }
+  return waits;
+}
+
+uint64_t Segment::BlockWaitTimeouts() {
+  InitVars();
+  uint64_t timeouts = block_wait_timeouts_->get_value();
+  std::lock_guard<std::mutex> lock(arena_lock_);
+  for (auto& arena : arenas_) {
+    if (arena != nullptr) {
+      timeouts += arena->BlockWaitTimeouts();
+    }
+  }
+  return timeouts;
+}
+
+uint64_t Segment::ArenaHits(uint32_t arena_id) {
+  InitVars();
+  if (arena_id >= hits_.size()) {
+    return 0;
+  }
+  return hits_[arena_id]->get_value();
+}
+
 bool Segment::Destroy() {
   if (!init_) {
     return true;
   }
+  UnregisterReaderCursor();
   init_ = false;
 
   try {
@@ -133,34 +304,136 @@ bool Segment::Destroy() {
   return true;
 }
 
-bool Segment::Remap() {
-  init_ = false;
-  ADEBUG << "before reset.";
-  Reset();
-  ADEBUG << "after reset.";
-  return OpenOnly();
-}
-
-bool Segment::Recreate(const uint64_t& msg_size) {
-  init_ = false;
-  state_->set_need_remap(true);
-  Reset();
-  Remove();
-  conf_.Update(msg_size);
-  return OpenOrCreate();
-}
-
 uint32_t Segment::GetNextWritableBlockIndex() {
   const auto block_num = conf_.block_num();
   while (1) {
-    uint32_t try_idx = state_->FetchAddSeq(1) % block_num;
+    uint64_t seq = state_->FetchAddSeq(1);
+    uint32_t try_idx = static_cast<uint32_t>(seq % block_num);
+    if (block_wait_us_.load(std::memory_order_relaxed) > 0) {
+      WaitReaders(blocks_[try_idx].seq());
+    }
     if (blocks_[try_idx].TryLockForWrite()) {
+      blocks_[try_idx].set_seq(seq + 1);
       return try_idx;
     }
   }
   return 0;
 }
 
+bool Segment::AcquireArenaBlockToWrite(std::size_t msg_size,
+                                       WritableBlock* writable_block) {
+  uint32_t size_class = ShmConf::GetSizeClass(msg_size);
+  if (arena_ || msg_size > ShmConf::GetClassCeiling(size_class)) {
+    AERROR << "msg_size: " << msg_size << " larger than any shm block of "
+           << "channel " << channel_id_ << ", can't write.";
+    return false;
+  }
+
+  uint32_t arena_id = size_class + 1;
+  auto arena = GetArena(arena_id);
+  if (!arena->AcquireBlockToWrite(msg_size, writable_block)) {
+    return false;
+  }
+  writable_block->index |= arena_id << kArenaShift;
+  CountHit(arena_id);
+  return true;
+}
+
+SegmentPtr Segment::GetArena(uint32_t arena_id) {
+  if (arena_id == 0 || arena_id > ShmConf::kClassNum) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(arena_lock_);
+  if (arenas_.empty()) {
+    arenas_.resize(ShmConf::kClassNum);
+  }
+  auto& arena = arenas_[arena_id - 1];
+  if (arena == nullptr) {
+    // opened or created by its first access like any segment
+    arena = SegmentFactory::CreateSegment(common::Hash(
+        std::to_string(channel_id_) + "-arena-" + std::to_string(arena_id)));
+    arena->arena_ = true;
+    arena->reader_cursor_.store(reader_cursor_.load());
+    arena->block_wait_us_.store(block_wait_us_.load());
+  }
+  return arena;
+}
+
+void Segment::CountHit(uint32_t arena_id) {
+  if (arena_) {
+    return;
+  }
+  InitVars();
+  *hits_[arena_id] << 1;
+}
+
+void Segment::InitVars() {
+  std::call_once(hits_once_, [this]() {
+    const std::string& channel_name = GlobalData::GetChannelById(channel_id_);
+    if (arena_) {
+      // not exposed, the parent segment sums them up
+      block_waits_ = std::make_shared<::bvar::Adder<uint64_t>>();
+      block_wait_timeouts_ = std::make_shared<::bvar::Adder<uint64_t>>();
+      return;
+    }
+    block_waits_ = ChannelAdder(channel_name, "shm-block-waits");
+    block_wait_timeouts_ =
+        ChannelAdder(channel_name, "shm-block-wait-timeouts");
+    for (uint32_t i = 0; i <= ShmConf::kClassNum; ++i) {
+      std::string name =
+          i == 0 ? "shm-segment-hits"
+                 : "shm-arena-" +
+                       std::to_string(ShmConf::GetClassCeiling(i - 1) / 1024) +
+                       "k-hits";
+      hits_.emplace_back(ChannelAdder(channel_name, name));
+    }
+  });
+}
+
+void Segment::WaitReaders(uint64_t block_seq) {
+  if (block_seq == 0 || state_->ReadersPassed(block_seq)) {
+    return;
+  }
+  InitVars();
+  *block_waits_ << 1;
+  auto deadline =
+      std::chrono::steady_clock::now() +
+      std::chrono::microseconds(block_wait_us_.load(std::memory_order_relaxed));
+  while (!state_->ReadersPassed(block_seq)) {
+    if (std::chrono::steady_clock::now() >= deadline) {
+      // a crashed reader must not stall the writer on every later block
+      state_->ReleaseDeadReaders();
+      *block_wait_timeouts_ << 1;
+      ADEBUG << "reader behind on channel " << channel_id_
+             << ", overwrite block of seq " << block_seq;
+      return;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(20));
+  }
+}
+
+void Segment::RegisterReaderCursor() {
+  reader_slot_ = state_->RegisterReader(static_cast<int32_t>(getpid()));
+  if (reader_slot_ < 0) {
+    reader_slot_failed_ = true;
+    AWARN << "no reader cursor left on channel " << channel_id_
+          << ", writers will not wait for this reader.";
+  }
+}
+
+void Segment::UnregisterReaderCursor() {
+  if (reader_slot_ >= 0 && state_ != nullptr) {
+    state_->UnregisterReader(reader_slot_);
+  }
+  reader_slot_ = -1;
+  reader_slot_failed_ = false;
+}
+
+uint64_t Segment::SegmentKey(uint64_t channel_id) {
+  return common::Hash(std::to_string(channel_id) + "-shm-v" +
+                      std::to_string(State::kLayoutVersion));
+}
+
 }  // namespace transport
 }  // namespace cyber
 }  // namespace apollo
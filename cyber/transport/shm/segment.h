@@ -17,11 +17,14 @@
 #ifndef CYBER_TRANSPORT_SHM_SEGMENT_H_
 #define CYBER_TRANSPORT_SHM_SEGMENT_H_
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
+#include "cyber/statistics/statistics.h"
 #include "cyber/transport/shm/block.h"
 #include "cyber/transport/shm/shm_conf.h"
 #include "cyber/transport/shm/state.h"
@@ -40,6 +43,20 @@ struct WritableBlock {
 };
 using ReadableBlock = WritableBlock;
 
+/**
+ * @class Segment
+ * @brief The shared memory blocks of a channel.
+ *
+ * The segment is sized for the first message written to it. A larger message
+ * goes to an overflow arena of its size class, another segment created on
+ * demand, so the segment is never recreated and readers never remap. The
+ * arena of a block is encoded in the high bits of its index, the readers open
+ * the arenas as they show up.
+ *
+ * Reading segments publish a cursor in the State. A writer with a block wait
+ * does not overwrite a block some reader has not read yet, unless that reader
+ * is still behind after the wait.
+ */
 class Segment {
  public:
   explicit Segment(uint64_t channel_id);
@@ -51,6 +68,32 @@ class Segment {
   bool AcquireBlockToRead(ReadableBlock* readable_block);
   void ReleaseReadBlock(const ReadableBlock& readable_block);
 
+  // Loaned blocks stay locked beyond a single transmit or dispatch, see
+  // LoanedMessage and the zero-copy path of ShmDispatcher. A reading segment
+  // loans at most a quarter of its blocks at a time so a writer is never
+  // stalled by messages held for long, AcquireLoanedBlockToRead fails beyond
+  // that and the message has to be copied.
+  bool AcquireLoanedBlockToWrite(std::size_t msg_size,
+                                 WritableBlock* writable_block);
+  void ReleaseLoanedWrittenBlock(const WritableBlock& writable_block);
+
+  bool AcquireLoanedBlockToRead(ReadableBlock* readable_block);
+  void ReleaseLoanedReadBlock(const ReadableBlock& readable_block);
+
+  // blocks written to the segment itself (0) and to the arena of every size
+  // class (1 + ShmConf::GetSizeClass), also exposed as bvar; the counters
+  // are shared by the writers of the channel in this process
+  uint64_t ArenaHits(uint32_t arena_id);
+
+  // publish a cursor for the blocks read through this segment
+  void EnableReaderCursor();
+  // bounded wait of the writer for readers behind, 0 never waits
+  void set_block_wait_us(uint32_t block_wait_us);
+  // writes that waited for a reader, and the ones that gave up waiting, shared
+  // like ArenaHits
+  uint64_t BlockWaits();
+  uint64_t BlockWaitTimeouts();
+
  protected:
   virtual bool Destroy();
   virtual void Reset() = 0;
@@ -58,6 +101,9 @@ class Segment {
   virtual bool OpenOnly() = 0;
   virtual bool OpenOrCreate() = 0;
 
+  // the shm key of a channel, derived with State::kLayoutVersion
+  static uint64_t SegmentKey(uint64_t channel_id);
+
   bool init_;
   ShmConf conf_;
   uint64_t channel_id_;
@@ -67,11 +113,44 @@ class Segment {
   void* managed_shm_;
   std::mutex block_buf_lock_;
   std::unordered_map<uint32_t, uint8_t*> block_buf_addrs_;
+  std::atomic<uint32_t> loaned_read_blocks_ = {0};
 
  private:
-  bool Remap();
-  bool Recreate(const uint64_t& msg_size);
+  static const uint32_t kArenaShift;
+  // loaned read blocks are at most block num / kLoanedReadDivisor
+  static const uint32_t kLoanedReadDivisor;
+  static uint32_t ArenaOf(uint32_t index) { return index >> kArenaShift; }
+  static uint32_t LocalIndex(uint32_t index) {
+    return index & ((1U << kArenaShift) - 1);
+  }
+
   uint32_t GetNextWritableBlockIndex();
+  bool AcquireArenaBlockToWrite(std::size_t msg_size,
+                                WritableBlock* writable_block);
+  // nullptr if the index is not one of an arena
+  SegmentPtr GetArena(uint32_t arena_id);
+  void CountHit(uint32_t arena_id);
+  void InitVars();
+  void WaitReaders(uint64_t block_seq);
+  void RegisterReaderCursor();
+  void UnregisterReaderCursor();
+
+  // an arena has no arenas of its own
+  bool arena_ = false;
+  std::mutex arena_lock_;
+  // index: arena id - 1
+  std::vector<SegmentPtr> arenas_;
+  std::once_flag hits_once_;
+  std::vector<std::shared_ptr<::bvar::Adder<uint64_t>>> hits_;
+
+  std::atomic<bool> reader_cursor_ = {false};
+  // only touched by the thread dispatching the channel, see ShmDispatcher
+  int32_t reader_slot_ = -1;
+  // a failed registration is not retried until the segment is destroyed
+  bool reader_slot_failed_ = false;
+  std::atomic<uint32_t> block_wait_us_ = {0};
+  std::shared_ptr<::bvar::Adder<uint64_t>> block_waits_;
+  std::shared_ptr<::bvar::Adder<uint64_t>> block_wait_timeouts_;
 };
 
 }  // namespace transport
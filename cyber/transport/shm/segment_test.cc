@@ -0,0 +1,175 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "cyber/transport/shm/segment.h"
+
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "cyber/common/util.h"
+#include "cyber/transport/shm/posix_segment.h"
+
+namespace apollo {
+namespace cyber {
+namespace transport {
+
+TEST(SegmentTest, size_class) {
+  EXPECT_EQ(ShmConf::GetSizeClass(1), 0);
+  EXPECT_EQ(ShmConf::GetSizeClass(16 * 1024), 0);
+  EXPECT_EQ(ShmConf::GetSizeClass(16 * 1024 + 1), 1);
+  EXPECT_EQ(ShmConf::GetSizeClass(2 * 1024 * 1024), 3);
+  EXPECT_EQ(ShmConf::GetSizeClass(UINT64_MAX), ShmConf::kClassNum - 1);
+  EXPECT_EQ(ShmConf::GetClassCeiling(1), 128 * 1024);
+}
+
+TEST(SegmentTest, oversize_message_goes_to_arena) {
+  uint64_t channel_id = common::Hash("/segment_test/arena");
+  PosixSegment writer(channel_id);
+  PosixSegment reader(channel_id);
+
+  // the segment is sized for the first message
+  WritableBlock wb;
+  ASSERT_TRUE(writer.AcquireBlockToWrite(100, &wb));
+  std::memset(wb.buf, 'a', 100);
+  wb.block->set_msg_size(100);
+  writer.ReleaseWrittenBlock(wb);
+
+  const std::size_t large_size = 512 * 1024;
+  WritableBlock large_wb;
+  ASSERT_TRUE(writer.AcquireBlockToWrite(large_size, &large_wb));
+  EXPECT_NE(large_wb.index, wb.index);
+  std::memset(large_wb.buf, 'b', large_size);
+  large_wb.block->set_msg_size(large_size);
+  writer.ReleaseWrittenBlock(large_wb);
+
+  // neither the reader nor the writer remaps the small blocks
+  ReadableBlock rb;
+  rb.index = wb.index;
+  ASSERT_TRUE(reader.AcquireBlockToRead(&rb));
+  EXPECT_EQ(rb.block->msg_size(), 100);
+  EXPECT_EQ(rb.buf[99], 'a');
+
+  ReadableBlock large_rb;
+  large_rb.index = large_wb.index;
+  ASSERT_TRUE(reader.AcquireBlockToRead(&large_rb));
+  EXPECT_EQ(large_rb.block->msg_size(), large_size);
+  EXPECT_EQ(large_rb.buf[large_size - 1], 'b');
+  reader.ReleaseReadBlock(large_rb);
+  reader.ReleaseReadBlock(rb);
+
+  EXPECT_EQ(writer.ArenaHits(0), 1);
+  EXPECT_EQ(writer.ArenaHits(1 + ShmConf::GetSizeClass(large_size)), 1);
+
+  WritableBlock too_large;
+  EXPECT_FALSE(writer.AcquireBlockToWrite(64 * 1024 * 1024, &too_large));
+}
+
+TEST(SegmentTest, writers_of_a_channel_share_hits) {
+  uint64_t channel_id = common::Hash("/segment_test/shared_hits");
+  PosixSegment first(channel_id);
+  PosixSegment second(channel_id);
+
+  for (auto* writer : {&first, &second}) {
+    WritableBlock wb;
+    ASSERT_TRUE(writer->AcquireBlockToWrite(100, &wb));
+    wb.block->set_msg_size(100);
+    writer->ReleaseWrittenBlock(wb);
+  }
+
+  EXPECT_EQ(first.ArenaHits(0), 2);
+  EXPECT_EQ(second.ArenaHits(0), 2);
+}
+
+TEST(SegmentTest, writer_waits_for_reader_cursor) {
+  uint64_t channel_id = common::Hash("/segment_test/cursor");
+  PosixSegment writer(channel_id);
+  PosixSegment reader(channel_id);
+  writer.set_block_wait_us(1000);
+  reader.EnableReaderCursor();
+
+  auto write = [&writer]() {
+    WritableBlock wb;
+    ASSERT_TRUE(writer.AcquireBlockToWrite(100, &wb));
+    wb.block->set_msg_size(100);
+    writer.ReleaseWrittenBlock(wb);
+  };
+  write();
+
+  ReadableBlock rb;
+  rb.index = 0;
+  ASSERT_TRUE(reader.AcquireBlockToRead(&rb));
+  reader.ReleaseReadBlock(rb);
+
+  // the fresh blocks and then the block read already are written at once
+  uint32_t block_num = ShmConf(100).block_num();
+  for (uint32_t i = 0; i < block_num; ++i) {
+    write();
+  }
+  EXPECT_EQ(writer.BlockWaits(), 0);
+
+  // block 1 was never read, the writer gives up waiting for the reader
+  write();
+  EXPECT_EQ(writer.BlockWaits(), 1);
+  EXPECT_EQ(writer.BlockWaitTimeouts(), 1);
+}
+
+TEST(SegmentTest, loaned_read_blocks_are_bounded) {
+  uint64_t channel_id = common::Hash("/segment_test/loan");
+  PosixSegment writer(channel_id);
+  PosixSegment reader(channel_id);
+
+  uint32_t block_num = ShmConf(100).block_num();
+  for (uint32_t i = 0; i < block_num; ++i) {
+    WritableBlock wb;
+    ASSERT_TRUE(writer.AcquireBlockToWrite(100, &wb));
+    wb.block->set_msg_size(100);
+    writer.ReleaseWrittenBlock(wb);
+  }
+
+  // a quarter of the blocks at most, the next message is copied
+  std::vector<ReadableBlock> views;
+  for (uint32_t i = 0; i < block_num / 4; ++i) {
+    ReadableBlock rb;
+    rb.index = i;
+    ASSERT_TRUE(reader.AcquireBlockToRead(&rb));
+    ReadableBlock view;
+    view.index = i;
+    ASSERT_TRUE(reader.AcquireLoanedBlockToRead(&view));
+    reader.ReleaseReadBlock(rb);
+    views.push_back(view);
+  }
+  ReadableBlock rb;
+  rb.index = block_num / 4;
+  ASSERT_TRUE(reader.AcquireBlockToRead(&rb));
+  ReadableBlock view;
+  view.index = rb.index;
+  EXPECT_FALSE(reader.AcquireLoanedBlockToRead(&view));
+
+  reader.ReleaseLoanedReadBlock(views.back());
+  views.pop_back();
+  EXPECT_TRUE(reader.AcquireLoanedBlockToRead(&view));
+  reader.ReleaseLoanedReadBlock(view);
+  reader.ReleaseReadBlock(rb);
+  for (auto& loaned : views) {
+    reader.ReleaseLoanedReadBlock(loaned);
+  }
+}
+
+}  // namespace transport
+}  // namespace cyber
+}  // namespace apollo
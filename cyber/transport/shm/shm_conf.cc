@@ -76,6 +76,24 @@ uint64_t ShmConf::GetCeilingMessageSize(const uint64_t& real_msg_size) {
   return ceiling_msg_size;
 }
 
+const uint32_t ShmConf::kClassNum = 6;
+
+uint32_t ShmConf::GetSizeClass(const uint64_t& real_msg_size) {
+  uint32_t size_class = 0;
+  while (size_class + 1 < kClassNum &&
+         real_msg_size > GetClassCeiling(size_class)) {
+    ++size_class;
+  }
+  return size_class;
+}
+
+uint64_t ShmConf::GetClassCeiling(uint32_t size_class) {
+  static const uint64_t ceilings[] = {MESSAGE_SIZE_16K, MESSAGE_SIZE_128K,
+                                      MESSAGE_SIZE_1M,  MESSAGE_SIZE_8M,
+                                      MESSAGE_SIZE_16M, MESSAGE_SIZE_MORE};
+  return ceilings[size_class < kClassNum ? size_class : kClassNum - 1];
+}
+
 uint64_t ShmConf::GetBlockBufSize(const uint64_t& ceiling_msg_size) {
   return ceiling_msg_size + MESSAGE_INFO_SIZE;
 }
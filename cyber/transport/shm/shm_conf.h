@@ -37,6 +37,12 @@ class ShmConf {
   const uint32_t& block_num() { return block_num_; }
   const uint64_t& managed_shm_size() { return managed_shm_size_; }
 
+  // Size classes of ShmConf, 0 for the 16K one. Messages above the largest
+  // class ceiling can not be held by any block.
+  static const uint32_t kClassNum;
+  static uint32_t GetSizeClass(const uint64_t& real_msg_size);
+  static uint64_t GetClassCeiling(uint32_t size_class);
+
  private:
   uint64_t GetCeilingMessageSize(const uint64_t& real_msg_size);
   uint64_t GetBlockBufSize(const uint64_t& ceiling_msg_size);
@@ -16,6 +16,10 @@
 
 #include "cyber/transport/shm/state.h"
 
+#include <signal.h>
+
+#include <cerrno>
+
 namespace apollo {
 namespace cyber {
 namespace transport {
@@ -25,6 +29,55 @@ State::State(const uint64_t& ceiling_msg_size)
 
 State::~State() {}
 
+int32_t State::RegisterReader(int32_t pid) {
+  for (uint32_t i = 0; i < kMaxReaders; ++i) {
+    int32_t free_pid = 0;
+    if (readers_[i].pid.compare_exchange_strong(free_pid, pid)) {
+      // every block written so far counts as read
+      readers_[i].block_seq.store(seq_.load());
+      return static_cast<int32_t>(i);
+    }
+  }
+  return -1;
+}
+
+void State::UnregisterReader(int32_t slot) {
+  if (slot < 0 || slot >= static_cast<int32_t>(kMaxReaders)) {
+    return;
+  }
+  readers_[slot].pid.store(0);
+}
+
+void State::UpdateReader(int32_t slot, uint64_t block_seq) {
+  if (slot < 0 || slot >= static_cast<int32_t>(kMaxReaders)) {
+    return;
+  }
+  auto& cursor = readers_[slot].block_seq;
+  uint64_t current = cursor.load(std::memory_order_relaxed);
+  while (current < block_seq &&
+         !cursor.compare_exchange_weak(current, block_seq)) {
+  }
+}
+
+bool State::ReadersPassed(uint64_t block_seq) {
+  for (auto& reader : readers_) {
+    if (reader.pid.load(std::memory_order_relaxed) != 0 &&
+        reader.block_seq.load() < block_seq) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void State::ReleaseDeadReaders() {
+  for (auto& reader : readers_) {
+    int32_t pid = reader.pid.load();
+    if (pid != 0 && kill(pid, 0) != 0 && errno == ESRCH) {
+      reader.pid.compare_exchange_strong(pid, 0);
+    }
+  }
+}
+
 }  // namespace transport
 }  // namespace cyber
 }  // namespace apollo
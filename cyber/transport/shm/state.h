@@ -28,9 +28,25 @@ namespace transport {
 
 class State {
  public:
+  // Readers publish the seq of the latest block they read, so that a writer
+  // can wait for them before overwriting a block, see Segment.
+  static const uint32_t kMaxReaders = 16;
+  // bumped on any change of the State or Block layout, it is part of the
+  // segment key so that builds of different layouts never map one segment
+  static const uint32_t kLayoutVersion = 2;
+
   explicit State(const uint64_t& ceiling_msg_size);
   virtual ~State();
 
+  // @return the cursor slot, -1 if all of them are taken
+  int32_t RegisterReader(int32_t pid);
+  void UnregisterReader(int32_t slot);
+  void UpdateReader(int32_t slot, uint64_t block_seq);
+  // whether every reader has read the block written at block_seq, or later
+  bool ReadersPassed(uint64_t block_seq);
+  // frees the slots of readers whose process is gone
+  void ReleaseDeadReaders();
+
   void DecreaseReferenceCounts() {
     uint32_t current_reference_count = reference_count_.load();
     do {
@@ -43,20 +59,23 @@ class State {
 
   void IncreaseReferenceCounts() { reference_count_.fetch_add(1); }
 
-  uint32_t FetchAddSeq(uint32_t diff) { return seq_.fetch_add(diff); }
-  uint32_t seq() { return seq_.load(); }
-
-  void set_need_remap(bool need) { need_remap_.store(need); }
-  bool need_remap() { return need_remap_; }
+  uint64_t FetchAddSeq(uint64_t diff) { return seq_.fetch_add(diff); }
+  uint64_t seq() { return seq_.load(); }
 
   uint64_t ceiling_msg_size() { return ceiling_msg_size_.load(); }
   uint32_t reference_counts() { return reference_count_.load(); }
 
  private:
-  std::atomic<bool> need_remap_ = {false};
-  std::atomic<uint32_t> seq_ = {0};
+  struct ReaderCursor {
+    // 0 for a free slot
+    std::atomic<int32_t> pid = {0};
+    std::atomic<uint64_t> block_seq = {0};
+  };
+
+  std::atomic<uint64_t> seq_ = {0};
   std::atomic<uint32_t> reference_count_ = {0};
   std::atomic<uint64_t> ceiling_msg_size_;
+  ReaderCursor readers_[kMaxReaders];
 };
 
 }  // namespace transport
@@ -30,7 +30,7 @@ namespace cyber {
 namespace transport {
 
 XsiSegment::XsiSegment(uint64_t channel_id) : Segment(channel_id) {
-  key_ = static_cast<key_t>(channel_id);
+  key_ = static_cast<key_t>(SegmentKey(channel_id));
 }
 
 XsiSegment::~XsiSegment() { Destroy(); }
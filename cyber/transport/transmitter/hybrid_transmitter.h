@@ -71,6 +71,11 @@ class HybridTransmitter : public Transmitter<M> {
 
   bool Transmit(const MessagePtr& msg, const MessageInfo& msg_info) override;
 
+  bool Loan(LoanedMessage<M>* loaned) override;
+  bool Publish(LoanedMessage<M>* loaned, const MessageInfo& msg_info) override;
+
+  bool Flush() override;
+
  private:
   void InitMode();
   void ObtainConfig();
@@ -171,6 +176,49 @@ bool HybridTransmitter<M>::Transmit(const MessagePtr& msg,
   return true;
 }
 
+template <typename M>
+bool HybridTransmitter<M>::Loan(LoanedMessage<M>* loaned) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // a loaned message lives in shm only, it can neither be cached for late
+  // joiners nor reach readers served by the other transports.
+  if (this->attr_.qos_profile().durability() ==
+      QosDurabilityPolicy::DURABILITY_TRANSIENT_LOCAL) {
+    return false;
+  }
+  for (auto& item : receivers_) {
+    if (item.first != OptionalMode::SHM && !item.second.empty()) {
+      return false;
+    }
+  }
+  auto iter = transmitters_.find(OptionalMode::SHM);
+  if (iter == transmitters_.end()) {
+    return false;
+  }
+  return iter->second->Loan(loaned);
+}
+
+template <typename M>
+bool HybridTransmitter<M>::Publish(LoanedMessage<M>* loaned,
+                                   const MessageInfo& msg_info) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = transmitters_.find(OptionalMode::SHM);
+  if (iter == transmitters_.end()) {
+    loaned->Reset();
+    return false;
+  }
+  return iter->second->Publish(loaned, msg_info);
+}
+
+template <typename M>
+bool HybridTransmitter<M>::Flush() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  bool result = true;
+  for (auto& item : transmitters_) {
+    result = item.second->Flush() && result;
+  }
+  return result;
+}
+
 template <typename M>
 void HybridTransmitter<M>::InitMode() {
   mode_ = std::make_shared<proto::CommunicationMode>();
@@ -17,16 +17,23 @@
 #ifndef CYBER_TRANSPORT_TRANSMITTER_SHM_TRANSMITTER_H_
 #define CYBER_TRANSPORT_TRANSMITTER_SHM_TRANSMITTER_H_
 
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <cstring>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <type_traits>
 
 #include "cyber/common/global_data.h"
 #include "cyber/common/log.h"
 #include "cyber/common/util.h"
 #include "cyber/message/message_traits.h"
 #include "cyber/statistics/statistics.h"
+#include "cyber/transport/shm/message_batch.h"
 #include "cyber/transport/shm/notifier_factory.h"
 #include "cyber/transport/shm/readable_info.h"
 #include "cyber/transport/shm/segment_factory.h"
@@ -49,13 +56,36 @@ class ShmTransmitter : public Transmitter<M> {
 
   bool Transmit(const MessagePtr& msg, const MessageInfo& msg_info) override;
 
+  bool Loan(LoanedMessage<M>* loaned) override;
+  bool Publish(LoanedMessage<M>* loaned, const MessageInfo& msg_info) override;
+
+  bool Flush() override;
+
  private:
   bool Transmit(const M& msg, const MessageInfo& msg_info);
+  bool TransmitBlock(const M& msg, const MessageInfo& msg_info);
+  bool TransmitBatched(const M& msg, const MessageInfo& msg_info);
+  // NOTE: batch_mutex_ hold
+  bool FlushBatch();
+  void BatchThreadFunc();
 
   SegmentPtr segment_;
   uint64_t channel_id_;
   uint64_t host_id_;
   NotifierPtr notifier_;
+
+  // Small messages are packed into one block and one notification, sent when
+  // batch_max_count_ messages are pending or the oldest of them has waited
+  // batch_max_delay_. Zero-copy messages are never batched, their readers
+  // map the block itself.
+  uint32_t batch_max_count_;
+  std::chrono::microseconds batch_max_delay_;
+  MessageBatch batch_;
+  std::chrono::steady_clock::time_point batch_deadline_;
+  std::mutex batch_mutex_;
+  std::condition_variable batch_cv_;
+  std::thread batch_thread_;
+  bool batch_stop_ = false;
 };
 
 template <typename M>
@@ -63,8 +93,14 @@ ShmTransmitter<M>::ShmTransmitter(const RoleAttributes& attr)
     : Transmitter<M>(attr),
       segment_(nullptr),
       channel_id_(attr.channel_id()),
-      notifier_(nullptr) {
+      notifier_(nullptr),
+      batch_max_count_(0),
+      batch_max_delay_(attr.qos_profile().batch_max_delay_us()) {
   host_id_ = common::Hash(attr.host_ip());
+  if (!message::IsZeroCopy<M>::value &&
+      attr.qos_profile().batch_max_count() > 1) {
+    batch_max_count_ = attr.qos_profile().batch_max_count();
+  }
 }
 
 template <typename M>
@@ -79,13 +115,27 @@ void ShmTransmitter<M>::Enable() {
   }
 
   segment_ = SegmentFactory::CreateSegment(channel_id_);
+  segment_->set_block_wait_us(this->attr_.qos_profile().shm_block_wait_us());
   notifier_ = NotifierFactory::CreateNotifier();
   this->enabled_ = true;
+  if (batch_max_count_ > 1) {
+    batch_stop_ = false;
+    batch_thread_ = std::thread(&ShmTransmitter<M>::BatchThreadFunc, this);
+  }
 }
 
 template <typename M>
 void ShmTransmitter<M>::Disable() {
   if (this->enabled_) {
+    if (batch_thread_.joinable()) {
+      {
+        std::lock_guard<std::mutex> lock(batch_mutex_);
+        batch_stop_ = true;
+      }
+      batch_cv_.notify_one();
+      // the pending messages are flushed before the thread exits
+      batch_thread_.join();
+    }
     segment_ = nullptr;
     notifier_ = nullptr;
     this->enabled_ = false;
@@ -105,6 +155,15 @@ bool ShmTransmitter<M>::Transmit(const M& msg, const MessageInfo& msg_info) {
     return false;
   }
 
+  if (batch_max_count_ > 1) {
+    return TransmitBatched(msg, msg_info);
+  }
+  return TransmitBlock(msg, msg_info);
+}
+
+template <typename M>
+bool ShmTransmitter<M>::TransmitBlock(const M& msg,
+                                      const MessageInfo& msg_info) {
   WritableBlock wb;
   std::size_t msg_size = message::ByteSize(msg);
   if (!segment_->AcquireBlockToWrite(msg_size, &wb)) {
@@ -121,12 +180,12 @@ bool ShmTransmitter<M>::Transmit(const M& msg, const MessageInfo& msg_info) {
   wb.block->set_msg_size(msg_size);
 
   char* msg_info_addr = reinterpret_cast<char*>(wb.buf) + msg_size;
-  if (!msg_info.SerializeTo(msg_info_addr, MessageInfo::kSize)) {
+  if (!msg_info.SerializeTo(msg_info_addr, msg_info.ByteSize())) {
     AERROR << "serialize message info failed.";
     segment_->ReleaseWrittenBlock(wb);
     return false;
   }
-  wb.block->set_msg_info_size(MessageInfo::kSize);
+  wb.block->set_msg_info_size(msg_info.ByteSize());
   segment_->ReleaseWrittenBlock(wb);
 
   ReadableInfo readable_info(host_id_, wb.index, channel_id_);
@@ -137,6 +196,151 @@ bool ShmTransmitter<M>::Transmit(const M& msg, const MessageInfo& msg_info) {
   return notifier_->Notify(readable_info);
 }
 
+template <typename M>
+bool ShmTransmitter<M>::TransmitBatched(const M& msg,
+                                       const MessageInfo& msg_info) {
+  std::size_t msg_size = message::ByteSize(msg);
+  std::lock_guard<std::mutex> lock(batch_mutex_);
+  std::size_t record_size =
+      MessageBatch::RecordSize(msg_size, msg_info.ByteSize());
+  if (batch_.ByteSize() + record_size > MessageBatch::kMaxBytes &&
+      !FlushBatch()) {
+    return false;
+  }
+
+  if (record_size > MessageBatch::kMaxBytes) {
+    // too large to be packed, sent on its own behind the flushed ones
+    return TransmitBlock(msg, msg_info);
+  }
+
+  if (!batch_.Append(msg, msg_size, msg_info)) {
+    AERROR << "serialize to batch failed.";
+    return false;
+  }
+  if (batch_.Count() == 1) {
+    batch_deadline_ = std::chrono::steady_clock::now() + batch_max_delay_;
+    batch_cv_.notify_one();
+  }
+  if (batch_.Count() >= batch_max_count_) {
+    return FlushBatch();
+  }
+  return true;
+}
+
+template <typename M>
+bool ShmTransmitter<M>::FlushBatch() {
+  if (batch_.Empty()) {
+    return true;
+  }
+
+  WritableBlock wb;
+  if (!segment_->AcquireBlockToWrite(batch_.ByteSize(), &wb)) {
+    AERROR << "acquire block failed, drop " << batch_.Count()
+           << " batched messages.";
+    batch_.Clear();
+    return false;
+  }
+  std::memcpy(wb.buf, batch_.Data(), batch_.ByteSize());
+  wb.block->set_msg_size(batch_.ByteSize());
+  wb.block->set_msg_info_size(MessageBatch::kFlag);
+  segment_->ReleaseWrittenBlock(wb);
+
+  ADEBUG << "Writing " << batch_.Count() << " batched sharedmem messages: "
+         << common::GlobalData::GetChannelById(channel_id_)
+         << " to block: " << wb.index;
+  batch_.Clear();
+  return notifier_->Notify(ReadableInfo(host_id_, wb.index, channel_id_));
+}
+
+template <typename M>
+bool ShmTransmitter<M>::Flush() {
+  if (!this->enabled_ || batch_max_count_ <= 1) {
+    return true;
+  }
+  std::lock_guard<std::mutex> lock(batch_mutex_);
+  return FlushBatch();
+}
+
+template <typename M>
+void ShmTransmitter<M>::BatchThreadFunc() {
+  std::unique_lock<std::mutex> lock(batch_mutex_);
+  while (!batch_stop_) {
+    if (batch_.Empty()) {
+      batch_cv_.wait(lock);
+      continue;
+    }
+    // the deadline moves on whenever a count-triggered flush starts a batch
+    batch_cv_.wait_until(lock, batch_deadline_);
+    if (!batch_stop_ &&
+        std::chrono::steady_clock::now() >= batch_deadline_) {
+      FlushBatch();
+    }
+  }
+  FlushBatch();
+}
+
+template <typename M>
+bool ShmTransmitter<M>::Loan(LoanedMessage<M>* loaned) {
+  if (!message::IsZeroCopy<M>::value) {
+    ADEBUG << "message type can not be loaned.";
+    return false;
+  }
+
+  if (!this->enabled_) {
+    ADEBUG << "not enable.";
+    return false;
+  }
+
+  WritableBlock wb;
+  if (!segment_->AcquireLoanedBlockToWrite(sizeof(M), &wb)) {
+    AERROR << "acquire block failed.";
+    return false;
+  }
+
+  if (reinterpret_cast<std::uintptr_t>(wb.buf) % alignof(M) != 0) {
+    AERROR << "block buffer is not aligned for loaned message.";
+    segment_->ReleaseLoanedWrittenBlock(wb);
+    return false;
+  }
+
+  *loaned = LoanedMessage<M>(segment_, wb);
+  return true;
+}
+
+template <typename M>
+bool ShmTransmitter<M>::Publish(LoanedMessage<M>* loaned,
+                                const MessageInfo& msg_info) {
+  if (!loaned->IsValid()) {
+    AERROR << "invalid loaned message.";
+    return false;
+  }
+
+  if (!this->enabled_ || loaned->segment_ != segment_) {
+    ADEBUG << "not enable.";
+    loaned->Reset();
+    return false;
+  }
+
+  WritableBlock wb = loaned->block_;
+  wb.block->set_msg_size(sizeof(M));
+  char* msg_info_addr = reinterpret_cast<char*>(wb.buf) + sizeof(M);
+  if (!msg_info.SerializeTo(msg_info_addr, msg_info.ByteSize())) {
+    AERROR << "serialize message info failed.";
+    loaned->Reset();
+    return false;
+  }
+  wb.block->set_msg_info_size(msg_info.ByteSize());
+  // hand the block over to the readers, the loan is consumed
+  loaned->Reset();
+
+  ReadableInfo readable_info(host_id_, wb.index, channel_id_);
+
+  ADEBUG << "Publishing loaned sharedmem message: "
+         << common::GlobalData::GetChannelById(channel_id_)
+         << " to block: " << wb.index;
+  return notifier_->Notify(readable_info);
+}
+
 }  // namespace transport
 }  // namespace cyber
 }  // namespace apollo
@@ -22,9 +22,11 @@
 #include <string>
 
 #include "cyber/event/perf_event_cache.h"
+#include "cyber/statistics/latency_tracer.h"
 #include "cyber/statistics/statistics.h"
 #include "cyber/transport/common/endpoint.h"
 #include "cyber/transport/message/message_info.h"
+#include "cyber/transport/shm/loaned_message.h"
 
 namespace apollo {
 namespace cyber {
@@ -50,6 +52,14 @@ class Transmitter : public Endpoint {
   virtual bool Transmit(const MessagePtr& msg);
   virtual bool Transmit(const MessagePtr& msg, const MessageInfo& msg_info) = 0;
 
+  // Zero-copy publishing, only shm transmitters hand out loans.
+  virtual bool Loan(LoanedMessage<M>* loaned);
+  virtual bool Publish(LoanedMessage<M>* loaned);
+  virtual bool Publish(LoanedMessage<M>* loaned, const MessageInfo& msg_info);
+
+  // Send the messages a batching transmitter still holds back.
+  virtual bool Flush() { return true; }
+
   uint64_t NextSeqNum() { return ++seq_num_; }
 
   uint64_t seq_num() const { return seq_num_; }
@@ -78,11 +88,42 @@ bool Transmitter<M>::Transmit(const MessagePtr& msg) {
   msg_info_.set_seq_num(NextSeqNum());
   msg_info_.set_msg_seq_num(msg_counter_->get_value());
   msg_info_.set_send_time(Time::Now().ToNanosecond());
+  msg_info_.set_origin_time(
+      statistics::LatencyTracer::Instance()->OriginTime(
+          msg_info_.send_time()));
   PerfEventCache::Instance()->AddTransportEvent(
       TransPerf::TRANSMIT_BEGIN, attr_.channel_id(), msg_info_.seq_num());
   return Transmit(msg, msg_info_);
 }
 
+template <typename M>
+bool Transmitter<M>::Loan(LoanedMessage<M>* loaned) {
+  (void)loaned;
+  return false;
+}
+
+template <typename M>
+bool Transmitter<M>::Publish(LoanedMessage<M>* loaned) {
+  (*msg_counter_) << 1;
+  msg_info_.set_seq_num(NextSeqNum());
+  msg_info_.set_msg_seq_num(msg_counter_->get_value());
+  msg_info_.set_send_time(Time::Now().ToNanosecond());
+  msg_info_.set_origin_time(
+      statistics::LatencyTracer::Instance()->OriginTime(
+          msg_info_.send_time()));
+  PerfEventCache::Instance()->AddTransportEvent(
+      TransPerf::TRANSMIT_BEGIN, attr_.channel_id(), msg_info_.seq_num());
+  return Publish(loaned, msg_info_);
+}
+
+template <typename M>
+bool Transmitter<M>::Publish(LoanedMessage<M>* loaned,
+                             const MessageInfo& msg_info) {
+  (void)msg_info;
+  loaned->Reset();
+  return false;
+}
+
 template <typename M>
 void Transmitter<M>::Enable(const RoleAttributes& opposite_attr) {
   (void)opposite_attr;
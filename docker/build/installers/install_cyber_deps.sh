@@ -28,7 +28,9 @@ apt-get -y update && \
     apt-get -y install \
     ncurses-dev \
     libuuid1 \
-    uuid-dev
+    uuid-dev \
+    liblz4-dev \
+    libzstd-dev
 
 info "Install protobuf ..."
 bash ${CURR_DIR}/install_protobuf.sh
@@ -318,6 +318,7 @@ const Obstacle *Frame::CreateStaticObstacle(
 
 const Obstacle *Frame::CreateStaticVirtualObstacle(const std::string &id,
                                                    const Box2d &box) {
+  std::lock_guard<std::mutex> lock(virtual_obstacle_mutex_);
   const auto *object = obstacles_.Find(id);
   if (object) {
     AWARN << "obstacle " << id << " already exist.";
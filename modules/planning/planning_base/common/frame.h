@@ -22,6 +22,7 @@
 
 #include <list>
 #include <map>
+#include <mutex>
 #include <string>
 #include <tuple>
 #include <unordered_map>
@@ -219,6 +220,8 @@ class Frame {
   const ReferenceLineInfo *drive_reference_line_info_ = nullptr;
 
   ThreadSafeIndexedObstacles obstacles_;
+  // reference lines planned concurrently may create the same virtual obstacle
+  std::mutex virtual_obstacle_mutex_;
 
   std::unordered_map<std::string, const perception::TrafficLight *>
       traffic_lights_;
@@ -23,5 +23,20 @@ void PlanningContext::Init() {}
 
 void PlanningContext::Clear() { planning_status_.Clear(); }
 
+thread_local const PlanningContext* PlanningContext::scoped_context_ = nullptr;
+thread_local PlanningStatus* PlanningContext::scoped_status_ = nullptr;
+
+PlanningContext::ScopedStatus::ScopedStatus(const PlanningContext* context,
+                                            PlanningStatus* status)
+    : previous_context_(scoped_context_), previous_status_(scoped_status_) {
+  scoped_context_ = context;
+  scoped_status_ = status;
+}
+
+PlanningContext::ScopedStatus::~ScopedStatus() {
+  scoped_context_ = previous_context_;
+  scoped_status_ = previous_status_;
+}
+
 }  // namespace planning
 }  // namespace apollo
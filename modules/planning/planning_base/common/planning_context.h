@@ -42,11 +42,34 @@ class PlanningContext {
    * please put all status info inside PlanningStatus for easy maintenance.
    * do NOT create new struct at this level.
    * */
-  const PlanningStatus& planning_status() const { return planning_status_; }
-  PlanningStatus* mutable_planning_status() { return &planning_status_; }
+  const PlanningStatus& planning_status() const {
+    return scoped_context_ == this ? *scoped_status_ : planning_status_;
+  }
+  PlanningStatus* mutable_planning_status() {
+    return scoped_context_ == this ? scoped_status_ : &planning_status_;
+  }
+
+  /**
+   * @brief While in scope the status of the context reads and writes status
+   * in the calling thread, e.g. for a reference line planned concurrently
+   * with the others.
+   */
+  class ScopedStatus {
+   public:
+    ScopedStatus(const PlanningContext* context, PlanningStatus* status);
+    ~ScopedStatus();
+
+   private:
+    const PlanningContext* previous_context_;
+    PlanningStatus* previous_status_;
+    DISALLOW_COPY_AND_ASSIGN(ScopedStatus);
+  };
 
  private:
   PlanningStatus planning_status_;
+
+  static thread_local const PlanningContext* scoped_context_;
+  static thread_local PlanningStatus* scoped_status_;
 };
 
 }  // namespace planning
@@ -0,0 +1,94 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+/**
+ * @file
+ **/
+
+#include "modules/planning/planning_base/common/planning_context.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace apollo {
+namespace planning {
+
+TEST(PlanningContextTest, scoped_status) {
+  PlanningContext context;
+  PlanningContext other_context;
+  context.mutable_planning_status()->mutable_change_lane()->set_path_id("a");
+
+  PlanningStatus status;
+  {
+    PlanningContext::ScopedStatus scoped_status(&context, &status);
+    EXPECT_FALSE(context.planning_status().has_change_lane());
+    context.mutable_planning_status()->mutable_change_lane()->set_path_id("b");
+    EXPECT_EQ(&status, context.mutable_planning_status());
+    // other contexts are not redirected
+    EXPECT_EQ(other_context.mutable_planning_status(),
+              &other_context.planning_status());
+
+    PlanningStatus nested_status;
+    {
+      PlanningContext::ScopedStatus nested_scoped_status(&context,
+                                                         &nested_status);
+      EXPECT_EQ(&nested_status, context.mutable_planning_status());
+    }
+    EXPECT_EQ(&status, context.mutable_planning_status());
+  }
+  EXPECT_EQ("a", context.planning_status().change_lane().path_id());
+  EXPECT_EQ("b", status.change_lane().path_id());
+}
+
+TEST(PlanningContextTest, scoped_status_per_thread) {
+  PlanningContext context;
+  context.mutable_planning_status()->mutable_change_lane()->set_path_id("main");
+
+  constexpr int kThreadNum = 4;
+  constexpr int kWriteNum = 1000;
+  std::vector<PlanningStatus> status(kThreadNum);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadNum; ++i) {
+    threads.emplace_back([&, i]() {
+      PlanningContext::ScopedStatus scoped_status(&context, &status[i]);
+      for (int j = 0; j < kWriteNum; ++j) {
+        auto* change_lane =
+            context.mutable_planning_status()->mutable_change_lane();
+        change_lane->set_path_id(std::to_string(i));
+        change_lane->set_timestamp(change_lane->timestamp() + 1.0);
+        std::this_thread::yield();
+      }
+    });
+  }
+  // the calling thread is not redirected meanwhile
+  EXPECT_EQ("main", context.planning_status().change_lane().path_id());
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < kThreadNum; ++i) {
+    EXPECT_EQ(std::to_string(i), status[i].change_lane().path_id());
+    EXPECT_DOUBLE_EQ(kWriteNum, status[i].change_lane().timestamp());
+  }
+  EXPECT_EQ("main", context.planning_status().change_lane().path_id());
+  EXPECT_FALSE(context.planning_status().change_lane().has_timestamp());
+}
+
+}  // namespace planning
+}  // namespace apollo
@@ -209,6 +209,9 @@ DEFINE_double(speed_fallback_distance, 3.0,
 /// thread pool
 DEFINE_bool(use_multi_thread_to_add_obstacles, false,
             "use multiple thread to add obstacles.");
+DEFINE_bool(enable_parallel_reference_line_planning, false,
+            "plan the reference lines of LaneFollowStage concurrently, "
+            "each with its own task instances.");
 
 /// Lattice Planner
 DEFINE_double(numerical_epsilon, 1e-6, "Epsilon in lattice planner.");
@@ -102,6 +102,7 @@ DECLARE_double(slowdown_profile_deceleration);
 DECLARE_double(speed_fallback_distance);
 /// thread pool
 DECLARE_bool(use_multi_thread_to_add_obstacles);
+DECLARE_bool(enable_parallel_reference_line_planning);
 
 DECLARE_double(numerical_epsilon);
 DECLARE_double(default_cruise_speed);
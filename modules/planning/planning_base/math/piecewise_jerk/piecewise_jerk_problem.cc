@@ -16,6 +16,9 @@
 
 #include "modules/planning/planning_base/math/piecewise_jerk/piecewise_jerk_problem.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "cyber/common/log.h"
 #include "modules/planning/planning_base/gflags/planning_gflags.h"
 
@@ -70,6 +73,19 @@ bool PiecewiseJerkProblem::FormulateProblem(OSQPData* data) {
 
   CHECK_EQ(lower_bounds.size(), upper_bounds.size());
 
+  FillData(P_data, P_indices, P_indptr, A_data, A_indices, A_indptr,
+           lower_bounds, upper_bounds, q, data);
+
+  return CheckLowUpperBound(lower_bounds, upper_bounds);
+}
+
+void PiecewiseJerkProblem::FillData(
+    const std::vector<c_float>& P_data, const std::vector<c_int>& P_indices,
+    const std::vector<c_int>& P_indptr, const std::vector<c_float>& A_data,
+    const std::vector<c_int>& A_indices, const std::vector<c_int>& A_indptr,
+    const std::vector<c_float>& lower_bounds,
+    const std::vector<c_float>& upper_bounds, const std::vector<c_float>& q,
+    OSQPData* data) {
   size_t kernel_dim = 3 * num_of_knots_;
   size_t num_affine_constraint = lower_bounds.size();
 
@@ -83,11 +99,13 @@ bool PiecewiseJerkProblem::FormulateProblem(OSQPData* data) {
                  CopyData(A_data), CopyData(A_indices), CopyData(A_indptr));
   data->l = CopyData(lower_bounds);
   data->u = CopyData(upper_bounds);
-
-  return CheckLowUpperBound(lower_bounds, upper_bounds);
 }
 
 bool PiecewiseJerkProblem::Optimize(const int max_iter) {
+  if (workspace_ != nullptr) {
+    return OptimizeInWorkspace(max_iter);
+  }
+
   OSQPData* data = reinterpret_cast<OSQPData*>(c_malloc(sizeof(OSQPData)));
   if (FormulateProblem(data)) {
     FreeData(data);
@@ -116,15 +134,7 @@ bool PiecewiseJerkProblem::Optimize(const int max_iter) {
   }
 
   // extract primal results
-  x_.resize(num_of_knots_);
-  dx_.resize(num_of_knots_);
-  ddx_.resize(num_of_knots_);
-  for (size_t i = 0; i < num_of_knots_; ++i) {
-    x_.at(i) = osqp_work->solution->x[i] / scale_factor_[0];
-    dx_.at(i) = osqp_work->solution->x[i + num_of_knots_] / scale_factor_[1];
-    ddx_.at(i) =
-        osqp_work->solution->x[i + 2 * num_of_knots_] / scale_factor_[2];
-  }
+  ExtractSolution(osqp_work->solution->x);
 
   // Cleanup
   osqp_cleanup(osqp_work);
@@ -133,6 +143,178 @@ bool PiecewiseJerkProblem::Optimize(const int max_iter) {
   return true;
 }
 
+bool PiecewiseJerkProblem::OptimizeInWorkspace(const int max_iter) {
+  std::vector<c_float> P_data;
+  std::vector<c_int> P_indices;
+  std::vector<c_int> P_indptr;
+  CalculateKernel(&P_data, &P_indices, &P_indptr);
+  // osqp reads the upper triangular part of P only, the workspace keeps just
+  // that part so that the kernel values can be updated in place
+  UpperTriangular(&P_data, &P_indices, &P_indptr);
+
+  std::vector<c_float> A_data;
+  std::vector<c_int> A_indices;
+  std::vector<c_int> A_indptr;
+  std::vector<c_float> lower_bounds;
+  std::vector<c_float> upper_bounds;
+  CalculateAffineConstraint(&A_data, &A_indices, &A_indptr, &lower_bounds,
+                            &upper_bounds);
+
+  std::vector<c_float> q;
+  CalculateOffset(&q);
+
+  CHECK_EQ(lower_bounds.size(), upper_bounds.size());
+  if (CheckLowUpperBound(lower_bounds, upper_bounds)) {
+    return false;
+  }
+
+  PiecewiseJerkWorkspace* ws = workspace_;
+  bool warm = UpdateWorkspace(P_data, P_indices, P_indptr, A_data, A_indices,
+                              A_indptr, lower_bounds, upper_bounds, q,
+                              max_iter);
+  if (!warm) {
+    ws->Reset();
+    OSQPData* data = reinterpret_cast<OSQPData*>(c_malloc(sizeof(OSQPData)));
+    FillData(P_data, P_indices, P_indptr, A_data, A_indices, A_indptr,
+             lower_bounds, upper_bounds, q, data);
+    OSQPSettings* settings = SolverDefaultSettings();
+    settings->max_iter = max_iter;
+    // osqp_setup copies the data and the settings
+    ws->work_ = osqp_setup(data, settings);
+    FreeData(data);
+    c_free(data->P);
+    c_free(data->A);
+    c_free(data);
+    c_free(settings);
+    if (ws->work_ == nullptr) {
+      AERROR << "osqp setup failed";
+      return false;
+    }
+    ++ws->setup_num_;
+    ws->num_of_knots_ = num_of_knots_;
+    ws->num_of_constraints_ = lower_bounds.size();
+    ws->P_data_ = std::move(P_data);
+    ws->P_indices_ = std::move(P_indices);
+    ws->P_indptr_ = std::move(P_indptr);
+    ws->A_data_ = std::move(A_data);
+    ws->A_indices_ = std::move(A_indices);
+    ws->A_indptr_ = std::move(A_indptr);
+  }
+
+  osqp_solve(ws->work_);
+  ++ws->solve_num_;
+  ws->last_iter_ = static_cast<int>(ws->work_->info->iter);
+  auto status = ws->work_->info->status_val;
+  if (status < 0 || (status != 1 && status != 2) ||
+      ws->work_->solution == nullptr) {
+    AERROR << "failed optimization status:\t" << ws->work_->info->status
+           << (warm ? ", retry without warm start" : "");
+    // a stale warm start must not cost a solution the cold setup finds
+    ws->Reset();
+    return warm && OptimizeInWorkspace(max_iter);
+  }
+
+  ExtractSolution(ws->work_->solution->x);
+  ws->solution_.assign(ws->work_->solution->x,
+                       ws->work_->solution->x + 3 * num_of_knots_);
+  ws->start_ = workspace_start_;
+  return true;
+}
+
+bool PiecewiseJerkProblem::UpdateWorkspace(
+    const std::vector<c_float>& P_data, const std::vector<c_int>& P_indices,
+    const std::vector<c_int>& P_indptr, const std::vector<c_float>& A_data,
+    const std::vector<c_int>& A_indices, const std::vector<c_int>& A_indptr,
+    const std::vector<c_float>& lower_bounds,
+    const std::vector<c_float>& upper_bounds, const std::vector<c_float>& q,
+    const int max_iter) {
+  PiecewiseJerkWorkspace* ws = workspace_;
+  // another sparsity needs another symbolic factorization, set up again
+  if (ws->work_ == nullptr || ws->num_of_knots_ != num_of_knots_ ||
+      ws->num_of_constraints_ != lower_bounds.size() ||
+      ws->P_indices_ != P_indices || ws->P_indptr_ != P_indptr ||
+      ws->A_indices_ != A_indices || ws->A_indptr_ != A_indptr) {
+    return false;
+  }
+
+  // new values only refactorize the kkt matrix
+  const bool P_changed = ws->P_data_ != P_data;
+  const bool A_changed = ws->A_data_ != A_data;
+  c_int ret = 0;
+  if (P_changed && A_changed) {
+    ret = osqp_update_P_A(ws->work_, P_data.data(), OSQP_NULL,
+                          static_cast<c_int>(P_data.size()), A_data.data(),
+                          OSQP_NULL, static_cast<c_int>(A_data.size()));
+  } else if (P_changed) {
+    ret = osqp_update_P(ws->work_, P_data.data(), OSQP_NULL,
+                        static_cast<c_int>(P_data.size()));
+  } else if (A_changed) {
+    ret = osqp_update_A(ws->work_, A_data.data(), OSQP_NULL,
+                        static_cast<c_int>(A_data.size()));
+  }
+  if (ret != 0) {
+    return false;
+  }
+  ws->P_data_ = P_data;
+  ws->A_data_ = A_data;
+  if (osqp_update_lin_cost(ws->work_, q.data()) != 0 ||
+      osqp_update_bounds(ws->work_, lower_bounds.data(),
+                         upper_bounds.data()) != 0 ||
+      osqp_update_max_iter(ws->work_, max_iter) != 0) {
+    return false;
+  }
+
+  // the solver goes on from its last iterate, which is the previous solution
+  // unless the knots moved on by whole steps
+  const int n = static_cast<int>(num_of_knots_);
+  const int shift =
+      static_cast<int>(std::lround((workspace_start_ - ws->start_) / delta_s_));
+  if (shift > 0 && shift < n &&
+      ws->solution_.size() == static_cast<size_t>(3 * n)) {
+    std::vector<c_float> x(3 * n);
+    for (int k = 0; k < 3; ++k) {
+      for (int i = 0; i < n; ++i) {
+        x[k * n + i] = ws->solution_[k * n + std::min(i + shift, n - 1)];
+      }
+    }
+    osqp_warm_start_x(ws->work_, x.data());
+    ++ws->shifted_warm_start_num_;
+  }
+  return true;
+}
+
+void PiecewiseJerkProblem::UpperTriangular(std::vector<c_float>* P_data,
+                                           std::vector<c_int>* P_indices,
+                                           std::vector<c_int>* P_indptr) {
+  size_t kept = 0;
+  size_t begin = 0;
+  for (size_t col = 0; col + 1 < P_indptr->size(); ++col) {
+    const size_t end = static_cast<size_t>((*P_indptr)[col + 1]);
+    for (size_t k = begin; k < end; ++k) {
+      if ((*P_indices)[k] <= static_cast<c_int>(col)) {
+        (*P_data)[kept] = (*P_data)[k];
+        (*P_indices)[kept] = (*P_indices)[k];
+        ++kept;
+      }
+    }
+    begin = end;
+    (*P_indptr)[col + 1] = static_cast<c_int>(kept);
+  }
+  P_data->resize(kept);
+  P_indices->resize(kept);
+}
+
+void PiecewiseJerkProblem::ExtractSolution(const c_float* solution) {
+  x_.resize(num_of_knots_);
+  dx_.resize(num_of_knots_);
+  ddx_.resize(num_of_knots_);
+  for (size_t i = 0; i < num_of_knots_; ++i) {
+    x_.at(i) = solution[i] / scale_factor_[0];
+    dx_.at(i) = solution[i + num_of_knots_] / scale_factor_[1];
+    ddx_.at(i) = solution[i + 2 * num_of_knots_] / scale_factor_[2];
+  }
+}
+
 void PiecewiseJerkProblem::CalculateAffineConstraint(
     std::vector<c_float>* A_data, std::vector<c_int>* A_indices,
     std::vector<c_int>* A_indptr, std::vector<c_float>* lower_bounds,
@@ -362,6 +544,16 @@ void PiecewiseJerkProblem::FreeData(OSQPData* data) {
   delete[] data->A->x;
 }
 
+PiecewiseJerkWorkspace::~PiecewiseJerkWorkspace() { Reset(); }
+
+void PiecewiseJerkWorkspace::Reset() {
+  if (work_ != nullptr) {
+    osqp_cleanup(work_);
+    work_ = nullptr;
+  }
+  solution_.clear();
+}
+
 bool PiecewiseJerkProblem::CheckLowUpperBound(
     const std::vector<c_float>& lower, const std::vector<c_float>& upper) {
   for (size_t i = 0; i < lower.size(); i++) {
@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <array>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -29,6 +30,62 @@
 namespace apollo {
 namespace planning {
 
+/*
+ * @brief:
+ * The OSQP workspace of a PiecewiseJerkProblem kept across Optimize calls,
+ * e.g. of successive planning cycles. As long as the problem keeps its
+ * dimension, kernel and constraint sparsity the new values are updated in
+ * place and the solver starts from the previous solution, shifted to the new
+ * start. Not thread safe, one workspace per caller.
+ */
+class PiecewiseJerkWorkspace {
+ public:
+  PiecewiseJerkWorkspace() = default;
+
+  ~PiecewiseJerkWorkspace();
+
+  PiecewiseJerkWorkspace(const PiecewiseJerkWorkspace&) = delete;
+  PiecewiseJerkWorkspace& operator=(const PiecewiseJerkWorkspace&) = delete;
+
+  // drop the workspace, the next Optimize sets up from scratch
+  void Reset();
+
+  // osqp_setup calls and solves so far
+  int setup_num() const { return setup_num_; }
+
+  int solve_num() const { return solve_num_; }
+
+  // solves started from the previous solution shifted to the new start
+  int shifted_warm_start_num() const { return shifted_warm_start_num_; }
+
+  // admm iterations of the last solve
+  int last_iter() const { return last_iter_; }
+
+ private:
+  friend class PiecewiseJerkProblem;
+
+  OSQPWorkspace* work_ = nullptr;
+
+  // the structure the workspace was set up for
+  size_t num_of_knots_ = 0;
+  size_t num_of_constraints_ = 0;
+  std::vector<c_float> P_data_;
+  std::vector<c_int> P_indices_;
+  std::vector<c_int> P_indptr_;
+  std::vector<c_float> A_data_;
+  std::vector<c_int> A_indices_;
+  std::vector<c_int> A_indptr_;
+
+  // scaled primal solution of the last solve and the start of its first knot
+  std::vector<c_float> solution_;
+  double start_ = 0.0;
+
+  int setup_num_ = 0;
+  int solve_num_ = 0;
+  int shifted_warm_start_num_ = 0;
+  int last_iter_ = 0;
+};
+
 /*
  * @brief:
  * This class solve an optimization problem:
@@ -117,6 +174,20 @@ class PiecewiseJerkProblem {
   void set_end_state_ref(const std::array<double, 3>& weight_end_state,
                          const std::array<double, 3>& end_state_ref);
 
+  /**
+   * @brief Solve in the workspace instead of a fresh OSQP setup per call
+   *
+   * @param workspace: owned by the caller, nullptr solves from scratch
+   * @param start: position of the first knot on the axis of the knots, the
+   * previous solution is shifted by the whole knots in between for the warm
+   * start
+   */
+  void set_workspace(PiecewiseJerkWorkspace* workspace,
+                     const double start = 0.0) {
+    workspace_ = workspace;
+    workspace_start_ = start;
+  }
+
   virtual bool Optimize(const int max_iter = 4000);
 
   const std::vector<double>& opt_x() const { return x_; }
@@ -143,8 +214,37 @@ class PiecewiseJerkProblem {
 
   bool FormulateProblem(OSQPData* data);
 
+  void FillData(const std::vector<c_float>& P_data,
+                const std::vector<c_int>& P_indices,
+                const std::vector<c_int>& P_indptr,
+                const std::vector<c_float>& A_data,
+                const std::vector<c_int>& A_indices,
+                const std::vector<c_int>& A_indptr,
+                const std::vector<c_float>& lower_bounds,
+                const std::vector<c_float>& upper_bounds,
+                const std::vector<c_float>& q, OSQPData* data);
+
   void FreeData(OSQPData* data);
 
+  bool OptimizeInWorkspace(const int max_iter);
+
+  // true if the workspace was set up for this structure and took the update
+  bool UpdateWorkspace(const std::vector<c_float>& P_data,
+                       const std::vector<c_int>& P_indices,
+                       const std::vector<c_int>& P_indptr,
+                       const std::vector<c_float>& A_data,
+                       const std::vector<c_int>& A_indices,
+                       const std::vector<c_int>& A_indptr,
+                       const std::vector<c_float>& lower_bounds,
+                       const std::vector<c_float>& upper_bounds,
+                       const std::vector<c_float>& q, const int max_iter);
+
+  void UpperTriangular(std::vector<c_float>* P_data,
+                       std::vector<c_int>* P_indices,
+                       std::vector<c_int>* P_indptr);
+
+  void ExtractSolution(const c_float* solution);
+
   bool CheckLowUpperBound(const std::vector<c_float>& lower,
                           const std::vector<c_float>& upper);
 
@@ -191,6 +291,9 @@ class PiecewiseJerkProblem {
   bool has_end_state_ref_ = false;
   std::array<double, 3> weight_end_state_ = {{0.0, 0.0, 0.0}};
   std::array<double, 3> end_state_ref_;
+
+  PiecewiseJerkWorkspace* workspace_ = nullptr;
+  double workspace_start_ = 0.0;
 };
 
 }  // namespace planning
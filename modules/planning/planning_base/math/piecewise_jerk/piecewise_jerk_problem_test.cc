@@ -0,0 +1,184 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "modules/planning/planning_base/math/piecewise_jerk/piecewise_jerk_problem.h"
+
+#include <array>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "modules/planning/planning_base/math/piecewise_jerk/piecewise_jerk_path_problem.h"
+
+namespace apollo {
+namespace planning {
+
+namespace {
+constexpr double kTolerance = 1e-2;
+}  // namespace
+
+struct Solution {
+  std::vector<double> x;
+  std::vector<double> dx;
+  std::vector<double> ddx;
+};
+
+struct Params {
+  size_t num_of_knots = 60;
+  double delta_s = 0.5;
+  double start_s = 0.0;
+  double weight_ddx = 1000.0;
+  std::array<double, 3> x_init = {{0.0, 0.0, 0.0}};
+  // lateral room around the reference, e.g. nudging a parked car
+  double room = 1.0;
+  double center = 0.0;
+};
+
+// a path that nudges towards the reference at 0.8 within bounds that sway
+// along s, solved in the workspace if any
+bool Solve(const Params& params, PiecewiseJerkWorkspace* workspace,
+           Solution* solution) {
+  const size_t n = params.num_of_knots;
+  std::vector<std::pair<double, double>> x_bounds(n);
+  for (size_t i = 0; i < n; ++i) {
+    const double s = params.start_s + static_cast<double>(i) * params.delta_s;
+    const double center = params.center + 0.3 * std::sin(s / 5.0);
+    x_bounds[i] = {center - params.room, center + params.room};
+  }
+  PiecewiseJerkPathProblem problem(n, params.delta_s, params.x_init);
+  problem.set_x_bounds(std::move(x_bounds));
+  problem.set_dx_bounds(-2.0, 2.0);
+  problem.set_ddx_bounds(-0.5, 0.5);
+  problem.set_dddx_bound(0.5);
+  problem.set_weight_x(1.0);
+  problem.set_weight_dx(100.0);
+  problem.set_weight_ddx(params.weight_ddx);
+  problem.set_weight_dddx(10000.0);
+  problem.set_x_ref(10.0, std::vector<double>(n, 0.8));
+  problem.set_scale_factor({1.0, 10.0, 100.0});
+  problem.set_workspace(workspace, params.start_s);
+  if (!problem.Optimize(4000)) {
+    return false;
+  }
+  solution->x = problem.opt_x();
+  solution->dx = problem.opt_dx();
+  solution->ddx = problem.opt_ddx();
+  return true;
+}
+
+// the workspace solve against a fresh osqp setup of the same problem
+void ExpectMatchesCold(const Params& params,
+                       PiecewiseJerkWorkspace* workspace) {
+  Solution cold;
+  ASSERT_TRUE(Solve(params, nullptr, &cold));
+  Solution warm;
+  ASSERT_TRUE(Solve(params, workspace, &warm));
+  ASSERT_EQ(cold.x.size(), warm.x.size());
+  for (size_t i = 0; i < cold.x.size(); ++i) {
+    EXPECT_NEAR(cold.x[i], warm.x[i], kTolerance) << "knot " << i;
+    EXPECT_NEAR(cold.dx[i], warm.dx[i], kTolerance) << "knot " << i;
+    EXPECT_NEAR(cold.ddx[i], warm.ddx[i], kTolerance) << "knot " << i;
+  }
+}
+
+TEST(PiecewiseJerkProblemTest, workspace_matches_cold_solve) {
+  PiecewiseJerkWorkspace workspace;
+  Params params;
+  ExpectMatchesCold(params, &workspace);
+  EXPECT_EQ(1, workspace.setup_num());
+  EXPECT_EQ(1, workspace.solve_num());
+  const int cold_iter = workspace.last_iter();
+
+  // unchanged, the solver starts from its solution
+  ExpectMatchesCold(params, &workspace);
+  EXPECT_EQ(1, workspace.setup_num());
+  EXPECT_EQ(2, workspace.solve_num());
+  EXPECT_LE(workspace.last_iter(), cold_iter);
+
+  // new kernel values
+  params.weight_ddx = 500.0;
+  ExpectMatchesCold(params, &workspace);
+  EXPECT_EQ(1, workspace.setup_num());
+
+  // new kernel and constraint values, delta_s is in both
+  params.delta_s = 0.4;
+  ExpectMatchesCold(params, &workspace);
+  EXPECT_EQ(1, workspace.setup_num());
+
+  // new bounds and start state only
+  params.x_init = {{0.1, 0.05, 0.0}};
+  params.center = 0.2;
+  ExpectMatchesCold(params, &workspace);
+  EXPECT_EQ(1, workspace.setup_num());
+
+  // another dimension sets up again
+  params.num_of_knots = 80;
+  ExpectMatchesCold(params, &workspace);
+  EXPECT_EQ(2, workspace.setup_num());
+  EXPECT_EQ(6, workspace.solve_num());
+}
+
+TEST(PiecewiseJerkProblemTest, shifted_warm_start) {
+  PiecewiseJerkWorkspace workspace;
+  Params params;
+  Solution first;
+  ASSERT_TRUE(Solve(params, &workspace, &first));
+  EXPECT_EQ(0, workspace.shifted_warm_start_num());
+
+  // the same start is no shift
+  ExpectMatchesCold(params, &workspace);
+  EXPECT_EQ(0, workspace.shifted_warm_start_num());
+
+  // the next cycle starts two knots on, from the state planned there
+  params.start_s += 2.0 * params.delta_s;
+  params.x_init = {{first.x[2], first.dx[2], first.ddx[2]}};
+  ExpectMatchesCold(params, &workspace);
+  EXPECT_EQ(1, workspace.shifted_warm_start_num());
+  EXPECT_EQ(1, workspace.setup_num());
+
+  // a jump past all the knots keeps the last iterate
+  params.start_s += static_cast<double>(params.num_of_knots) * params.delta_s;
+  ExpectMatchesCold(params, &workspace);
+  EXPECT_EQ(1, workspace.shifted_warm_start_num());
+}
+
+TEST(PiecewiseJerkProblemTest, cold_retry_after_failed_warm_solve) {
+  PiecewiseJerkWorkspace workspace;
+  Params params;
+  Solution solution;
+  ASSERT_TRUE(Solve(params, &workspace, &solution));
+  EXPECT_EQ(1, workspace.setup_num());
+  EXPECT_EQ(1, workspace.solve_num());
+
+  // the start state lies outside the room, the warm solve fails and so does
+  // the retry from a fresh setup
+  Params infeasible = params;
+  infeasible.center = 5.0;
+  infeasible.room = 0.5;
+  EXPECT_FALSE(Solve(infeasible, &workspace, &solution));
+  EXPECT_EQ(2, workspace.setup_num());
+  EXPECT_EQ(3, workspace.solve_num());
+
+  // the failed workspace is dropped, the next problem sets up again
+  ExpectMatchesCold(params, &workspace);
+  EXPECT_EQ(3, workspace.setup_num());
+  EXPECT_EQ(4, workspace.solve_num());
+}
+
+}  // namespace planning
+}  // namespace apollo
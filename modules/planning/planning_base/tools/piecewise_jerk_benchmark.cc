@@ -0,0 +1,236 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+// Solve time and osqp iterations of the piecewise jerk path and speed
+// problems over consecutive planning cycles, solved from scratch and in a
+// PiecewiseJerkWorkspace. The cycles replay a drive along a lane with parked
+// cars to nudge around and a lead vehicle to follow, every cycle starts from
+// the state the previous one planned for the cycle time.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gflags/gflags.h"
+
+#include "modules/planning/planning_base/math/piecewise_jerk/piecewise_jerk_path_problem.h"
+#include "modules/planning/planning_base/math/piecewise_jerk/piecewise_jerk_speed_problem.h"
+
+DEFINE_int32(cycles, 300, "planning cycles to replay");
+DEFINE_double(cycle_time, 0.1, "time between the cycles");
+DEFINE_double(cruise_speed, 10.0, "speed of the ego vehicle");
+DEFINE_int32(path_knots, 160, "knots of the path problem");
+DEFINE_double(path_delta_s, 0.5, "distance between the path knots");
+DEFINE_int32(speed_knots, 70, "knots of the speed problem");
+DEFINE_double(speed_delta_t, 0.1, "time between the speed knots");
+
+namespace apollo {
+namespace planning {
+
+namespace {
+constexpr double kHalfLaneWidth = 1.75;
+constexpr double kHalfVehicleWidth = 1.05;
+constexpr double kCarSpacing = 60.0;
+constexpr double kCarLength = 5.0;
+constexpr double kCarIntrusion = 0.6;
+constexpr double kFollowDistance = 20.0;
+}  // namespace
+
+struct Stats {
+  double total_ms = 0.0;
+  int64_t total_iter = 0;
+  int solved = 0;
+};
+
+// lateral room at s of the road, parked cars on alternating sides
+std::pair<double, double> LateralBound(const double s) {
+  double lower = -kHalfLaneWidth + kHalfVehicleWidth;
+  double upper = kHalfLaneWidth - kHalfVehicleWidth;
+  const int car = static_cast<int>(std::floor(s / kCarSpacing));
+  if (car > 0 && s - car * kCarSpacing < kCarLength) {
+    if (car % 2 == 0) {
+      lower += kCarIntrusion;
+    } else {
+      upper -= kCarIntrusion;
+    }
+  }
+  return {lower, upper};
+}
+
+double RoadKappa(const double s) { return 0.01 * std::sin(s / 80.0); }
+
+bool SolvePath(const double start_s, const std::array<double, 3>& init_l,
+               PiecewiseJerkWorkspace* workspace, Stats* stats,
+               std::vector<double>* l, std::vector<double>* dl,
+               std::vector<double>* ddl) {
+  const size_t n = static_cast<size_t>(FLAGS_path_knots);
+  std::vector<std::pair<double, double>> x_bounds(n);
+  std::vector<std::pair<double, double>> ddx_bounds(n);
+  for (size_t i = 0; i < n; ++i) {
+    const double s = start_s + static_cast<double>(i) * FLAGS_path_delta_s;
+    x_bounds[i] = LateralBound(s);
+    ddx_bounds[i] = {-0.2 - RoadKappa(s), 0.2 - RoadKappa(s)};
+  }
+  // keep the start feasible after a nudge
+  x_bounds[0].first = std::min(x_bounds[0].first, init_l[0]);
+  x_bounds[0].second = std::max(x_bounds[0].second, init_l[0]);
+
+  PiecewiseJerkPathProblem problem(n, FLAGS_path_delta_s, init_l);
+  problem.set_x_bounds(std::move(x_bounds));
+  problem.set_dx_bounds(-2.0, 2.0);
+  problem.set_ddx_bounds(std::move(ddx_bounds));
+  problem.set_dddx_bound(0.5 / FLAGS_cruise_speed);
+  problem.set_weight_x(1.0);
+  problem.set_weight_dx(100.0);
+  problem.set_weight_ddx(1000.0);
+  problem.set_weight_dddx(10000.0);
+  problem.set_x_ref(0.0, std::vector<double>(n, 0.0));
+  problem.set_end_state_ref({1000.0, 0.0, 0.0}, {0.0, 0.0, 0.0});
+  problem.set_scale_factor({1.0, 10.0, 100.0});
+  problem.set_workspace(workspace, start_s);
+
+  const auto start = std::chrono::steady_clock::now();
+  const bool success = problem.Optimize(4000);
+  stats->total_ms += std::chrono::duration<double, std::milli>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+  stats->total_iter += workspace->last_iter();
+  if (!success) {
+    return false;
+  }
+  ++stats->solved;
+  *l = problem.opt_x();
+  *dl = problem.opt_dx();
+  *ddl = problem.opt_ddx();
+  return true;
+}
+
+bool SolveSpeed(const double ego_s, const std::array<double, 3>& init_s,
+                PiecewiseJerkWorkspace* workspace, Stats* stats,
+                std::vector<double>* s, std::vector<double>* ds,
+                std::vector<double>* dds) {
+  const size_t n = static_cast<size_t>(FLAGS_speed_knots);
+  // the lead vehicle changes its speed slowly, the ego follows it
+  const double lead_speed =
+      FLAGS_cruise_speed * (0.8 + 0.2 * std::sin(ego_s / 150.0));
+  const double lead_gap = kFollowDistance + 10.0 * std::cos(ego_s / 150.0);
+  std::vector<std::pair<double, double>> x_bounds(n);
+  std::vector<double> x_ref(n);
+  std::vector<double> penalty_dx(n);
+  for (size_t i = 0; i < n; ++i) {
+    const double t = static_cast<double>(i) * FLAGS_speed_delta_t;
+    x_bounds[i] = {0.0, lead_gap + lead_speed * t};
+    x_ref[i] = std::min(FLAGS_cruise_speed * t,
+                        lead_gap - kFollowDistance + lead_speed * t);
+    penalty_dx[i] = std::fabs(RoadKappa(ego_s + FLAGS_cruise_speed * t)) *
+                    1000.0;
+  }
+  x_bounds[0].second = std::max(x_bounds[0].second, init_s[0]);
+
+  PiecewiseJerkSpeedProblem problem(n, FLAGS_speed_delta_t, init_s);
+  problem.set_weight_ddx(1.0);
+  problem.set_weight_dddx(10.0);
+  problem.set_scale_factor({1.0, 10.0, 100.0});
+  problem.set_x_bounds(std::move(x_bounds));
+  problem.set_dx_bounds(0.0, 1.5 * FLAGS_cruise_speed);
+  problem.set_ddx_bounds(-6.0, 2.0);
+  problem.set_dddx_bound(-4.0, 2.0);
+  problem.set_dx_ref(10.0, FLAGS_cruise_speed);
+  problem.set_x_ref(10.0, std::move(x_ref));
+  problem.set_penalty_dx(std::move(penalty_dx));
+  problem.set_workspace(workspace);
+
+  const auto start = std::chrono::steady_clock::now();
+  const bool success = problem.Optimize(4000);
+  stats->total_ms += std::chrono::duration<double, std::milli>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+  stats->total_iter += workspace->last_iter();
+  if (!success) {
+    return false;
+  }
+  ++stats->solved;
+  *s = problem.opt_x();
+  *ds = problem.opt_dx();
+  *dds = problem.opt_ddx();
+  return true;
+}
+
+// state of the knots at the cycle time, as the next cycle is stitched to it
+std::array<double, 3> Stitch(const std::vector<double>& x,
+                             const std::vector<double>& dx,
+                             const std::vector<double>& ddx, const double t) {
+  const size_t i = std::min(x.size() - 1, static_cast<size_t>(std::lround(t)));
+  return {x[i], dx[i], ddx[i]};
+}
+
+void Run(const bool persistent) {
+  PiecewiseJerkWorkspace path_workspace;
+  PiecewiseJerkWorkspace speed_workspace;
+  Stats path_stats;
+  Stats speed_stats;
+  std::array<double, 3> init_l = {0.0, 0.0, 0.0};
+  std::array<double, 3> init_s = {0.0, FLAGS_cruise_speed, 0.0};
+  double ego_s = 0.0;
+  std::vector<double> x, dx, ddx;
+  for (int cycle = 0; cycle < FLAGS_cycles; ++cycle) {
+    if (!persistent) {
+      path_workspace.Reset();
+      speed_workspace.Reset();
+    }
+    if (SolvePath(ego_s, init_l, &path_workspace, &path_stats, &x, &dx,
+                  &ddx)) {
+      init_l = Stitch(x, dx, ddx,
+                      FLAGS_cruise_speed * FLAGS_cycle_time /
+                          FLAGS_path_delta_s);
+    }
+    if (SolveSpeed(ego_s, init_s, &speed_workspace, &speed_stats, &x, &dx,
+                   &ddx)) {
+      init_s = Stitch(x, dx, ddx, FLAGS_cycle_time / FLAGS_speed_delta_t);
+      init_s[0] = 0.0;
+    }
+    ego_s += FLAGS_cruise_speed * FLAGS_cycle_time;
+  }
+
+  const std::string mode = persistent ? "persistent" : "cold      ";
+  for (const auto& item : {std::make_pair("path ", &path_stats),
+                           std::make_pair("speed", &speed_stats)}) {
+    const Stats& stats = *item.second;
+    std::cout << item.first << " " << mode << " solved: " << stats.solved
+              << "/" << FLAGS_cycles
+              << " avg ms: " << stats.total_ms / FLAGS_cycles
+              << " avg iter: "
+              << static_cast<double>(stats.total_iter) / FLAGS_cycles
+              << std::endl;
+  }
+  std::cout << "setups path: " << path_workspace.setup_num()
+            << " speed: " << speed_workspace.setup_num() << std::endl;
+}
+
+}  // namespace planning
+}  // namespace apollo
+
+int main(int argc, char* argv[]) {
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  apollo::planning::Run(false);
+  apollo::planning::Run(true);
+  return 0;
+}
@@ -131,7 +131,8 @@ bool PathOptimizerUtil::OptimizePath(
     const PathBoundary& path_boundary,
     const std::vector<std::pair<double, double>>& ddl_bounds, double dddl_bound,
     const PiecewiseJerkPathConfig& config, std::vector<double>* x,
-    std::vector<double>* dx, std::vector<double>* ddx) {
+    std::vector<double>* dx, std::vector<double>* ddx,
+    PiecewiseJerkWorkspace* workspace) {
   // num of knots
   const auto& lat_boundaries = path_boundary.boundary();
   const size_t kNumKnots = lat_boundaries.size();
@@ -139,6 +140,7 @@ bool PathOptimizerUtil::OptimizePath(
   double delta_s = path_boundary.delta_s();
   PiecewiseJerkPathProblem piecewise_jerk_problem(kNumKnots, delta_s,
                                                   init_state.second);
+  piecewise_jerk_problem.set_workspace(workspace, path_boundary.start_s());
 
   ADCVertexConstraints adc_vertex_constraints;
   // CalculateVertexConstraints(init_state, path_boundary,
@@ -21,6 +21,7 @@
 
 #include "modules/planning/planning_base/common/path/path_data.h"
 #include "modules/planning/planning_base/common/path_boundary.h"
+#include "modules/planning/planning_base/math/piecewise_jerk/piecewise_jerk_problem.h"
 
 namespace apollo {
 namespace planning {
@@ -52,6 +53,8 @@ class PathOptimizerUtil {
       InterPolatedPointVec* extra_constraints);
   /**
    * @brief Piecewise jerk path optimizer.
+   * @param workspace is kept by the caller across cycles, nullptr sets up
+   * the solver from scratch
    */
   static bool OptimizePath(
       const SLState& init_state, const std::array<double, 3>& end_state,
@@ -60,7 +63,8 @@ class PathOptimizerUtil {
       const std::vector<std::pair<double, double>>& ddl_bounds,
       double dddl_bound, const PiecewiseJerkPathConfig& config,
       std::vector<double>* x, std::vector<double>* dx,
-      std::vector<double>* ddx);
+      std::vector<double>* ddx,
+      PiecewiseJerkWorkspace* workspace = nullptr);
 
   static bool OptimizePathWithTowingPoints(
       const SLState& init_state, const std::array<double, 3>& end_state,
@@ -68,5 +68,7 @@ Status Task::Execute(Frame* frame) {
   return Status::OK();
 }
 
+bool Task::ReachesOtherReferenceLines() const { return false; }
+
 }  // namespace planning
 }  // namespace apollo
@@ -50,6 +50,12 @@ class Task {
 
   virtual common::Status Execute(Frame* frame);
 
+  /**
+   * @brief Whether Execute on a reference line reads or writes the other
+   * reference lines of the frame, which rules out planning them concurrently
+   */
+  virtual bool ReachesOtherReferenceLines() const;
+
  protected:
   template <typename T>
   bool LoadConfig(T* config);
@@ -20,16 +20,39 @@
 
 #include "modules/planning/planning_open_space/coarse_trajectory_generator/grid_search.h"
 
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
 namespace apollo {
 namespace planning {
 
 using apollo::common::math::Vec2d;
 
+namespace {
+// bits of GridSearch::dp_cell_states_
+constexpr uint8_t kCellChecked = 1;
+constexpr uint8_t kCellFree = 2;
+constexpr uint8_t kCellAffected = 4;
+
+// 8 个相邻栅格，从上开始，顺时针旋转，相对的两个相差 4
+constexpr int kNeighborNum = 8;
+constexpr int kDx[kNeighborNum] = {0, 1, 1, 1, 0, -1, -1, -1};
+constexpr int kDy[kNeighborNum] = {1, 1, 0, -1, -1, -1, 0, 1};
+
+double StepCost(const int neighbor) {
+  return neighbor % 2 == 0 ? 1.0 : std::sqrt(2.0);
+}
+}  // namespace
+
 GridSearch::GridSearch(const PlannerOpenSpaceConfig& open_space_conf) {
   xy_grid_resolution_ =
       open_space_conf.warm_start_config().grid_a_star_xy_resolution();
   node_radius_ =
       open_space_conf.warm_start_config().node_radius();
+  cache_dp_map_ = open_space_conf.warm_start_config().cache_dp_map();
+  dp_map_max_repair_ratio_ =
+      open_space_conf.warm_start_config().dp_map_max_repair_ratio();
 }
 
 double GridSearch::EuclidDistance(
@@ -38,13 +61,16 @@ double GridSearch::EuclidDistance(
 }
 
 bool GridSearch::CheckConstraints(std::shared_ptr<Node2d> node) {
-  const double node_grid_x = node->GetGridX();
-  const double node_grid_y = node->GetGridY();
+  return CheckConstraints(static_cast<int>(node->GetGridX()),
+                          static_cast<int>(node->GetGridY()));
+}
+
+bool GridSearch::CheckConstraints(const int grid_x, const int grid_y) {
   // 检查是否越界
-  if (node_grid_x > max_grid_x_ ||
-      node_grid_x < 0  ||
-      node_grid_y > max_grid_y_ ||
-      node_grid_y < 0) {
+  if (grid_x > max_grid_x_ ||
+      grid_x < 0  ||
+      grid_y > max_grid_y_ ||
+      grid_y < 0) {
     return false;
   }
   // 碰撞检测-无障碍物
@@ -55,8 +81,9 @@ bool GridSearch::CheckConstraints(std::shared_ptr<Node2d> node) {
   for (const auto& obstacle_linesegments : obstacles_linesegments_vec_) {
     for (const common::math::LineSegment2d& linesegment :
          obstacle_linesegments) {
-      if (linesegment.DistanceTo({node->GetGridX(), node->GetGridY()})
-          < node_radius_) {
+      if (linesegment.DistanceTo({static_cast<double>(grid_x),
+                                  static_cast<double>(grid_y)}) <
+          node_radius_) {
         return false;
       }
     }
@@ -113,11 +140,11 @@ bool GridSearch::GenerateAStarPath(
     const std::vector<std::vector<common::math::LineSegment2d>>&
         obstacles_linesegments_vec,
     GridAStartResult* result) {
-  std::priority_queue<std::pair<std::string, double>,
-                      std::vector<std::pair<std::string, double>>, cmp>
+  std::priority_queue<std::pair<uint64_t, double>,
+                      std::vector<std::pair<uint64_t, double>>, cmp>
       open_pq;
-  std::unordered_map<std::string, std::shared_ptr<Node2d>> open_set;
-  std::unordered_map<std::string, std::shared_ptr<Node2d>> close_set;
+  std::unordered_map<uint64_t, std::shared_ptr<Node2d>> open_set;
+  std::unordered_map<uint64_t, std::shared_ptr<Node2d>> close_set;
   XYbounds_ = XYbounds;
   std::shared_ptr<Node2d> start_node =
       std::make_shared<Node2d>(sx, sy, xy_grid_resolution_, XYbounds_);
@@ -131,7 +158,7 @@ bool GridSearch::GenerateAStarPath(
   // Grid a star begins
   size_t explored_node_num = 0;
   while (!open_pq.empty()) {
-    std::string current_id = open_pq.top().first;
+    uint64_t current_id = open_pq.top().first;
     open_pq.pop();
     std::shared_ptr<Node2d> current_node = open_set[current_id];
     // Check destination
@@ -178,86 +205,275 @@ bool GridSearch::GenerateDpMap(
             obstacles_linesegments_vec,
         const std::vector<std::vector<common::math::LineSegment2d>>&
             soft_boundary_linesegments_vec) {
-  
-  // 依据 cost  升序排序的 Node2d 的 index
-  std::priority_queue<std::pair<std::string, double>,
-                      std::vector<std::pair<std::string, double>>, cmp>
-      open_pq;
-  std::unordered_map<std::string, std::shared_ptr<Node2d>> open_set;
-  dp_map_ = decltype(dp_map_)();
   XYbounds_ = XYbounds;
   // XYbounds with xmin, xmax, ymin, ymax
   max_grid_y_ = std::round((XYbounds_[3] - XYbounds_[2]) / xy_grid_resolution_);
   max_grid_x_ = std::round((XYbounds_[1] - XYbounds_[0]) / xy_grid_resolution_);
-  std::shared_ptr<Node2d> end_node =
-      std::make_shared<Node2d>(ex, ey, xy_grid_resolution_, XYbounds_);
+  grid_x_num_ = static_cast<int>(max_grid_x_) + 1;
+  grid_y_num_ = static_cast<int>(max_grid_y_) + 1;
   obstacles_linesegments_vec_ = obstacles_linesegments_vec;
-  // open_set 放入终点
-  open_set.emplace(end_node->GetIndex(), end_node);
-  // open_pq 放入终点
-  open_pq.emplace(end_node->GetIndex(), end_node->GetCost());
+  dp_map_updated_cells_ = 0;
 
-  // Grid a star begins
-  size_t explored_node_num = 0;
-  // 只要 open_pq 不空
+  const int end_grid_x =
+      static_cast<int>((ex - XYbounds_[0]) / xy_grid_resolution_);
+  const int end_grid_y =
+      static_cast<int>((ey - XYbounds_[2]) / xy_grid_resolution_);
+  if (end_grid_x < 0 || end_grid_x >= grid_x_num_ || end_grid_y < 0 ||
+      end_grid_y >= grid_y_num_) {
+    AERROR << "end of dp map out of XYbounds: " << ex << ", " << ey;
+    dp_XYbounds_.clear();
+    return false;
+  }
+  const size_t end_cell =
+      static_cast<size_t>(end_grid_y) * grid_x_num_ + end_grid_x;
+
+  // 终点和边界不变时复用上次的 dp map，障碍物变化少时只修复受影响的栅格
+  std::vector<std::array<double, 4>> obstacle_keys =
+      ObstacleKeys(obstacles_linesegments_vec);
+  if (cache_dp_map_ && dp_XYbounds_ == XYbounds_ && dp_end_cell_ == end_cell) {
+    if (dp_obstacle_keys_ == obstacle_keys) {
+      ADEBUG << "dp map reused";
+      return true;
+    }
+    if (RepairDpMap(obstacle_keys)) {
+      dp_obstacle_keys_ = std::move(obstacle_keys);
+      ADEBUG << "dp map repaired, updated cells " << dp_map_updated_cells_;
+      return true;
+    }
+  }
+
+  // keeps the capacity of the previous map
+  const size_t cell_num = static_cast<size_t>(grid_x_num_) * grid_y_num_;
+  dp_map_.assign(cell_num, std::numeric_limits<double>::infinity());
+  dp_cell_states_.assign(cell_num, 0);
+  dp_parents_.assign(cell_num, -1);
+
+  dp_map_[end_cell] = 0.0;
+  std::vector<std::pair<uint64_t, double>> open_cells = {{end_cell, 0.0}};
+  PropagateDpMap(&open_cells);
+
+  dp_XYbounds_ = XYbounds_;
+  dp_end_cell_ = end_cell;
+  dp_obstacle_keys_ = std::move(obstacle_keys);
+  ADEBUG << "explored node num is " << dp_map_updated_cells_;
+  return true;
+}
+
+void GridSearch::PropagateDpMap(
+    std::vector<std::pair<uint64_t, double>>* open_cells) {
+  // 依据 cost 升序排序的栅格，同一栅格可有多项，比其 cost 大的已过时
+  std::priority_queue<std::pair<uint64_t, double>,
+                      std::vector<std::pair<uint64_t, double>>, cmp>
+      open_pq(cmp(), std::move(*open_cells));
   while (!open_pq.empty()) {
-    
-    // 取出 open 优先队列中 cost 最小的 index
-    const std::string current_id = open_pq.top().first;
+    const size_t current_cell = open_pq.top().first;
+    const double current_cost = open_pq.top().second;
     open_pq.pop();
-    std::shared_ptr<Node2d> current_node = open_set[current_id];
-    
-    // 将当前节点加入 dp_map_
-    dp_map_.emplace(current_node->GetIndex(), current_node);
-    
-    // 拓展8 个节点，从上开始，顺时针旋转
-    std::vector<std::shared_ptr<Node2d>> next_nodes =
-        std::move(GenerateNextNodes(current_node));
-    // 遍历子节点
-    for (auto& next_node : next_nodes) {
-      // 检查是否符合约束，不符合则跳过
-      if (!CheckConstraints(next_node)) {
+    if (current_cost > dp_map_[current_cell]) {
+      continue;
+    }
+    const int grid_x = static_cast<int>(current_cell % grid_x_num_);
+    const int grid_y = static_cast<int>(current_cell / grid_x_num_);
+
+    for (int i = 0; i < kNeighborNum; ++i) {
+      const int next_x = grid_x + kDx[i];
+      const int next_y = grid_y + kDy[i];
+      if (next_x < 0 || next_x >= grid_x_num_ || next_y < 0 ||
+          next_y >= grid_y_num_) {
         continue;
       }
-      // 如果已经在 dp_map_ 中，则跳过
-      if (dp_map_.find(next_node->GetIndex()) != dp_map_.end()) {
+      const size_t next_cell =
+          static_cast<size_t>(next_y) * grid_x_num_ + next_x;
+      const double next_cost = current_cost + StepCost(i);
+      if (next_cost >= dp_map_[next_cell]) {
         continue;
       }
-      // 如果不在 open_set 中，则加入 open_set 和 open_pq
-      if (open_set.find(next_node->GetIndex()) == open_set.end()) {
-        ++explored_node_num;
-        // 设置 pre_node
-        next_node->SetPreNode(current_node);
-        open_set.emplace(next_node->GetIndex(), next_node);
-        open_pq.emplace(next_node->GetIndex(), next_node->GetCost());
-      } 
-      // 如果已经在 open_set 中
-      else {
-        // 如果 cost 更小，则更新 cost 和 pre_node
-        if (open_set[next_node->GetIndex()]->GetCost() > next_node->GetCost()) {
-          open_set[next_node->GetIndex()]->SetCost(next_node->GetCost());
-          open_set[next_node->GetIndex()]->SetPreNode(current_node);
+      // 每个栅格只做一次碰撞检测
+      uint8_t& state = dp_cell_states_[next_cell];
+      if (!(state & kCellChecked)) {
+        state |= kCellChecked;
+        if (CheckConstraints(next_x, next_y)) {
+          state |= kCellFree;
         }
       }
+      if (!(state & kCellFree)) {
+        continue;
+      }
+      ++dp_map_updated_cells_;
+      dp_map_[next_cell] = next_cost;
+      dp_parents_[next_cell] = static_cast<int8_t>((i + 4) % kNeighborNum);
+      open_pq.emplace(next_cell, next_cost);
     }
   }
-  ADEBUG << "explored node num is " << explored_node_num;
+}
+
+std::vector<std::array<double, 4>> GridSearch::ObstacleKeys(
+    const std::vector<std::vector<common::math::LineSegment2d>>&
+        obstacles_linesegments_vec) {
+  std::vector<std::array<double, 4>> keys;
+  for (const auto& obstacle_linesegments : obstacles_linesegments_vec) {
+    for (const auto& linesegment : obstacle_linesegments) {
+      keys.push_back({linesegment.start().x(), linesegment.start().y(),
+                      linesegment.end().x(), linesegment.end().y()});
+    }
+  }
+  std::sort(keys.begin(), keys.end());
+  return keys;
+}
+
+bool GridSearch::RepairDpMap(
+    const std::vector<std::array<double, 4>>& obstacle_keys) {
+  // 增加和移除的线段
+  std::vector<std::array<double, 4>> changed_keys;
+  std::set_symmetric_difference(
+      dp_obstacle_keys_.begin(), dp_obstacle_keys_.end(),
+      obstacle_keys.begin(), obstacle_keys.end(),
+      std::back_inserter(changed_keys));
+
+  // 线段附近可能改变可行性的栅格，与 CheckConstraints 同在栅格坐标下
+  const size_t max_affected_num = static_cast<size_t>(
+      dp_map_max_repair_ratio_ * static_cast<double>(dp_map_.size()));
+  std::vector<size_t> affected_cells;
+  bool too_many = false;
+  for (const auto& key : changed_keys) {
+    const common::math::LineSegment2d linesegment({key[0], key[1]},
+                                                  {key[2], key[3]});
+    const int min_x = std::max(
+        0, static_cast<int>(
+               std::floor(std::min(key[0], key[2]) - node_radius_)));
+    const int max_x = std::min(
+        grid_x_num_ - 1,
+        static_cast<int>(std::ceil(std::max(key[0], key[2]) + node_radius_)));
+    const int min_y = std::max(
+        0, static_cast<int>(
+               std::floor(std::min(key[1], key[3]) - node_radius_)));
+    const int max_y = std::min(
+        grid_y_num_ - 1,
+        static_cast<int>(std::ceil(std::max(key[1], key[3]) + node_radius_)));
+    for (int y = min_y; y <= max_y && !too_many; ++y) {
+      for (int x = min_x; x <= max_x; ++x) {
+        const size_t cell = static_cast<size_t>(y) * grid_x_num_ + x;
+        if ((dp_cell_states_[cell] & kCellAffected) ||
+            linesegment.DistanceTo({static_cast<double>(x),
+                                    static_cast<double>(y)}) >= node_radius_) {
+          continue;
+        }
+        dp_cell_states_[cell] |= kCellAffected;
+        affected_cells.push_back(cell);
+      }
+      too_many = affected_cells.size() > max_affected_num;
+    }
+    if (too_many) {
+      break;
+    }
+  }
+  for (const size_t cell : affected_cells) {
+    dp_cell_states_[cell] &= static_cast<uint8_t>(~kCellAffected);
+  }
+  if (too_many) {
+    return false;
+  }
+
+  // 可行性改变的栅格，未检测过的栅格到达时再检测
+  std::vector<size_t> blocked_cells;
+  std::vector<size_t> freed_cells;
+  for (const size_t cell : affected_cells) {
+    uint8_t& state = dp_cell_states_[cell];
+    if (!(state & kCellChecked)) {
+      continue;
+    }
+    const bool free = CheckConstraints(static_cast<int>(cell % grid_x_num_),
+                                       static_cast<int>(cell / grid_x_num_));
+    if (free == static_cast<bool>(state & kCellFree)) {
+      continue;
+    }
+    if (free) {
+      state |= kCellFree;
+      freed_cells.push_back(cell);
+    } else {
+      state &= static_cast<uint8_t>(~kCellFree);
+      // 终点的 cost 总为 0
+      if (cell != dp_end_cell_) {
+        blocked_cells.push_back(cell);
+      }
+    }
+  }
+
+  // 被阻挡的栅格及 cost 经过它们的栅格失效
+  std::vector<size_t> invalid_cells = blocked_cells;
+  for (size_t i = 0; i < invalid_cells.size(); ++i) {
+    const size_t cell = invalid_cells[i];
+    dp_map_[cell] = std::numeric_limits<double>::infinity();
+    dp_parents_[cell] = -1;
+    const int grid_x = static_cast<int>(cell % grid_x_num_);
+    const int grid_y = static_cast<int>(cell / grid_x_num_);
+    for (int j = 0; j < kNeighborNum; ++j) {
+      const int next_x = grid_x + kDx[j];
+      const int next_y = grid_y + kDy[j];
+      if (next_x < 0 || next_x >= grid_x_num_ || next_y < 0 ||
+          next_y >= grid_y_num_) {
+        continue;
+      }
+      const size_t next_cell =
+          static_cast<size_t>(next_y) * grid_x_num_ + next_x;
+      if (dp_parents_[next_cell] == (j + 4) % kNeighborNum &&
+          !std::isinf(dp_map_[next_cell])) {
+        // 先置为无穷大，避免重复加入
+        dp_map_[next_cell] = std::numeric_limits<double>::infinity();
+        invalid_cells.push_back(next_cell);
+      }
+    }
+  }
+
+  // 失效和新可行的栅格从相邻栅格取 cost，再向外传播
+  std::vector<std::pair<uint64_t, double>> open_cells;
+  invalid_cells.insert(invalid_cells.end(), freed_cells.begin(),
+                       freed_cells.end());
+  for (const size_t cell : invalid_cells) {
+    if (!(dp_cell_states_[cell] & kCellFree)) {
+      continue;
+    }
+    const int grid_x = static_cast<int>(cell % grid_x_num_);
+    const int grid_y = static_cast<int>(cell / grid_x_num_);
+    for (int j = 0; j < kNeighborNum; ++j) {
+      const int next_x = grid_x + kDx[j];
+      const int next_y = grid_y + kDy[j];
+      if (next_x < 0 || next_x >= grid_x_num_ || next_y < 0 ||
+          next_y >= grid_y_num_) {
+        continue;
+      }
+      const size_t next_cell =
+          static_cast<size_t>(next_y) * grid_x_num_ + next_x;
+      const double cost = dp_map_[next_cell] + StepCost(j);
+      if (cost < dp_map_[cell]) {
+        dp_map_[cell] = cost;
+        dp_parents_[cell] = static_cast<int8_t>(j);
+      }
+    }
+    if (!std::isinf(dp_map_[cell])) {
+      open_cells.emplace_back(cell, dp_map_[cell]);
+    }
+  }
+  dp_map_updated_cells_ = invalid_cells.size();
+  PropagateDpMap(&open_cells);
   return true;
 }
 
 double GridSearch::CheckDpMap(const double sx, const double sy) {
-  
-  // 根据坐标计算 index
-  std::string index = Node2d::CalcIndex(sx, sy, xy_grid_resolution_, XYbounds_);
-  
-  // 若 dp_map_ 中存在该点，则返回成本
-  if (dp_map_.find(index) != dp_map_.end()) {
-    return dp_map_[index]->GetCost() * xy_grid_resolution_;
-  } 
-  // 否则返回无穷大
-  else {
+  // 根据坐标计算栅格
+  const int grid_x =
+      static_cast<int>((sx - XYbounds_[0]) / xy_grid_resolution_);
+  const int grid_y =
+      static_cast<int>((sy - XYbounds_[2]) / xy_grid_resolution_);
+
+  // 栅格在地图外，返回无穷大
+  if (grid_x < 0 || grid_x >= grid_x_num_ || grid_y < 0 ||
+      grid_y >= grid_y_num_) {
     return std::numeric_limits<double>::infinity();
   }
+  // 未到达的栅格为无穷大
+  return dp_map_[static_cast<size_t>(grid_y) * grid_x_num_ + grid_x] *
+         xy_grid_resolution_;
 }
 
 void GridSearch::LoadGridAStarResult(GridAStartResult* result) {
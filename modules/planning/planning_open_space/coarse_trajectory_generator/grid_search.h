@@ -20,6 +20,8 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <limits>
 #include <memory>
 #include <queue>
@@ -29,8 +31,6 @@
 #include <unordered_set>
 #include <vector>
 
-#include "absl/strings/str_cat.h"
-
 #include "modules/planning/planning_open_space/proto/planner_open_space_config.pb.h"
 
 #include "cyber/common/log.h"
@@ -46,13 +46,13 @@ class Node2d {
     // XYbounds with xmin, xmax, ymin, ymax
     grid_x_ = static_cast<int>((x - XYbounds[0]) / xy_resolution);
     grid_y_ = static_cast<int>((y - XYbounds[2]) / xy_resolution);
-    index_ = ComputeStringIndex(grid_x_, grid_y_);
+    index_ = ComputeIndex(grid_x_, grid_y_);
   }
   Node2d(const int grid_x, const int grid_y,
          const std::vector<double>& XYbounds) {
     grid_x_ = grid_x;
     grid_y_ = grid_y;
-    index_ = ComputeStringIndex(grid_x_, grid_y_);
+    index_ = ComputeIndex(grid_x_, grid_y_);
   }
   void SetPathCost(const double path_cost) {
     path_cost_ = path_cost;
@@ -75,23 +75,24 @@ class Node2d {
   double GetDistanceToObstacle() const {
       return distance_to_obstacle_;
   }
-  const std::string& GetIndex() const { return index_; }
+  uint64_t GetIndex() const { return index_; }
   std::shared_ptr<Node2d> GetPreNode() const { return pre_node_; }
-  static std::string CalcIndex(const double x, const double y,
-                               const double xy_resolution,
-                               const std::vector<double>& XYbounds) {
+  static uint64_t CalcIndex(const double x, const double y,
+                            const double xy_resolution,
+                            const std::vector<double>& XYbounds) {
     // XYbounds with xmin, xmax, ymin, ymax
     int grid_x = static_cast<int>((x - XYbounds[0]) / xy_resolution);
     int grid_y = static_cast<int>((y - XYbounds[2]) / xy_resolution);
-    return ComputeStringIndex(grid_x, grid_y);
+    return ComputeIndex(grid_x, grid_y);
   }
   bool operator==(const Node2d& right) const {
     return right.GetIndex() == index_;
   }
 
  private:
-  static std::string ComputeStringIndex(int x_grid, int y_grid) {
-    return absl::StrCat(x_grid, "_", y_grid);
+  static uint64_t ComputeIndex(int x_grid, int y_grid) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x_grid)) << 32) |
+           static_cast<uint32_t>(y_grid);
   }
 
  private:
@@ -101,7 +102,7 @@ class Node2d {
   double heuristic_ = 0.0;
   double cost_ = 0.0;
   double distance_to_obstacle_ = std::numeric_limits<double>::max();
-  std::string index_;
+  uint64_t index_ = 0;
   std::shared_ptr<Node2d> pre_node_ = nullptr;
 };
 
@@ -130,6 +131,8 @@ class GridSearch {
           const std::vector<std::vector<common::math::LineSegment2d>>&
               soft_boundary_linesegments_vec = {{}});
   double CheckDpMap(const double sx, const double sy);
+  // cells relaxed by the last GenerateDpMap, 0 if the cached map was reused
+  size_t dp_map_updated_cells() const { return dp_map_updated_cells_; }
 
  private:
   double EuclidDistance(const double x1, const double y1, const double x2,
@@ -137,6 +140,17 @@ class GridSearch {
   std::vector<std::shared_ptr<Node2d>> GenerateNextNodes(
       std::shared_ptr<Node2d> node);
   bool CheckConstraints(std::shared_ptr<Node2d> node);
+  bool CheckConstraints(const int grid_x, const int grid_y);
+  // segments as (start x, start y, end x, end y), sorted
+  static std::vector<std::array<double, 4>> ObstacleKeys(
+      const std::vector<std::vector<common::math::LineSegment2d>>&
+          obstacles_linesegments_vec);
+  // update the cached dp map for the obstacles changed since, false if they
+  // affect too many cells
+  bool RepairDpMap(const std::vector<std::array<double, 4>>& obstacle_keys);
+  // Dijkstra from the cells queued, lowering the costs of dp_map_
+  void PropagateDpMap(
+      std::vector<std::pair<uint64_t, double>>* open_cells);
   void LoadGridAStarResult(GridAStartResult* result);
 
  private:
@@ -152,14 +166,27 @@ class GridSearch {
       obstacles_linesegments_vec_;
 
   struct cmp {
-      bool operator()(const std::pair<std::string,
-                      double>& left,
-                      const std::pair<std::string, double>& right) const {
+      bool operator()(const std::pair<uint64_t, double>& left,
+                      const std::pair<uint64_t, double>& right) const {
           return left.second >= right.second;
       }
   };
-  // 基于终点的所有节点的 index-cost 无序图
-  std::unordered_map<std::string, std::shared_ptr<Node2d>> dp_map_;
+  // 基于终点的所有栅格的 cost，未到达为无穷大
+  // cell index: grid_y * grid_x_num_ + grid_x
+  std::vector<double> dp_map_;
+  // whether a cell of dp_map_ was checked and is free
+  std::vector<uint8_t> dp_cell_states_;
+  // neighbor a cell of dp_map_ gets its cost from, -1 for none
+  std::vector<int8_t> dp_parents_;
+  int grid_x_num_ = 0;
+  int grid_y_num_ = 0;
+  // what the cached dp map is for, empty dp_XYbounds_ for none
+  bool cache_dp_map_ = true;
+  double dp_map_max_repair_ratio_ = 0.0;
+  std::vector<double> dp_XYbounds_;
+  size_t dp_end_cell_ = 0;
+  std::vector<std::array<double, 4>> dp_obstacle_keys_;
+  size_t dp_map_updated_cells_ = 0;
 
   // park generic
  public:
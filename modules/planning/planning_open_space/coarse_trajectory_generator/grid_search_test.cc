@@ -0,0 +1,91 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "modules/planning/planning_open_space/coarse_trajectory_generator/grid_search.h"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+namespace apollo {
+namespace planning {
+
+using apollo::common::math::LineSegment2d;
+using apollo::common::math::Vec2d;
+
+class GridSearchTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {
+    conf_.mutable_warm_start_config()->set_grid_a_star_xy_resolution(0.5);
+    conf_.mutable_warm_start_config()->set_node_radius(1.0);
+  }
+
+ protected:
+  // the dp map of a search without cache for the same problem
+  void ExpectSameDpMap(
+      GridSearch* grid_search,
+      const std::vector<std::vector<LineSegment2d>>& obstacles) {
+    PlannerOpenSpaceConfig conf = conf_;
+    conf.mutable_warm_start_config()->set_cache_dp_map(false);
+    GridSearch fresh(conf);
+    ASSERT_TRUE(fresh.GenerateDpMap(ex_, ey_, XYbounds_, obstacles));
+    for (double x = XYbounds_[0]; x < XYbounds_[1]; x += 0.5) {
+      for (double y = XYbounds_[2]; y < XYbounds_[3]; y += 0.5) {
+        const double cost = fresh.CheckDpMap(x + 0.1, y + 0.1);
+        if (std::isinf(cost)) {
+          EXPECT_TRUE(std::isinf(grid_search->CheckDpMap(x + 0.1, y + 0.1)));
+        } else {
+          EXPECT_NEAR(grid_search->CheckDpMap(x + 0.1, y + 0.1), cost, 1e-9);
+        }
+      }
+    }
+  }
+
+  PlannerOpenSpaceConfig conf_;
+  std::vector<double> XYbounds_ = {0.0, 20.0, 0.0, 20.0};
+  double ex_ = 10.0;
+  double ey_ = 2.0;
+};
+
+TEST_F(GridSearchTest, RepairDpMap) {
+  GridSearch grid_search(conf_);
+  // walls in the grid coordinates the constraints are checked in
+  std::vector<std::vector<LineSegment2d>> obstacles = {
+      {LineSegment2d(Vec2d(0.0, 20.0), Vec2d(30.0, 20.0))},
+      {LineSegment2d(Vec2d(10.0, 30.0), Vec2d(40.0, 30.0))}};
+  ASSERT_TRUE(grid_search.GenerateDpMap(ex_, ey_, XYbounds_, obstacles));
+  const size_t full_cells = grid_search.dp_map_updated_cells();
+  EXPECT_GT(full_cells, 0U);
+
+  // nothing changed
+  ASSERT_TRUE(grid_search.GenerateDpMap(ex_, ey_, XYbounds_, obstacles));
+  EXPECT_EQ(grid_search.dp_map_updated_cells(), 0U);
+
+  // the first wall gets longer, the second one is removed
+  obstacles[0].emplace_back(Vec2d(30.0, 20.0), Vec2d(35.0, 20.0));
+  obstacles.pop_back();
+  ASSERT_TRUE(grid_search.GenerateDpMap(ex_, ey_, XYbounds_, obstacles));
+  EXPECT_LT(grid_search.dp_map_updated_cells(), full_cells);
+  ExpectSameDpMap(&grid_search, obstacles);
+
+  // another end is another map
+  ex_ = 5.0;
+  ASSERT_TRUE(grid_search.GenerateDpMap(ex_, ey_, XYbounds_, obstacles));
+  ExpectSameDpMap(&grid_search, obstacles);
+}
+
+}  // namespace planning
+}  // namespace apollo
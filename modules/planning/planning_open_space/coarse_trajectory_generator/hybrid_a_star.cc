@@ -21,7 +21,6 @@
 #include "modules/planning/planning_open_space/coarse_trajectory_generator/hybrid_a_star.h"
 
 #include <limits>
-#include <unordered_set>
 
 #include "modules/planning/planning_base/common/path/discretized_path.h"
 #include "modules/planning/planning_base/common/speed/speed_data.h"
@@ -35,6 +34,12 @@ using apollo::common::math::Box2d;
 using apollo::common::math::Vec2d;
 using apollo::cyber::Clock;
 
+namespace {
+constexpr uint8_t kNodeUnvisited = 0;
+constexpr uint8_t kNodeOpen = 1;
+constexpr uint8_t kNodeClosed = 2;
+}  // namespace
+
 HybridAStar::HybridAStar(const PlannerOpenSpaceConfig& open_space_conf) {
   planner_open_space_config_.CopyFrom(open_space_conf);
   reed_shepp_generator_ =
@@ -181,6 +186,36 @@ bool HybridAStar::ValidityCheck(std::shared_ptr<Node3d> node) {
     // 获取车辆矩形，判断是否与障碍物线段发生碰撞
     Box2d bounding_box = Node3d::GetBoundingBox(
         vehicle_param_, traversed_x[i], traversed_y[i], traversed_phi[i]);
+    if (HasCollision(bounding_box)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void HybridAStar::BuildObstacleIndex() {
+  obstacle_kdtree_.reset();
+  obstacle_segment_boxes_.clear();
+  if (!planner_open_space_config_.warm_start_config().use_collision_index()) {
+    return;
+  }
+  for (const auto& obstacle_linesegments : obstacles_linesegments_vec_) {
+    for (const auto& linesegment : obstacle_linesegments) {
+      obstacle_segment_boxes_.emplace_back(linesegment);
+    }
+  }
+  if (obstacle_segment_boxes_.empty()) {
+    return;
+  }
+  common::math::AABoxKDTreeParams params;
+  params.max_leaf_dimension = 5.0;
+  params.max_leaf_size = 16;
+  obstacle_kdtree_.reset(new common::math::AABoxKDTree2d<ObstacleSegmentBox>(
+      obstacle_segment_boxes_, params));
+}
+
+bool HybridAStar::HasCollision(const Box2d& bounding_box) const {
+  if (obstacle_kdtree_ == nullptr) {
     for (const auto& obstacle_linesegments : obstacles_linesegments_vec_) {
       for (const common::math::LineSegment2d& linesegment :
            obstacle_linesegments) {
@@ -189,12 +224,64 @@ bool HybridAStar::ValidityCheck(std::shared_ptr<Node3d> node) {
           ADEBUG << "collision start at y: " << linesegment.start().y();
           ADEBUG << "collision end at x: " << linesegment.end().x();
           ADEBUG << "collision end at y: " << linesegment.end().y();
-          return false;
+          return true;
         }
       }
     }
+    return false;
   }
-  return true;
+
+  // a segment overlapping the box is within its circumcircle, and one
+  // within its incircle overlaps it
+  const Vec2d& center = bounding_box.center();
+  const double radius = bounding_box.diagonal() / 2.0;
+  const double distance =
+      obstacle_kdtree_->GetNearestObject(center)->DistanceTo(center);
+  if (distance > radius) {
+    return false;
+  }
+  if (distance <
+      std::min(bounding_box.half_length(), bounding_box.half_width())) {
+    return true;
+  }
+  for (const auto* object : obstacle_kdtree_->GetObjects(center, radius)) {
+    if (bounding_box.HasOverlap(object->segment())) {
+      ADEBUG << "collision start at x: " << object->segment().start().x();
+      ADEBUG << "collision start at y: " << object->segment().start().y();
+      ADEBUG << "collision end at x: " << object->segment().end().x();
+      ADEBUG << "collision end at y: " << object->segment().end().y();
+      return true;
+    }
+  }
+  return false;
+}
+
+void HybridAStar::ResetNodeStates() {
+  const auto& warm_start_config =
+      planner_open_space_config_.warm_start_config();
+  x_cells_ = static_cast<int>((XYbounds_[1] - XYbounds_[0]) /
+                              warm_start_config.xy_grid_resolution()) +
+             1;
+  y_cells_ = static_cast<int>((XYbounds_[3] - XYbounds_[2]) /
+                              warm_start_config.xy_grid_resolution()) +
+             1;
+  phi_cells_ = static_cast<int>(2 * M_PI /
+                                warm_start_config.phi_grid_resolution()) +
+               1;
+  // keeps the capacity of the previous search
+  node_states_.assign(static_cast<size_t>(x_cells_) * y_cells_ * phi_cells_,
+                      kNodeUnvisited);
+}
+
+size_t HybridAStar::NodeCell(const Node3d& node) const {
+  // the grid of the searched nodes is in the bounds, the one of a start pose
+  // may not be, and its heading may not be normalized
+  const int x_grid = std::max(0, std::min(node.GetGridX(), x_cells_ - 1));
+  const int y_grid = std::max(0, std::min(node.GetGridY(), y_cells_ - 1));
+  const int phi_grid =
+      (node.GetGridPhi() % phi_cells_ + phi_cells_) % phi_cells_;
+  return (static_cast<size_t>(phi_grid) * y_cells_ + y_grid) * x_cells_ +
+         x_grid;
 }
 
 std::shared_ptr<Node3d> HybridAStar::LoadRSPinCS(
@@ -234,18 +321,18 @@ std::shared_ptr<Node3d> HybridAStar::Next_node_generator(
   }
   // take above motion primitive to generate a curve driving the car to a
   // different grid
-  std::vector<double> intermediate_x;
-  std::vector<double> intermediate_y;
-  std::vector<double> intermediate_phi;
+  intermediate_x_.clear();
+  intermediate_y_.clear();
+  intermediate_phi_.clear();
 
   // 获取当前节点的位姿
   double last_x = current_node->GetX();
   double last_y = current_node->GetY();
   double last_phi = current_node->GetPhi();
 
-  intermediate_x.push_back(last_x);
-  intermediate_y.push_back(last_y);
-  intermediate_phi.push_back(last_phi);
+  intermediate_x_.push_back(last_x);
+  intermediate_y_.push_back(last_y);
+  intermediate_phi_.push_back(last_phi);
 
   // 计算 arc_length_ 长度下的经过的点位姿
   for (size_t i = 0; i < arc_length_ / step_size_; ++i) {
@@ -259,26 +346,26 @@ std::shared_ptr<Node3d> HybridAStar::Next_node_generator(
     const double next_y = last_y +
                           traveled_distance *
                           std::sin((last_phi + next_phi) / 2.0);
-    intermediate_x.push_back(next_x);
-    intermediate_y.push_back(next_y);
-    intermediate_phi.push_back(common::math::NormalizeAngle(next_phi));
+    intermediate_x_.push_back(next_x);
+    intermediate_y_.push_back(next_y);
+    intermediate_phi_.push_back(common::math::NormalizeAngle(next_phi));
     last_x = next_x;
     last_y = next_y;
     last_phi = next_phi;
   }
 
   // 若拓展的节点超过边界，拓展失败，返回 nullptr
-  if (intermediate_x.back() > XYbounds_[1] ||
-      intermediate_x.back() < XYbounds_[0] ||
-      intermediate_y.back() > XYbounds_[3] ||
-      intermediate_y.back() < XYbounds_[2]) {
+  if (intermediate_x_.back() > XYbounds_[1] ||
+      intermediate_x_.back() < XYbounds_[0] ||
+      intermediate_y_.back() > XYbounds_[3] ||
+      intermediate_y_.back() < XYbounds_[2]) {
     return nullptr;
   }
 
   // 创建拓展节点 Node3d，设置父节点、行驶方向、转向角
-  std::shared_ptr<Node3d> next_node = std::shared_ptr<Node3d>(
-      new Node3d(intermediate_x, intermediate_y, intermediate_phi, XYbounds_,
-                 planner_open_space_config_));
+  std::shared_ptr<Node3d> next_node = node_pool_.New();
+  next_node->Init(intermediate_x_, intermediate_y_, intermediate_phi_,
+                  XYbounds_, planner_open_space_config_);
   next_node->SetPre(current_node);
   next_node->SetDirec(traveled_distance > 0.0);
   next_node->SetSteer(steering);
@@ -802,10 +889,10 @@ bool HybridAStar::Plan(
     bool reeds_sheep_last_straight) {
   reed_shepp_generator_->reeds_sheep_last_straight_ = reeds_sheep_last_straight;
   // clear containers
-  open_set_.clear();
-  close_set_.clear();
   open_pq_ = decltype(open_pq_)();
   final_node_ = nullptr;
+  node_pool_.Reset();
+  explored_node_num_ = 0;
   PrintCurves print_curves;
   /*
   障碍物点集=>障碍物线段集
@@ -827,6 +914,7 @@ bool HybridAStar::Plan(
   }
   // 通过 std::move 移动资源
   obstacles_linesegments_vec_ = std::move(obstacles_linesegments_vec);
+  BuildObstacleIndex();
 
   // 绘图 map 添加障碍物的 index ：障碍物点坐标x,y 的 pair 的 vector映射
   for (size_t i = 0; i < obstacles_linesegments_vec_.size(); i++) {
@@ -866,6 +954,7 @@ bool HybridAStar::Plan(
   print_curves.AddPoint("vehicle_end_box", ebox.GetAllCorners());
   
   XYbounds_ = XYbounds;
+  ResetNodeStates();
   // load nodes and obstacles
   start_node_.reset(
       new Node3d({sx}, {sy}, {sphi}, XYbounds_, planner_open_space_config_));
@@ -897,7 +986,7 @@ bool HybridAStar::Plan(
   ADEBUG << "map time " << Clock::NowInSeconds() - map_time;
   
   // 将起点加入 open_set 和 open_pq
-  open_set_.insert(start_node_->GetIndex());
+  node_states_[NodeCell(*start_node_)] = kNodeOpen;
   open_pq_.emplace(start_node_, start_node_->GetCost());
 
   // Hybrid A* begins
@@ -944,7 +1033,7 @@ bool HybridAStar::Plan(
     explored_node_num++;
     const double rs_end_time = Clock::NowInSeconds();
     rs_time += rs_end_time - rs_start_time;
-    close_set_.insert(current_node->GetIndex());
+    node_states_[NodeCell(*current_node)] = kNodeClosed;
 
     if (Clock::NowInSeconds() - astar_start_time >
             planner_open_space_config_.warm_start_config()
@@ -956,7 +1045,7 @@ bool HybridAStar::Plan(
     size_t begin_index = 0;
     // 拓展子节点数量
     size_t end_index = next_node_num_;
-    std::unordered_set<std::string> temp_set;
+    opened_cells_.clear();
 
     // 拓展子节点
     for (size_t i = begin_index; i < end_index; ++i) {
@@ -970,8 +1059,9 @@ bool HybridAStar::Plan(
         continue;
       }
 
-      // 检查若子节点在 close_set_ 中，则跳过
-      if (close_set_.count(next_node->GetIndex()) > 0) {
+      // 检查若子节点已关闭，则跳过
+      const size_t next_cell = NodeCell(*next_node);
+      if (node_states_[next_cell] == kNodeClosed) {
         continue;
       }
 
@@ -982,8 +1072,8 @@ bool HybridAStar::Plan(
       }
       validity_check_time += Clock::NowInSeconds() - validity_check_start_time;
 
-      // 若子节点不在 open_set_ 中，则将其加入 open_pq_
-      if (open_set_.count(next_node->GetIndex()) == 0) {
+      // 若子节点未打开，则将其加入 open_pq_
+      if (node_states_[next_cell] == kNodeUnvisited) {
         const double start_time = Clock::NowInSeconds();
 
         // 计算节点代价
@@ -991,15 +1081,18 @@ bool HybridAStar::Plan(
         const double end_time = Clock::NowInSeconds();
         heuristic_time += end_time - start_time;
 
-        temp_set.insert(next_node->GetIndex());
+        opened_cells_.push_back(next_cell);
         open_pq_.emplace(next_node, next_node->GetCost());
       }
     }
 
-    // 将所有不在 open_set_ 中的子节点加入 open_set_
-    open_set_.insert(temp_set.begin(), temp_set.end());
+    // 打开所有未打开的子节点
+    for (const size_t cell : opened_cells_) {
+      node_states_[cell] = kNodeOpen;
+    }
   }
 
+  explored_node_num_ = explored_node_num;
   // 若搜索完成未找到可行路径
   if (final_node_ == nullptr) {
     AERROR << "Hybird A* cannot find a valid path";
@@ -36,6 +36,9 @@
 #include "cyber/common/macros.h"
 #include "cyber/time/clock.h"
 #include "modules/common/configs/vehicle_config_helper.h"
+#include "modules/common/math/aabox2d.h"
+#include "modules/common/math/aaboxkdtree2d.h"
+#include "modules/common/math/line_segment2d.h"
 #include "modules/common/math/math_utils.h"
 #include "modules/planning/planning_base/common/obstacle.h"
 #include "modules/planning/planning_base/gflags/planning_gflags.h"
@@ -56,6 +59,25 @@ struct HybridAStartResult {
   std::vector<double> accumulated_s;
 };
 
+// obstacle line segment indexed by AABoxKDTree2d
+class ObstacleSegmentBox {
+ public:
+  explicit ObstacleSegmentBox(const common::math::LineSegment2d& segment)
+      : segment_(segment), aabox_(segment.start(), segment.end()) {}
+  const common::math::AABox2d& aabox() const { return aabox_; }
+  double DistanceTo(const common::math::Vec2d& point) const {
+    return segment_.DistanceTo(point);
+  }
+  double DistanceSquareTo(const common::math::Vec2d& point) const {
+    return segment_.DistanceSquareTo(point);
+  }
+  const common::math::LineSegment2d& segment() const { return segment_; }
+
+ private:
+  common::math::LineSegment2d segment_;
+  common::math::AABox2d aabox_;
+};
+
 class HybridAStar {
  public:
   explicit HybridAStar(const PlannerOpenSpaceConfig& open_space_conf);
@@ -63,6 +85,8 @@ class HybridAStar {
   bool TrajectoryPartition(
           const HybridAStartResult& result,
           std::vector<HybridAStartResult>* partitioned_result);
+  // nodes expanded by the last Plan
+  size_t explored_node_num() const { return explored_node_num_; }
 
  private:
   bool AnalyticExpansion(
@@ -70,6 +94,12 @@ class HybridAStar {
           std::shared_ptr<Node3d>* candidate_final_node);
   // check collision and validity
   bool ValidityCheck(std::shared_ptr<Node3d> node);
+  // index the segments of obstacles_linesegments_vec_ for ValidityCheck
+  void BuildObstacleIndex();
+  bool HasCollision(const common::math::Box2d& bounding_box) const;
+  // size node_states_ for XYbounds_ and mark every cell unvisited
+  void ResetNodeStates();
+  size_t NodeCell(const Node3d& node) const;
   // check Reeds Shepp path collision and validity
   bool RSPCheck(const std::shared_ptr<ReedSheppPath> reeds_shepp_to_end);
   // load the whole RSP as nodes and add to the close set
@@ -129,6 +159,11 @@ class HybridAStar {
   std::shared_ptr<Node3d> final_node_;
   std::vector<std::vector<common::math::LineSegment2d>>
       obstacles_linesegments_vec_;
+  // the tree points into obstacle_segment_boxes_, nullptr checks all segments
+  std::vector<ObstacleSegmentBox> obstacle_segment_boxes_;
+  std::unique_ptr<common::math::AABoxKDTree2d<ObstacleSegmentBox>>
+      obstacle_kdtree_;
+  size_t explored_node_num_ = 0;
 
   struct cmp {
       bool operator()(
@@ -142,8 +177,17 @@ class HybridAStar {
           std::vector<std::pair<std::shared_ptr<Node3d>, double>>,
           cmp>
           open_pq_;
-  std::unordered_set<std::string> open_set_;
-  std::unordered_set<std::string> close_set_;
+  // open and closed cells of the grid of Node3d, see NodeCell
+  std::vector<uint8_t> node_states_;
+  int x_cells_ = 0;
+  int y_cells_ = 0;
+  int phi_cells_ = 0;
+  // children of the node expanded, opened after the expansion
+  std::vector<size_t> opened_cells_;
+  Node3dPool node_pool_;
+  std::vector<double> intermediate_x_;
+  std::vector<double> intermediate_y_;
+  std::vector<double> intermediate_phi_;
   std::unique_ptr<ReedShepp> reed_shepp_generator_;
   std::unique_ptr<GridSearch> grid_a_star_heuristic_generator_;
 
@@ -79,5 +79,38 @@ TEST_F(HybridATest, test1) {
                                 obstacles_list, &result,
                                 soft_obstacles_list, false));
 }
+
+TEST_F(HybridATest, collision_index) {
+  // a wall sampled every 0.1m with a gap to pass through
+  std::vector<std::vector<Vec2d>> obstacles_list(2);
+  for (int i = 0; i <= 400; ++i) {
+    obstacles_list[0].emplace_back(0.0, -50.0 + i * 0.1);
+    obstacles_list[1].emplace_back(0.0, 10.0 + i * 0.1);
+  }
+  std::vector<double> XYbounds_ = {-50.0, 50.0, -50.0, 50.0};
+
+  // stop at the first path, not at the search time limit
+  planner_open_space_config_.mutable_warm_start_config()
+      ->set_desired_explored_num(1);
+  HybridAStar indexed(planner_open_space_config_);
+  HybridAStartResult indexed_result;
+  ASSERT_TRUE(indexed.Plan(-15.0, 0.0, 0.0, 15.0, 0.0, 0.0, XYbounds_,
+                           obstacles_list, &indexed_result));
+
+  // the index only skips segments far from the vehicle, the path is the same
+  planner_open_space_config_.mutable_warm_start_config()
+      ->set_use_collision_index(false);
+  HybridAStar brute_force(planner_open_space_config_);
+  HybridAStartResult result;
+  ASSERT_TRUE(brute_force.Plan(-15.0, 0.0, 0.0, 15.0, 0.0, 0.0, XYbounds_,
+                               obstacles_list, &result));
+  EXPECT_EQ(result.x, indexed_result.x);
+  EXPECT_EQ(result.y, indexed_result.y);
+  EXPECT_EQ(brute_force.explored_node_num(), indexed.explored_node_num());
+
+  // start pose on the wall
+  EXPECT_FALSE(indexed.Plan(0.0, -20.0, 0.0, 15.0, 0.0, 0.0, XYbounds_,
+                            obstacles_list, &result));
+}
 }  // namespace planning
 }  // namespace apollo
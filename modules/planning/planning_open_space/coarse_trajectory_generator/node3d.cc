@@ -20,8 +20,6 @@
 
 #include "modules/planning/planning_open_space/coarse_trajectory_generator/node3d.h"
 
-#include "absl/strings/str_cat.h"
-
 #include "cyber/common/log.h"
 
 namespace apollo {
@@ -59,7 +57,7 @@ Node3d::Node3d(double x, double y, double phi,
   traversed_y_.push_back(y);
   traversed_phi_.push_back(phi);
 
-  index_ = ComputeStringIndex(x_grid_, y_grid_, phi_grid_);
+  index_ = ComputeIndex(x_grid_, y_grid_, phi_grid_);
 }
 
 // 构造函数，用于从已遍历的点集构造节点
@@ -68,6 +66,14 @@ Node3d::Node3d(const std::vector<double>& traversed_x,
                const std::vector<double>& traversed_phi,
                const std::vector<double>& XYbounds,
                const PlannerOpenSpaceConfig& open_space_conf) {
+  Init(traversed_x, traversed_y, traversed_phi, XYbounds, open_space_conf);
+}
+
+void Node3d::Init(const std::vector<double>& traversed_x,
+                  const std::vector<double>& traversed_y,
+                  const std::vector<double>& traversed_phi,
+                  const std::vector<double>& XYbounds,
+                  const PlannerOpenSpaceConfig& open_space_conf) {
   CHECK_EQ(XYbounds.size(), 4U)
       << "XYbounds size is not 4, but" << XYbounds.size();
   CHECK_EQ(traversed_x.size(), traversed_y.size());
@@ -91,14 +97,22 @@ Node3d::Node3d(const std::vector<double>& traversed_x,
       open_space_conf.warm_start_config().phi_grid_resolution());
 
   // 将已遍历的点集复制到当前节点
-  traversed_x_ = traversed_x;
-  traversed_y_ = traversed_y;
-  traversed_phi_ = traversed_phi;
+  traversed_x_.assign(traversed_x.begin(), traversed_x.end());
+  traversed_y_.assign(traversed_y.begin(), traversed_y.end());
+  traversed_phi_.assign(traversed_phi.begin(), traversed_phi.end());
 
   // 计算当前节点的索引
-  index_ = ComputeStringIndex(x_grid_, y_grid_, phi_grid_);
+  index_ = ComputeIndex(x_grid_, y_grid_, phi_grid_);
   // 计算当前节点已经过的步长
   step_size_ = traversed_x.size();
+
+  traj_cost_ = 0.0;
+  heuristic_cost_ = 0.0;
+  cost_ = 0.0;
+  pre_node_ = nullptr;
+  steering_ = 0.0;
+  direction_ = true;
+  travel_distance_ = 0.0;
 }
 
 Box2d Node3d::GetBoundingBox(const common::VehicleParam& vehicle_param_,
@@ -117,8 +131,38 @@ bool Node3d::operator==(const Node3d& right) const {
     return right.GetIndex() == index_;
 }
 
-std::string Node3d::ComputeStringIndex(int x_grid, int y_grid, int phi_grid) {
-    return absl::StrCat(x_grid, "_", y_grid, "_", phi_grid);
+uint64_t Node3d::ComputeIndex(int x_grid, int y_grid, int phi_grid) {
+  // 21 bits per grid coordinate
+  static constexpr uint64_t kMask = (1ULL << 21) - 1;
+  return ((static_cast<uint64_t>(x_grid) & kMask) << 42) |
+         ((static_cast<uint64_t>(y_grid) & kMask) << 21) |
+         (static_cast<uint64_t>(phi_grid) & kMask);
+}
+
+Node3dPool::~Node3dPool() { DetachNodes(); }
+
+std::shared_ptr<Node3d> Node3dPool::New() {
+  if (arena_->used == arena_->nodes.size()) {
+    arena_->nodes.emplace_back();
+  }
+  // aliasing, the node is owned through the arena
+  return std::shared_ptr<Node3d>(arena_, &arena_->nodes[arena_->used++]);
+}
+
+void Node3dPool::Reset() {
+  DetachNodes();
+  if (arena_.use_count() > 1) {
+    arena_ = std::make_shared<Arena>();
+  } else {
+    arena_->used = 0;
+  }
+}
+
+void Node3dPool::DetachNodes() {
+  // the pre nodes are the references the arena holds to itself
+  for (size_t i = 0; i < arena_->used; ++i) {
+    arena_->nodes[i].SetPre(nullptr);
+  }
 }
 
 }  // namespace planning
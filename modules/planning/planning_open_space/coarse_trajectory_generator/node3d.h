@@ -20,8 +20,9 @@
 
 #pragma once
 
+#include <cstdint>
+#include <deque>
 #include <memory>
-#include <string>
 #include <vector>
 
 #include "modules/common_msgs/config_msgs/vehicle_config.pb.h"
@@ -34,6 +35,7 @@ namespace planning {
 
 class Node3d {
  public:
+  Node3d() = default;
   Node3d(const double x, const double y, const double phi);
   Node3d(const double x,
           const double y,
@@ -46,6 +48,13 @@ class Node3d {
           const std::vector<double>& XYbounds,
           const PlannerOpenSpaceConfig& open_space_conf);
   virtual ~Node3d() = default;
+  // reset to a node constructed from the traversed points, the vectors keep
+  // their capacity
+  void Init(const std::vector<double>& traversed_x,
+            const std::vector<double>& traversed_y,
+            const std::vector<double>& traversed_phi,
+            const std::vector<double>& XYbounds,
+            const PlannerOpenSpaceConfig& open_space_conf);
   static apollo::common::math::Box2d GetBoundingBox(
           const common::VehicleParam& vehicle_param_,
           const double x,
@@ -66,6 +75,9 @@ class Node3d {
   int GetGridY() const {
       return y_grid_;
   }
+  int GetGridPhi() const {
+      return phi_grid_;
+  }
   double GetX() const {
       return x_;
   }
@@ -76,7 +88,7 @@ class Node3d {
       return phi_;
   }
   bool operator==(const Node3d& right) const;
-  const std::string& GetIndex() const {
+  uint64_t GetIndex() const {
       return index_;
   }
   size_t GetStepSize() const {
@@ -123,8 +135,7 @@ class Node3d {
   }
 
  private:
-  static std::string ComputeStringIndex(
-          int x_grid, int y_grid, int phi_grid);
+  static uint64_t ComputeIndex(int x_grid, int y_grid, int phi_grid);
 
  private:
   double x_ = 0.0;
@@ -137,7 +148,7 @@ class Node3d {
   int x_grid_ = 0;    // 当前节点在栅格地图中的x坐标
   int y_grid_ = 0;    // 当前节点在栅格地图中的y坐标
   int phi_grid_ = 0;    // 当前节点在栅格地图中的phi坐标
-  std::string index_;    // 当前节点的索引
+  uint64_t index_ = 0;    // 当前节点的索引
   double traj_cost_ = 0.0;  // 当前节点的轨迹代价，即 f = g + h 中的 g
   double heuristic_cost_ = 0.0;  // 启发代价，即 h
   double cost_ = 0.0;
@@ -163,5 +174,34 @@ class Node3d {
           const WarmStartConfig& warm_start_conf);
 };
 
+/**
+ * @class Node3dPool
+ * @brief Node storage of a search, reused by the next search.
+ *
+ * The nodes handed out share the ownership of the arena, no node is
+ * allocated on its own and Node3d::Init reuses the vectors of the nodes of
+ * the previous search. Reset detaches the nodes from their pre nodes, so a
+ * node held beyond it keeps the arena alive but not its path.
+ */
+class Node3dPool {
+ public:
+  Node3dPool() = default;
+  ~Node3dPool();
+
+  std::shared_ptr<Node3d> New();
+  void Reset();
+  size_t size() const { return arena_->used; }
+
+ private:
+  void DetachNodes();
+
+  struct Arena {
+    // stable addresses on growth
+    std::deque<Node3d> nodes;
+    size_t used = 0;
+  };
+  std::shared_ptr<Arena> arena_ = std::make_shared<Arena>();
+};
+
 }  // namespace planning
 }  // namespace apollo
@@ -62,5 +62,36 @@ TEST_F(Node3dTest, GetBoundingBox) {
   ASSERT_EQ(test_box.width(), gold_box.width());
 }
 
+TEST(Node3dPoolTest, ReuseNodes) {
+  PlannerOpenSpaceConfig open_space_conf;
+  std::vector<double> XYbounds = {-10.0, 10.0, -10.0, 10.0};
+  Node3dPool pool;
+  std::shared_ptr<Node3d> node = pool.New();
+  const Node3d* first = node.get();
+  node->Init({0.0, 1.0}, {0.0, 1.0}, {0.0, 0.1}, XYbounds, open_space_conf);
+  for (int i = 0; i < 100; ++i) {
+    std::shared_ptr<Node3d> next_node = pool.New();
+    next_node->Init({1.0}, {1.0}, {0.1}, XYbounds, open_space_conf);
+    next_node->SetPre(node);
+    node = next_node;
+  }
+  EXPECT_EQ(pool.size(), 101U);
+  EXPECT_EQ(node->GetIndex(), node->GetPreNode()->GetIndex());
+
+  // the next search gets the nodes of the last one
+  node.reset();
+  pool.Reset();
+  node = pool.New();
+  EXPECT_EQ(node.get(), first);
+  node->Init({2.0}, {3.0}, {0.0}, XYbounds, open_space_conf);
+  EXPECT_EQ(node->GetStepSize(), 1U);
+  EXPECT_EQ(node->GetPreNode(), nullptr);
+
+  // a node held beyond the search stays valid
+  pool.Reset();
+  EXPECT_NE(pool.New().get(), node.get());
+  EXPECT_EQ(node->GetX(), 2.0);
+}
+
 }  // namespace planning
 }  // namespace apollo
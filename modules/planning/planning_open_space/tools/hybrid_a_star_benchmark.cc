@@ -0,0 +1,184 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+// Hybrid A* search time and node throughput with and without the obstacle
+// kd-tree (use_collision_index of WarmStartConfig), on parking lots whose
+// boundaries are sampled every sample_distance meters like ROI boundaries.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "gflags/gflags.h"
+
+#include "cyber/common/file.h"
+#include "modules/common/math/vec2d.h"
+#include "modules/planning/planning_base/gflags/planning_gflags.h"
+#include "modules/planning/planning_open_space/coarse_trajectory_generator/hybrid_a_star.h"
+
+DEFINE_int32(iterations, 5, "plans per scenario and mode");
+DEFINE_double(sample_distance, 0.1, "length of the boundary segments");
+DEFINE_int32(slot_num, 8, "parking slots per row");
+
+namespace apollo {
+namespace planning {
+
+using apollo::common::math::Vec2d;
+
+struct Scenario {
+  std::string name;
+  double sx = 0.0;
+  double sy = 0.0;
+  double sphi = 0.0;
+  double ex = 0.0;
+  double ey = 0.0;
+  double ephi = 0.0;
+  std::vector<double> xy_bounds;
+  std::vector<std::vector<Vec2d>> obstacles;
+};
+
+// the polyline with its edges cut into segments of sample_distance
+std::vector<Vec2d> Densify(const std::vector<Vec2d>& vertices) {
+  std::vector<Vec2d> points;
+  for (size_t i = 0; i + 1 < vertices.size(); ++i) {
+    const Vec2d edge = vertices[i + 1] - vertices[i];
+    const int steps = std::max(
+        1, static_cast<int>(std::ceil(edge.Length() / FLAGS_sample_distance)));
+    for (int j = 0; j < steps; ++j) {
+      points.push_back(vertices[i] + edge * (static_cast<double>(j) / steps));
+    }
+  }
+  points.push_back(vertices.back());
+  return points;
+}
+
+std::vector<Vec2d> Rectangle(double min_x, double min_y, double max_x,
+                             double max_y) {
+  return Densify({{min_x, min_y},
+                  {max_x, min_y},
+                  {max_x, max_y},
+                  {min_x, max_y},
+                  {min_x, min_y}});
+}
+
+// reverse into the middle slot of a row of perpendicular slots below the
+// aisle, the other slots are taken
+Scenario PerpendicularScenario() {
+  const double slot_width = 2.8;
+  const double slot_depth = 5.5;
+  const double half_row = FLAGS_slot_num * slot_width / 2.0;
+  Scenario scenario;
+  scenario.name = "perpendicular";
+  scenario.sx = -half_row + 3.0;
+  scenario.sy = 3.5;
+  scenario.ex = slot_width / 2.0;
+  scenario.ey = -4.2;
+  scenario.ephi = M_PI_2;
+  scenario.xy_bounds = {-half_row - 2.0, half_row + 2.0, -slot_depth - 1.0,
+                        9.0};
+  const int target = FLAGS_slot_num / 2;
+  for (int i = 0; i < FLAGS_slot_num; ++i) {
+    const double left = -half_row + i * slot_width;
+    if (i == target) {
+      continue;
+    }
+    scenario.obstacles.push_back(Rectangle(left + 0.35, -slot_depth + 0.3,
+                                           left + slot_width - 0.35, -0.4));
+  }
+  scenario.obstacles.push_back(
+      Densify({{-half_row, -slot_depth}, {half_row, -slot_depth}}));
+  scenario.obstacles.push_back(Densify({{-half_row, 8.0}, {half_row, 8.0}}));
+  return scenario;
+}
+
+// parallel parking between two of the cars along the curb
+Scenario ParallelScenario() {
+  const double gap = 7.5;
+  const double half_row = gap / 2.0 + FLAGS_slot_num * 6.0;
+  Scenario scenario;
+  scenario.name = "parallel";
+  scenario.sx = -gap / 2.0 - 6.0;
+  scenario.sy = 2.5;
+  scenario.ex = -1.4;
+  scenario.ey = -1.3;
+  scenario.xy_bounds = {-half_row - 2.0, half_row + 2.0, -3.0, 7.0};
+  for (int i = 0; i < FLAGS_slot_num; ++i) {
+    const double offset = gap / 2.0 + 0.5 + i * 6.0;
+    scenario.obstacles.push_back(Rectangle(offset, -2.3, offset + 4.9, -0.3));
+    scenario.obstacles.push_back(
+        Rectangle(-offset - 4.9, -2.3, -offset, -0.3));
+  }
+  scenario.obstacles.push_back(
+      Densify({{-half_row, -2.5}, {half_row, -2.5}}));
+  scenario.obstacles.push_back(Densify({{-half_row, 6.5}, {half_row, 6.5}}));
+  return scenario;
+}
+
+void Run(const Scenario& scenario, PlannerOpenSpaceConfig config,
+         bool use_collision_index) {
+  config.mutable_warm_start_config()->set_use_collision_index(
+      use_collision_index);
+  HybridAStar hybrid_a_star(config);
+  size_t segment_num = 0;
+  for (const auto& obstacle : scenario.obstacles) {
+    segment_num += obstacle.size() - 1;
+  }
+
+  int success = 0;
+  size_t explored = 0;
+  double total_ms = 0.0;
+  for (int i = 0; i < FLAGS_iterations; ++i) {
+    HybridAStartResult result;
+    auto start = std::chrono::steady_clock::now();
+    if (hybrid_a_star.Plan(scenario.sx, scenario.sy, scenario.sphi,
+                           scenario.ex, scenario.ey, scenario.ephi,
+                           scenario.xy_bounds, scenario.obstacles, &result)) {
+      ++success;
+    }
+    total_ms += std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+    explored += hybrid_a_star.explored_node_num();
+  }
+  std::cout << scenario.name << " segments: " << segment_num
+            << " index: " << (use_collision_index ? "on " : "off")
+            << " success: " << success << "/" << FLAGS_iterations
+            << " avg ms: " << total_ms / FLAGS_iterations
+            << " nodes/s: " << explored / (total_ms / 1000.0) << std::endl;
+}
+
+}  // namespace planning
+}  // namespace apollo
+
+int main(int argc, char* argv[]) {
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  apollo::planning::PlannerOpenSpaceConfig config;
+  if (!apollo::cyber::common::GetProtoFromFile(
+          FLAGS_planner_open_space_config_filename, &config)) {
+    std::cout << "failed to load " << FLAGS_planner_open_space_config_filename
+              << std::endl;
+    return -1;
+  }
+  for (const auto& scenario : {apollo::planning::PerpendicularScenario(),
+                               apollo::planning::ParallelScenario()}) {
+    apollo::planning::Run(scenario, config, false);
+    apollo::planning::Run(scenario, config, true);
+  }
+  return 0;
+}
@@ -20,9 +20,12 @@
 
 #include "modules/planning/scenarios/lane_follow/lane_follow_stage.h"
 
+#include <algorithm>
+#include <future>
 #include <utility>
 
 #include "cyber/common/log.h"
+#include "cyber/task/task.h"
 #include "cyber/time/clock.h"
 #include "modules/common/math/math_utils.h"
 #include "modules/common/util/point_factory.h"
@@ -32,6 +35,7 @@
 #include "modules/map/hdmap/hdmap_common.h"
 #include "modules/planning/planning_base/common/ego_info.h"
 #include "modules/planning/planning_base/common/frame.h"
+#include "modules/planning/planning_base/common/planning_context.h"
 #include "modules/planning/planning_base/common/speed_profile_generator.h"
 #include "modules/planning/planning_base/gflags/planning_gflags.h"
 #include "modules/planning/planning_base/math/constraint_checker/constraint_checker.h"
@@ -90,6 +94,19 @@ StageResult LaneFollowStage::Process(
   ADEBUG << "Number of reference lines:\t"
          << frame->mutable_reference_line_info()->size();
 
+  // a task reaching into the other reference lines needs them planned in
+  // order, e.g. the change lane lines before the current lane
+  const bool reaches_other_lines =
+      std::any_of(task_list_.begin(), task_list_.end(),
+                  [](const std::shared_ptr<Task>& task) {
+                    return task->ReachesOtherReferenceLines();
+                  });
+  if (FLAGS_enable_parallel_reference_line_planning && !reaches_other_lines &&
+      frame->reference_line_info().size() > 1 &&
+      CreateLineTasks(frame->reference_line_info().size() - 1)) {
+    return ProcessInParallel(planning_start_point, frame);
+  }
+
   unsigned int count = 0;
   StageResult result;
   for (auto& reference_line_info : *frame->mutable_reference_line_info()) {
@@ -107,35 +124,119 @@ StageResult LaneFollowStage::Process(
 
     result =
         PlanOnReferenceLine(planning_start_point, frame, &reference_line_info);
+    UpdateDrivable(result, &reference_line_info, &has_drivable_reference_line);
+  }
 
-    if (!result.HasError()) {
-      if (!reference_line_info.IsChangeLanePath()) {
-        ADEBUG << "reference line is NOT lane change ref.";
-        has_drivable_reference_line = true;
-        continue;
-      }
-      if (reference_line_info.Cost() < kStraightForwardLineCost) {
-        // If the path and speed optimization succeed on target lane while
-        // under smart lane-change or IsClearToChangeLane under older version
-        has_drivable_reference_line = true;
-        reference_line_info.SetDrivable(true);
-      } else {
-        reference_line_info.SetDrivable(false);
-        ADEBUG << "\tlane change failed";
-      }
+  return has_drivable_reference_line
+             ? result.SetStageStatus(StageStatusType::RUNNING)
+             : result.SetStageStatus(StageStatusType::ERROR);
+}
+
+StageResult LaneFollowStage::ProcessInParallel(
+    const TrajectoryPoint& planning_start_point, Frame* frame) {
+  std::vector<ReferenceLineInfo*> reference_line_infos;
+  for (auto& reference_line_info : *frame->mutable_reference_line_info()) {
+    reference_line_infos.push_back(&reference_line_info);
+  }
+  const size_t line_num = reference_line_infos.size();
+
+  // every reference line plans on a copy of the planning status, the one of
+  // the line the sequential planning would have stopped at is kept
+  auto* planning_context = injector_->planning_context();
+  std::vector<PlanningStatus> planning_status(
+      line_num, planning_context->planning_status());
+  std::vector<StageResult> results(line_num);
+  auto plan = [&](const size_t i) {
+    PlanningContext::ScopedStatus scoped_status(planning_context,
+                                                &planning_status[i]);
+    if (i == 0) {
+      results[i] = PlanOnReferenceLine(planning_start_point, frame,
+                                       reference_line_infos[i], task_list_,
+                                       fallback_task_);
     } else {
-      reference_line_info.SetDrivable(false);
+      results[i] = PlanOnReferenceLine(
+          planning_start_point, frame, reference_line_infos[i],
+          line_tasks_[i - 1].task_list, line_tasks_[i - 1].fallback_task);
     }
+  };
+  std::vector<std::future<void>> futures;
+  for (size_t i = 1; i < line_num; ++i) {
+    futures.push_back(cyber::Async(plan, i));
+  }
+  plan(0);
+  for (auto& future : futures) {
+    future.get();
   }
 
+  bool has_drivable_reference_line = false;
+  size_t selected = 0;
+  StageResult result;
+  for (size_t i = 0; i < line_num; ++i) {
+    // planned as well, but the sequential planning never gets here
+    if (has_drivable_reference_line) {
+      reference_line_infos[i]->SetDrivable(false);
+      continue;
+    }
+    selected = i;
+    result = results[i];
+    UpdateDrivable(result, reference_line_infos[i],
+                   &has_drivable_reference_line);
+  }
+  *planning_context->mutable_planning_status() =
+      std::move(planning_status[selected]);
+
   return has_drivable_reference_line
              ? result.SetStageStatus(StageStatusType::RUNNING)
              : result.SetStageStatus(StageStatusType::ERROR);
 }
 
+void LaneFollowStage::UpdateDrivable(const StageResult& result,
+                                     ReferenceLineInfo* reference_line_info,
+                                     bool* has_drivable_reference_line) {
+  if (!result.HasError()) {
+    if (!reference_line_info->IsChangeLanePath()) {
+      ADEBUG << "reference line is NOT lane change ref.";
+      *has_drivable_reference_line = true;
+      return;
+    }
+    if (reference_line_info->Cost() < kStraightForwardLineCost) {
+      // If the path and speed optimization succeed on target lane while
+      // under smart lane-change or IsClearToChangeLane under older version
+      *has_drivable_reference_line = true;
+      reference_line_info->SetDrivable(true);
+    } else {
+      reference_line_info->SetDrivable(false);
+      ADEBUG << "\tlane change failed";
+    }
+  } else {
+    reference_line_info->SetDrivable(false);
+  }
+}
+
+bool LaneFollowStage::CreateLineTasks(const size_t line_num) {
+  while (line_tasks_.size() < line_num) {
+    LineTasks line_tasks;
+    if (!CreateTasks(&line_tasks.task_list, &line_tasks.fallback_task)) {
+      AERROR << "Failed to create tasks for parallel planning of " << Name();
+      return false;
+    }
+    line_tasks_.push_back(std::move(line_tasks));
+  }
+  return true;
+}
+
 StageResult LaneFollowStage::PlanOnReferenceLine(
     const TrajectoryPoint& planning_start_point, Frame* frame,
     ReferenceLineInfo* reference_line_info) {
+  return PlanOnReferenceLine(planning_start_point, frame, reference_line_info,
+                             task_list_, fallback_task_);
+}
+
+StageResult LaneFollowStage::PlanOnReferenceLine(
+    const TrajectoryPoint& planning_start_point, Frame* frame,
+    ReferenceLineInfo* reference_line_info,
+    const std::vector<std::shared_ptr<Task>>& task_list,
+    const std::shared_ptr<Task>& fallback_task) {
   if (!reference_line_info->IsChangeLanePath()) {
     reference_line_info->AddCost(kStraightForwardLineCost);
   }
@@ -144,7 +245,7 @@ StageResult LaneFollowStage::PlanOnReferenceLine(
          << reference_line_info->IsChangeLanePath();
 
   StageResult ret;
-  for (auto task : task_list_) {
+  for (auto task : task_list) {
     const double start_timestamp = Clock::NowInSeconds();
     const auto start_planning_perf_timestamp =
         std::chrono::duration<double>(
@@ -188,7 +289,7 @@ StageResult LaneFollowStage::PlanOnReferenceLine(
   // check path and speed results for path or speed fallback
   reference_line_info->set_trajectory_type(ADCTrajectory::NORMAL);
   if (ret.IsTaskError()) {
-    fallback_task_->Execute(frame, reference_line_info);
+    fallback_task->Execute(frame, reference_line_info);
   }
 
   DiscretizedTrajectory trajectory;
@@ -45,6 +45,12 @@ class LaneFollowStage : public Stage {
       const common::TrajectoryPoint& planning_start_point, Frame* frame,
       ReferenceLineInfo* reference_line_info);
 
+  virtual StageResult PlanOnReferenceLine(
+      const common::TrajectoryPoint& planning_start_point, Frame* frame,
+      ReferenceLineInfo* reference_line_info,
+      const std::vector<std::shared_ptr<Task>>& task_list,
+      const std::shared_ptr<Task>& fallback_task);
+
   void PlanFallbackTrajectory(
       const common::TrajectoryPoint& planning_start_point, Frame* frame,
       ReferenceLineInfo* reference_line_info);
@@ -53,6 +59,31 @@ class LaneFollowStage : public Stage {
                             const ReferenceLine& reference_line) const;
 
   void RecordObstacleDebugInfo(ReferenceLineInfo* reference_line_info);
+
+ protected:
+  // task instances for the reference lines after the first one
+  virtual bool CreateLineTasks(const size_t line_num);
+
+  struct LineTasks {
+    std::vector<std::shared_ptr<Task>> task_list;
+    std::shared_ptr<Task> fallback_task;
+  };
+  std::vector<LineTasks> line_tasks_;
+
+ private:
+  /**
+   * @brief Plan all reference lines concurrently on the cyber task pool, the
+   * first one on the calling thread, then select as the sequential planning
+   * does
+   */
+  StageResult ProcessInParallel(
+      const common::TrajectoryPoint& planning_start_point, Frame* frame);
+
+  // drivable of the reference line by its planning result, as selected in
+  // the order of the reference lines
+  void UpdateDrivable(const StageResult& result,
+                      ReferenceLineInfo* reference_line_info,
+                      bool* has_drivable_reference_line);
 };
 
 CYBER_PLUGIN_MANAGER_REGISTER_PLUGIN(apollo::planning::LaneFollowStage, Stage)
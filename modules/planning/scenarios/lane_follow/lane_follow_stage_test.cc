@@ -0,0 +1,173 @@
+/******************************************************************************
+ * Copyright 2024 The Apollo Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+/**
+ * @file
+ **/
+
+#include "modules/planning/scenarios/lane_follow/lane_follow_stage.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "modules/planning/planning_base/common/frame.h"
+#include "modules/planning/planning_base/common/planning_context.h"
+#include "modules/planning/planning_base/gflags/planning_gflags.h"
+#include "modules/planning/planning_interface_base/task_base/task.h"
+
+namespace apollo {
+namespace planning {
+
+namespace {
+
+// plans a reference line by its cost: a negative cost fails, any other cost
+// is written to the planning status as the path id
+class FakeLaneFollowStage : public LaneFollowStage {
+ public:
+  explicit FakeLaneFollowStage(
+      const std::shared_ptr<DependencyInjector>& injector) {
+    injector_ = injector;
+  }
+
+  using LaneFollowStage::PlanOnReferenceLine;
+
+  StageResult PlanOnReferenceLine(
+      const common::TrajectoryPoint& planning_start_point, Frame* frame,
+      ReferenceLineInfo* reference_line_info,
+      const std::vector<std::shared_ptr<Task>>& task_list,
+      const std::shared_ptr<Task>& fallback_task) override {
+    ++planned_num_;
+    StageResult result;
+    if (reference_line_info->Cost() < 0.0) {
+      return result.SetStageStatus(StageStatusType::ERROR, "fake failure");
+    }
+    injector_->planning_context()
+        ->mutable_planning_status()
+        ->mutable_change_lane()
+        ->set_path_id(std::to_string(reference_line_info->Cost()));
+    return result;
+  }
+
+  void AddTask(const std::shared_ptr<Task>& task) {
+    task_list_.push_back(task);
+  }
+
+  int planned_num() const { return planned_num_.load(); }
+
+ protected:
+  bool CreateLineTasks(const size_t line_num) override {
+    line_tasks_.resize(line_num);
+    return true;
+  }
+
+ private:
+  std::atomic<int> planned_num_ = {0};
+};
+
+class ReachingTask : public Task {
+ public:
+  bool ReachesOtherReferenceLines() const override { return true; }
+};
+
+struct PlanResult {
+  StageStatusType stage_status;
+  std::vector<bool> drivable;
+  PlanningStatus planning_status;
+  int planned_num;
+};
+
+// all lines are change lane paths, which are drivable below a cost of 10
+PlanResult Plan(const std::vector<double>& costs, const bool parallel,
+                const std::shared_ptr<Task>& task = nullptr) {
+  FLAGS_enable_parallel_reference_line_planning = parallel;
+  auto injector = std::make_shared<DependencyInjector>();
+  injector->planning_context()
+      ->mutable_planning_status()
+      ->mutable_change_lane()
+      ->set_path_id("previous");
+  FakeLaneFollowStage stage(injector);
+  if (task != nullptr) {
+    stage.AddTask(task);
+  }
+  Frame frame(1);
+  for (const double cost : costs) {
+    frame.mutable_reference_line_info()->emplace_back();
+    frame.mutable_reference_line_info()->back().SetCost(cost);
+  }
+
+  PlanResult plan_result;
+  plan_result.stage_status =
+      stage.Process(common::TrajectoryPoint(), &frame).GetStageStatus();
+  for (const auto& reference_line_info : frame.reference_line_info()) {
+    plan_result.drivable.push_back(reference_line_info.IsDrivable());
+  }
+  plan_result.planning_status =
+      injector->planning_context()->planning_status();
+  plan_result.planned_num = stage.planned_num();
+  FLAGS_enable_parallel_reference_line_planning = false;
+  return plan_result;
+}
+
+void ExpectSameResult(const std::vector<double>& costs) {
+  const auto sequential = Plan(costs, false);
+  const auto parallel = Plan(costs, true);
+  EXPECT_EQ(sequential.stage_status, parallel.stage_status);
+  EXPECT_EQ(sequential.drivable, parallel.drivable);
+  EXPECT_EQ(sequential.planning_status.DebugString(),
+            parallel.planning_status.DebugString());
+  EXPECT_EQ(parallel.planned_num, static_cast<int>(costs.size()));
+}
+
+}  // namespace
+
+TEST(LaneFollowStageTest, parallel_selects_as_sequential) {
+  // the first line is too expensive to change to, the second is selected
+  ExpectSameResult({20.0, 1.0});
+  const auto result = Plan({20.0, 1.0}, true);
+  EXPECT_EQ(StageStatusType::RUNNING, result.stage_status);
+  EXPECT_EQ(std::vector<bool>({false, true}), result.drivable);
+  EXPECT_EQ(std::to_string(1.0),
+            result.planning_status.change_lane().path_id());
+
+  // the first line is selected, the second is planned in vain
+  ExpectSameResult({1.0, 2.0});
+  EXPECT_EQ(std::vector<bool>({true, false}), Plan({1.0, 2.0}, true).drivable);
+
+  // a failed line and a line stopped in sequential planning
+  ExpectSameResult({-1.0, 1.0, 2.0});
+
+  // no line is drivable
+  ExpectSameResult({-1.0, 20.0});
+  EXPECT_EQ(StageStatusType::ERROR, Plan({-1.0, 20.0}, true).stage_status);
+
+  // a failed line only keeps the previous status
+  ExpectSameResult({-1.0, -1.0});
+  EXPECT_EQ("previous",
+            Plan({-1.0, -1.0}, true).planning_status.change_lane().path_id());
+}
+
+TEST(LaneFollowStageTest, sequential_for_task_reaching_other_lines) {
+  const auto result =
+      Plan({1.0, 2.0, 3.0}, true, std::make_shared<ReachingTask>());
+  EXPECT_EQ(1, result.planned_num);
+  EXPECT_EQ(std::vector<bool>({true, false, false}), result.drivable);
+}
+
+}  // namespace planning
+}  // namespace apollo
@@ -213,9 +213,12 @@ bool LaneFollowPath::OptimizePath(
     PathOptimizerUtil::UpdatePathRefWithBound(path_boundary,
                                               config.path_reference_l_weight(),
                                               towing_l, &ref_l, &weight_ref_l);
+    PiecewiseJerkWorkspace* workspace =
+        config.persistent_workspace() ? GetWorkspace(path_boundary.label())
+                                      : nullptr;
     bool res_opt = PathOptimizerUtil::OptimizePath(
         init_sl_state_, end_state, ref_l, weight_ref_l, path_boundary,
-        ddl_bounds, jerk_bound, config, &opt_l, &opt_dl, &opt_ddl);
+        ddl_bounds, jerk_bound, config, &opt_l, &opt_dl, &opt_ddl, workspace);
     if (res_opt) {
       auto frenet_frame_path = PathOptimizerUtil::ToPiecewiseJerkPath(
           opt_l, opt_dl, opt_ddl, path_boundary.delta_s(),
@@ -246,6 +249,26 @@ bool LaneFollowPath::OptimizePath(
   return true;
 }
 
+PiecewiseJerkWorkspace* LaneFollowPath::GetWorkspace(
+    const std::string& label) {
+  const uint32_t sequence_num = frame_->SequenceNum();
+  // drop the workspaces of lanes left behind
+  for (auto iter = workspaces_.begin(); iter != workspaces_.end();) {
+    if (iter->second.sequence_num + 1 < sequence_num) {
+      iter = workspaces_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+  auto& entry =
+      workspaces_[absl::StrCat(reference_line_info_->Lanes().Id(), "/", label)];
+  if (entry.workspace == nullptr) {
+    entry.workspace = std::make_unique<PiecewiseJerkWorkspace>();
+  }
+  entry.sequence_num = sequence_num;
+  return entry.workspace.get();
+}
+
 bool LaneFollowPath::AssessPath(std::vector<PathData>* candidate_path_data,
                                 PathData* final_path) {
   PathData& curr_path_data = candidate_path_data->back();
@@ -22,9 +22,11 @@
 
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "modules/planning/tasks/lane_follow_path/proto/lane_follow_path.pb.h"
 #include "cyber/plugin_manager/plugin_manager.h"
+#include "modules/planning/planning_base/math/piecewise_jerk/piecewise_jerk_problem.h"
 #include "modules/planning/planning_interface_base/task_base/common/path_generation.h"
 
 namespace apollo {
@@ -57,8 +59,21 @@ class LaneFollowPath : public PathGeneration {
    */
   bool AssessPath(std::vector<PathData>* candidate_path_data,
                   PathData* final_path);
+  /**
+   * @brief The solver workspace of a path boundary on the current reference
+   * line, kept while the lanes are planned on cycle after cycle
+   */
+  PiecewiseJerkWorkspace* GetWorkspace(const std::string& label);
 
   LaneFollowPathConfig config_;
+
+  struct WorkspaceEntry {
+    std::unique_ptr<PiecewiseJerkWorkspace> workspace;
+    // frame sequence number of the last use
+    uint32_t sequence_num = 0;
+  };
+  // key: lanes id and path boundary label
+  std::unordered_map<std::string, WorkspaceEntry> workspaces_;
 };
 
 CYBER_PLUGIN_MANAGER_REGISTER_PLUGIN(apollo::planning::LaneFollowPath, Task)
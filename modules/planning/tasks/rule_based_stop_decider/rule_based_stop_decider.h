@@ -32,6 +32,11 @@ class RuleBasedStopDecider : public Decider {
   bool Init(const std::string& config_dir, const std::string& name,
             const std::shared_ptr<DependencyInjector>& injector) override;
 
+  // the urgent lane change check reads the decisions of the other lines
+  bool ReachesOtherReferenceLines() const override {
+    return config_.enable_lane_change_urgency_checking();
+  }
+
  private:
   apollo::common::Status Process(
       Frame* const frame,
@@ -73,6 +78,9 @@ class RuleBasedStopDecider : public Decider {
   RuleBasedStopDeciderConfig config_;
   bool is_clear_to_change_lane_ = false;
   bool is_change_lane_planning_succeed_ = false;
+  // side pass stop waiting for the lane to clear
+  bool check_clear_ = false;
+  common::PathPoint change_lane_stop_path_point_;
 };
 
 CYBER_PLUGIN_MANAGER_REGISTER_PLUGIN(apollo::planning::RuleBasedStopDecider,
@@ -0,0 +1,15 @@
+"""Loads the zstd library"""
+
+# Sanitize a dependency so that it works correctly from code that includes
+# Apollo as a submodule.
+def clean_dep(dep):
+    return str(Label(dep))
+
+# Installed via libzstd-dev
+def repo():
+    # zstd
+    native.new_local_repository(
+        name = "zstd",
+        build_file = clean_dep("//third_party/zstd:zstd.BUILD"),
+        path = "/usr/include",
+    )